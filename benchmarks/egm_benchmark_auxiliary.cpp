@@ -0,0 +1,159 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include "egm.pb.h"         // Generated by Google Protocol Buffer compiler protoc
+#include "egm_wrapper.pb.h" // Generated by Google Protocol Buffer compiler protoc
+
+#include "abb_libegm/egm_common_auxiliary.h"
+#include "abb_libegm/egm_decoder.h"
+
+#include "egm_benchmark_common.h"
+
+namespace abb
+{
+namespace egm
+{
+namespace benchmarks
+{
+namespace
+{
+/***********************************************************************************************************************
+ * Benchmarks
+ */
+
+void benchmarkProtobufParse(benchmark::State& state)
+{
+  const std::string packet = generatePackets(1, Six)[0];
+  EgmRobot robot;
+
+  AllocationScope allocation_scope(state);
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(robot.ParseFromArray(packet.data(), (int) packet.size()));
+  }
+}
+
+void benchmarkDirectDecode(benchmark::State& state)
+{
+  const std::string packet = generatePackets(1, Six)[0];
+  RobotData robot_data;
+
+  AllocationScope allocation_scope(state);
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(decode(&robot_data, packet.data(), (int) packet.size()));
+  }
+}
+
+void benchmarkParseFeedback(benchmark::State& state)
+{
+  const RobotAxes axes = (RobotAxes) state.range(0);
+  const std::string packet = generatePackets(1, axes)[0];
+
+  EgmRobot robot;
+  robot.ParseFromArray(packet.data(), (int) packet.size());
+
+  wrapper::Feedback feedback;
+  parse(&feedback, robot.feedback(), axes);
+
+  AllocationScope allocation_scope(state);
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(parse(&feedback, robot.feedback(), axes));
+  }
+}
+
+void benchmarkParseFeedbackDecoded(benchmark::State& state)
+{
+  const RobotAxes axes = (RobotAxes) state.range(0);
+  const std::string packet = generatePackets(1, axes)[0];
+
+  RobotData robot_data;
+  decode(&robot_data, packet.data(), (int) packet.size());
+
+  wrapper::Feedback feedback;
+  parse(&feedback, robot_data.feedback, axes);
+
+  AllocationScope allocation_scope(state);
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(parse(&feedback, robot_data.feedback, axes));
+  }
+}
+
+void benchmarkCopyPresent(benchmark::State& state)
+{
+  wrapper::Output source;
+  wrapper::Output target;
+
+  for (int i = 0; i < 6; ++i)
+  {
+    source.mutable_robot()->mutable_joints()->mutable_position()->add_values(i);
+    source.mutable_robot()->mutable_joints()->mutable_velocity()->add_values(i);
+  }
+  source.mutable_robot()->mutable_cartesian()->mutable_pose()->mutable_position()->set_x(1.0);
+  source.mutable_robot()->mutable_cartesian()->mutable_pose()->mutable_position()->set_y(2.0);
+  source.mutable_robot()->mutable_cartesian()->mutable_pose()->mutable_position()->set_z(3.0);
+  source.mutable_robot()->mutable_cartesian()->mutable_pose()->mutable_quaternion()->set_u0(1.0);
+  source.mutable_robot()->mutable_cartesian()->mutable_pose()->mutable_quaternion()->set_u1(0.0);
+  source.mutable_robot()->mutable_cartesian()->mutable_pose()->mutable_quaternion()->set_u2(0.0);
+  source.mutable_robot()->mutable_cartesian()->mutable_pose()->mutable_quaternion()->set_u3(0.0);
+  target.CopyFrom(source);
+
+  AllocationScope allocation_scope(state);
+
+  for (auto _ : state)
+  {
+    copyPresent(&target, source);
+    benchmark::DoNotOptimize(target);
+  }
+}
+
+} // end namespace
+
+BENCHMARK(benchmarkProtobufParse);
+BENCHMARK(benchmarkDirectDecode);
+BENCHMARK(benchmarkParseFeedback)->Arg(Six)->Arg(Seven);
+BENCHMARK(benchmarkParseFeedbackDecoded)->Arg(Six)->Arg(Seven);
+BENCHMARK(benchmarkCopyPresent);
+
+} // end namespace benchmarks
+} // end namespace egm
+} // end namespace abb
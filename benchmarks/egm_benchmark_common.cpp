@@ -0,0 +1,193 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+#include <boost/atomic.hpp>
+
+#include "egm.pb.h" // Generated by Google Protocol Buffer compiler protoc
+
+#include "abb_libegm/egm_realtime_checker.h"
+
+#include "egm_benchmark_common.h"
+
+namespace
+{
+/**
+ * \brief Counter for the number of heap allocations (updated by the replaced global operator new).
+ */
+boost::atomic<size_t> allocation_counter(0);
+}
+
+/***********************************************************************************************************************
+ * Replaced global allocation functions (for counting allocations, incl. those made inside the library)
+ */
+
+void* operator new(std::size_t size)
+{
+  allocation_counter.fetch_add(1, boost::memory_order_relaxed);
+
+  // Also report the allocation to the real-time checker (a no-op, unless the library is built with the checks).
+  abb::egm::EGMRealTimeChecker::recordAllocation();
+
+  void* p = std::malloc(size > 0 ? size : 1);
+
+  if (!p)
+  {
+    throw std::bad_alloc();
+  }
+
+  return p;
+}
+
+void* operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void* p) throw()
+{
+  std::free(p);
+}
+
+void operator delete[](void* p) throw()
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) throw()
+{
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) throw()
+{
+  std::free(p);
+}
+
+namespace abb
+{
+namespace egm
+{
+namespace benchmarks
+{
+/***********************************************************************************************************************
+ * Function definitions
+ */
+
+std::vector<std::string> generatePackets(const size_t number_of_packets, const RobotAxes axes)
+{
+  const double SAMPLE_TIME = 0.004;
+  const int number_of_joints = (axes == None ? 0 : 6);
+  const int number_of_external_joints = (axes == Seven ? 1 : 0);
+
+  std::vector<std::string> packets(number_of_packets);
+  EgmRobot robot;
+
+  for (size_t i = 0; i < number_of_packets; ++i)
+  {
+    const double t = i*SAMPLE_TIME;
+    const double value = 10.0*std::sin(t);
+    const unsigned int usec = (unsigned int) (i*SAMPLE_TIME*1.0e6);
+
+    robot.Clear();
+
+    EgmHeader* p_header = robot.mutable_header();
+    p_header->set_seqno((unsigned int) i);
+    p_header->set_tm(usec / 1000);
+    p_header->set_mtype(EgmHeader_MessageType_MSGTYPE_DATA);
+
+    EgmFeedBack* p_feedback = robot.mutable_feedback();
+    EgmPlanned* p_planned = robot.mutable_planned();
+
+    for (int j = 0; j < number_of_joints; ++j)
+    {
+      p_feedback->mutable_joints()->add_joints(value + j);
+      p_planned->mutable_joints()->add_joints(value + j);
+    }
+
+    for (int j = 0; j < number_of_external_joints; ++j)
+    {
+      p_feedback->mutable_externaljoints()->add_joints(value);
+      p_planned->mutable_externaljoints()->add_joints(value);
+    }
+
+    if (axes != None)
+    {
+      EgmPose* p_poses[] = {p_feedback->mutable_cartesian(), p_planned->mutable_cartesian()};
+
+      for (int j = 0; j < 2; ++j)
+      {
+        p_poses[j]->mutable_pos()->set_x(500.0 + value);
+        p_poses[j]->mutable_pos()->set_y(value);
+        p_poses[j]->mutable_pos()->set_z(800.0);
+        p_poses[j]->mutable_orient()->set_u0(1.0);
+        p_poses[j]->mutable_orient()->set_u1(0.0);
+        p_poses[j]->mutable_orient()->set_u2(0.0);
+        p_poses[j]->mutable_orient()->set_u3(0.0);
+      }
+    }
+
+    p_feedback->mutable_time()->set_sec(usec / 1000000);
+    p_feedback->mutable_time()->set_usec(usec % 1000000);
+    p_planned->mutable_time()->CopyFrom(p_feedback->time());
+
+    robot.mutable_motorstate()->set_state(EgmMotorState_MotorStateType_MOTORS_ON);
+    robot.mutable_mcistate()->set_state(EgmMCIState_MCIStateType_MCI_RUNNING);
+    robot.set_mciconvergencemet(true);
+    robot.mutable_rapidexecstate()->set_state(EgmRapidCtrlExecState_RapidCtrlExecStateType_RAPID_RUNNING);
+
+    for (int j = 0; j < 6; ++j)
+    {
+      robot.mutable_measuredforce()->add_force(0.0);
+    }
+
+    robot.SerializeToString(&packets[i]);
+  }
+
+  return packets;
+}
+
+size_t numberOfAllocations()
+{
+  return allocation_counter.load(boost::memory_order_relaxed);
+}
+
+} // end namespace benchmarks
+} // end namespace egm
+} // end namespace abb
@@ -0,0 +1,124 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_BENCHMARK_COMMON_H
+#define EGM_BENCHMARK_COMMON_H
+
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "abb_libegm/egm_common.h"
+
+namespace abb
+{
+namespace egm
+{
+namespace benchmarks
+{
+/**
+ * \brief Static constant for the number of synthetic packets generated for the callback benchmarks.
+ */
+static const size_t NUMBER_OF_PACKETS = 1000;
+
+/**
+ * \brief Static constant for the port number reported to the interfaces (no socket is opened).
+ */
+static const unsigned short PORT_NUMBER = 6510;
+
+/**
+ * \brief Generate synthetic, serialized, EgmRobot messages (as sent by a robot controller during an EGM session).
+ *
+ * The messages have consecutive sequence numbers (starting at zero), a 4 ms sample time and sinusoidal motions.
+ *
+ * \param number_of_packets to generate.
+ * \param axes specifying the number of robot axes (a seven axes robot also gets one external axis).
+ *
+ * \return std::vector<std::string> containing the serialized messages.
+ */
+std::vector<std::string> generatePackets(const size_t number_of_packets, const RobotAxes axes);
+
+/**
+ * \brief Retrieve the number of heap allocations made (by any thread) since the program started.
+ *
+ * \return size_t containing the number of allocations.
+ */
+size_t numberOfAllocations();
+
+/**
+ * \brief Class for measuring the number of heap allocations made during a benchmark.
+ */
+class AllocationScope
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param state of the benchmark to report to.
+   */
+  AllocationScope(benchmark::State& state)
+  :
+  state_(state),
+  start_(numberOfAllocations())
+  {}
+
+  /**
+   * \brief A destructor, which reports the average number of allocations per iteration.
+   */
+  ~AllocationScope()
+  {
+    state_.counters["allocations"] = benchmark::Counter((double) (numberOfAllocations() - start_),
+                                                        benchmark::Counter::kAvgIterations);
+  }
+
+private:
+  /**
+   * \brief The benchmark's state.
+   */
+  benchmark::State& state_;
+
+  /**
+   * \brief Number of allocations when the scope was entered.
+   */
+  const size_t start_;
+};
+
+} // end namespace benchmarks
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_BENCHMARK_COMMON_H
@@ -0,0 +1,173 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <boost/asio.hpp>
+
+#include "abb_libegm/egm_controller_interface.h"
+#include "abb_libegm/egm_trajectory_interface.h"
+#include "abb_libegm/egm_udp_server.h"
+
+#include "egm_benchmark_common.h"
+
+namespace abb
+{
+namespace egm
+{
+namespace benchmarks
+{
+namespace
+{
+/***********************************************************************************************************************
+ * Auxiliary functions
+ */
+
+/**
+ * \brief Feed the synthetic packets (cyclically) directly into an interface's callback, without any socket.
+ *
+ * \param state of the benchmark.
+ * \param p_interface to feed the packets to.
+ * \param axes specifying the number of robot axes used in the packets.
+ */
+void runCallback(benchmark::State& state, AbstractUDPServerInterface* p_interface, const RobotAxes axes)
+{
+  std::vector<std::string> packets = generatePackets(NUMBER_OF_PACKETS, axes);
+  std::vector<std::vector<char> > buffers(packets.size());
+  for (size_t i = 0; i < packets.size(); ++i)
+  {
+    buffers[i].assign(packets[i].begin(), packets[i].end());
+  }
+
+  UDPDispatcher dispatcher(PORT_NUMBER, p_interface);
+
+  // Warm up (i.e. let all the internal containers reach their steady state sizes).
+  for (size_t i = 0; i < buffers.size(); ++i)
+  {
+    dispatcher.dispatch(&buffers[i][0], (int) buffers[i].size());
+  }
+
+  size_t index = 0;
+  size_t reply_bytes = 0;
+
+  {
+    AllocationScope allocation_scope(state);
+
+    for (auto _ : state)
+    {
+      const std::string& reply = dispatcher.dispatch(&buffers[index][0], (int) buffers[index].size());
+      reply_bytes += reply.size();
+
+      index = (index + 1 < buffers.size() ? index + 1 : 0);
+    }
+  }
+
+  benchmark::DoNotOptimize(reply_bytes);
+}
+
+/**
+ * \brief Create a base configuration for the benchmarks.
+ *
+ * \param demo_outputs indicating if demo outputs should be generated.
+ * \param fast_input_parsing indicating if the received messages should be decoded directly from the wire format.
+ *
+ * \return BaseConfiguration containing the configuration.
+ */
+BaseConfiguration createConfiguration(const bool demo_outputs, const bool fast_input_parsing)
+{
+  BaseConfiguration configuration;
+  configuration.use_demo_outputs = demo_outputs;
+  configuration.use_fast_input_parsing = fast_input_parsing;
+  configuration.use_non_blocking_outputs = true;
+  configuration.udp_server.mode = UDPServerConfiguration::External;
+
+  return configuration;
+}
+
+/***********************************************************************************************************************
+ * Benchmarks
+ */
+
+void benchmarkBaseCallback(benchmark::State& state)
+{
+  boost::asio::io_service io_service;
+  EGMBaseInterface interface(io_service, PORT_NUMBER, createConfiguration(true, state.range(0) != 0));
+
+  runCallback(state, &interface, Six);
+}
+
+void benchmarkControllerCallback(benchmark::State& state)
+{
+  boost::asio::io_service io_service;
+  EGMControllerInterface interface(io_service, PORT_NUMBER, createConfiguration(false, state.range(0) != 0));
+
+  runCallback(state, &interface, Six);
+}
+
+void benchmarkTrajectoryCallback(benchmark::State& state)
+{
+  boost::asio::io_service io_service;
+  TrajectoryConfiguration configuration;
+  configuration.base = createConfiguration(false, state.range(0) != 0);
+
+  EGMTrajectoryInterface interface(io_service, PORT_NUMBER, configuration);
+
+  // Keep the interface busy with a long joint trajectory.
+  wrapper::trajectory::TrajectoryGoal trajectory;
+  for (int i = 0; i < 1000; ++i)
+  {
+    wrapper::trajectory::PointGoal* p_point = trajectory.add_points();
+    p_point->set_duration(1.0);
+    p_point->set_reach(false);
+
+    for (int j = 0; j < 6; ++j)
+    {
+      p_point->mutable_robot()->mutable_joints()->mutable_position()->add_values((i % 2 == 0 ? 10.0 : -10.0) + j);
+    }
+  }
+  interface.addTrajectory(trajectory);
+
+  runCallback(state, &interface, Six);
+}
+
+} // end namespace
+
+// The argument selects the input parsing: 0 = Google Protocol Buffers parser, 1 = direct wire format decoding.
+BENCHMARK(benchmarkBaseCallback)->Arg(0)->Arg(1);
+BENCHMARK(benchmarkControllerCallback)->Arg(0)->Arg(1);
+BENCHMARK(benchmarkTrajectoryCallback)->Arg(0)->Arg(1);
+
+} // end namespace benchmarks
+} // end namespace egm
+} // end namespace abb
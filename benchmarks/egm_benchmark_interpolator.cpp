@@ -0,0 +1,282 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <cmath>
+
+#include "abb_libegm/egm_interpolator.h"
+#include "abb_libegm/egm_trajectory_preview.h"
+
+#include "egm_benchmark_common.h"
+
+namespace abb
+{
+namespace egm
+{
+namespace benchmarks
+{
+namespace
+{
+/***********************************************************************************************************************
+ * Auxiliary functions
+ */
+
+/**
+ * \brief Create a point goal, with both joint and Cartesian values, for the interpolator benchmarks.
+ *
+ * \param offset for the position values.
+ * \param velocity for the velocity values.
+ *
+ * \return wrapper::trajectory::PointGoal containing the point goal.
+ */
+wrapper::trajectory::PointGoal createPoint(const double offset, const double velocity)
+{
+  wrapper::trajectory::PointGoal point;
+
+  wrapper::trajectory::JointGoal* p_joints = point.mutable_robot()->mutable_joints();
+  wrapper::trajectory::JointGoal* p_external = point.mutable_external()->mutable_joints();
+
+  for (int i = 0; i < 6; ++i)
+  {
+    p_joints->mutable_position()->add_values(offset + i);
+    p_joints->mutable_velocity()->add_values(velocity);
+    p_joints->mutable_acceleration()->add_values(0.0);
+  }
+
+  p_external->mutable_position()->add_values(offset);
+  p_external->mutable_velocity()->add_values(velocity);
+  p_external->mutable_acceleration()->add_values(0.0);
+
+  wrapper::trajectory::CartesianGoal* p_cartesian = point.mutable_robot()->mutable_cartesian();
+  p_cartesian->mutable_pose()->mutable_position()->set_x(500.0 + offset);
+  p_cartesian->mutable_pose()->mutable_position()->set_y(offset);
+  p_cartesian->mutable_pose()->mutable_position()->set_z(800.0);
+  p_cartesian->mutable_pose()->mutable_quaternion()->set_u0(std::cos(offset*0.01));
+  p_cartesian->mutable_pose()->mutable_quaternion()->set_u1(std::sin(offset*0.01));
+  p_cartesian->mutable_pose()->mutable_quaternion()->set_u2(0.0);
+  p_cartesian->mutable_pose()->mutable_quaternion()->set_u3(0.0);
+  p_cartesian->mutable_velocity()->set_x(velocity);
+  p_cartesian->mutable_velocity()->set_y(velocity);
+  p_cartesian->mutable_velocity()->set_z(0.0);
+  p_cartesian->mutable_acceleration()->set_x(0.0);
+  p_cartesian->mutable_acceleration()->set_y(0.0);
+  p_cartesian->mutable_acceleration()->set_z(0.0);
+
+  return point;
+}
+
+/**
+ * \brief Create interpolator conditions from a benchmark's arguments.
+ *
+ * \param state of the benchmark (first argument: EGM mode, second argument: interpolator operation).
+ *
+ * \return EGMInterpolator::Conditions containing the conditions.
+ */
+EGMInterpolator::Conditions createConditions(const benchmark::State& state)
+{
+  EGMInterpolator::Conditions conditions;
+  conditions.duration = 1.0;
+  conditions.mode = (EGMModes) state.range(0);
+  conditions.operation = (EGMInterpolator::Operation) state.range(1);
+  conditions.ramp_down_factor = 0.5;
+  conditions.spline_method = TrajectoryConfiguration::Quintic;
+
+  return conditions;
+}
+
+/***********************************************************************************************************************
+ * Benchmarks
+ */
+
+void benchmarkInterpolatorUpdate(benchmark::State& state)
+{
+  const wrapper::trajectory::PointGoal start = createPoint(0.0, 1.0);
+  const wrapper::trajectory::PointGoal goal = createPoint(10.0, 0.0);
+  const EGMInterpolator::Conditions conditions = createConditions(state);
+
+  EGMInterpolator interpolator;
+  interpolator.update(start, goal, conditions);
+
+  AllocationScope allocation_scope(state);
+
+  for (auto _ : state)
+  {
+    interpolator.update(start, goal, conditions);
+    benchmark::ClobberMemory();
+  }
+}
+
+void benchmarkInterpolatorUpdateCached(benchmark::State& state)
+{
+  const wrapper::trajectory::PointGoal start = createPoint(0.0, 1.0);
+  const wrapper::trajectory::PointGoal goal = createPoint(10.0, 0.0);
+  const EGMInterpolator::Conditions conditions = createConditions(state);
+  const EGMInterpolator::Timing timing(conditions.duration);
+
+  EGMInterpolator interpolator;
+  interpolator.update(start, goal, conditions, timing);
+
+  AllocationScope allocation_scope(state);
+
+  for (auto _ : state)
+  {
+    interpolator.update(start, goal, conditions, timing);
+    benchmark::ClobberMemory();
+  }
+}
+
+void benchmarkInterpolatorEvaluate(benchmark::State& state)
+{
+  const double SAMPLE_TIME = 0.004;
+
+  EGMInterpolator interpolator;
+  interpolator.update(createPoint(0.0, 1.0), createPoint(10.0, 0.0), createConditions(state));
+
+  // Warm up the output (i.e. let it reach its steady state size, the interpolator only updates present values).
+  wrapper::trajectory::PointGoal output = createPoint(0.0, 1.0);
+  interpolator.evaluate(&output, SAMPLE_TIME, 0.0);
+
+  double t = 0.0;
+
+  AllocationScope allocation_scope(state);
+
+  for (auto _ : state)
+  {
+    interpolator.evaluate(&output, SAMPLE_TIME, t);
+    benchmark::DoNotOptimize(output);
+
+    t = (t + SAMPLE_TIME < interpolator.getDuration() ? t + SAMPLE_TIME : 0.0);
+  }
+}
+
+void benchmarkInterpolatorEvaluateSplines(benchmark::State& state)
+{
+  const double SAMPLE_TIME = 0.004;
+
+  EGMInterpolator interpolator;
+  interpolator.update(createPoint(0.0, 1.0), createPoint(10.0, 0.0), createConditions(state));
+
+  double positions[EGMInterpolator::MAX_NUMBER_OF_SPLINES];
+  double velocities[EGMInterpolator::MAX_NUMBER_OF_SPLINES];
+  double accelerations[EGMInterpolator::MAX_NUMBER_OF_SPLINES];
+
+  double t = 0.0;
+
+  AllocationScope allocation_scope(state);
+
+  for (auto _ : state)
+  {
+    interpolator.evaluateSplines(positions, velocities, accelerations, t);
+    benchmark::DoNotOptimize(positions);
+    benchmark::DoNotOptimize(velocities);
+    benchmark::DoNotOptimize(accelerations);
+
+    t = (t + SAMPLE_TIME < interpolator.getDuration() ? t + SAMPLE_TIME : 0.0);
+  }
+}
+
+void benchmarkTrajectoryPreview(benchmark::State& state)
+{
+  const int NUMBER_OF_POINTS = 10;
+
+  wrapper::trajectory::TrajectoryGoal trajectory;
+  for (int i = 1; i <= NUMBER_OF_POINTS; ++i)
+  {
+    wrapper::trajectory::PointGoal* p_point = trajectory.add_points();
+    p_point->mutable_robot()->mutable_joints()->CopyFrom(createPoint(10.0*i, 0.0).robot().joints());
+    p_point->set_duration(0.5);
+  }
+
+  const wrapper::trajectory::PointGoal start = createPoint(0.0, 0.0);
+  const TrajectoryConfiguration configuration;
+
+  EGMTrajectoryPreviewer previewer((unsigned int) state.range(0));
+  TrajectoryPreview preview;
+  previewer.preview(start, trajectory, configuration, &preview);
+
+  AllocationScope allocation_scope(state);
+
+  for (auto _ : state)
+  {
+    previewer.preview(start, trajectory, configuration, &preview);
+    benchmark::DoNotOptimize(preview.number_of_samples);
+  }
+
+  state.counters["samples"] = (double) preview.number_of_samples;
+}
+
+/**
+ * \brief Register the benchmark arguments (EGM mode and operation).
+ *
+ * The Normal operation exercises the spline polynomials (and Slerp in pose mode), the other operations exercise the
+ * soft ramps.
+ *
+ * \param p_benchmark to register the arguments for.
+ */
+void registerArguments(benchmark::internal::Benchmark* p_benchmark)
+{
+  const int modes[] = {EGMJoint, EGMPose};
+  const int operations[] = {EGMInterpolator::Normal,
+                            EGMInterpolator::RampDown,
+                            EGMInterpolator::RampInPosition,
+                            EGMInterpolator::RampInVelocity};
+
+  p_benchmark->ArgNames({"mode", "operation"});
+
+  for (int i = 0; i < 2; ++i)
+  {
+    for (int j = 0; j < 4; ++j)
+    {
+      p_benchmark->Args({modes[i], operations[j]});
+    }
+  }
+}
+
+} // end namespace
+
+BENCHMARK(benchmarkInterpolatorUpdate)->Apply(registerArguments);
+BENCHMARK(benchmarkInterpolatorUpdateCached)
+  ->ArgNames({"mode", "operation"})
+  ->Args({EGMJoint, EGMInterpolator::Normal})
+  ->Args({EGMPose, EGMInterpolator::Normal});
+BENCHMARK(benchmarkInterpolatorEvaluate)->Apply(registerArguments);
+BENCHMARK(benchmarkInterpolatorEvaluateSplines)
+  ->ArgNames({"mode", "operation"})
+  ->Args({EGMJoint, EGMInterpolator::Normal});
+BENCHMARK(benchmarkTrajectoryPreview)->ArgName("workers")->Arg(0)->Arg(2);
+
+} // end namespace benchmarks
+} // end namespace egm
+} // end namespace abb
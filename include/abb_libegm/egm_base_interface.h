@@ -44,8 +44,18 @@
 #include "egm.pb.h"         // Generated by Google Protocol Buffer compiler protoc
 #include "egm_wrapper.pb.h" // Generated by Google Protocol Buffer compiler protoc
 
+#include "egm_clock_estimator.h"
+#include "egm_columnar_log.h"
 #include "egm_common.h"
+#include "egm_connection_monitor.h"
+#include "egm_decoder.h"
+#include "egm_event_notifier.h"
+#include "egm_joint_mapping.h"
 #include "egm_logger.h"
+#include "egm_realtime_checker.h"
+#include "egm_snapshot_publisher.h"
+#include "egm_statistics.h"
+#include "egm_telemetry.h"
 #include "egm_udp_server.h"
 
 namespace abb
@@ -69,10 +79,20 @@ public:
    * \param io_service for operating boost asio's asynchronous functions.
    * \param port_number for the server's UDP socket.
    * \param configuration for the interface's configuration.
+   * \param start_server indicating if the underlying server should be started by the constructor (derived interfaces
+   *                     start the server themselves, once they have been fully constructed).
    */
   EGMBaseInterface(boost::asio::io_service& io_service,
                    const unsigned short port_number,
-                   const BaseConfiguration& configuration = BaseConfiguration());
+                   const BaseConfiguration& configuration = BaseConfiguration(),
+                   const bool start_server = true);
+
+  /**
+   * \brief A destructor.
+   *
+   * Note: Stops the underlying server, before any of the interface's members are destroyed.
+   */
+  virtual ~EGMBaseInterface();
 
   /**
    * \brief Checks if the underlying server was successfully initialized or not.
@@ -84,10 +104,106 @@ public:
   /**
    * \brief Checks if an EGM communication session is connected or not.
    *
+   * Note: Non-blocking, the check is based on when the most recent valid message was received.
+   *
    * \return bool indicating if a connection exists between the interface, and the robot controller's EGM client.
    */
   bool isConnected();
 
+  /**
+   * \brief Retrieve the status of the EGM communication session's connection.
+   *
+   * \return ConnectionStatus containing the connection status (e.g. the estimated message period).
+   */
+  ConnectionStatus getConnectionStatus();
+
+  /**
+   * \brief Retrieve a pollable file descriptor, which becomes readable each time a message has been processed.
+   *
+   * E.g. for integrating the interface into an external event loop (epoll, select, boost asio, etc.), instead of
+   * dedicating a thread to wait for new messages. Call acknowledgeEvents() once the descriptor has become readable.
+   * For an EGMControllerInterface, the descriptor becomes readable as soon as the inputs are available via read(...).
+   *
+   * Note: Non-blocking. The descriptor is owned by the interface, and it must not be closed by the user.
+   *
+   * \return int containing the descriptor, or -1 if not enabled (see BaseConfiguration::use_event_descriptor), or
+   *         not supported on the platform.
+   */
+  int getEventDescriptor();
+
+  /**
+   * \brief Acknowledge the events signalled via the event descriptor (i.e. make it non-readable again).
+   *
+   * Note: Non-blocking.
+   *
+   * \return unsigned int containing the number of processed messages since the previous acknowledgement (e.g. more
+   *         than one if the external event loop has missed messages).
+   */
+  unsigned int acknowledgeEvents();
+
+  /**
+   * \brief Register a callback for the decimated telemetry stream (see BaseConfiguration::telemetry).
+   *
+   * Note: The callback is notified from the telemetry stream's background thread (never from the EGM communication
+   *       loop), once for every aggregation window.
+   *
+   * \param callback for the callback to register.
+   *
+   * \return int containing the subscriber's identifier, or -1 if the telemetry stream is not enabled.
+   */
+  int addTelemetrySubscriber(const TelemetryCallback& callback);
+
+  /**
+   * \brief Remove a registered telemetry callback.
+   *
+   * \param id containing the subscriber's identifier.
+   *
+   * \return bool indicating if the subscriber was removed or not.
+   */
+  bool removeTelemetrySubscriber(const int id);
+
+  /**
+   * \brief Retrieve the estimated sample time, and clock relations, of the EGM communication session.
+   *
+   * Note: Wait-free, e.g. ClockEstimate::next_receive_time can be used to schedule computations just before the next
+   *       message arrives.
+   *
+   * \param p_estimate for containing the estimates.
+   *
+   * \return bool indicating if the estimates were retrieved (false if no message has been received yet, or if the
+   *         attempt overlapped with an update, in which case it can simply be retried).
+   */
+  bool retrieveClockEstimate(ClockEstimate* p_estimate);
+
+  /**
+   * \brief Retrieve the real-time safety report, for the interface's callbacks.
+   *
+   * Note: Wait-free. Requires that the library is built with the ABB_LIBEGM_RT_CHECKS option.
+   *
+   * \param p_report for containing the report.
+   *
+   * \return bool indicating if the report was retrieved (false if the checks are disabled, if no report has been
+   *         published yet, or if the attempt overlapped with an update, in which case it can simply be retried).
+   */
+  bool retrieveRealTimeReport(RealTimeReport* p_report);
+
+  /**
+   * \brief Retrieve the status of the underlying server's thread attributes (i.e. CPU affinity, real-time priority and
+   *        memory locking).
+   *
+   * Note: Only relevant for the dedicated server modes, where e.g. a missing privilege results in the Failed status.
+   *
+   * \return UDPServer::ThreadAttributesStatus with the status.
+   */
+  UDPServer::ThreadAttributesStatus getThreadAttributesStatus();
+
+  /**
+   * \brief Retrieve the number of replies that the underlying server could not send to the robot controller.
+   *
+   * \return unsigned int containing the number of failed replies.
+   */
+  unsigned int getNumberOfFailedReplies();
+
   /**
    * \brief Retrieve the most recently received EGM status message.
    *
@@ -103,6 +219,20 @@ public:
    */
   wrapper::Status getStatus();
 
+  /**
+   * \brief Retrieve the timing and packet statistics collected by the interface's callbacks.
+   *
+   * Note: Statistics are only collected if the configuration specifies that they should be.
+   *
+   * \return InterfaceStatistics containing the statistics.
+   */
+  InterfaceStatistics getStatistics();
+
+  /**
+   * \brief Reset the collected timing and packet statistics.
+   */
+  void resetStatistics();
+
   /**
    * \brief Retrieve the interface's current configuration.
    *
@@ -111,7 +241,10 @@ public:
   BaseConfiguration getConfiguration();
 
   /**
-   * \brief Update the interface's configuration (update is only applied for new EGM communication sessions).
+   * \brief Update the interface's configuration.
+   *
+   * Note: The runtime parameters (see BaseConfiguration) are applied from the next received message, and the session
+   *       parameters are applied when the next EGM communication session starts.
    *
    * \param configuration containing the new configurations for the interface.
    */
@@ -130,26 +263,32 @@ protected:
     InputContainer();
 
     /**
-     * \brief Parse an array, into an abb::egm::EgmRobot message.
+     * \brief Parse an array, into an abb::egm::EgmRobot message (or directly into a flat struct).
      *
      * \param data containing the serialized array received from the robot controller.
      * \param bytes_transferred for the number of bytes received.
+     * \param use_fast_parsing indicating if the array should be decoded directly into a flat struct or not.
      *
      * \return bool indicating if the parsing was successful or not.
      */
-    bool parseFromArray(const char* data, const int bytes_transferred);
+    bool parseFromArray(const char* data, const int bytes_transferred, const bool use_fast_parsing = false);
 
     /**
      * \brief Extract the parsed information.
      *
      * \param axes specifying the number of axes of the robot.
+     * \param receive_time specifying when the message was received (the current time is used if it is zero).
      *
      * \return bool indicating if the extraction was successful or not.
      */
-    bool extractParsedInformation(const RobotAxes& axes);
+    bool extractParsedInformation(const RobotAxes& axes,
+                                  const boost::chrono::steady_clock::time_point& receive_time =
+                                    boost::chrono::steady_clock::time_point());
 
     /**
      * \brief Update the previous inputs with the current inputs.
+     *
+     * Note: The containers are swapped instead of copied, i.e. the current inputs are stale until the next extraction.
      */
     void updatePrevious();
 
@@ -179,7 +318,14 @@ protected:
      *
      * \return double containing the estimation.
      */
-    double estimatedSampleTime() const { return estimated_sample_time_; };
+    double estimatedSampleTime() const { return clock_estimator_.sampleTime(); };
+
+    /**
+     * \brief Retrieve the estimator of the sample time and the clock relations.
+     *
+     * \return EGMClockEstimator& containing the estimator.
+     */
+    const EGMClockEstimator& clockEstimator() const { return clock_estimator_; };
 
     /**
      * \brief Retrieve a flag, indicating if the received message was the first in a communication session.
@@ -205,13 +351,6 @@ protected:
      */
     void detectRWAndEGMVersions();
 
-    /**
-     * \brief Estimate the sample time.
-     *
-     * \return double containing the estimation.
-     */
-    double estimateSampleTime();
-
     /**
      * \brief Estimate the joint and the Cartesian velocities.
      *
@@ -224,6 +363,16 @@ protected:
      */
     EgmRobot egm_robot_;
 
+    /**
+     * \brief Container for the EGM robot message, when decoded directly into a flat struct.
+     */
+    RobotData robot_data_;
+
+    /**
+     * \brief Flag indicating if the most recent message was decoded into the flat struct or not.
+     */
+    bool use_robot_data_;
+
     /**
      * \brief Container for the initial inputs, extracted from the EGM robot message.
      */
@@ -255,9 +404,14 @@ protected:
     bool first_message_;
 
     /**
-     * \brief The estimated sample time [s].
+     * \brief Estimator of the sample time, and of the clock relations.
+     */
+    EGMClockEstimator clock_estimator_;
+
+    /**
+     * \brief The joint mappings, selected for the robot's axes configuration.
      */
-    double estimated_sample_time_;
+    JointMapper joint_mapper_;
   };
 
   /**
@@ -351,6 +505,15 @@ protected:
      */
     bool constructJointBody(const BaseConfiguration& configuration);
 
+    /**
+     * \brief Assign joint values to an EGM joints message, in place (i.e. reusing the already allocated capacity).
+     *
+     * \param p_target for the EGM joints message.
+     * \param p_values containing the values to assign.
+     * \param size for the number of values.
+     */
+    void assign(EgmJoints* p_target, const double* p_values, const int size);
+
     /**
      * \brief Construct the Cartesian body.
      *
@@ -376,9 +539,19 @@ protected:
     unsigned int sequence_number_;
 
     /**
-     * \brief Container for the reply string.
+     * \brief The joint mappings, selected for the robot's axes configuration.
+     */
+    JointMapper joint_mapper_;
+
+    /**
+     * \brief Container for the reply string (with preallocated storage).
      */
     std::string reply_;
+
+    /**
+     * \brief Static constant for the max size [bytes] of a reply (i.e. the reply's preallocated storage).
+     */
+    static const size_t MAX_REPLY_SIZE = 1024;
   };
 
   /**
@@ -415,33 +588,55 @@ protected:
     BaseConfigurationContainer(const BaseConfiguration& initial)
     :
     active(initial),
-    update(initial),
+    snapshots(initial),
     has_pending_update(false)
     {}
 
     /**
      * \brief The active configuration.
+     *
+     * Note: Only accessed by the EGM communication loop (after construction).
      */
     BaseConfiguration active;
 
     /**
-     * \brief The configuration update.
+     * \brief The published configuration snapshots (i.e. the most recently requested configuration).
      */
-    BaseConfiguration update;
+    SnapshotPublisher<BaseConfiguration> snapshots;
 
     /**
-     * \brief Flag indicating if the active configuration should be updated.
+     * \brief Flag indicating if the active configuration has session parameters that should be updated, when the
+     *        next EGM communication session starts.
      */
     bool has_pending_update;
-
-    /**
-     * \brief Mutex for protecting the configuration.
-     */
-    boost::mutex mutex;
   };
 
   /**
-   * \brief Log input, from robot controller, and output, to robot controller, into a CSV file.
+   * \brief Apply the configuration parameters that are allowed to change during an EGM communication session.
+   *
+   * \param p_active for containing the active configuration.
+   * \param latest containing the most recently requested configuration.
+   */
+  static void applyRuntimeParameters(BaseConfiguration* p_active, const BaseConfiguration& latest);
+
+  /**
+   * \brief Refresh the active configuration, if a new configuration has been requested.
+   *
+   * Note: Lock-free. The runtime parameters are applied directly, and the session parameters are applied when the
+   *       next EGM communication session starts (see initializeCallback).
+   */
+  void refreshConfiguration();
+
+  /**
+   * \brief Initialize the logger(s), if the configuration specifies that logging should be used.
+   *
+   * \param port_number for the server's UDP socket (used in the log's filename).
+   * \param configuration containing the configurations for the interface.
+   */
+  void initializeLogger(const unsigned short port_number, const BaseConfiguration& configuration);
+
+  /**
+   * \brief Log input, from robot controller, and output, to robot controller, into a CSV (or binary) file.
    *
    * \param inputs containing the inputs from the robot controller.
    * \param outputs containing the outputs to the robot controller.
@@ -458,13 +653,6 @@ protected:
    */
   bool initializeCallback(const UDPServerData& server_data);
 
-  /**
-   * \brief Static constant wait time [ms] used when determining if a connection has been established or not.
-   *
-   * I.e. a connection between the interface's UDP server, and a robot controller's EGM client.
-   */
-  static const unsigned int WAIT_TIME_MS = 100;
-
   /**
    * \brief Container for the inputs, to the interface, from the UDP server.
    */
@@ -485,6 +673,41 @@ protected:
    */
   boost::shared_ptr<EGMLogger> p_logger_;
 
+  /**
+   * \brief Logger, for asynchronously logging EGM messages to a binary file.
+   */
+  boost::shared_ptr<EGMAsyncLogger> p_async_logger_;
+
+  /**
+   * \brief Logger, for asynchronously logging EGM messages to memory-mapped columnar binary files.
+   */
+  boost::shared_ptr<EGMColumnarLogger> p_columnar_logger_;
+
+  /**
+   * \brief Publisher of the (optional) decimated telemetry stream.
+   */
+  boost::shared_ptr<EGMTelemetryPublisher> p_telemetry_;
+
+  /**
+   * \brief Collector of timing and packet statistics.
+   */
+  EGMStatisticsCollector statistics_;
+
+  /**
+   * \brief Checker of the callbacks' real-time safety (only active if built with the ABB_LIBEGM_RT_CHECKS option).
+   */
+  EGMRealTimeChecker rt_checker_;
+
+  /**
+   * \brief Monitor of the EGM communication session's connection.
+   */
+  EGMConnectionMonitor connection_monitor_;
+
+  /**
+   * \brief Notifier of processed messages, via a pollable event descriptor.
+   */
+  EGMEventNotifier event_notifier_;
+
   /**
    * \brief The interface's configuration.
    */
@@ -0,0 +1,307 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_CAPTURE_H
+#define EGM_CAPTURE_H
+
+#include <fstream>
+#include <string>
+
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/thread.hpp>
+
+#include "egm_ring_buffer.h"
+#include "egm_udp_server.h"
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Struct for a captured UDP datagram.
+ */
+struct CaptureRecord
+{
+  /**
+   * \brief Static constant for the maximum size [bytes] of a captured datagram.
+   */
+  static const size_t MAX_DATA_SIZE = 1024;
+
+  /**
+   * \brief Time [ns] when the datagram was received, relative to the start of the capture.
+   */
+  boost::uint64_t time_ns;
+
+  /**
+   * \brief Port number that the datagram was received on.
+   */
+  boost::uint16_t port_number;
+
+  /**
+   * \brief Size [bytes] of the datagram.
+   */
+  boost::uint16_t size;
+
+  /**
+   * \brief The datagram's data (only the first size bytes are valid).
+   */
+  char data[MAX_DATA_SIZE];
+};
+
+/**
+ * \brief Class for capturing received UDP datagrams (with receive timestamps) into a compact binary file.
+ *
+ * The datagrams are handed over to a background writer thread via a lock-free ring buffer, so capturing never blocks
+ * the calling (real-time) thread on file I/O. Datagrams are dropped (and counted) if the ring buffer is full.
+ *
+ * File format: An 8 byte magic ("EGMCAP01"), followed by one entry per datagram, where each entry consists of the
+ * receive time [ns] (uint64), the port number (uint16), the size (uint16) and the datagram's bytes.
+ */
+class EGMCaptureWriter
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param filename for the capture file.
+   * \param capacity specifying the number of datagrams the ring buffer can hold.
+   */
+  EGMCaptureWriter(const std::string& filename, const size_t capacity = DEFAULT_CAPACITY);
+
+  /**
+   * \brief A destructor, which writes all remaining datagrams before closing the file.
+   */
+  ~EGMCaptureWriter();
+
+  /**
+   * \brief Check if the capture file was opened successfully or not.
+   *
+   * \return bool indicating if the file is open.
+   */
+  bool isOpen() const;
+
+  /**
+   * \brief Add a received datagram to the capture.
+   *
+   * \param server_data containing the received datagram and its receive time.
+   *
+   * \return bool indicating if the datagram was queued (false if it was dropped).
+   */
+  bool add(const UDPServerData& server_data);
+
+  /**
+   * \brief Retrieve the number of datagrams dropped (because the ring buffer was full, or the datagram too large).
+   *
+   * \return size_t containing the number of dropped datagrams.
+   */
+  size_t numberOfDroppedDatagrams() const;
+
+  /**
+   * \brief Static constant for the file format's magic.
+   */
+  static const char MAGIC[8];
+
+private:
+  /**
+   * \brief Static constant for the default ring buffer capacity.
+   */
+  static const size_t DEFAULT_CAPACITY = 1024;
+
+  /**
+   * \brief Static constant for the number of records the writer thread pops at a time.
+   */
+  static const size_t BATCH_SIZE = 16;
+
+  /**
+   * \brief Static constant wait time [ms] for the writer thread, when the ring buffer is empty.
+   */
+  static const unsigned int IDLE_WAIT_TIME_MS = 10;
+
+  /**
+   * \brief Run the writer thread, which drains the ring buffer into the file.
+   */
+  void writerThread();
+
+  /**
+   * \brief Write a record to the file.
+   *
+   * \param record containing the record to write.
+   */
+  void writeRecord(const CaptureRecord& record);
+
+  /**
+   * \brief Flush the file's stream object.
+   */
+  void flushCapture();
+
+  /**
+   * \brief Time when the capture started.
+   */
+  boost::chrono::steady_clock::time_point start_time_;
+
+  /**
+   * \brief Number of dropped datagrams.
+   */
+  boost::atomic<size_t> number_of_dropped_datagrams_;
+
+  /**
+   * \brief Flag indicating if the writer thread should stop.
+   */
+  boost::atomic<bool> stop_requested_;
+
+  /**
+   * \brief Ring buffer for handing over datagrams to the writer thread.
+   */
+  RingBuffer<CaptureRecord> ring_buffer_;
+
+  /**
+   * \brief Stream for the capture file.
+   */
+  std::ofstream capture_stream_;
+
+  /**
+   * \brief The writer thread.
+   */
+  boost::thread writer_thread_;
+};
+
+/**
+ * \brief Class for reading a capture file, written by the EGMCaptureWriter class.
+ */
+class EGMCaptureReader
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param filename of the capture file.
+   */
+  EGMCaptureReader(const std::string& filename);
+
+  /**
+   * \brief Check if the capture file was opened successfully, and has a valid format.
+   *
+   * \return bool indicating if the file is open and valid.
+   */
+  bool isOpen() const;
+
+  /**
+   * \brief Read the next captured datagram.
+   *
+   * \param p_record for containing the datagram.
+   *
+   * \return bool indicating if a datagram was read (false at the end of the file, or if the file is corrupt).
+   */
+  bool next(CaptureRecord* p_record);
+
+private:
+  /**
+   * \brief Stream for the capture file.
+   */
+  std::ifstream capture_stream_;
+
+  /**
+   * \brief Flag indicating if the file has a valid format.
+   */
+  bool valid_;
+};
+
+/**
+ * \brief Class for replaying a capture file through an interface, without any socket.
+ *
+ * The captured datagrams are dispatched to the interface's callback in the recorded order, either paced according to
+ * the recorded receive times (optionally accelerated), or as fast as possible. Together with the UDP server's
+ * external mode this allows reproducing a robot cell's traffic offline, e.g. for profiling.
+ */
+class EGMReplayDriver
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param p_interface that processes the replayed datagrams.
+   */
+  EGMReplayDriver(AbstractUDPServerInterface* p_interface);
+
+  /**
+   * \brief Replay a capture file.
+   *
+   * \param filename of the capture file.
+   * \param speed_factor for the replay speed, relative to the recorded speed (e.g. 10.0 means ten times faster).
+   *                     A value of zero (or less) replays the datagrams as fast as possible.
+   * \param port_number for only replaying datagrams received on a specific port (zero replays all datagrams).
+   *
+   * \return bool indicating if the capture file could be replayed or not.
+   */
+  bool replay(const std::string& filename, const double speed_factor = 1.0, const unsigned short port_number = 0);
+
+  /**
+   * \brief Retrieve the number of datagrams dispatched during the latest replay.
+   *
+   * \return size_t containing the number of datagrams.
+   */
+  size_t numberOfReplayedDatagrams() const;
+
+  /**
+   * \brief Retrieve the number of non-empty replies generated during the latest replay.
+   *
+   * \return size_t containing the number of replies.
+   */
+  size_t numberOfReplies() const;
+
+private:
+  /**
+   * \brief Pointer to an object that is derived from AbstractUDPSeverInterface, which processes the datagrams.
+   */
+  AbstractUDPServerInterface* p_interface_;
+
+  /**
+   * \brief Number of datagrams dispatched during the latest replay.
+   */
+  size_t number_of_replayed_datagrams_;
+
+  /**
+   * \brief Number of non-empty replies generated during the latest replay.
+   */
+  size_t number_of_replies_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_CAPTURE_H
@@ -0,0 +1,315 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_CLOCK_ESTIMATOR_H
+#define EGM_CLOCK_ESTIMATOR_H
+
+#include <boost/chrono.hpp>
+#include <boost/cstdint.hpp>
+
+#include "egm_wrapper.pb.h" // Generated by Google Protocol Buffer compiler protoc
+
+#include "egm_seqlock.h"
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Struct for containing estimates of an EGM communication session's timing.
+ *
+ * The host clock refers to boost's steady clock, and the controller clock to the feedback time in the EGM messages.
+ */
+struct ClockEstimate
+{
+  /**
+   * \brief Default constructor.
+   */
+  ClockEstimate()
+  :
+  number_of_samples(0),
+  sample_time(0.0),
+  sample_gap(1),
+  has_controller_clock(false),
+  clock_offset(0.0),
+  clock_drift(0.0),
+  receive_jitter(0.0)
+  {}
+
+  /**
+   * \brief Number of messages used in the estimation (restarted for every new session).
+   */
+  unsigned int number_of_samples;
+
+  /**
+   * \brief Estimated (filtered) sample time [s] between the robot controller's messages.
+   */
+  double sample_time;
+
+  /**
+   * \brief Number of sample times between the two most recent messages (i.e. larger than one if messages were lost).
+   */
+  unsigned int sample_gap;
+
+  /**
+   * \brief Flag indicating if the messages contain the controller clock (i.e. if the offset and drift are valid).
+   *
+   * Note: The feedback time field was added in RobotWare '6.07'.
+   */
+  bool has_controller_clock;
+
+  /**
+   * \brief Estimated offset [s] between the clocks, at the most recent message (host time = controller time + offset).
+   *
+   * Note: The offset includes the mean transport delay, from the robot controller to the interface.
+   */
+  double clock_offset;
+
+  /**
+   * \brief Estimated drift [s/s] of the host clock, relative to the controller clock (i.e. the offset's rate).
+   */
+  double clock_drift;
+
+  /**
+   * \brief Estimated standard deviation [s] of the receive times, around the estimated clock relation.
+   */
+  double receive_jitter;
+
+  /**
+   * \brief Host time when the most recent message was received.
+   */
+  boost::chrono::steady_clock::time_point last_receive_time;
+
+  /**
+   * \brief Host time when the most recent message was received, according to the estimated clock relation.
+   *
+   * Note: I.e. without the receive jitter (equal to the last receive time if the controller clock is missing).
+   */
+  boost::chrono::steady_clock::time_point filtered_receive_time;
+
+  /**
+   * \brief Predicted host time when the next message will be received.
+   */
+  boost::chrono::steady_clock::time_point next_receive_time;
+};
+
+/**
+ * \brief Class for estimating the sample time of an EGM communication session, and its clock relations.
+ *
+ * The class provides behavior for:
+ * - Filtering the sample time, based on the controller clock (or on the receive times if the clock is missing).
+ * - Tracking the offset and drift between the host and controller clocks, with recursive least squares
+ *   (with exponential forgetting) on the receive times.
+ * - Publishing the estimates, so that other threads can retrieve them without blocking the calling thread
+ *   (i.e. the UDP server's callback thread).
+ */
+class EGMClockEstimator
+{
+public:
+  /**
+   * \brief Default constructor.
+   */
+  EGMClockEstimator();
+
+  /**
+   * \brief Update the estimates with a received message.
+   *
+   * \param header containing the message's header.
+   * \param feedback containing the message's feedback (with the controller clock).
+   * \param receive_time specifying when the message was received (the current time is used if it is zero).
+   * \param first_message indicating if the message is the first in a new session.
+   *
+   * Note: Reordered messages (i.e. with older sequence numbers) are skipped, and the estimation is restarted if the
+   *       sequence numbers jump too far ahead (or if too many consecutive messages have been skipped).
+   */
+  void update(const wrapper::Header& header,
+              const wrapper::Feedback& feedback,
+              const boost::chrono::steady_clock::time_point& receive_time,
+              const bool first_message);
+
+  /**
+   * \brief Retrieve the estimated sample time.
+   *
+   * \return double containing the estimated sample time [s].
+   */
+  double sampleTime() const { return estimate_.sample_time; };
+
+  /**
+   * \brief Retrieve the estimated time between the two most recent messages (i.e. including any lost messages).
+   *
+   * \return double containing the estimated time [s].
+   */
+  double elapsedTime() const { return estimate_.sample_gap*estimate_.sample_time; };
+
+  /**
+   * \brief Retrieve the estimated host time of the most recent message (i.e. without the receive jitter).
+   *
+   * \return boost::chrono::steady_clock::time_point containing the estimated time.
+   */
+  boost::chrono::steady_clock::time_point filteredReceiveTime() const { return estimate_.filtered_receive_time; };
+
+  /**
+   * \brief Retrieve the latest published estimates (can be called from any thread).
+   *
+   * \param p_estimate for containing the estimates.
+   *
+   * \return bool indicating if the estimates were retrieved (false if none have been published yet, or if the
+   *         attempt overlapped with a publication, in which case it can simply be retried).
+   */
+  bool retrieveEstimate(ClockEstimate* p_estimate) const;
+
+private:
+  /**
+   * \brief Update the sample time filter.
+   *
+   * \param difference specifying the time difference [s] between the two most recent messages.
+   * \param sequence_gap specifying the sequence number difference between the two most recent messages.
+   */
+  void updateSampleTime(const double difference, const boost::uint32_t sequence_gap);
+
+  /**
+   * \brief Update the clock relation, with recursive least squares.
+   *
+   * Note: The relation is kept relative to the most recent message (i.e. it is moved forward before each update),
+   *       so that the least squares problem stays well conditioned during long sessions.
+   *
+   * \param difference specifying the controller time difference [s] between the two most recent messages.
+   * \param offset specifying the measured offset [s], relative to the session's first message.
+   */
+  void updateClockRelation(const double difference, const double offset);
+
+  /**
+   * \brief Static constant for the sample time filter's smoothing factor.
+   */
+  static const double SAMPLE_TIME_SMOOTHING;
+
+  /**
+   * \brief Static constant for the max relative deviation of a sample time, before it is treated as an outlier.
+   */
+  static const double SAMPLE_TIME_TOLERANCE;
+
+  /**
+   * \brief Static constant for the forgetting factor used in the clock relation's recursive least squares.
+   */
+  static const double FORGETTING_FACTOR;
+
+  /**
+   * \brief Static constant for the initial covariance used in the clock relation's recursive least squares.
+   */
+  static const double INITIAL_COVARIANCE;
+
+  /**
+   * \brief Static constant for the receive jitter filter's smoothing factor.
+   */
+  static const double JITTER_SMOOTHING;
+
+  /**
+   * \brief Static constant for the number of consecutive outliers, before the sample time filter is restarted.
+   */
+  static const unsigned int MAX_OUTLIERS = 10;
+
+  /**
+   * \brief Static constant for the max sequence number gap, before the estimation is restarted (i.e. the sequence
+   *        numbers are assumed to have jumped, instead of that many messages being lost).
+   */
+  static const unsigned int MAX_SEQUENCE_GAP = 1000;
+
+  /**
+   * \brief The current estimates.
+   */
+  ClockEstimate estimate_;
+
+  /**
+   * \brief The published estimates.
+   */
+  SeqLock<ClockEstimate> estimates_;
+
+  /**
+   * \brief Number of consecutive sample time outliers.
+   */
+  unsigned int number_of_outliers_;
+
+  /**
+   * \brief Number of consecutive skipped messages (i.e. with sequence numbers older than the most recent message).
+   */
+  unsigned int number_of_skipped_messages_;
+
+  /**
+   * \brief Sequence number of the most recent message.
+   */
+  boost::uint32_t previous_sequence_number_;
+
+  /**
+   * \brief Controller time [us] of the session's first message.
+   */
+  boost::uint64_t first_controller_time_;
+
+  /**
+   * \brief Controller time [us] of the most recent message.
+   */
+  boost::uint64_t previous_controller_time_;
+
+  /**
+   * \brief Host time of the session's first message.
+   */
+  boost::chrono::steady_clock::time_point first_receive_time_;
+
+  /**
+   * \brief Offset [s] between the clocks, at the session's first message.
+   */
+  double first_offset_;
+
+  /**
+   * \brief Parameters of the clock relation, i.e. the offset [s] at the most recent message (relative to the
+   *        session's first message) and the drift [s/s].
+   */
+  double theta_[2];
+
+  /**
+   * \brief Covariance (row-major) of the clock relation's parameters.
+   */
+  double covariance_[4];
+
+  /**
+   * \brief Variance [s^2] of the receive times, around the clock relation.
+   */
+  double variance_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_CLOCK_ESTIMATOR_H
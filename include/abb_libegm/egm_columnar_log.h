@@ -0,0 +1,589 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_COLUMNAR_LOG_H
+#define EGM_COLUMNAR_LOG_H
+
+#include <string>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include "egm_logger.h"
+#include "egm_ring_buffer.h"
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Struct describing the layout of a columnar log file.
+ *
+ * A file is preallocated to its maximum size, and it consists of (native byte order, 8-byte aligned sections):
+ * - A file header.
+ * - A block index, with one entry per block (i.e. time stamp range, row range, and location in the file).
+ * - The blocks, where each block contains:
+ *   - A column table with the offsets [bytes] (relative to the block's start) of each value column, followed by the
+ *     block's end offset.
+ *   - One time stamp column (32-bit unsigned integers).
+ *   - One column per log record value (doubles).
+ *
+ * If compression is used, then a value column that is constant within a block (e.g. padded joints) is stored as a
+ * single double. I.e. a column's size is one double if, and only if, the column is constant (or the block has one row).
+ */
+struct EGMColumnarLogLayout
+{
+  /**
+   * \brief Struct for a columnar log's file header.
+   */
+  struct FileHeader
+  {
+    /**
+     * \brief Identifier of the file format.
+     */
+    char magic[8];
+
+    /**
+     * \brief Version of the file format.
+     */
+    boost::uint32_t version;
+
+    /**
+     * \brief Number of value columns in each block.
+     */
+    boost::uint32_t number_of_values;
+
+    /**
+     * \brief Max number of rows in each block.
+     */
+    boost::uint32_t block_capacity;
+
+    /**
+     * \brief Max number of blocks in the file.
+     */
+    boost::uint32_t max_blocks;
+
+    /**
+     * \brief Number of completed blocks.
+     *
+     * Note: Updated after each block (and its index entry) has been written, i.e. the file is consistent at all times.
+     */
+    boost::uint32_t number_of_blocks;
+
+    /**
+     * \brief Reserved for alignment.
+     */
+    boost::uint32_t reserved;
+
+    /**
+     * \brief Number of rows in the completed blocks.
+     */
+    boost::uint64_t number_of_rows;
+
+    /**
+     * \brief Size [bytes] of the completed blocks.
+     */
+    boost::uint64_t data_size;
+  };
+
+  /**
+   * \brief Struct for an entry in a columnar log's block index.
+   */
+  struct BlockIndex
+  {
+    /**
+     * \brief Time stamp [ms] of the block's first row.
+     */
+    boost::uint32_t first_time_stamp;
+
+    /**
+     * \brief Time stamp [ms] of the block's last row.
+     */
+    boost::uint32_t last_time_stamp;
+
+    /**
+     * \brief Number of rows in the block.
+     */
+    boost::uint32_t number_of_rows;
+
+    /**
+     * \brief Reserved for alignment.
+     */
+    boost::uint32_t reserved;
+
+    /**
+     * \brief Index of the block's first row (within the file).
+     */
+    boost::uint64_t first_row;
+
+    /**
+     * \brief Offset [bytes] of the block (relative to the file's start).
+     */
+    boost::uint64_t offset;
+
+    /**
+     * \brief Size [bytes] of the block.
+     */
+    boost::uint64_t size;
+  };
+
+  /**
+   * \brief Calculate the offset [bytes] of the first block in a file.
+   *
+   * \param max_blocks specifying the max number of blocks in the file.
+   *
+   * \return size_t containing the offset.
+   */
+  static size_t dataOffset(const size_t max_blocks);
+
+  /**
+   * \brief Calculate the max size [bytes] of a block (i.e. without compression).
+   *
+   * \param block_capacity specifying the max number of rows in the block.
+   *
+   * \return size_t containing the max size.
+   */
+  static size_t maxBlockSize(const size_t block_capacity);
+
+  /**
+   * \brief Round a size up to the sections' alignment.
+   *
+   * \param size specifying the size [bytes] to align.
+   *
+   * \return size_t containing the aligned size.
+   */
+  static size_t align(const size_t size) { return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+  /**
+   * \brief Static constant for the file format identifier.
+   */
+  static const char MAGIC[8];
+
+  /**
+   * \brief Static constant for the file format version.
+   */
+  static const boost::uint32_t VERSION = 1;
+
+  /**
+   * \brief Static constant for the sections' alignment [bytes].
+   */
+  static const size_t ALIGNMENT = 8;
+
+  /**
+   * \brief Static constant for the size [bytes] of a block's column table.
+   */
+  static const size_t COLUMN_TABLE_SIZE = ((EGMLogRecord::NUMBER_OF_VALUES + 1)*sizeof(boost::uint32_t) +
+                                           ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+};
+
+/**
+ * \brief Class for asynchronous logging of EGM messages into memory-mapped, columnar binary files.
+ *
+ * The class provides behavior for:
+ * - Copying inputs and outputs into fixed-size records, which are pushed into a lock-free
+ *   single-producer/single-consumer ring buffer. This is the only work done in the calling thread
+ *   (i.e. the UDP server's callback thread).
+ * - Transposing the records into column blocks in a background thread, and writing each completed block (optionally
+ *   compressed) into a preallocated, memory-mapped file, together with a time stamp index.
+ * - Rolling over to a new file when the current file is full, i.e. "<base>_0.col", "<base>_1.col", and so on.
+ *
+ * Use the EGMColumnarLogReader class to read the files.
+ *
+ * Note: Records are dropped (and counted) if the ring buffer is full, the calling thread never waits for disk I/O.
+ */
+class EGMColumnarLogger
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param base_filename specifying the base of the log files' filenames.
+   * \param use_compression indicating if constant columns should be compressed (per block).
+   * \param block_capacity specifying the max number of rows in each block.
+   * \param max_blocks specifying the max number of blocks in each file.
+   * \param capacity specifying the ring buffer's capacity (i.e. max number of records waiting to be written).
+   */
+  EGMColumnarLogger(const std::string& base_filename,
+                    const bool use_compression = true,
+                    const size_t block_capacity = DEFAULT_BLOCK_CAPACITY,
+                    const size_t max_blocks = DEFAULT_MAX_BLOCKS,
+                    const size_t capacity = EGMAsyncLogger::DEFAULT_CAPACITY);
+
+  /**
+   * \brief A destructor.
+   *
+   * Note: Any records remaining in the ring buffer are written to the log before the log is closed.
+   */
+  ~EGMColumnarLogger();
+
+  /**
+   * \brief Add inputs and outputs to the log, as one record.
+   *
+   * \param inputs containing the inputs from the robot controller.
+   * \param outputs containing the outputs to the robot controller.
+   *
+   * \return bool indicating if the record was accepted or not (i.e. if the ring buffer was full).
+   */
+  bool add(const wrapper::Input& inputs, const wrapper::Output& outputs);
+
+  /**
+   * \brief Calculate the amount of time logged.
+   *
+   * \param sample_time specifying the sample time.
+   *
+   * \return double for the time logged.
+   */
+  double calculateTimeLogged(const double sample_time);
+
+  /**
+   * \brief Retrieve the number of records that have been dropped (e.g. due to a full ring buffer).
+   *
+   * \return unsigned int containing the number of dropped records.
+   */
+  unsigned int numberOfDroppedRecords() const { return number_of_dropped_records_; };
+
+  /**
+   * \brief Retrieve the number of files that have been created.
+   *
+   * \return unsigned int containing the number of files.
+   */
+  unsigned int numberOfFiles() const { return number_of_files_; };
+
+  /**
+   * \brief Create the filename of a log file.
+   *
+   * \param base_filename specifying the base of the log files' filenames.
+   * \param file_index specifying the file's index (in the rolling sequence).
+   *
+   * \return std::string containing the filename.
+   */
+  static std::string createFilename(const std::string& base_filename, const unsigned int file_index);
+
+  /**
+   * \brief Default max number of rows in each block (i.e. approximately 4 seconds of data at 250 Hz).
+   */
+  static const size_t DEFAULT_BLOCK_CAPACITY = 1024;
+
+  /**
+   * \brief Default max number of blocks in each file (i.e. approximately 1 hour of data at 250 Hz).
+   */
+  static const size_t DEFAULT_MAX_BLOCKS = 900;
+
+private:
+  /**
+   * \brief Write function for the background thread, which drains the ring buffer into the log files.
+   */
+  void writerThread();
+
+  /**
+   * \brief Add a record to the current block, and write the block if it is full.
+   *
+   * \param record containing the record to add.
+   */
+  void addToBlock(const EGMLogRecord& record);
+
+  /**
+   * \brief Write the current block (if it contains any rows) into the current file.
+   *
+   * Note: A new file is opened if there is no current file, or if the current file is full.
+   *
+   * \return bool indicating if the block was written or not.
+   */
+  bool writeBlock();
+
+  /**
+   * \brief Create, preallocate and map the next file in the rolling sequence.
+   *
+   * \return bool indicating if the file was opened or not.
+   */
+  bool openFile();
+
+  /**
+   * \brief Flush and unmap the current file (if any).
+   */
+  void closeFile();
+
+  /**
+   * \brief Static constant for the max number of records drained in one batch.
+   */
+  static const size_t BATCH_SIZE = 64;
+
+  /**
+   * \brief Static constant for the background thread's idle wait time [ms].
+   */
+  static const unsigned int IDLE_WAIT_TIME_MS = 10;
+
+  /**
+   * \brief The base of the log files' filenames.
+   */
+  const std::string base_filename_;
+
+  /**
+   * \brief Flag indicating if constant columns should be compressed.
+   */
+  const bool use_compression_;
+
+  /**
+   * \brief The max number of rows in each block.
+   */
+  const size_t block_capacity_;
+
+  /**
+   * \brief The max number of blocks in each file.
+   */
+  const size_t max_blocks_;
+
+  /**
+   * \brief The number of logged messages.
+   */
+  unsigned int number_of_logged_messages_;
+
+  /**
+   * \brief The number of dropped records.
+   */
+  boost::atomic<unsigned int> number_of_dropped_records_;
+
+  /**
+   * \brief The number of created files.
+   */
+  boost::atomic<unsigned int> number_of_files_;
+
+  /**
+   * \brief Flag indicating if the background thread should stop.
+   */
+  boost::atomic<bool> stop_requested_;
+
+  /**
+   * \brief Ring buffer for records waiting to be written.
+   */
+  RingBuffer<EGMLogRecord> ring_buffer_;
+
+  /**
+   * \brief The current block's time stamp column.
+   */
+  std::vector<boost::uint32_t> block_time_stamps_;
+
+  /**
+   * \brief The current block's value columns (column-major, i.e. with block capacity values per column).
+   */
+  std::vector<double> block_values_;
+
+  /**
+   * \brief The number of rows in the current block.
+   */
+  size_t block_rows_;
+
+  /**
+   * \brief Mapping of the current file.
+   */
+  boost::scoped_ptr<boost::interprocess::file_mapping> p_mapping_;
+
+  /**
+   * \brief Mapped region of the current file.
+   */
+  boost::scoped_ptr<boost::interprocess::mapped_region> p_region_;
+
+  /**
+   * \brief Background thread for writing records to the log.
+   */
+  boost::thread writer_thread_;
+};
+
+/**
+ * \brief Class for reading a columnar log file (e.g. for post-analysis).
+ *
+ * The class provides behavior for:
+ * - Memory-mapping a file (read only), i.e. only the accessed parts of the file are loaded.
+ * - Seeking to a time stamp, via binary searches in the block index and in a block's time stamp column.
+ * - Reading complete records, or ranges of a single value column.
+ *
+ * Note: Rows are indexed within the file, and the time stamps are assumed to be non-decreasing within the file.
+ */
+class EGMColumnarLogReader
+{
+public:
+  /**
+   * \brief A constructor.
+   */
+  EGMColumnarLogReader();
+
+  /**
+   * \brief Open a columnar log file.
+   *
+   * \param filename specifying the log file's filename.
+   *
+   * \return bool indicating if the file was opened (and validated) or not.
+   */
+  bool open(const std::string& filename);
+
+  /**
+   * \brief Close the log file (if any).
+   */
+  void close();
+
+  /**
+   * \brief Check if a log file is open.
+   *
+   * \return bool indicating if a log file is open or not.
+   */
+  bool isOpen() const { return p_header_ != 0; };
+
+  /**
+   * \brief Retrieve the number of rows in the log file.
+   *
+   * \return size_t containing the number of rows.
+   */
+  size_t numberOfRows() const;
+
+  /**
+   * \brief Retrieve the number of blocks in the log file.
+   *
+   * \return size_t containing the number of blocks.
+   */
+  size_t numberOfBlocks() const;
+
+  /**
+   * \brief Find the first row with a time stamp greater than, or equal to, a time stamp.
+   *
+   * \param time_stamp specifying the time stamp [ms] to seek.
+   * \param p_row for containing the found row's index.
+   *
+   * \return bool indicating if a row was found or not.
+   */
+  bool findRow(const boost::uint32_t time_stamp, size_t* p_row) const;
+
+  /**
+   * \brief Read a complete record.
+   *
+   * \param row specifying the row's index.
+   * \param p_record for containing the read record.
+   *
+   * \return bool indicating if the record was read or not.
+   */
+  bool readRecord(const size_t row, EGMLogRecord* p_record) const;
+
+  /**
+   * \brief Read a range of a value column.
+   *
+   * \param value_index specifying the value's index in a record (see EGMLogRecord).
+   * \param first_row specifying the range's first row.
+   * \param number_of_rows specifying the max number of rows to read (the range ends at the file's last row).
+   * \param p_values for containing the read values.
+   *
+   * \return bool indicating if the range was read or not.
+   */
+  bool readColumn(const size_t value_index,
+                  const size_t first_row,
+                  const size_t number_of_rows,
+                  std::vector<double>* p_values) const;
+
+  /**
+   * \brief Convert a columnar log file into a CSV formatted file (with the same layout as the EGMLogger class).
+   *
+   * \param columnar_filename specifying the columnar log file's filename.
+   * \param csv_filename specifying the CSV log's filename.
+   *
+   * \return bool indicating if the conversion was successful or not.
+   */
+  static bool convertToCSV(const std::string& columnar_filename, const std::string& csv_filename);
+
+private:
+  /**
+   * \brief Find the block containing a row.
+   *
+   * \param row specifying the row's index.
+   *
+   * \return const EGMColumnarLogLayout::BlockIndex* to the block's index entry (or a null pointer, if not found).
+   */
+  const EGMColumnarLogLayout::BlockIndex* findBlock(const size_t row) const;
+
+  /**
+   * \brief Read a value from a block.
+   *
+   * \param block specifying the block's index entry.
+   * \param value_index specifying the value's index in a record.
+   * \param block_row specifying the row's index within the block.
+   *
+   * \return double containing the value.
+   */
+  double readValue(const EGMColumnarLogLayout::BlockIndex& block,
+                   const size_t value_index,
+                   const size_t block_row) const;
+
+  /**
+   * \brief Retrieve a block's time stamp column.
+   *
+   * \param block specifying the block's index entry.
+   *
+   * \return const boost::uint32_t* to the block's first time stamp.
+   */
+  const boost::uint32_t* timeStamps(const EGMColumnarLogLayout::BlockIndex& block) const;
+
+  /**
+   * \brief Mapping of the log file.
+   */
+  boost::scoped_ptr<boost::interprocess::file_mapping> p_mapping_;
+
+  /**
+   * \brief Mapped region of the log file.
+   */
+  boost::scoped_ptr<boost::interprocess::mapped_region> p_region_;
+
+  /**
+   * \brief The mapped file's header.
+   */
+  const EGMColumnarLogLayout::FileHeader* p_header_;
+
+  /**
+   * \brief The mapped file's block index.
+   */
+  const EGMColumnarLogLayout::BlockIndex* p_index_;
+
+  /**
+   * \brief The mapped file's start.
+   */
+  const char* p_data_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_COLUMNAR_LOG_H
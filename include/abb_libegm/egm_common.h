@@ -37,6 +37,10 @@
 #ifndef EGM_COMMON_H
 #define EGM_COMMON_H
 
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/condition_variable.hpp>
 
@@ -88,17 +92,17 @@ struct Constants
     /**
      * \brief Default number of robot joints.
      */
-    static const int DEFAULT_NUMBER_OF_ROBOT_JOINTS;
+    static const int DEFAULT_NUMBER_OF_ROBOT_JOINTS = 6;
 
     /**
      * \brief Default number of external joints.
      */
-    static const int DEFAULT_NUMBER_OF_EXTERNAL_JOINTS;
+    static const int DEFAULT_NUMBER_OF_EXTERNAL_JOINTS = 6;
 
     /**
      * \brief Maximum number of joints.
      */
-    static const int MAX_NUMBER_OF_JOINTS;
+    static const int MAX_NUMBER_OF_JOINTS = DEFAULT_NUMBER_OF_ROBOT_JOINTS + DEFAULT_NUMBER_OF_EXTERNAL_JOINTS;
   };
 
   /**
@@ -133,8 +137,122 @@ struct Constants
   };
 };
 
+/**
+ * \brief Struct for the configuration of a UDP server (i.e. how the server's socket is operated).
+ */
+struct UDPServerConfiguration
+{
+  /**
+   * \brief Enum for the available operating modes.
+   */
+  enum Mode
+  {
+    Asynchronous,         ///< \brief Use asynchronous operations, executed by the user provided boost asio io_service.
+    DedicatedBlocking,    ///< \brief Use blocking receive/send operations, in a dedicated thread owned by the server.
+    DedicatedBusyPolling, ///< \brief Use non-blocking receive/send operations, busy-polled in a dedicated thread.
+    External              ///< \brief Don't open any socket, messages are dispatched externally (e.g. UDPMultiServer).
+  };
+
+  /**
+   * \brief Default constructor.
+   */
+  UDPServerConfiguration()
+  :
+  mode(Asynchronous),
+  cpu_affinity(-1),
+  priority(0),
+  lock_memory(false),
+  capture_filename("")
+  {}
+
+  /**
+   * \brief Value specifying the operating mode.
+   */
+  Mode mode;
+
+  /**
+   * \brief Value specifying which CPU the dedicated thread should be pinned to.
+   *
+   * Note: Only used in the dedicated modes (and only supported on Linux). A negative value disables the pinning.
+   */
+  int cpu_affinity;
+
+  /**
+   * \brief Value specifying the real-time (SCHED_FIFO) scheduling priority [1, 99] of the dedicated thread.
+   *
+   * Note: Only used in the dedicated modes (and only supported on Linux). A value of zero keeps the default
+   *       scheduling policy. Real-time scheduling typically requires elevated privileges (e.g. CAP_SYS_NICE).
+   */
+  int priority;
+
+  /**
+   * \brief Flag indicating if the process' memory should be locked into RAM (i.e. mlockall), to avoid page faults.
+   *
+   * Note: Only used in the dedicated modes (and only supported on Linux).
+   */
+  bool lock_memory;
+
+  /**
+   * \brief Filename of a capture file, for recording all received datagrams (with receive timestamps).
+   *
+   * Note: Capturing is disabled if empty. The capture can be replayed offline with the EGMReplayDriver class.
+   */
+  std::string capture_filename;
+};
+
+/**
+ * \brief Struct for the configuration of a telemetry stream (i.e. decimated and aggregated values for monitoring).
+ */
+struct TelemetryConfiguration
+{
+  /**
+   * \brief Default constructor.
+   */
+  TelemetryConfiguration()
+  :
+  use_telemetry(false),
+  window_duration(0.033),
+  multicast_address(""),
+  multicast_port(0)
+  {}
+
+  /**
+   * \brief Flag indicating if the telemetry stream should be used or not.
+   */
+  bool use_telemetry;
+
+  /**
+   * \brief Duration [s] of each aggregation window (i.e. the inverse of the stream's rate).
+   */
+  double window_duration;
+
+  /**
+   * \brief Indices of the values to aggregate, in the same layout as for a log record (see EGMLogRecord).
+   *
+   * Note: If empty, then the robot feedback section is used (i.e. the first 40 values).
+   */
+  std::vector<unsigned int> value_indices;
+
+  /**
+   * \brief Address of a UDP multicast group (e.g. "239.255.0.1") to stream the aggregated values to.
+   *
+   * Note: Streaming is disabled if empty.
+   */
+  std::string multicast_address;
+
+  /**
+   * \brief Port number of the UDP multicast stream.
+   */
+  unsigned short multicast_port;
+};
+
 /**
  * \brief Struct for an EGM user interface's base configuration.
+ *
+ * Configuration updates (e.g. via EGMBaseInterface::setConfiguration) are applied according to each parameter:
+ * - Runtime parameters: Applied from the next received message (i.e. also during an EGM communication session).
+ * - Session parameters: Applied when the next EGM communication session starts.
+ * - Construction parameters: Only applied when the interface is created.
  */
 struct BaseConfiguration
 {
@@ -147,13 +265,21 @@ struct BaseConfiguration
   use_demo_outputs(false),
   use_velocity_outputs(false),
   use_logging(false),
-  max_logging_duration(60.0)
+  use_asynchronous_logging(false),
+  use_columnar_logging(false),
+  max_logging_duration(60.0),
+  use_fast_input_parsing(false),
+  use_non_blocking_outputs(false),
+  use_output_extrapolation(false),
+  extrapolation_duration(0.1),
+  use_statistics(false),
+  use_event_descriptor(false)
   {}
 
   /**
    * \brief Value specifying if a six or seven axes robot is used.
    *
-   * Note: If set to a seven axes robot, then an implicit mapping of joint values is performed.
+   * Note: If set to a seven axes robot, then an implicit mapping of joint values is performed. Session parameter.
    */
   RobotAxes axes;
 
@@ -161,37 +287,208 @@ struct BaseConfiguration
    * \brief Flag indicating if demo outputs should be used.
    *
    * Note: Overrides any other execution mode. Mainly used to verify that the EGM communication channel
-   *       works as intended.
+   *       works as intended. Session parameter.
    */
   bool use_demo_outputs;
 
   /**
    * \brief Flag indicating if the messages, sent to the robot controller, should include velocity outputs.
    *
-   * Note: If set to false, then no velocity values are sent (they are optional).
+   * Note: If set to false, then no velocity values are sent (they are optional). Runtime parameter.
    */
   bool use_velocity_outputs;
 
   /**
    * \brief Flag indicating if the interface should log data.
+   *
+   * Note: Runtime parameter, but the log file is only created if logging is specified when the interface is created.
+   *       I.e. logging can be paused and resumed during an EGM communication session.
    */
   bool use_logging;
 
+  /**
+   * \brief Flag indicating if the logging should be done asynchronously, into a binary file.
+   *
+   * Note: If set to true, then the callback only copies each message into a ring buffer, and a background thread
+   *       writes the data to a "port_<number>_log.bin" file. Use EGMAsyncLogger::convertToCSV to convert the file into
+   *       the same CSV format as for the default (synchronous) logging. Construction parameter.
+   */
+  bool use_asynchronous_logging;
+
+  /**
+   * \brief Flag indicating if the logging should be done asynchronously, into memory-mapped columnar binary files.
+   *
+   * Note: If set to true, then the callback only copies each message into a ring buffer, and a background thread
+   *       writes the data in column blocks (with a time stamp index) to a rolling sequence of preallocated
+   *       "port_<number>_log_<index>.col" files. Use EGMColumnarLogReader to seek and read the files. Overrides
+   *       use_asynchronous_logging. Construction parameter.
+   */
+  bool use_columnar_logging;
+
   /**
    * \brief Maximum duration [s] to log data.
+   *
+   * Note: Runtime parameter.
    */
   double max_logging_duration;
 
+  /**
+   * \brief Flag indicating if received messages should be decoded directly from the wire format.
+   *
+   * Note: If set to true, then the received messages are decoded into a flat, fixed-capacity struct (without any
+   *       heap allocations), instead of being parsed by the Google Protocol Buffer parser. Session parameter.
+   */
+  bool use_fast_input_parsing;
+
+  /**
+   * \brief Flag indicating if the callback should use the latest available outputs, instead of waiting for new ones.
+   *
+   * Note: Only used by the EGMControllerInterface class. If set to true, then a slow external control loop never
+   *       delays the reply to the robot controller (the most recently written outputs are used instead). Runtime
+   *       parameter.
+   */
+  bool use_non_blocking_outputs;
+
+  /**
+   * \brief Flag indicating if late outputs should be extrapolated, instead of resending the previous outputs.
+   *
+   * Note: Only used by the EGMControllerInterface class. If set to true, then cycles without new outputs (e.g. due to
+   *       a timeout, or with non-blocking outputs) continue from the most recent new outputs' velocities and
+   *       accelerations, and come to a smooth stop within the extrapolation duration. Missed messages (i.e. gaps in
+   *       the sequence numbers) are accounted for. See EGMControllerInterface::retrieveExtrapolationStatistics.
+   *       Runtime parameter.
+   */
+  bool use_output_extrapolation;
+
+  /**
+   * \brief Duration [s] for extrapolating late outputs (i.e. until the extrapolated outputs have come to a stop).
+   *
+   * Note: Runtime parameter.
+   */
+  double extrapolation_duration;
+
+  /**
+   * \brief Flag indicating if timing and packet statistics should be collected (see getStatistics()).
+   *
+   * Note: Runtime parameter.
+   */
+  bool use_statistics;
+
+  /**
+   * \brief The configuration of the interface's UDP server.
+   *
+   * Note: Construction parameter.
+   */
+  UDPServerConfiguration udp_server;
+
+  /**
+   * \brief The configuration of the interface's telemetry stream (see EGMBaseInterface::addTelemetrySubscriber).
+   *
+   * Note: Construction parameter.
+   */
+  TelemetryConfiguration telemetry;
+
   /**
    * \brief Optional condition variable intended for notifying an external control loop that a new message is available.
    *
-   * Note: This is only intended to be used in the EGMControllerInterface class.
+   * Note: This is only intended to be used in the EGMControllerInterface class. Runtime parameter.
    */
   boost::shared_ptr<boost::condition_variable> p_new_message_cv;
+
+  /**
+   * \brief Optional callback, notified when an EGM communication session connects (true) or disconnects (false).
+   *
+   * Note: Construction parameter. The callback is notified from a background thread, which is only started if the
+   *       callback is provided.
+   */
+  boost::function<void (const bool connected)> connection_callback;
+
+  /**
+   * \brief Flag indicating if a pollable event descriptor should be created or not (see
+   *        EGMBaseInterface::getEventDescriptor).
+   *
+   * Note: Construction parameter. Only supported on Linux.
+   */
+  bool use_event_descriptor;
+};
+
+/**
+ * \brief Struct for an axis' motion limits.
+ *
+ * Note: Values that are not positive are treated as unlimited.
+ */
+struct AxisLimits
+{
+  /**
+   * \brief A constructor.
+   *
+   * \param max_velocity specifying the max velocity [degrees/s or mm/s].
+   * \param max_acceleration specifying the max acceleration [degrees/s^2 or mm/s^2].
+   * \param max_jerk specifying the max jerk [degrees/s^3 or mm/s^3].
+   */
+  AxisLimits(const double max_velocity = 0.0, const double max_acceleration = 0.0, const double max_jerk = 0.0)
+  :
+  velocity(max_velocity),
+  acceleration(max_acceleration),
+  jerk(max_jerk)
+  {}
+
+  /**
+   * \brief The max velocity [degrees/s or mm/s].
+   */
+  double velocity;
+
+  /**
+   * \brief The max acceleration [degrees/s^2 or mm/s^2].
+   */
+  double acceleration;
+
+  /**
+   * \brief The max jerk [degrees/s^3 or mm/s^3].
+   */
+  double jerk;
+};
+
+/**
+ * \brief Struct for the configuration of trajectory retiming.
+ *
+ * Retiming replaces the durations of trajectory points with the shortest durations that keep the interpolated
+ * motions within the specified limits.
+ */
+struct RetimingConfiguration
+{
+  /**
+   * \brief Default constructor.
+   */
+  RetimingConfiguration()
+  :
+  use_retiming(false)
+  {}
+
+  /**
+   * \brief Flag indicating if added trajectories should be retimed.
+   */
+  bool use_retiming;
+
+  /**
+   * \brief Limits for the robot axes (i.e. the robot joints, or the Cartesian x, y and z axes in pose mode).
+   *
+   * Note: Axes without specified limits are treated as unlimited.
+   */
+  std::vector<AxisLimits> robot_limits;
+
+  /**
+   * \brief Limits for the external axes.
+   *
+   * Note: Axes without specified limits are treated as unlimited.
+   */
+  std::vector<AxisLimits> external_limits;
 };
 
 /**
  * \brief Struct for the EGM trajectory user interface's configuration.
+ *
+ * See BaseConfiguration for how configuration updates are applied.
  */
 struct TrajectoryConfiguration
 {
@@ -234,7 +531,10 @@ struct TrajectoryConfiguration
   TrajectoryConfiguration(const BaseConfiguration& base_configuration = BaseConfiguration())
   :
   base(base_configuration),
-  spline_method(Quintic)
+  spline_method(Quintic),
+  stream_capacity(1000),
+  use_segment_cache(false),
+  use_predictive_outputs(false)
   {}
 
   /**
@@ -244,8 +544,52 @@ struct TrajectoryConfiguration
 
   /**
    * \brief Value specifying which spline method to use in the interpolation.
+   *
+   * Note: Runtime parameter, which is applied from the next interpolated trajectory segment.
    */
   SplineMethod spline_method;
+
+  /**
+   * \brief Value specifying the max number of points that can be buffered for streaming.
+   *
+   * Note: Construction parameter.
+   */
+  unsigned int stream_capacity;
+
+  /**
+   * \brief Flag indicating if duration dependent interpolation values should be precomputed for added trajectories.
+   *
+   * Note: The values are computed (by the user thread) when a trajectory is added, for points with specified
+   *       durations. They are transparently recomputed in the EGM communication loop if the timing has changed
+   *       (e.g. due to a duration factor update or an interrupted goal). Applied directly for added trajectories.
+   */
+  bool use_segment_cache;
+
+  /**
+   * \brief Flag indicating if the next interpolation should be predicted, right after a reply has been sent.
+   *
+   * Note: The prediction is made for the estimated sample time, and it is only used if the goal (and sample time)
+   *       is unchanged when the next message arrives. The feedback dependent parts (e.g. condition checks and output
+   *       calculations) are still done after the message has been received. Requires that the UDP server notifies
+   *       the interface after each sent reply (e.g. via UDPDispatcher::postReply if messages are dispatched
+   *       externally). Runtime parameter.
+   */
+  bool use_predictive_outputs;
+
+  /**
+   * \brief The configuration for retiming of added trajectories.
+   *
+   * Note: Applied directly for added trajectories.
+   */
+  RetimingConfiguration retiming;
+
+  /**
+   * \brief Optional condition variable for notifying external threads that the execution progress has changed.
+   *
+   * Note: Notified when the execution state, sub state or active goal changes. The latest progress can then be
+   *       retrieved with EGMTrajectoryInterface::retrieveProgressSnapshot(). Runtime parameter.
+   */
+  boost::shared_ptr<boost::condition_variable> p_progress_cv;
 };
 
 } // end namespace egm
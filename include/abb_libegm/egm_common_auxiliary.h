@@ -43,6 +43,9 @@
 #include "egm_wrapper.pb.h" // Generated by Google Protocol Buffer compiler protoc
 
 #include "egm_common.h"
+#include "egm_decoder.h"
+#include "egm_joint_mapping.h"
+#include "egm_math.h"
 
 namespace abb
 {
@@ -243,6 +246,54 @@ double findMaxDifference(const wrapper::Cartesian& c1, const wrapper::Cartesian&
  */
 double findMaxDifference(const wrapper::Euler& e1, const wrapper::Euler& e2);
 
+/**
+ * \brief Copy a Cartesian object into a math vector.
+ *
+ * \param p_target for the math vector.
+ * \param source containing the values to copy.
+ */
+void copy(math::Vector3* p_target, const wrapper::Cartesian& source);
+
+/**
+ * \brief Copy a math vector into a Cartesian object.
+ *
+ * \param p_target for the Cartesian object.
+ * \param source containing the values to copy.
+ */
+void copy(wrapper::Cartesian* p_target, const math::Vector3& source);
+
+/**
+ * \brief Copy an Euler object (i.e. Euler angles or an angular velocity) into a math vector.
+ *
+ * \param p_target for the math vector.
+ * \param source containing the values to copy.
+ */
+void copy(math::Vector3* p_target, const wrapper::Euler& source);
+
+/**
+ * \brief Copy a math vector into an Euler object (i.e. Euler angles or an angular velocity).
+ *
+ * \param p_target for the Euler object.
+ * \param source containing the values to copy.
+ */
+void copy(wrapper::Euler* p_target, const math::Vector3& source);
+
+/**
+ * \brief Copy a Quaternion object into a math quaternion.
+ *
+ * \param p_target for the math quaternion.
+ * \param source containing the values to copy.
+ */
+void copy(math::Quaternion* p_target, const wrapper::Quaternion& source);
+
+/**
+ * \brief Copy a math quaternion into a Quaternion object.
+ *
+ * \param p_target for the Quaternion object.
+ * \param source containing the values to copy.
+ */
+void copy(wrapper::Quaternion* p_target, const math::Quaternion& source);
+
 /**
  * \brief Copy the data present in one joints object to another.
  *
@@ -368,7 +419,7 @@ bool parse(wrapper::Clock* p_target, const EgmClock& source);
  * \param p_target_external for containing the parsed external data.
  * \param source_robot containing robot data to parse.
  * \param source_external containing external data to parse.
- * \param axes specifying the number of axes of the robot.
+ * \param mapper for the joint mappings of the robot's axes configuration.
  *
  * \return bool indicating if the parsing was successful or not.
  */
@@ -376,7 +427,7 @@ bool parse(wrapper::Joints* p_target_robot,
            wrapper::Joints* p_target_external,
            const EgmJoints& source_robot,
            const EgmJoints& source_external,
-           const RobotAxes axes);
+           const JointMapper& mapper);
 
 /**
  * \brief Parse an abb::egm::EgmPose object.
@@ -393,22 +444,22 @@ bool parse(wrapper::CartesianPose* p_target, const EgmPose& source);
  *
  * \param p_target for containing the parsed data.
  * \param source containing data to parse.
- * \param axes specifying the number of axes of the robot.
+ * \param mapper for the joint mappings of the robot's axes configuration.
  *
  * \return bool indicating if the parsing was successful or not.
  */
-bool parse(wrapper::Feedback* p_target, const EgmFeedBack& source, const RobotAxes axes);
+bool parse(wrapper::Feedback* p_target, const EgmFeedBack& source, const JointMapper& mapper);
 
 /**
  * \brief Parse an abb::egm::Planned object.
  *
  * \param p_target for containing the parsed data.
  * \param source containing data to parse.
- * \param axes specifying the number of axes of the robot.
+ * \param mapper for the joint mappings of the robot's axes configuration.
  *
  * \return bool indicating if the parsing was successful or not.
  */
-bool parse(wrapper::Planned* p_target, const EgmPlanned& source, const RobotAxes axes);
+bool parse(wrapper::Planned* p_target, const EgmPlanned& source, const JointMapper& mapper);
 
 
 /**
@@ -421,6 +472,85 @@ bool parse(wrapper::Planned* p_target, const EgmPlanned& source, const RobotAxes
  */
 bool parse(wrapper::MeasuredForce* p_target, const EgmMeasuredForce& source);
 
+/**
+ * \brief Parse decoded header data.
+ *
+ * \param p_target for containing the parsed data.
+ * \param source containing data to parse.
+ *
+ * \return bool indicating if the parsing was successful or not.
+ */
+bool parse(wrapper::Header* p_target, const RobotData::Header& source);
+
+/**
+ * \brief Parse decoded status data.
+ *
+ * \param p_target for containing the parsed data.
+ * \param source containing data to parse.
+ *
+ * \return bool indicating if the parsing was successful or not.
+ */
+bool parse(wrapper::Status* p_target, const RobotData& source);
+
+/**
+ * \brief Parse decoded joint data (i.e. robot and external joints).
+ *
+ * \param p_target_robot for containing the parsed robot data.
+ * \param p_target_external for containing the parsed external data.
+ * \param source_robot containing robot data to parse.
+ * \param source_external containing external data to parse.
+ * \param mapper for the joint mappings of the robot's axes configuration.
+ *
+ * \return bool indicating if the parsing was successful or not.
+ */
+bool parse(wrapper::Joints* p_target_robot,
+           wrapper::Joints* p_target_external,
+           const RobotData::Values& source_robot,
+           const RobotData::Values& source_external,
+           const JointMapper& mapper);
+
+/**
+ * \brief Parse decoded pose data.
+ *
+ * \param p_target for containing the parsed data.
+ * \param source containing data to parse.
+ *
+ * \return bool indicating if the parsing was successful or not.
+ */
+bool parse(wrapper::CartesianPose* p_target, const RobotData::Pose& source);
+
+/**
+ * \brief Parse decoded feedback data.
+ *
+ * \param p_target for containing the parsed data.
+ * \param source containing data to parse.
+ * \param mapper for the joint mappings of the robot's axes configuration.
+ *
+ * \return bool indicating if the parsing was successful or not.
+ */
+bool parse(wrapper::Feedback* p_target, const RobotData::Motion& source, const JointMapper& mapper);
+
+/**
+ * \brief Parse decoded planned data.
+ *
+ * \param p_target for containing the parsed data.
+ * \param source containing data to parse.
+ * \param mapper for the joint mappings of the robot's axes configuration.
+ *
+ * \return bool indicating if the parsing was successful or not.
+ */
+bool parse(wrapper::Planned* p_target, const RobotData::Motion& source, const JointMapper& mapper);
+
+/**
+ * \brief Parse decoded measured force data.
+ *
+ * \param p_target for containing the parsed data.
+ * \param source containing data to parse.
+ *
+ * \return bool indicating if the parsing was successful or not.
+ */
+bool parse(wrapper::MeasuredForce* p_target, const RobotData::Values& source);
+
 /**
  * \brief Reset all values (i.e. set to zero) in a joints object.
  *
@@ -0,0 +1,218 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_CONNECTION_MONITOR_H
+#define EGM_CONNECTION_MONITOR_H
+
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Struct for containing the status of an EGM communication session's connection.
+ */
+struct ConnectionStatus
+{
+  /**
+   * \brief Default constructor.
+   */
+  ConnectionStatus()
+  :
+  connected(false),
+  time_since_last_message(0.0),
+  estimated_message_period(0.0)
+  {}
+
+  /**
+   * \brief Flag indicating if an EGM communication session is connected or not.
+   */
+  bool connected;
+
+  /**
+   * \brief Time [s] since the most recent message was received (zero if no message has been received).
+   */
+  double time_since_last_message;
+
+  /**
+   * \brief Estimated period [s] between received messages (zero if not yet estimated).
+   */
+  double estimated_message_period;
+};
+
+/**
+ * \brief Class for tracking the liveness of an EGM communication session.
+ *
+ * The class provides behavior for:
+ * - Recording when messages are received, and estimating the message period. This is the only work done in the
+ *   calling thread (i.e. the UDP server's callback thread), and it only consists of a few atomic operations.
+ * - Non-blocking checks of whether a session is connected or not, i.e. if a message has been received recently.
+ * - Optionally notifying a user provided callback, from a background thread, when a session connects or disconnects.
+ */
+class EGMConnectionMonitor
+{
+public:
+  /**
+   * \brief Type for a callback, which is notified when a session connects (true) or disconnects (false).
+   */
+  typedef boost::function<void (const bool connected)> EventCallback;
+
+  /**
+   * \brief A constructor.
+   *
+   * \param event_callback for an optional callback (a background thread is only started if it is provided).
+   */
+  EGMConnectionMonitor(const EventCallback& event_callback = EventCallback());
+
+  /**
+   * \brief A destructor.
+   */
+  ~EGMConnectionMonitor();
+
+  /**
+   * \brief Record that a valid message has been received.
+   *
+   * \param receive_time specifying when the message was received (the current time is used if it is zero).
+   * \param first_message indicating if the message is the first in a new session.
+   */
+  void update(const boost::chrono::steady_clock::time_point& receive_time, const bool first_message);
+
+  /**
+   * \brief Record that an invalid message has been received (i.e. the session is considered to be disconnected).
+   */
+  void invalidate();
+
+  /**
+   * \brief Checks if an EGM communication session is connected or not.
+   *
+   * A session is considered to be connected if a valid message has been received within the timeout, which is
+   * the largest of MIN_TIMEOUT_MS and TIMEOUT_PERIODS times the estimated message period.
+   *
+   * \return bool indicating if a session is connected or not.
+   */
+  bool isConnected() const;
+
+  /**
+   * \brief Retrieve the connection status.
+   *
+   * \return ConnectionStatus containing the status.
+   */
+  ConnectionStatus getStatus() const;
+
+  /**
+   * \brief Static constant for the min timeout [ms] before a session is considered to be disconnected.
+   */
+  static const unsigned int MIN_TIMEOUT_MS = 100;
+
+  /**
+   * \brief Static constant for the number of estimated message periods before a session is considered to be
+   *        disconnected (if it exceeds the min timeout).
+   */
+  static const unsigned int TIMEOUT_PERIODS = 4;
+
+private:
+  /**
+   * \brief Retrieve the current time, as nanoseconds since the steady clock's epoch.
+   *
+   * \return boost::int64_t containing the current time.
+   */
+  static boost::int64_t now();
+
+  /**
+   * \brief Checks if a session is connected or not, at a specific time.
+   *
+   * \param time specifying the time [ns] to check at.
+   * \param p_age for containing the time [ns] since the most recent message (zero if none has been received).
+   *
+   * \return bool indicating if a session is connected or not.
+   */
+  bool isConnected(const boost::int64_t time, boost::int64_t* p_age) const;
+
+  /**
+   * \brief Function for the background thread, which notifies the event callback about connection changes.
+   */
+  void monitorThread();
+
+  /**
+   * \brief Static constant for the background thread's poll time [ms].
+   */
+  static const unsigned int POLL_TIME_MS = 10;
+
+  /**
+   * \brief Static constant for the smoothing factor used when estimating the message period.
+   */
+  static const double PERIOD_SMOOTHING;
+
+  /**
+   * \brief Time [ns] when the most recent valid message was received (zero if none).
+   */
+  boost::atomic<boost::int64_t> last_receive_time_;
+
+  /**
+   * \brief Estimated period [ns] between received messages (zero if not yet estimated).
+   */
+  boost::atomic<boost::int64_t> estimated_period_;
+
+  /**
+   * \brief The estimated period [ns], with full precision (only used by the calling thread).
+   */
+  double period_;
+
+  /**
+   * \brief Flag indicating if the background thread should stop.
+   */
+  boost::atomic<bool> stop_requested_;
+
+  /**
+   * \brief The optional callback for connection events.
+   */
+  EventCallback event_callback_;
+
+  /**
+   * \brief Background thread for notifying the event callback.
+   */
+  boost::thread monitor_thread_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_CONNECTION_MONITOR_H
@@ -38,6 +38,10 @@
 #define EGM_CONTROLLER_INTERFACE_H
 
 #include "egm_base_interface.h"
+#include "egm_output_extrapolator.h"
+#include "egm_seqlock.h"
+#include "egm_shared_memory.h"
+#include "egm_triple_buffer.h"
 
 namespace abb
 {
@@ -71,6 +75,13 @@ public:
                          const unsigned short port_number,
                          const BaseConfiguration& configuration = BaseConfiguration());
 
+  /**
+   * \brief A destructor.
+   *
+   * Note: Stops the underlying server, before any of the interface's members are destroyed.
+   */
+  ~EGMControllerInterface();
+
   /**
    * \brief Wait for the next EGM message.
    *
@@ -94,6 +105,35 @@ public:
    */
   void write(const wrapper::Output& outputs);
 
+  /**
+   * \brief Create a shared memory segment, for an external control loop in another process (see
+   *        EGMSharedMemoryClient).
+   *
+   * When enabled, the inputs are published both in-process and to the segment, while the outputs are taken from the
+   * segment (i.e. instead of from write(...)).
+   *
+   * Note: Intended to be called once, before the robot controller starts an EGM communication session.
+   *       Only supported on Linux.
+   *
+   * \param name for the segment's name (e.g. "/abb_libegm").
+   *
+   * \return bool indicating if the shared memory segment was created or not.
+   */
+  bool enableSharedMemory(const std::string& name);
+
+  /**
+   * \brief Retrieve the most recently published extrapolation statistics (see
+   *        BaseConfiguration::use_output_extrapolation).
+   *
+   * Note: Only collected while output extrapolation is used.
+   *
+   * \param p_statistics for containing the statistics.
+   *
+   * \return bool indicating if the statistics were retrieved or not (e.g. false if nothing has been published yet,
+   *         or if the retrieval overlapped with an update, in which case it can simply be retried).
+   */
+  bool retrieveExtrapolationStatistics(ExtrapolationStatistics* p_statistics) const;
+
 private:
   /**
    * \brief Class for managing controller motion data, between the inner loop and an external control loop.
@@ -104,7 +144,7 @@ private:
     /**
      * \brief Default constructor.
      */
-    ControllerMotion() : read_data_ready_(false), write_data_ready_(false) {}
+    ControllerMotion() : read_data_ready_(false), write_data_ready_(false), use_shared_memory_(false) {}
 
     /**
      * \brief Initialize the motion data for a new communication session.
@@ -147,8 +187,21 @@ private:
      * \brief Read the current outputs (from the intermediate storage, to the inner loop).
      *
      * \param p_outputs for containing the outputs.
+     * \param wait indicating if new outputs should be waited for (until a timeout occurs), or if the latest available
+     *             outputs should be used directly.
+     *
+     * \return bool indicating if new outputs were read or not (i.e. false if the previous outputs were kept).
      */
-    void readOutputs(wrapper::Output* p_outputs);
+    bool readOutputs(wrapper::Output* p_outputs, const bool wait);
+
+    /**
+     * \brief Create a shared memory segment, for exchanging inputs and outputs with another process.
+     *
+     * \param name for the segment's name.
+     *
+     * \return bool indicating if the shared memory segment was created or not.
+     */
+    bool createSharedMemory(const std::string& name);
 
   private:
     /**
@@ -166,6 +219,16 @@ private:
      */
     boost::mutex write_mutex_;
 
+    /**
+     * \brief Mutex for serializing the external loop's reads of the inputs (i.e. the triple buffer's consumer side).
+     */
+    boost::mutex inputs_consumer_mutex_;
+
+    /**
+     * \brief Mutex for serializing the external loop's writes of the outputs (i.e. the triple buffer's producer side).
+     */
+    boost::mutex outputs_producer_mutex_;
+
     /**
      * \brief Condition variable for waiting on read data.
      */
@@ -187,14 +250,35 @@ private:
     bool write_data_ready_;
 
     /**
-     * \brief Container for the inputs received from the robot controller.
+     * \brief Wait-free handoff of the inputs received from the robot controller.
+     *
+     * Note: Written by the inner loop and read by the external loop. The mutex only protects the ready flag.
+     */
+    TripleBuffer<wrapper::Input> inputs_;
+
+    /**
+     * \brief Wait-free handoff of the outputs to send to the robot controller.
+     *
+     * Note: Written by the external loop and read by the inner loop. The mutex only protects the ready flag.
      */
-    wrapper::Input inputs_;
+    TripleBuffer<wrapper::Output> outputs_;
 
     /**
-     * \brief Container for the outputs to send to the robot controller.
+     * \brief Shared memory segment, for an external control loop in another process.
      */
-    wrapper::Output outputs_;
+    EGMSharedMemory shared_memory_;
+
+    /**
+     * \brief Flag indicating if the shared memory segment should be used or not.
+     *
+     * Note: Set (once the segment has been created) by the user, and read by the inner loop.
+     */
+    boost::atomic<bool> use_shared_memory_;
+
+    /**
+     * \brief Container for outputs read from the shared memory segment.
+     */
+    wrapper::Output shared_outputs_;
   };
 
   /**
@@ -210,6 +294,16 @@ private:
    * \brief The interface's controller motion data (between internal loop and external controller loop).
    */
   ControllerMotion controller_motion_;
+
+  /**
+   * \brief Extrapolator for late outputs.
+   */
+  EGMOutputExtrapolator output_extrapolator_;
+
+  /**
+   * \brief The published extrapolation statistics.
+   */
+  SeqLock<ExtrapolationStatistics> extrapolation_statistics_;
 };
 
 } // end namespace egm
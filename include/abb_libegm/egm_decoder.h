@@ -0,0 +1,162 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_DECODER_H
+#define EGM_DECODER_H
+
+#include <boost/cstdint.hpp>
+
+#include "abb_libegm_export.h"
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Struct for a flat, fixed-capacity representation of an abb::egm::EgmRobot message.
+ *
+ * The struct is intended to be decoded into directly from the EGM wire format, without any heap allocations.
+ * Each field has a corresponding presence flag, mirroring the optional fields in the EGM protocol.
+ */
+struct RobotData
+{
+  /**
+   * \brief Static constant for the max number of values in a repeated field (i.e. the max number of joints).
+   */
+  static const int MAX_NUMBER_OF_VALUES = 12;
+
+  /**
+   * \brief Struct for a fixed-capacity array of values (e.g. joint values).
+   */
+  struct Values
+  {
+    /**
+     * \brief Number of used values.
+     */
+    int size;
+
+    /**
+     * \brief The values.
+     */
+    double data[MAX_NUMBER_OF_VALUES];
+  };
+
+  /**
+   * \brief Struct for header data.
+   */
+  struct Header
+  {
+    bool has_seqno;           ///< \brief Flag indicating if the sequence number is present.
+    bool has_tm;              ///< \brief Flag indicating if the time stamp is present.
+    bool has_mtype;           ///< \brief Flag indicating if the message type is present.
+    boost::uint32_t seqno;    ///< \brief The sequence number.
+    boost::uint32_t tm;       ///< \brief The time stamp [ms].
+    int mtype;                ///< \brief The message type (abb::egm::EgmHeader_MessageType value).
+  };
+
+  /**
+   * \brief Struct for clock data.
+   */
+  struct Clock
+  {
+    boost::uint64_t sec;  ///< \brief Seconds since 1 Jan 1970.
+    boost::uint64_t usec; ///< \brief Microseconds.
+  };
+
+  /**
+   * \brief Struct for pose data.
+   */
+  struct Pose
+  {
+    bool has_pos;       ///< \brief Flag indicating if the position is present.
+    bool has_orient;    ///< \brief Flag indicating if the quaternion orientation is present.
+    bool has_euler;     ///< \brief Flag indicating if the Euler orientation is present.
+    double pos[3];      ///< \brief The position (x, y, z) [mm].
+    double orient[4];   ///< \brief The quaternion orientation (u0, u1, u2, u3).
+    double euler[3];    ///< \brief The Euler orientation (x, y, z) [degrees].
+  };
+
+  /**
+   * \brief Struct for motion data (i.e. the data in abb::egm::EgmFeedBack and abb::egm::EgmPlanned messages).
+   */
+  struct Motion
+  {
+    bool has_cartesian;       ///< \brief Flag indicating if the Cartesian pose is present.
+    bool has_time;            ///< \brief Flag indicating if the time is present.
+    Values joints;            ///< \brief The robot joints [degrees].
+    Values external_joints;   ///< \brief The external joints.
+    Pose cartesian;           ///< \brief The Cartesian pose.
+    Clock time;               ///< \brief The time.
+  };
+
+  bool has_header;                ///< \brief Flag indicating if the header is present.
+  bool has_motor_state;           ///< \brief Flag indicating if the motor state is present.
+  bool has_mci_state;             ///< \brief Flag indicating if the EGM (MCI) state is present.
+  bool has_mci_convergence_met;   ///< \brief Flag indicating if the EGM (MCI) convergence flag is present.
+  bool has_rapid_exec_state;      ///< \brief Flag indicating if the RAPID execution state is present.
+  bool has_utilization_rate;      ///< \brief Flag indicating if the utilization rate is present.
+
+  Header header;                  ///< \brief The header.
+  Motion feedback;                ///< \brief The feedback.
+  Motion planned;                 ///< \brief The planned.
+  int motor_state;                ///< \brief The motor state (abb::egm::EgmMotorState_MotorStateType value).
+  int mci_state;                  ///< \brief The EGM (MCI) state (abb::egm::EgmMCIState_MCIStateType value).
+  bool mci_convergence_met;       ///< \brief The EGM (MCI) convergence flag.
+  int rapid_exec_state;           ///< \brief The RAPID execution state (abb::egm::EgmRapidCtrlExecState value).
+  Values measured_force;          ///< \brief The measured force.
+  double utilization_rate;        ///< \brief The utilization rate.
+};
+
+/**
+ * \brief Decode a serialized abb::egm::EgmRobot message, directly from the wire format, into a flat struct.
+ *
+ * Note: No heap allocations are performed. The decoding fails if the data is malformed, if any required field is
+ *       missing (same as for the Google Protocol Buffer parser) or if a repeated field exceeds the fixed capacity.
+ *       Unknown fields are skipped, and unknown enum values are treated as absent (i.e. the decoding fails if the
+ *       enum field is required).
+ *
+ * \param p_target for containing the decoded data.
+ * \param data containing the serialized array received from the robot controller.
+ * \param bytes_transferred for the number of bytes received.
+ *
+ * \return bool indicating if the decoding was successful or not.
+ */
+bool decode(RobotData* p_target, const char* data, const int bytes_transferred);
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_DECODER_H
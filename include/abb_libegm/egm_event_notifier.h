@@ -0,0 +1,100 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_EVENT_NOTIFIER_H
+#define EGM_EVENT_NOTIFIER_H
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Class for signalling events via a pollable file descriptor (i.e. an eventfd on Linux).
+ *
+ * The descriptor becomes readable when an event has been signalled, which lets external event loops (e.g. based on
+ * epoll, select or boost asio) react on the events without dedicating a thread to wait for them.
+ *
+ * Note: Only supported on Linux (i.e. the descriptor is invalid on other platforms).
+ */
+class EGMEventNotifier
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param enable indicating if a descriptor should be created or not.
+   */
+  explicit EGMEventNotifier(const bool enable);
+
+  /**
+   * \brief Destructor.
+   */
+  ~EGMEventNotifier();
+
+  /**
+   * \brief Retrieve the pollable file descriptor.
+   *
+   * \return int containing the descriptor, or -1 if there is none.
+   */
+  int descriptor() const;
+
+  /**
+   * \brief Signal an event (i.e. make the descriptor readable).
+   *
+   * Note: Never blocks.
+   */
+  void notify();
+
+  /**
+   * \brief Acknowledge all signalled events (i.e. make the descriptor non-readable again).
+   *
+   * Note: Never blocks.
+   *
+   * \return unsigned int containing the number of events signalled since the previous acknowledgement.
+   */
+  unsigned int acknowledge();
+
+private:
+  /**
+   * \brief The pollable file descriptor (-1 if there is none).
+   */
+  int descriptor_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_EVENT_NOTIFIER_H
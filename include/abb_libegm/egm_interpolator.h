@@ -37,13 +37,13 @@
 #ifndef EGM_INTERPOLATOR_H
 #define EGM_INTERPOLATOR_H
 
-#include <boost/array.hpp>
 
 #include "abb_libegm_export.h"
 
 #include "egm_wrapper_trajectory.pb.h" // Generated by Google Protocol Buffer compiler protoc
 
 #include "egm_common.h"
+#include "egm_math.h"
 
 namespace abb
 {
@@ -118,6 +118,39 @@ public:
     TrajectoryConfiguration::SplineMethod spline_method;
   };
 
+  /**
+   * \brief Struct for containing precomputed, duration dependent, values for the spline polynomials.
+   *
+   * The values only depend on the interpolation duration, so they can be computed ahead of time (e.g. when a
+   * trajectory is added) and are valid for any interpolation session with the same duration.
+   */
+  struct Timing
+  {
+    /**
+     * \brief Default constructor.
+     *
+     * Note: The default duration never matches a (saturated) interpolation duration.
+     */
+    Timing();
+
+    /**
+     * \brief A constructor.
+     *
+     * \param segment_duration specifying the duration [s] (saturated to the lowest sample time).
+     */
+    explicit Timing(const double segment_duration);
+
+    /**
+     * \brief Duration [s] that the values have been computed for.
+     */
+    double duration;
+
+    /**
+     * \brief The duration's inverse powers. I.e. 1/T^n, for n = 0, ..., 5.
+     */
+    double inverse_powers[6];
+  };
+
   /**
    * \brief Update the interpolator for upcoming calculations. E.g. used after a new goal has been chosen.
    *
@@ -129,6 +162,22 @@ public:
               const wrapper::trajectory::PointGoal& goal,
               const Conditions& conditions);
 
+  /**
+   * \brief Update the interpolator for upcoming calculations, with precomputed duration dependent values.
+   *
+   * Note: The precomputed values are only used if they match the (saturated) duration in the conditions,
+   *       otherwise they are recomputed.
+   *
+   * \param start containing the start point.
+   * \param goal containing the goal point.
+   * \param conditions for specifying conditions for the interpolator.
+   * \param timing containing the precomputed duration dependent values.
+   */
+  void update(const wrapper::trajectory::PointGoal& start,
+              const wrapper::trajectory::PointGoal& goal,
+              const Conditions& conditions,
+              const Timing& timing);
+
   /**
    * \brief Evaluate the interpolator at a specific time instance.
    *
@@ -148,6 +197,62 @@ public:
     return conditions_.duration;
   }
 
+  /**
+   * \brief Checks if the evaluation only depends on the time instance (i.e. not on any previous output).
+   *
+   * Note: If true, then the interpolator can be evaluated ahead of time into a separate output.
+   *
+   * \return bool indicating if the evaluation only depends on the time instance or not.
+   */
+  bool isStateless() const
+  {
+    return (conditions_.operation == Normal || (conditions_.operation == RampDown && conditions_.mode == EGMJoint));
+  }
+
+  /**
+   * \brief Retrieve the offset to the external joint values, in the arrays produced by evaluateSplines.
+   *
+   * \return int containing the offset.
+   */
+  int getExternalJointsOffset() const
+  {
+    return offset_;
+  }
+
+  /**
+   * \brief Evaluate all spline polynomials at a specific time instance, into plain arrays (in one pass).
+   *
+   * The arrays contain the robot joint values (or the Cartesian x, y and z values in pose mode), followed by the
+   * external joint values starting at getExternalJointsOffset().
+   *
+   * Note: Only meaningful for the Normal and RampDown operations (i.e. orientations and soft ramps are excluded).
+   *
+   * \param p_positions for storing the positions (MAX_NUMBER_OF_SPLINES values).
+   * \param p_velocities for storing the velocities (MAX_NUMBER_OF_SPLINES values).
+   * \param p_accelerations for storing the accelerations (MAX_NUMBER_OF_SPLINES values).
+   * \param t for the time instance [s] that the interpolation should be calculated at.
+   */
+  void evaluateSplines(double* p_positions, double* p_velocities, double* p_accelerations, double t) const;
+
+  /**
+   * \brief Evaluate the max absolute velocities, accelerations and jerks of all spline polynomials, during the
+   *        current interpolation session (i.e. for 0 <= t <= duration).
+   *
+   * The arrays are ordered in the same way as for evaluateSplines.
+   *
+   * Note: Only meaningful for the Normal and RampDown operations (i.e. orientations and soft ramps are excluded).
+   *
+   * \param p_velocities for storing the max absolute velocities (MAX_NUMBER_OF_SPLINES values).
+   * \param p_accelerations for storing the max absolute accelerations (MAX_NUMBER_OF_SPLINES values).
+   * \param p_jerks for storing the max absolute jerks (MAX_NUMBER_OF_SPLINES values).
+   */
+  void evaluateSplineExtremes(double* p_velocities, double* p_accelerations, double* p_jerks) const;
+
+  /**
+   * \brief Static constant for the max number of spline polynomials.
+   */
+  static const size_t MAX_NUMBER_OF_SPLINES = 12;
+
 private:
   /**
    * \brief Enum for specifying which Cartesian axis to consider in the spline polynomials.
@@ -169,10 +274,12 @@ private:
      * \brief A constructor.
      *
      * \param conditions specifying the general conditions for the interpolator.
+     * \param timing_values containing the duration dependent values.
      */
-    SplineConditions(const Conditions conditions)
+    SplineConditions(const Conditions conditions, const Timing& timing_values)
     :
     duration(conditions.duration),
+    timing(timing_values),
     alfa(0.0),
     d_alfa(0.0),
     dd_alfa(0.0),
@@ -211,6 +318,11 @@ private:
      */
     double duration;
 
+    /**
+     * \brief The duration dependent values.
+     */
+    const Timing& timing;
+
     /**
      * \brief The start position.
      */
@@ -260,109 +372,127 @@ private:
   };
 
   /**
-   * \brief Class for a spline interpolation polynomial of degree 5 or lower.
+   * \brief Class for a block of spline interpolation polynomials, each of degree 5 or lower.
+   *
+   * I.e. A[i] + B[i]*t + C[i]*t^2 + D[i]*t^3 + E[i]*t^4 + F[i]*t^5, for i = 0, ..., MAX_NUMBER_OF_SPLINES - 1.
    *
-   * I.e. A + B*t + C*t^2 + D*t^3 + E*t^4 + F*t^5.
+   * The coefficients are stored as a structure of arrays, so that all polynomials can be evaluated (in Horner form)
+   * in one vectorizable pass.
    */
-  class SplinePolynomial
+  class SplineBlock
   {
   public:
     /**
      * \brief Default constructor.
      */
-    SplinePolynomial() : a_(0.0), b_(0.0), c_(0.0), d_(0.0), e_(0.0), f_(0.0) {}
+    SplineBlock();
 
     /**
-     * \brief Update the polynomial's coefficients.
+     * \brief Update one polynomial's coefficients.
      *
+     * \param index of the polynomial.
      * \param conditions containing the spline's conditions.
      */
-    void update(const SplineConditions& conditions);
+    void update(const int index, const SplineConditions& conditions);
 
     /**
-     * \brief Evaluate the polynomial, for robot or external joints values.
+     * \brief Select the evaluation of all polynomials, specialized for the degree given by the conditions.
      *
-     * \param p_output for storing the evaluated values.
-     * \param index of the joint.
-     * \param t for the time instance [s] to evaluate at.
+     * Note: Intended to be called once per update of the polynomials (i.e. not for every evaluation).
+     *
+     * \param conditions containing the splines' conditions.
      */
-    void evaluate(wrapper::trajectory::JointGoal* p_output, const int index, const double t);
+    void selectEvaluation(const SplineConditions& conditions);
 
     /**
-     * \brief Evaluate the polynomial, for Cartesian values.
+     * \brief Evaluate all polynomials.
      *
-     * \param p_output for storing the evaluated values.
-     * \param axis specifying the axis to consider.
+     * \param p_positions for storing the evaluated positions (MAX_NUMBER_OF_SPLINES values).
+     * \param p_velocities for storing the evaluated velocities (MAX_NUMBER_OF_SPLINES values).
+     * \param p_accelerations for storing the evaluated accelerations (MAX_NUMBER_OF_SPLINES values).
      * \param t for the time instance [s] to evaluate at.
      */
-    void evaluate(wrapper::trajectory::CartesianGoal* p_output, const Axis axis, const double t);
+    void evaluate(double* p_positions, double* p_velocities, double* p_accelerations, const double t) const;
 
-  private:
     /**
-     * \brief Calculate the position.
-     *
-     * \param t for the time instance [s] to calculate at.
+     * \brief Evaluate the max absolute velocities, accelerations and jerks of all polynomials.
      *
-     * \return double containing the calculated position.
+     * \param p_velocities for storing the max absolute velocities (MAX_NUMBER_OF_SPLINES values).
+     * \param p_accelerations for storing the max absolute accelerations (MAX_NUMBER_OF_SPLINES values).
+     * \param p_jerks for storing the max absolute jerks (MAX_NUMBER_OF_SPLINES values).
+     * \param duration for the duration [s] to consider (i.e. 0 <= t <= duration).
      */
-    double calculatePosition(const double t)
-    {
-      return a_ + b_*t + c_*std::pow(t, 2) + d_*std::pow(t, 3) + e_*std::pow(t, 4) + f_*std::pow(t, 5);
-    }
+    void evaluateExtremes(double* p_velocities,
+                          double* p_accelerations,
+                          double* p_jerks,
+                          const double duration) const;
 
+  private:
     /**
-     * \brief Calculate the velocity.
-     *
-     * \param t for the time instance [s] to calculate at.
+     * \brief Type for a member function evaluating all polynomials.
+     */
+    typedef void (SplineBlock::*EvaluateFunction)(double*, double*, double*, const double) const;
+
+    /**
+     * \brief Evaluate all polynomials, up to a fixed degree (i.e. the higher coefficients are assumed to be zero).
      *
-     * \return double containing the calculated velocity.
+     * \param p_positions for storing the evaluated positions (MAX_NUMBER_OF_SPLINES values).
+     * \param p_velocities for storing the evaluated velocities (MAX_NUMBER_OF_SPLINES values).
+     * \param p_accelerations for storing the evaluated accelerations (MAX_NUMBER_OF_SPLINES values).
+     * \param t for the time instance [s] to evaluate at.
      */
-    double calculateVelocity(const double t)
-    {
-      return b_ + 2.0*c_*t + 3.0*d_*std::pow(t, 2) + 4.0*e_*std::pow(t, 3) + 5.0*f_*std::pow(t, 4);
-    }
+    template <int DEGREE>
+    void evaluateDegree(double* p_positions, double* p_velocities, double* p_accelerations, const double t) const;
 
     /**
-     * \brief Calculate the acceleration.
+     * \brief Find the roots, within an interval, of a polynomial of degree 2 or lower.
+     *
+     * I.e. c0 + c1*t + c2*t^2 = 0, for 0 < t < duration.
      *
-     * \param t for the time instance [s] to calculate at.
+     * \param p_roots for storing the roots in ascending order (max 2 values).
+     * \param c0 for the polynomial's constant coefficient.
+     * \param c1 for the polynomial's first degree coefficient.
+     * \param c2 for the polynomial's second degree coefficient.
+     * \param duration for the interval's end.
      *
-     * \return double containing the calculated acceleration.
+     * \return int containing the number of roots.
      */
-    double calculateAcceleration(const double t)
-    {
-      return 2.0*c_ + 6.0*d_*t + 12.0*e_*std::pow(t, 2) + 20.0*f_*std::pow(t, 3);
-    }
+    static int findRoots(double* p_roots, const double c0, const double c1, const double c2, const double duration);
 
     /**
-     * \brief Coefficient A.
+     * \brief Coefficients A.
      */
-    double a_;
+    double a_[MAX_NUMBER_OF_SPLINES];
 
     /**
-     * \brief Coefficient B.
+     * \brief Coefficients B.
      */
-    double b_;
+    double b_[MAX_NUMBER_OF_SPLINES];
 
     /**
-     * \brief Coefficient C.
+     * \brief Coefficients C.
      */
-    double c_;
+    double c_[MAX_NUMBER_OF_SPLINES];
 
     /**
-     * \brief Coefficient D.
+     * \brief Coefficients D.
      */
-    double d_;
+    double d_[MAX_NUMBER_OF_SPLINES];
 
     /**
-     * \brief Coefficient E.
+     * \brief Coefficients E.
      */
-    double e_;
+    double e_[MAX_NUMBER_OF_SPLINES];
 
     /**
-     * \brief Coefficient F.
+     * \brief Coefficients F.
      */
-    double f_;
+    double f_[MAX_NUMBER_OF_SPLINES];
+
+    /**
+     * \brief The selected evaluation of all polynomials.
+     */
+    EvaluateFunction p_evaluate_;
   };
 
   /**
@@ -386,11 +516,14 @@ private:
     :
     DOT_PRODUCT_THRESHOLD(0.9995),
     duration_(0.0),
+    inverse_duration_(0.0),
     omega_(0.0),
+    k_(0.0),
     use_linear_(false)
     {
-      q0_.set_u0(1.0);
-      q1_.set_u0(1.0);
+      const math::Quaternion identity = {1.0, 0.0, 0.0, 0.0};
+      q0_ = identity;
+      q1_ = identity;
     }
 
     /**
@@ -425,20 +558,30 @@ private:
      */
     double duration_;
 
+    /**
+     * \brief The inverse of the duration.
+     */
+    double inverse_duration_;
+
     /**
      * \brief Coefficient omega.
      */
     double omega_;
 
+    /**
+     * \brief Coefficient k. I.e. 1/sin(omega).
+     */
+    double k_;
+
     /**
      * \brief Start quaternion.
      */
-    wrapper::Quaternion q0_;
+    math::Quaternion q0_;
 
     /**
      * \brief Goal quaternion.
      */
-    wrapper::Quaternion q1_;
+    math::Quaternion q1_;
 
     /**
      * \brief Flag indicating if linear interpolation should be used or not.
@@ -461,7 +604,11 @@ private:
     /**
      * \brief Default constructor.
      */
-    SoftRamp() : duration_(0.0), operation_(RampDown) {}
+    SoftRamp() : duration_(0.0), operation_(RampDown)
+    {
+      const math::Vector3 zero = {0.0, 0.0, 0.0};
+      start_angular_velocity_ = zero;
+    }
 
     /**
      * \brief Update the ramp's internal data fields.
@@ -515,7 +662,7 @@ private:
     /**
      * \brief A container for the starting angular velocity values.
      */
-    wrapper::Euler start_angular_velocity_;
+    math::Vector3 start_angular_velocity_;
 
     /**
      * \brief A container for the goal point.
@@ -524,19 +671,29 @@ private:
   };
 
   /**
-   * \brief Static constant for the max number of spline polynomials.
+   * \brief Copy evaluated spline values into the corresponding joint goal fields.
+   *
+   * \param p_output for storing the values (only the values already present in the output are updated).
+   * \param offset to the first value to copy, in the evaluated arrays.
+   * \param positions containing the evaluated positions.
+   * \param velocities containing the evaluated velocities.
+   * \param accelerations containing the evaluated accelerations.
    */
-  static const size_t MAX_NUMBER_OF_SPLINES_ = 12;
+  static void copySplineValues(wrapper::trajectory::JointGoal* p_output,
+                               const int offset,
+                               const double* positions,
+                               const double* velocities,
+                               const double* accelerations);
 
   /**
-   * \brief Offset in the spline polynomial array, to the external joint elements.
+   * \brief Offset in the spline polynomial block, to the external joint elements.
    */
   int offset_;
 
   /**
    * \brief Container for the spline interpolation polynomials.
    */
-  boost::array<SplinePolynomial, MAX_NUMBER_OF_SPLINES_> spline_polynomials_;
+  SplineBlock spline_block_;
 
   /**
    * \brief Container for the Slerp (for interpolating quaterions).
@@ -0,0 +1,249 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_JOINT_MAPPING_H
+#define EGM_JOINT_MAPPING_H
+
+#include "egm_wrapper.pb.h" // Generated by Google Protocol Buffer compiler protoc
+
+#include "egm_common.h"
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Class for mapping joint values between the robot controller and the interface, for a fixed axes
+ *        configuration.
+ *
+ * The number of joints are compile-time constants, which lets the compiler unroll and specialize the mappings
+ * (instead of branching on the axes configuration for every joint array of every message).
+ *
+ * The robot controller always uses six robot joints, so for a seven axes robot (e.g. IRB14000) the extra robot
+ * joint is transferred as the first external joint, while the interface presents it as the third robot joint.
+ */
+template <RobotAxes AXES>
+class JointMapping
+{
+public:
+  /**
+   * \brief The number of robot joints used by the interface.
+   */
+  static const int ROBOT_JOINTS = static_cast<int>(AXES);
+
+  /**
+   * \brief The number of robot joints used by the robot controller.
+   *
+   * Note: Constants::RobotController::DEFAULT_NUMBER_OF_ROBOT_JOINTS is not a compile-time constant.
+   */
+  static const int CONTROLLER_ROBOT_JOINTS = (AXES == None ? 0 : 6);
+
+  /**
+   * \brief The maximum number of external joints used by the robot controller.
+   *
+   * Note: Constants::RobotController::DEFAULT_NUMBER_OF_EXTERNAL_JOINTS is not a compile-time constant.
+   */
+  static const int CONTROLLER_EXTERNAL_JOINTS = 6;
+
+  /**
+   * \brief The number of the robot controller's external joints, which are robot joints in the interface.
+   */
+  static const int BORROWED_JOINTS = ROBOT_JOINTS - CONTROLLER_ROBOT_JOINTS;
+
+  /**
+   * \brief The interface's robot joint index, for the first borrowed joint.
+   */
+  static const int BORROWED_JOINTS_INDEX = 2;
+
+  /**
+   * \brief Parse joint values from the robot controller, into the interface's representation.
+   *
+   * \param p_target_robot for containing the parsed robot joint values.
+   * \param p_target_external for containing the parsed external joint values.
+   * \param p_robot containing the robot controller's robot joint values.
+   * \param robot_size specifying the number of the robot controller's robot joint values.
+   * \param p_external containing the robot controller's external joint values.
+   * \param external_size specifying the number of the robot controller's external joint values.
+   *
+   * \return bool indicating if the parsing was successful or not.
+   */
+  static bool parse(wrapper::Joints* p_target_robot,
+                    wrapper::Joints* p_target_external,
+                    const double* p_robot,
+                    const int robot_size,
+                    const double* p_external,
+                    const int external_size)
+  {
+    if (robot_size != CONTROLLER_ROBOT_JOINTS || external_size < BORROWED_JOINTS)
+    {
+      return false;
+    }
+
+    // Note: Resizing keeps the allocated capacity, and the values are then set in place.
+    p_target_robot->mutable_values()->Resize(ROBOT_JOINTS, 0.0);
+    double* p_robot_values = p_target_robot->mutable_values()->mutable_data();
+
+    for (int i = 0; i < ROBOT_JOINTS; ++i)
+    {
+      if (BORROWED_JOINTS > 0 && i >= BORROWED_JOINTS_INDEX && i < BORROWED_JOINTS_INDEX + BORROWED_JOINTS)
+      {
+        p_robot_values[i] = p_external[i - BORROWED_JOINTS_INDEX];
+      }
+      else
+      {
+        p_robot_values[i] = p_robot[i < BORROWED_JOINTS_INDEX ? i : i - BORROWED_JOINTS];
+      }
+    }
+
+    const int external_joints = external_size - BORROWED_JOINTS;
+    p_target_external->mutable_values()->Resize(external_joints, 0.0);
+    double* p_external_values = p_target_external->mutable_values()->mutable_data();
+
+    for (int i = 0; i < external_joints; ++i)
+    {
+      p_external_values[i] = p_external[BORROWED_JOINTS + i];
+    }
+
+    return true;
+  }
+
+  /**
+   * \brief Map joint values from the interface's representation, into the robot controller's representation.
+   *
+   * Note: External joint values, exceeding what the robot controller supports, are ignored.
+   *
+   * \param p_robot_values for containing the mapped robot joint values.
+   * \param p_robot_size for containing the number of mapped robot joint values.
+   * \param p_external_values for containing the mapped external joint values.
+   * \param p_external_size for containing the number of mapped external joint values.
+   * \param robot containing the robot joint values to map.
+   * \param external containing the external joint values to map.
+   *
+   * \return bool indicating if the mapping was successful or not.
+   */
+  static bool map(double* p_robot_values,
+                  int* p_robot_size,
+                  double* p_external_values,
+                  int* p_external_size,
+                  const wrapper::Joints& robot,
+                  const wrapper::Joints& external)
+  {
+    *p_robot_size = 0;
+    *p_external_size = 0;
+
+    if (robot.values_size() != ROBOT_JOINTS)
+    {
+      return false;
+    }
+
+    const double* p_robot = robot.values().data();
+
+    for (int i = 0; i < CONTROLLER_ROBOT_JOINTS; ++i)
+    {
+      p_robot_values[i] = p_robot[i < BORROWED_JOINTS_INDEX ? i : i + BORROWED_JOINTS];
+    }
+
+    for (int i = 0; i < BORROWED_JOINTS; ++i)
+    {
+      p_external_values[i] = p_robot[BORROWED_JOINTS_INDEX + i];
+    }
+
+    int external_joints = external.values_size();
+
+    if (external_joints > CONTROLLER_EXTERNAL_JOINTS - BORROWED_JOINTS)
+    {
+      external_joints = CONTROLLER_EXTERNAL_JOINTS - BORROWED_JOINTS;
+    }
+
+    const double* p_external = external.values().data();
+
+    for (int i = 0; i < external_joints; ++i)
+    {
+      p_external_values[BORROWED_JOINTS + i] = p_external[i];
+    }
+
+    *p_robot_size = CONTROLLER_ROBOT_JOINTS;
+    *p_external_size = BORROWED_JOINTS + external_joints;
+
+    return true;
+  }
+};
+
+/**
+ * \brief Struct for the joint mappings of an axes configuration, which have been selected once (i.e. instead of
+ *        for every message).
+ */
+struct JointMapper
+{
+  /**
+   * \brief Type for a function parsing joint values from the robot controller.
+   */
+  typedef bool (*ParseFunction)(wrapper::Joints*, wrapper::Joints*, const double*, const int, const double*, const int);
+
+  /**
+   * \brief Type for a function mapping joint values to the robot controller.
+   */
+  typedef bool (*MapFunction)(double*, int*, double*, int*, const wrapper::Joints&, const wrapper::Joints&);
+
+  /**
+   * \brief A constructor.
+   *
+   * Note: Intentionally not explicit, so an axes configuration can be used where a mapper is expected.
+   *
+   * \param axes specifying the number of axes of the robot.
+   */
+  JointMapper(const RobotAxes axes = Six);
+
+  /**
+   * \brief The axes configuration, which the mappings have been selected for.
+   */
+  RobotAxes axes;
+
+  /**
+   * \brief The selected parse function.
+   */
+  ParseFunction parse;
+
+  /**
+   * \brief The selected map function.
+   */
+  MapFunction map;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_JOINT_MAPPING_H
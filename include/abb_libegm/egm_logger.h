@@ -39,14 +39,85 @@
 
 #include <fstream>
 
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/thread.hpp>
+
 #include "abb_libegm_export.h"
 
 #include "egm_wrapper.pb.h" // Generated by Google Protocol Buffer compiler protoc
 
+#include "egm_ring_buffer.h"
+
 namespace abb
 {
 namespace egm
 {
+/**
+ * \brief Struct for a fixed-size log record, containing the same data as one row in a CSV log.
+ *
+ * The values are ordered according to the default CSV headers, i.e. for each of the robot feedback, the robot planned
+ * and the sensor references sections:
+ * - 12 joint positions (robot joints padded to 6 values, followed by external joints up to 12 values in total).
+ * - 12 joint velocities (same layout as the joint positions).
+ * - Cartesian position (x, y, z), Euler angles (x, y, z) and quaternion (u0, u1, u2, u3).
+ * - Cartesian linear velocity (x, y, z) and angular velocity (x, y, z).
+ */
+struct EGMLogRecord
+{
+  /**
+   * \brief Number of joint values in each joint block.
+   */
+  static const size_t NUMBER_OF_JOINT_VALUES = 12;
+
+  /**
+   * \brief Number of values in each section (i.e. feedback, planned and references).
+   */
+  static const size_t SECTION_SIZE = 2*NUMBER_OF_JOINT_VALUES + 10 + 6;
+
+  /**
+   * \brief Total number of values in a record (excluding the time stamp).
+   */
+  static const size_t NUMBER_OF_VALUES = 3*SECTION_SIZE;
+
+  /**
+   * \brief Size [bytes] of a serialized record (i.e. the time stamp followed by the values, without any padding).
+   */
+  static const size_t SERIALIZED_SIZE = 4 + 8*NUMBER_OF_VALUES;
+
+  /**
+   * \brief The header's time stamp [ms].
+   */
+  boost::uint32_t time_stamp;
+
+  /**
+   * \brief The logged values.
+   */
+  double values[NUMBER_OF_VALUES];
+
+  /**
+   * \brief Copy inputs and outputs into the record (i.e. into the feedback, planned and references sections).
+   *
+   * \param inputs containing the inputs from the robot controller.
+   * \param outputs containing the outputs to the robot controller.
+   */
+  void set(const wrapper::Input& inputs, const wrapper::Output& outputs);
+
+  /**
+   * \brief Serialize the record, field by field in little-endian byte order (i.e. independent of the platform).
+   *
+   * \param p_bytes for containing the serialized record (SERIALIZED_SIZE bytes).
+   */
+  void serialize(char* p_bytes) const;
+
+  /**
+   * \brief Parse a record serialized with the serialize method.
+   *
+   * \param p_bytes containing the serialized record (SERIALIZED_SIZE bytes).
+   */
+  void parse(const char* p_bytes);
+};
+
 /**
  * \brief Class for logging EGM messages into CSV formatted file.
  */
@@ -101,6 +172,13 @@ public:
    */
   void add(const wrapper::CartesianVelocity& velocity, const bool last = false);
 
+  /**
+   * \brief Add a complete log record to the log stream, and flush the stream object.
+   *
+   * \param record containing the record to add.
+   */
+  void add(const EGMLogRecord& record);
+
   /**
    * \brief Calculate the amount of time logged.
    *
@@ -131,6 +209,180 @@ private:
   std::ofstream log_stream_;
 };
 
+/**
+ * \brief Class for asynchronous logging of EGM messages into a binary file.
+ *
+ * The class provides behavior for:
+ * - Copying inputs and outputs into fixed-size records, directly in the slots of a lock-free
+ *   single-producer/single-consumer ring buffer. This is the only work done in the calling thread
+ *   (i.e. the UDP server's callback thread).
+ * - Draining the ring buffer in a background thread, and writing the records to disk in batches.
+ * - Converting a binary log into a CSV formatted file (with the same layout as the EGMLogger class), offline.
+ *
+ * Note: Records are dropped (and counted) if the ring buffer is full, the calling thread never waits for disk I/O.
+ *       They are also dropped if the log file could not be opened, or if writing to it has failed (see isOpen).
+ */
+class EGMAsyncLogger
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param filename specifying the log's filename.
+   * \param capacity specifying the ring buffer's capacity (i.e. max number of records waiting to be written).
+   */
+  EGMAsyncLogger(const std::string& filename, const size_t capacity = DEFAULT_CAPACITY);
+
+  /**
+   * \brief A destructor.
+   *
+   * Note: Any records remaining in the ring buffer are written to the log before the log is closed.
+   */
+  ~EGMAsyncLogger();
+
+  /**
+   * \brief Check if the log file is open, i.e. if it was opened successfully and all writes to it have succeeded.
+   *
+   * \return bool indicating if the log file is open.
+   */
+  bool isOpen() const;
+
+  /**
+   * \brief Add inputs and outputs to the log, as one record.
+   *
+   * \param inputs containing the inputs from the robot controller.
+   * \param outputs containing the outputs to the robot controller.
+   *
+   * \return bool indicating if the record was accepted or not (e.g. false if the ring buffer was full).
+   */
+  bool add(const wrapper::Input& inputs, const wrapper::Output& outputs);
+
+  /**
+   * \brief Calculate the amount of time logged.
+   *
+   * \param sample_time specifying the sample time.
+   *
+   * \return double for the time logged.
+   */
+  double calculateTimeLogged(const double sample_time);
+
+  /**
+   * \brief Retrieve the number of records that have been dropped (e.g. due to a full ring buffer).
+   *
+   * \return unsigned int containing the number of dropped records.
+   */
+  unsigned int numberOfDroppedRecords() const { return number_of_dropped_records_; };
+
+  /**
+   * \brief Convert a binary log into a CSV formatted file.
+   *
+   * \param binary_filename specifying the binary log's filename.
+   * \param csv_filename specifying the CSV log's filename.
+   *
+   * \return bool indicating if the conversion was successful or not.
+   */
+  static bool convertToCSV(const std::string& binary_filename, const std::string& csv_filename);
+
+  /**
+   * \brief Default ring buffer capacity (i.e. approximately 16 seconds of data at 250 Hz).
+   */
+  static const size_t DEFAULT_CAPACITY = 4096;
+
+private:
+  /**
+   * \brief Struct for the binary log's file header (serialized in little-endian byte order, without any padding).
+   */
+  struct FileHeader
+  {
+    /**
+     * \brief Size [bytes] of a serialized file header.
+     */
+    static const size_t SERIALIZED_SIZE = 16;
+
+    /**
+     * \brief Identifier of the file format.
+     */
+    char magic[8];
+
+    /**
+     * \brief Size [bytes] of each record.
+     */
+    boost::uint32_t record_size;
+
+    /**
+     * \brief Number of values in each record.
+     */
+    boost::uint32_t number_of_values;
+  };
+
+  /**
+   * \brief Write function for the background thread, which drains the ring buffer into the log file.
+   */
+  void writerThread();
+
+  /**
+   * \brief Write a record to the log file (or drop it, if writing has failed).
+   *
+   * \param record containing the record to write.
+   */
+  void writeRecord(const EGMLogRecord& record);
+
+  /**
+   * \brief Flush the log file's stream object.
+   */
+  void flushLog();
+
+  /**
+   * \brief Static constant for the binary log's file format identifier.
+   */
+  static const char MAGIC[8];
+
+  /**
+   * \brief Static constant for the max number of records written in one batch.
+   */
+  static const size_t BATCH_SIZE = 64;
+
+  /**
+   * \brief Static constant for the background thread's idle wait time [ms].
+   */
+  static const unsigned int IDLE_WAIT_TIME_MS = 10;
+
+  /**
+   * \brief The number of logged messages.
+   */
+  unsigned int number_of_logged_messages_;
+
+  /**
+   * \brief The number of dropped records.
+   */
+  boost::atomic<unsigned int> number_of_dropped_records_;
+
+  /**
+   * \brief Flag indicating if the background thread should stop.
+   */
+  boost::atomic<bool> stop_requested_;
+
+  /**
+   * \brief Flag indicating if writing to the log file has failed.
+   */
+  boost::atomic<bool> write_failed_;
+
+  /**
+   * \brief Ring buffer for records waiting to be written.
+   */
+  RingBuffer<EGMLogRecord> ring_buffer_;
+
+  /**
+   * \brief Stream object for logging data.
+   */
+  std::ofstream log_stream_;
+
+  /**
+   * \brief Background thread for writing records to the log.
+   */
+  boost::thread writer_thread_;
+};
+
 } // end namespace egm
 } // end namespace abb
 
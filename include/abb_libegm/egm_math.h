@@ -0,0 +1,310 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_MATH_H
+#define EGM_MATH_H
+
+#ifndef _USE_MATH_DEFINES
+#define _USE_MATH_DEFINES
+#endif
+
+#include <cmath>
+
+#include "egm_common.h"
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Fixed-size value types, and inlineable kernels, for the Cartesian math.
+ *
+ * The types are plain old data (i.e. no protobuf objects), so the kernels can operate on registers directly, without
+ * any presence checks or setter calls. Conversions to and from the protobuf objects are only intended to be done at
+ * the message boundaries (see copy(...) in egm_common_auxiliary.h).
+ */
+namespace math
+{
+/**
+ * \brief Struct for a three dimensional vector (e.g. a position, or an angular velocity).
+ */
+struct Vector3
+{
+  double x; ///< \brief The x value.
+  double y; ///< \brief The y value.
+  double z; ///< \brief The z value.
+};
+
+/**
+ * \brief Type for ZYX Euler angles [deg] (i.e. with the same layout as a vector).
+ */
+typedef Vector3 Euler;
+
+/**
+ * \brief Struct for a quaternion.
+ */
+struct Quaternion
+{
+  double u0; ///< \brief The scalar part.
+  double u1; ///< \brief The first vector part.
+  double u2; ///< \brief The second vector part.
+  double u3; ///< \brief The third vector part.
+};
+
+/**
+ * \brief Multiply a quaternion with a factor.
+ *
+ * \param q for the quaternion.
+ * \param factor for the value to multiply with.
+ *
+ * \return Quaternion containing the result.
+ */
+inline Quaternion multiply(const Quaternion& q, const double factor)
+{
+  Quaternion result = {q.u0*factor, q.u1*factor, q.u2*factor, q.u3*factor};
+  return result;
+}
+
+/**
+ * \brief Multiply two quaternions (i.e. the Hamilton product).
+ *
+ * \param q1 for the first quaternion.
+ * \param q2 for the second quaternion.
+ *
+ * \return Quaternion containing the result.
+ */
+inline Quaternion multiply(const Quaternion& q1, const Quaternion& q2)
+{
+  Quaternion result = {q1.u0*q2.u0 - q1.u1*q2.u1 - q1.u2*q2.u2 - q1.u3*q2.u3,
+                       q1.u0*q2.u1 + q1.u1*q2.u0 + q1.u2*q2.u3 - q1.u3*q2.u2,
+                       q1.u0*q2.u2 + q1.u2*q2.u0 + q1.u3*q2.u1 - q1.u1*q2.u3,
+                       q1.u0*q2.u3 + q1.u3*q2.u0 + q1.u1*q2.u2 - q1.u2*q2.u1};
+  return result;
+}
+
+/**
+ * \brief Calculate the dot product of two quaternions.
+ *
+ * \param q1 for the first quaternion.
+ * \param q2 for the second quaternion.
+ *
+ * \return double containing the dot product.
+ */
+inline double dotProduct(const Quaternion& q1, const Quaternion& q2)
+{
+  return q1.u0*q2.u0 + q1.u1*q2.u1 + q1.u2*q2.u2 + q1.u3*q2.u3;
+}
+
+/**
+ * \brief Calculate the Euclidean norm of a quaternion.
+ *
+ * \param q for the quaternion.
+ *
+ * \return double containing the norm.
+ */
+inline double euclideanNorm(const Quaternion& q)
+{
+  return std::sqrt(dotProduct(q, q));
+}
+
+/**
+ * \brief Normalize a quaternion (unless its norm is zero).
+ *
+ * \param q for the quaternion.
+ *
+ * \return Quaternion containing the normalized quaternion.
+ */
+inline Quaternion normalize(const Quaternion& q)
+{
+  const double norm = euclideanNorm(q);
+
+  if (norm == 0.0)
+  {
+    return q;
+  }
+
+  Quaternion result = {q.u0 / norm, q.u1 / norm, q.u2 / norm, q.u3 / norm};
+  return result;
+}
+
+/**
+ * \brief Calculate the conjugate of a quaternion.
+ *
+ * \param q for the quaternion.
+ *
+ * \return Quaternion containing the conjugate.
+ */
+inline Quaternion conjugate(const Quaternion& q)
+{
+  Quaternion result = {q.u0, -q.u1, -q.u2, -q.u3};
+  return result;
+}
+
+/**
+ * \brief Convert ZYX Euler angles to a (normalized) quaternion.
+ *
+ * See for example https://en.wikipedia.org/wiki/Conversion_between_quaternions_and_Euler_angles for the equations.
+ *
+ * \param e for the ZYX Euler angles [deg] to convert.
+ *
+ * \return Quaternion containing the result.
+ */
+inline Quaternion toQuaternion(const Euler& e)
+{
+  const double x = e.x*Constants::Conversion::DEG_TO_RAD;
+  const double y = e.y*Constants::Conversion::DEG_TO_RAD;
+  const double z = e.z*Constants::Conversion::DEG_TO_RAD;
+
+  const double cx = std::cos(0.5*x);
+  const double sx = std::sin(0.5*x);
+  const double cy = std::cos(0.5*y);
+  const double sy = std::sin(0.5*y);
+  const double cz = std::cos(0.5*z);
+  const double sz = std::sin(0.5*z);
+
+  Quaternion result = {sx*sy*sz + cx*cy*cz,
+                       -cx*sy*sz + sx*cy*cz,
+                       sx*cy*sz + cx*sy*cz,
+                       cx*cy*sz - sx*sy*cz};
+
+  return normalize(result);
+}
+
+/**
+ * \brief Convert a quaternion to ZYX Euler angles.
+ *
+ * See for example https://en.wikipedia.org/wiki/Conversion_between_quaternions_and_Euler_angles for the equations.
+ *
+ * Singularities are handled, see for example
+ * http://www.euclideanspace.com/maths/geometry/rotations/conversions/quaternionToEuler/index.htm
+ * for indications of how to derive the equations.
+ *
+ * \param q for the quaternion to convert (should have a non-zero norm).
+ *
+ * \return Euler containing the ZYX Euler angles [deg].
+ */
+inline Euler toEuler(const Quaternion& q)
+{
+  const double SINGULARITY_THRESHOLD = 0.000001;
+
+  double x = 0.0;
+  double y = 0.0;
+  double z = 0.0;
+
+  const double singularity_check = q.u0*q.u2 - q.u1*q.u3;
+
+  // Check for singularity (i.e. when y is close to +- 90 degrees).
+  // This occur when the argument of y = sin(2*(u0*u2 - u1*u3)) is close to 1.0 -> u0*u2 - u1*u3 = 0.5.
+  if (std::abs(singularity_check - 0.5) <= SINGULARITY_THRESHOLD)
+  {
+    // Y is close to 90 degrees.
+    x = 2.0*std::atan2(q.u1, q.u0);
+    y = M_PI_2;
+  }
+  else if (std::abs(singularity_check + 0.5) <= SINGULARITY_THRESHOLD)
+  {
+    // Y is close to -90 degrees.
+    x = 2.0*std::atan2(q.u1, q.u0);
+    y = -M_PI_2;
+  }
+  else
+  {
+    x = std::atan2(2.0*(q.u0*q.u1 + q.u2*q.u3), 1.0 - 2.0*(q.u1*q.u1 + q.u2*q.u2));
+    y = std::asin(2.0*(q.u0*q.u2 - q.u1*q.u3));
+    z = std::atan2(2.0*(q.u0*q.u3 + q.u1*q.u2), 1.0 - 2.0*(q.u2*q.u2 + q.u3*q.u3));
+  }
+
+  Euler result = {x*Constants::Conversion::RAD_TO_DEG,
+                  y*Constants::Conversion::RAD_TO_DEG,
+                  z*Constants::Conversion::RAD_TO_DEG};
+  return result;
+}
+
+/**
+ * \brief Calculate a quaternion's derivate, from an angular velocity.
+ *
+ * I.e. dq = 0.5*(0, av)*q.
+ *
+ * \param q for the quaternion.
+ * \param av for the angular velocity [deg/s].
+ *
+ * \return Quaternion containing the derivate.
+ */
+inline Quaternion derivate(const Quaternion& q, const Vector3& av)
+{
+  const Quaternion temp = {0.0,
+                           av.x*Constants::Conversion::DEG_TO_RAD,
+                           av.y*Constants::Conversion::DEG_TO_RAD,
+                           av.z*Constants::Conversion::DEG_TO_RAD};
+  return multiply(multiply(temp, q), 0.5);
+}
+
+/**
+ * \brief Estimate the angular velocity between two orientations.
+ *
+ * See for example https://en.wikipedia.org/wiki/Rotation_formalisms_in_three_dimensions for equations.
+ *
+ * Note: Only valid for orientations, for the same object, at two points close in time.
+ *       Also assumes constant angular velocity between the points.
+ *
+ * \param current for the current orientation.
+ * \param previous for the previous orientation.
+ * \param sample_time for the time [s] between the orientations (should be larger than zero).
+ *
+ * \return Vector3 containing the estimated angular velocity [deg/s].
+ */
+inline Vector3 estimateAngularVelocity(const Quaternion& current,
+                                       const Quaternion& previous,
+                                       const double sample_time)
+{
+  // I.e. (2*(q2 - q1) / T)*conj(q1), of which only the vector part is needed.
+  const double a = 2.0*(current.u0 - previous.u0) / sample_time;
+  const double b = 2.0*(current.u1 - previous.u1) / sample_time;
+  const double c = 2.0*(current.u2 - previous.u2) / sample_time;
+  const double d = 2.0*(current.u3 - previous.u3) / sample_time;
+  const Quaternion r = conjugate(previous);
+
+  Vector3 result = {(a*r.u1 + b*r.u0 + c*r.u3 - d*r.u2)*Constants::Conversion::RAD_TO_DEG,
+                    (a*r.u2 - b*r.u3 + c*r.u0 + d*r.u1)*Constants::Conversion::RAD_TO_DEG,
+                    (a*r.u3 + b*r.u2 - c*r.u1 + d*r.u0)*Constants::Conversion::RAD_TO_DEG};
+  return result;
+}
+
+} // end namespace math
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_MATH_H
@@ -0,0 +1,300 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_OUTPUT_EXTRAPOLATOR_H
+#define EGM_OUTPUT_EXTRAPOLATOR_H
+
+#include <boost/cstdint.hpp>
+
+#include "egm_wrapper.pb.h"            // Generated by Google Protocol Buffer compiler protoc
+#include "egm_wrapper_trajectory.pb.h" // Generated by Google Protocol Buffer compiler protoc
+
+#include "egm_interpolator.h"
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Struct for containing counters of missed messages and extrapolated outputs.
+ */
+struct ExtrapolationStatistics
+{
+  /**
+   * \brief Default constructor.
+   */
+  ExtrapolationStatistics()
+  :
+  number_of_missed_messages(0),
+  number_of_late_outputs(0),
+  number_of_extrapolated_outputs(0),
+  number_of_held_outputs(0)
+  {}
+
+  /**
+   * \brief Number of messages never received (derived from gaps in the header sequence numbers).
+   */
+  boost::uint64_t number_of_missed_messages;
+
+  /**
+   * \brief Number of messages where no new outputs were available (e.g. the external control loop was late).
+   */
+  boost::uint64_t number_of_late_outputs;
+
+  /**
+   * \brief Number of late outputs that were extrapolated (i.e. within the extrapolation duration).
+   */
+  boost::uint64_t number_of_extrapolated_outputs;
+
+  /**
+   * \brief Number of late outputs that were held at the extrapolation's end point (i.e. beyond the duration).
+   */
+  boost::uint64_t number_of_held_outputs;
+};
+
+/**
+ * \brief Class for extrapolating outputs, when no new outputs are available in time (e.g. from an external control
+ *        loop).
+ *
+ * The velocities and accelerations of the most recent new outputs are estimated from the positions of consecutive
+ * new outputs (with the elapsed time derived from the header sequence numbers). Velocity outputs are not used as the
+ * basis for the extrapolation, but they are overwritten with extrapolated values.
+ *
+ * When outputs are late, a quintic spline is used to continue from the most recent new outputs, with the same
+ * velocities and accelerations, and to come to a smooth stop at the end of the extrapolation duration. The elapsed
+ * time (since the most recent new outputs) also accounts for missed messages.
+ *
+ * Extrapolated values: Robot joints, external joints and the Cartesian position (i.e. the orientation is held).
+ */
+class EGMOutputExtrapolator
+{
+public:
+  /**
+   * \brief Default constructor.
+   */
+  EGMOutputExtrapolator();
+
+  /**
+   * \brief Reset the extrapolator for a new communication session (the statistics are kept).
+   */
+  void reset();
+
+  /**
+   * \brief Update the extrapolator with new outputs.
+   *
+   * \param outputs containing the new outputs.
+   * \param sequence_number containing the sequence number of the message that the outputs are a reply to.
+   * \param sample_time specifying the estimated sample time [s].
+   */
+  void update(const wrapper::Output& outputs, const unsigned int sequence_number, const double sample_time);
+
+  /**
+   * \brief Extrapolate late outputs, from the most recent new outputs.
+   *
+   * \param p_outputs for containing the extrapolated outputs (values that have changed layout are kept).
+   * \param sequence_number containing the sequence number of the message that the outputs are a reply to.
+   * \param sample_time specifying the estimated sample time [s].
+   * \param duration specifying the extrapolation duration [s] (i.e. until the outputs have come to a stop).
+   *
+   * \return bool indicating if the outputs were extrapolated or not (e.g. false if no new outputs have been given).
+   */
+  bool extrapolate(wrapper::Output* p_outputs,
+                   const unsigned int sequence_number,
+                   const double sample_time,
+                   const double duration);
+
+  /**
+   * \brief Retrieve the extrapolation statistics.
+   *
+   * \return const ExtrapolationStatistics& containing the statistics.
+   */
+  const ExtrapolationStatistics& getStatistics() const
+  {
+    return statistics_;
+  }
+
+private:
+  /**
+   * \brief Count any missed messages, and calculate the time elapsed since the most recent new outputs.
+   *
+   * \param sequence_number containing the current sequence number.
+   * \param sample_time specifying the estimated sample time [s].
+   *
+   * \return double containing the elapsed time [s].
+   */
+  double updateSequence(const unsigned int sequence_number, const double sample_time);
+
+  /**
+   * \brief Update a reference with new joint outputs (i.e. positions, velocities and accelerations).
+   *
+   * \param p_reference for containing the reference.
+   * \param outputs containing the new joint outputs.
+   * \param dt specifying the time [s] since the previous new outputs (zero if there are no previous outputs).
+   */
+  static void updateReference(wrapper::trajectory::JointGoal* p_reference,
+                              const wrapper::JointSpace& outputs,
+                              const double dt);
+
+  /**
+   * \brief Update a reference with new Cartesian outputs (i.e. positions, velocities and accelerations).
+   *
+   * \param p_reference for containing the reference.
+   * \param outputs containing the new Cartesian outputs.
+   * \param dt specifying the time [s] since the previous new outputs (zero if there are no previous outputs).
+   */
+  static void updateReference(wrapper::trajectory::CartesianGoal* p_reference,
+                              const wrapper::CartesianSpace& outputs,
+                              const double dt);
+
+  /**
+   * \brief Set up the extrapolation goal for a joint reference (i.e. a smooth stop at the end of the duration).
+   *
+   * \param p_goal for containing the goal.
+   * \param reference containing the reference.
+   * \param duration specifying the extrapolation duration [s].
+   */
+  static void setupGoal(wrapper::trajectory::JointGoal* p_goal,
+                        const wrapper::trajectory::JointGoal& reference,
+                        const double duration);
+
+  /**
+   * \brief Set up the extrapolation goal for a Cartesian reference (i.e. a smooth stop at the end of the duration).
+   *
+   * \param p_goal for containing the goal.
+   * \param reference containing the reference.
+   * \param duration specifying the extrapolation duration [s].
+   */
+  static void setupGoal(wrapper::trajectory::CartesianGoal* p_goal,
+                        const wrapper::trajectory::CartesianGoal& reference,
+                        const double duration);
+
+  /**
+   * \brief Copy extrapolated joint values into joint outputs (if the layouts are the same).
+   *
+   * \param p_outputs for containing the joint outputs.
+   * \param reference containing the joint reference (i.e. specifying the layout).
+   * \param offset to the joint values in the extrapolated arrays.
+   * \param p_positions containing the extrapolated positions.
+   * \param p_velocities containing the extrapolated velocities.
+   */
+  static void copyExtrapolated(wrapper::JointSpace* p_outputs,
+                               const wrapper::trajectory::JointGoal& reference,
+                               const int offset,
+                               const double* p_positions,
+                               const double* p_velocities);
+
+  /**
+   * \brief Copy extrapolated Cartesian values into Cartesian outputs (if the outputs have a position).
+   *
+   * \param p_outputs for containing the Cartesian outputs.
+   * \param p_positions containing the extrapolated x, y and z positions.
+   * \param p_velocities containing the extrapolated x, y and z velocities.
+   */
+  static void copyExtrapolated(wrapper::CartesianSpace* p_outputs,
+                               const double* p_positions,
+                               const double* p_velocities);
+
+  /**
+   * \brief Flag indicating if a reference (i.e. new outputs) is available.
+   */
+  bool has_reference_;
+
+  /**
+   * \brief Flag indicating if the interpolators have been set up for the current reference.
+   */
+  bool has_extrapolation_;
+
+  /**
+   * \brief Flag indicating if a sequence number has been received in the current communication session.
+   */
+  bool has_sequence_number_;
+
+  /**
+   * \brief The most recently received sequence number.
+   */
+  unsigned int sequence_number_;
+
+  /**
+   * \brief The sequence number of the most recent new outputs.
+   */
+  unsigned int reference_sequence_number_;
+
+  /**
+   * \brief The extrapolation duration [s] that the interpolators have been set up for.
+   */
+  double duration_;
+
+  /**
+   * \brief The joint reference (i.e. the most recent new robot and external joint outputs, with velocities and
+   *        accelerations).
+   */
+  wrapper::trajectory::PointGoal joint_reference_;
+
+  /**
+   * \brief The joint extrapolation goal.
+   */
+  wrapper::trajectory::PointGoal joint_goal_;
+
+  /**
+   * \brief The Cartesian reference (i.e. the most recent new Cartesian outputs, with velocities and accelerations).
+   */
+  wrapper::trajectory::PointGoal pose_reference_;
+
+  /**
+   * \brief The Cartesian extrapolation goal.
+   */
+  wrapper::trajectory::PointGoal pose_goal_;
+
+  /**
+   * \brief Interpolator for the robot and external joints.
+   */
+  EGMInterpolator joint_interpolator_;
+
+  /**
+   * \brief Interpolator for the Cartesian position.
+   */
+  EGMInterpolator pose_interpolator_;
+
+  /**
+   * \brief The extrapolation statistics.
+   */
+  ExtrapolationStatistics statistics_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_OUTPUT_EXTRAPOLATOR_H
@@ -0,0 +1,129 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_REALTIME_ALLOCATION_HOOKS_H
+#define EGM_REALTIME_ALLOCATION_HOOKS_H
+
+/*
+ * Replacements of the global allocation functions, which report each allocation to the real-time checker.
+ *
+ * Note: Include this header in exactly one translation unit of an application (that does not replace the global
+ *       allocation functions itself), and build the library with the ABB_LIBEGM_RT_CHECKS option. Applications with
+ *       their own replacements should instead call EGMRealTimeChecker::recordAllocation from them.
+ */
+
+#include "abb_libegm_config.h"
+
+#ifdef ABB_LIBEGM_RT_CHECKS
+#include <cstdlib>
+#include <new>
+
+#include "egm_realtime_checker.h"
+
+#if __cplusplus >= 201103L
+#define ABB_LIBEGM_THROW_BAD_ALLOC
+#define ABB_LIBEGM_NO_THROW noexcept
+#else
+#define ABB_LIBEGM_THROW_BAD_ALLOC throw(std::bad_alloc)
+#define ABB_LIBEGM_NO_THROW throw()
+#endif
+
+void* operator new(std::size_t size) ABB_LIBEGM_THROW_BAD_ALLOC
+{
+  abb::egm::EGMRealTimeChecker::recordAllocation();
+
+  void* p = std::malloc(size > 0 ? size : 1);
+
+  if (!p)
+  {
+    throw std::bad_alloc();
+  }
+
+  return p;
+}
+
+void* operator new[](std::size_t size) ABB_LIBEGM_THROW_BAD_ALLOC
+{
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) ABB_LIBEGM_NO_THROW
+{
+  abb::egm::EGMRealTimeChecker::recordAllocation();
+
+  return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& nothrow) ABB_LIBEGM_NO_THROW
+{
+  return operator new(size, nothrow);
+}
+
+void operator delete(void* p) ABB_LIBEGM_NO_THROW
+{
+  std::free(p);
+}
+
+void operator delete[](void* p) ABB_LIBEGM_NO_THROW
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) ABB_LIBEGM_NO_THROW
+{
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) ABB_LIBEGM_NO_THROW
+{
+  std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) ABB_LIBEGM_NO_THROW
+{
+  std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) ABB_LIBEGM_NO_THROW
+{
+  std::free(p);
+}
+
+#undef ABB_LIBEGM_THROW_BAD_ALLOC
+#undef ABB_LIBEGM_NO_THROW
+#endif // ABB_LIBEGM_RT_CHECKS
+
+#endif // EGM_REALTIME_ALLOCATION_HOOKS_H
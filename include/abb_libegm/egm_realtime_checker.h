@@ -0,0 +1,327 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_REALTIME_CHECKER_H
+#define EGM_REALTIME_CHECKER_H
+
+#include <boost/chrono.hpp>
+
+#include "abb_libegm_config.h"
+
+#include "egm_seqlock.h"
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Struct for containing a real-time safety report, for the sections (e.g. callbacks) checked by a checker.
+ *
+ * Note: Only the sections after the warm-up sections (e.g. where the message containers allocate their initial
+ *       capacity) are included, and a section that allocated memory or waited for a lock counts as a violation.
+ */
+struct RealTimeReport
+{
+  /**
+   * \brief Default constructor.
+   */
+  RealTimeReport()
+  :
+  number_of_sections(0),
+  number_of_violations(0),
+  number_of_allocations(0),
+  max_allocations(0),
+  number_of_lock_waits(0),
+  max_lock_wait(0.0),
+  max_duration(0.0),
+  last_duration(0.0)
+  {}
+
+  /**
+   * \brief Number of checked sections.
+   */
+  unsigned int number_of_sections;
+
+  /**
+   * \brief Number of sections that allocated memory, or waited for a lock.
+   */
+  unsigned int number_of_violations;
+
+  /**
+   * \brief Total number of memory allocations in the sections.
+   */
+  unsigned int number_of_allocations;
+
+  /**
+   * \brief Max number of memory allocations in one section.
+   */
+  unsigned int max_allocations;
+
+  /**
+   * \brief Total number of lock acquisitions (in the sections) that had to wait for another thread.
+   */
+  unsigned int number_of_lock_waits;
+
+  /**
+   * \brief Longest wait [s] for a lock, in the sections.
+   */
+  double max_lock_wait;
+
+  /**
+   * \brief Longest duration [s] of a section (i.e. the worst-case duration).
+   */
+  double max_duration;
+
+  /**
+   * \brief Duration [s] of the most recent section.
+   */
+  double last_duration;
+};
+
+/**
+ * \brief Class for checking that real-time sections (e.g. the EGM callbacks) do not allocate memory or wait for locks.
+ *
+ * The class provides behavior for:
+ * - Counting the memory allocations made by a thread inside a section, via the application's replaced global
+ *   operator new (which also covers the Google Protocol Buffer messages' heap use). The replacement should call
+ *   recordAllocation, and egm_realtime_allocation_hooks.h provides a ready-made one.
+ * - Timing the lock acquisitions (done via RealTimeLockGuard) that have to wait for another thread.
+ * - Tracking the sections' worst-case durations, and publishing a report that other threads can retrieve without
+ *   blocking the checked thread.
+ * - Aborting, with a message, on the first violation (if built with the ABB_LIBEGM_RT_CHECKS_ABORT option).
+ *
+ * Note: Only active if the library is built with the ABB_LIBEGM_RT_CHECKS option (intended for debug builds), which
+ *       is recorded in the generated abb_libegm_config.h header. Otherwise, the checks compile to nothing. The
+ *       library never replaces the global allocation functions itself, so that it does not conflict with an
+ *       application's (or a benchmark's) own replacements.
+ */
+class EGMRealTimeChecker
+{
+public:
+  /**
+   * \brief Default constructor.
+   */
+  EGMRealTimeChecker();
+
+  /**
+   * \brief Begin a section, in the calling thread.
+   *
+   * Note: Sections can be nested, and only the outermost section is checked.
+   */
+  void beginSection();
+
+  /**
+   * \brief End a section, in the calling thread (and publish the updated report).
+   */
+  void endSection();
+
+  /**
+   * \brief Retrieve the latest published report (can be called from any thread).
+   *
+   * \param p_report for containing the report.
+   *
+   * \return bool indicating if the report was retrieved (false if the checks are disabled, if no report has been
+   *         published yet, or if the attempt overlapped with a publication, in which case it can simply be retried).
+   */
+  bool retrieveReport(RealTimeReport* p_report) const;
+
+  /**
+   * \brief Check if the real-time checks have been built into the library.
+   *
+   * \return bool indicating if the checks are enabled or not.
+   */
+  static bool isEnabled();
+
+  /**
+   * \brief Record a memory allocation, in the calling thread.
+   *
+   * Note: Intended to be called from the application's replaced global operator new. Ignored if the calling thread is
+   *       not inside a section.
+   */
+  static void recordAllocation();
+
+  /**
+   * \brief Check if any memory allocation has been recorded, i.e. if the allocation hooks appear to be installed.
+   *
+   * Note: If not, then the reports' allocation counts are always zero.
+   *
+   * \return bool indicating if allocations have been recorded or not (always false if the checks are disabled).
+   */
+  static bool hasAllocationHooks();
+
+  /**
+   * \brief Record a lock acquisition (in the calling thread) that had to wait for another thread.
+   *
+   * Note: Ignored if the calling thread is not inside a section.
+   *
+   * \param wait_time specifying the time [s] spent waiting for the lock.
+   */
+  static void recordLockWait(const double wait_time);
+
+  /**
+   * \brief Static constant for the number of initial sections, which are not checked for violations.
+   */
+  static const unsigned int WARM_UP_SECTIONS = 50;
+
+private:
+  /**
+   * \brief The report (only accessed by the checked thread).
+   */
+  RealTimeReport report_;
+
+  /**
+   * \brief The published reports.
+   */
+  SeqLock<RealTimeReport> reports_;
+
+  /**
+   * \brief The number of ended sections (including the warm-up sections).
+   */
+  unsigned int number_of_ended_sections_;
+
+  /**
+   * \brief Start time of the current section.
+   */
+  boost::chrono::steady_clock::time_point start_time_;
+};
+
+/**
+ * \brief Class for checking a scope as a real-time section (e.g. an EGM callback).
+ */
+class ScopedRealTimeSection
+{
+public:
+  /**
+   * \brief A constructor, which begins the section.
+   *
+   * \param checker for checking the section.
+   */
+  explicit ScopedRealTimeSection(EGMRealTimeChecker& checker)
+  :
+  checker_(checker)
+  {
+#ifdef ABB_LIBEGM_RT_CHECKS
+    checker_.beginSection();
+#endif
+  }
+
+  /**
+   * \brief A destructor, which ends the section.
+   */
+  ~ScopedRealTimeSection()
+  {
+#ifdef ABB_LIBEGM_RT_CHECKS
+    checker_.endSection();
+#endif
+  }
+
+private:
+  /**
+   * \brief Copy constructor (not allowed).
+   */
+  ScopedRealTimeSection(const ScopedRealTimeSection&);
+
+  /**
+   * \brief Copy assignment (not allowed).
+   */
+  ScopedRealTimeSection& operator=(const ScopedRealTimeSection&);
+
+  /**
+   * \brief The section's checker.
+   */
+  EGMRealTimeChecker& checker_;
+};
+
+/**
+ * \brief Class for a scoped lock, which records the acquisitions that have to wait for another thread.
+ *
+ * Note: Behaves as boost::lock_guard, if the real-time checks are disabled.
+ */
+template <typename Mutex>
+class RealTimeLockGuard
+{
+public:
+  /**
+   * \brief A constructor, which locks the mutex.
+   *
+   * \param mutex to lock.
+   */
+  explicit RealTimeLockGuard(Mutex& mutex)
+  :
+  mutex_(mutex)
+  {
+#ifdef ABB_LIBEGM_RT_CHECKS
+    if (!mutex_.try_lock())
+    {
+      const boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+      mutex_.lock();
+      EGMRealTimeChecker::recordLockWait(
+        boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count());
+    }
+#else
+    mutex_.lock();
+#endif
+  }
+
+  /**
+   * \brief A destructor, which unlocks the mutex.
+   */
+  ~RealTimeLockGuard()
+  {
+    mutex_.unlock();
+  }
+
+private:
+  /**
+   * \brief Copy constructor (not allowed).
+   */
+  RealTimeLockGuard(const RealTimeLockGuard&);
+
+  /**
+   * \brief Copy assignment (not allowed).
+   */
+  RealTimeLockGuard& operator=(const RealTimeLockGuard&);
+
+  /**
+   * \brief The locked mutex.
+   */
+  Mutex& mutex_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_REALTIME_CHECKER_H
@@ -0,0 +1,249 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_RING_BUFFER_H
+#define EGM_RING_BUFFER_H
+
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Class for a bounded lock-free ring buffer, for passing items from one producer thread to one consumer thread.
+ *
+ * The producer fills the next free slot in place and publishes it, while the consumer processes the oldest published
+ * slot in place and releases it. Neither side ever waits for the other, the producer is simply refused a slot when the
+ * ring buffer is full.
+ *
+ * Note: Only one producer thread and one consumer thread are supported. The slots are reused, so objects that retain
+ *       their storage between assignments (e.g. Protocol Buffers messages) don't allocate once warmed up. This also
+ *       allows the consumer to swap out a slot's content, instead of copying it.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param capacity specifying the max number of items the ring buffer can hold.
+   */
+  explicit RingBuffer(const size_t capacity)
+  :
+  slots_(capacity + 1),
+  head_(0),
+  tail_(0)
+  {}
+
+  /**
+   * \brief Retrieve the next free slot, for the producer to fill.
+   *
+   * Note: Only to be called by the producer.
+   *
+   * \return T* pointer to the free slot, or null if the ring buffer is full.
+   */
+  T* writeSlot()
+  {
+    const size_t head = head_.load(boost::memory_order_relaxed);
+
+    return (next(head) == tail_.load(boost::memory_order_acquire) ? 0 : &slots_[head]);
+  }
+
+  /**
+   * \brief Publish the slot retrieved with writeSlot.
+   *
+   * Note: Only to be called by the producer, and only after a successful call to writeSlot.
+   */
+  void publish()
+  {
+    head_.store(next(head_.load(boost::memory_order_relaxed)), boost::memory_order_release);
+  }
+
+  /**
+   * \brief Retrieve the oldest published slot, for the consumer to process.
+   *
+   * Note: Only to be called by the consumer.
+   *
+   * \return T* pointer to the published slot, or null if the ring buffer is empty.
+   */
+  T* readSlot()
+  {
+    const size_t tail = tail_.load(boost::memory_order_relaxed);
+
+    return (tail == head_.load(boost::memory_order_acquire) ? 0 : &slots_[tail]);
+  }
+
+  /**
+   * \brief Release the slot retrieved with readSlot (i.e. hand it back to the producer).
+   *
+   * Note: Only to be called by the consumer, and only after a successful call to readSlot.
+   */
+  void release()
+  {
+    tail_.store(next(tail_.load(boost::memory_order_relaxed)), boost::memory_order_release);
+  }
+
+  /**
+   * \brief Retrieve the number of published items (approximate, if called while the other side is active).
+   *
+   * \return size_t containing the number of items.
+   */
+  size_t size() const
+  {
+    const size_t head = head_.load(boost::memory_order_acquire);
+    const size_t tail = tail_.load(boost::memory_order_acquire);
+
+    return (head >= tail ? head - tail : head + slots_.size() - tail);
+  }
+
+  /**
+   * \brief Retrieve the ring buffer's capacity.
+   *
+   * \return size_t containing the capacity.
+   */
+  size_t capacity() const
+  {
+    return slots_.size() - 1;
+  }
+
+private:
+  /**
+   * \brief Calculate the index following a slot index.
+   *
+   * \param index of the slot.
+   *
+   * \return size_t containing the next index.
+   */
+  size_t next(const size_t index) const
+  {
+    return (index + 1 == slots_.size() ? 0 : index + 1);
+  }
+
+  /**
+   * \brief The slots (one more than the capacity, to distinguish between a full and an empty ring buffer).
+   */
+  std::vector<T> slots_;
+
+  /**
+   * \brief Index of the producer's next slot.
+   */
+  boost::atomic<size_t> head_;
+
+  /**
+   * \brief Padding, to keep the producer's and the consumer's indices on separate cache lines.
+   */
+  char padding_[64];
+
+  /**
+   * \brief Index of the consumer's next slot.
+   */
+  boost::atomic<size_t> tail_;
+};
+
+/**
+ * \brief Functor for consumers without any action when the ring buffer has been drained.
+ */
+struct NoIdleAction
+{
+  /**
+   * \brief Do nothing.
+   */
+  void operator()() const {}
+};
+
+/**
+ * \brief Consume the items of a ring buffer in batches, until a stop has been requested and the ring buffer is drained.
+ *
+ * Intended as the loop of a background consumer thread (e.g. a log writer), which sleeps while the ring buffer is
+ * empty. All items published before the stop request are consumed.
+ *
+ * \param p_ring_buffer to consume the items from.
+ * \param stop_requested flag indicating if the consumer should stop.
+ * \param batch_size specifying the max number of items consumed, before the stop flag is checked again.
+ * \param idle_wait_time_ms specifying the wait time [ms] after the ring buffer has been drained.
+ * \param consume functor called for each item (with the item's slot, which is reused after the call).
+ * \param idle functor called each time the ring buffer has been drained (e.g. for flushing a file).
+ */
+template <typename T, typename Consume, typename Idle>
+void consumeRingBuffer(RingBuffer<T>* p_ring_buffer,
+                       const boost::atomic<bool>& stop_requested,
+                       const size_t batch_size,
+                       const unsigned int idle_wait_time_ms,
+                       Consume consume,
+                       Idle idle)
+{
+  bool stop = false;
+
+  while (!stop)
+  {
+    // Check the stop flag before draining, so that all items published before the request are consumed.
+    stop = stop_requested;
+
+    size_t count = 0;
+
+    for (T* p_item = p_ring_buffer->readSlot(); p_item && count < batch_size; p_item = p_ring_buffer->readSlot())
+    {
+      consume(*p_item);
+      p_ring_buffer->release();
+      ++count;
+    }
+
+    if (count < batch_size)
+    {
+      idle();
+
+      if (!stop)
+      {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(idle_wait_time_ms));
+      }
+    }
+    else
+    {
+      // More items may be waiting, so keep draining before deciding to stop.
+      stop = false;
+    }
+  }
+}
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_RING_BUFFER_H
@@ -0,0 +1,134 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_SEQLOCK_H
+#define EGM_SEQLOCK_H
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Class for a sequence lock, for publishing values from one writer thread to any number of reader threads.
+ *
+ * The writer never waits, and a reader's load attempt never waits either (i.e. it is wait-free). A load attempt
+ * fails if it overlapped with a write, in which case the reader can simply retry.
+ *
+ * Note: Only one writer thread is supported, and the value type must be trivially copyable (e.g. no pointers to
+ *       owned memory), since a reader can copy a value while it is being written (the copy is then discarded).
+ */
+template <typename T>
+class SeqLock
+{
+public:
+  /**
+   * \brief Default constructor.
+   */
+  SeqLock()
+  :
+  sequence_(0)
+  {}
+
+  /**
+   * \brief Publish a value.
+   *
+   * Note: Only to be called by the writer.
+   *
+   * \param value to publish.
+   */
+  void store(const T& value)
+  {
+    const boost::uint32_t sequence = sequence_.load(boost::memory_order_relaxed);
+
+    // Note: An odd sequence number indicates that a write is in progress.
+    sequence_.store(sequence + 1, boost::memory_order_relaxed);
+    boost::atomic_thread_fence(boost::memory_order_release);
+    value_ = value;
+    sequence_.store(sequence + 2, boost::memory_order_release);
+  }
+
+  /**
+   * \brief Try to load the latest published value.
+   *
+   * \param p_value for storing the value.
+   *
+   * \return bool indicating if a consistent value was loaded (false if nothing has been published yet, or if the
+   *         attempt overlapped with a write).
+   */
+  bool tryLoad(T* p_value) const
+  {
+    const boost::uint32_t before = sequence_.load(boost::memory_order_acquire);
+
+    if (!p_value || before == 0 || (before & 1) != 0)
+    {
+      return false;
+    }
+
+    *p_value = value_;
+    boost::atomic_thread_fence(boost::memory_order_acquire);
+
+    return sequence_.load(boost::memory_order_relaxed) == before;
+  }
+
+  /**
+   * \brief Retrieve the number of published values.
+   *
+   * \return boost::uint32_t containing the number of published values.
+   */
+  boost::uint32_t version() const
+  {
+    return sequence_.load(boost::memory_order_acquire) / 2;
+  }
+
+private:
+  /**
+   * \brief The sequence number (incremented before and after each write).
+   */
+  boost::atomic<boost::uint32_t> sequence_;
+
+  /**
+   * \brief The published value.
+   */
+  T value_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_SEQLOCK_H
@@ -0,0 +1,326 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_SHARED_MEMORY_H
+#define EGM_SHARED_MEMORY_H
+
+#include <string>
+
+#include <boost/cstdint.hpp>
+
+#include "egm_wrapper.pb.h" // Generated by Google Protocol Buffer compiler protoc
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Class for a shared memory segment, for exchanging inputs and outputs with an external control loop that runs
+ *        in another process.
+ *
+ * The segment contains one slot for the inputs (written by the interface's process) and one slot for the outputs
+ * (written by the external control loop's process). Each slot holds the latest serialized message, protected by a
+ * sequence lock, so neither side ever blocks the other. The slot's sequence number is also used as a futex word, for
+ * waking up a process that waits for the next message.
+ *
+ * Note: Only supported on Linux (i.e. create and open fail on other platforms). Each slot supports one writer
+ *       thread and one reader thread.
+ */
+class EGMSharedMemory
+{
+public:
+  /**
+   * \brief Default constructor.
+   */
+  EGMSharedMemory();
+
+  /**
+   * \brief Destructor.
+   */
+  ~EGMSharedMemory();
+
+  /**
+   * \brief Create (or recreate) a named shared memory segment.
+   *
+   * Note: Intended for the interface's process. The segment is removed again when it is closed.
+   *
+   * \param name for the segment's name (e.g. "/abb_libegm").
+   *
+   * \return bool indicating if the segment was created or not.
+   */
+  bool create(const std::string& name);
+
+  /**
+   * \brief Open an existing named shared memory segment.
+   *
+   * Note: Intended for the external control loop's process.
+   *
+   * \param name for the segment's name (e.g. "/abb_libegm").
+   *
+   * \return bool indicating if the segment was opened or not.
+   */
+  bool open(const std::string& name);
+
+  /**
+   * \brief Close the segment (and remove it, if it was created by this object).
+   */
+  void close();
+
+  /**
+   * \brief Check if a segment is currently open.
+   *
+   * \return bool indicating if a segment is open or not.
+   */
+  bool isOpen() const;
+
+  /**
+   * \brief Publish inputs, and wake up any waiting reader.
+   *
+   * \param inputs containing the inputs to publish.
+   *
+   * \return bool indicating if the inputs were published or not (e.g. false if they are too large).
+   */
+  bool writeInputs(const wrapper::Input& inputs);
+
+  /**
+   * \brief Wait for inputs, that have not been read yet.
+   *
+   * \param timeout_ms for specifying a timeout in [ms]. If zero, then the method waits forever.
+   *
+   * \return bool indicating if there are unread inputs or not. I.e. returns false if a timeout has occurred.
+   */
+  bool waitForInputs(const unsigned int timeout_ms);
+
+  /**
+   * \brief Read the latest published inputs.
+   *
+   * \param p_inputs for containing the inputs.
+   *
+   * \return bool indicating if the inputs were read or not (e.g. false if nothing has been published yet).
+   */
+  bool readInputs(wrapper::Input* p_inputs);
+
+  /**
+   * \brief Publish outputs, and wake up any waiting reader.
+   *
+   * \param outputs containing the outputs to publish.
+   *
+   * \return bool indicating if the outputs were published or not (e.g. false if they are too large).
+   */
+  bool writeOutputs(const wrapper::Output& outputs);
+
+  /**
+   * \brief Wait for outputs, that have not been read yet.
+   *
+   * \param timeout_ms for specifying a timeout in [ms]. If zero, then the method waits forever.
+   *
+   * \return bool indicating if there are unread outputs or not. I.e. returns false if a timeout has occurred.
+   */
+  bool waitForOutputs(const unsigned int timeout_ms);
+
+  /**
+   * \brief Read the latest published outputs, if they have not been read yet.
+   *
+   * \param p_outputs for containing the outputs.
+   *
+   * \return bool indicating if new outputs were read or not. If not, then p_outputs is left unchanged.
+   */
+  bool readOutputs(wrapper::Output* p_outputs);
+
+  /**
+   * \brief Mark all published outputs as read (e.g. outputs from a previous communication session).
+   */
+  void discardOutputs();
+
+  /**
+   * \brief Static constant for the max size [bytes] of a serialized message in a slot.
+   */
+  static const unsigned int MAX_MESSAGE_SIZE = 4096;
+
+private:
+  /**
+   * \brief Struct for a slot in the segment (defined in the source file).
+   */
+  struct Slot;
+
+  /**
+   * \brief Struct for the segment's layout (defined in the source file).
+   */
+  struct Segment;
+
+  /**
+   * \brief Map a named shared memory segment.
+   *
+   * \param name for the segment's name.
+   * \param create indicating if the segment should be created or not.
+   *
+   * \return bool indicating if the segment was mapped or not.
+   */
+  bool map(const std::string& name, const bool create);
+
+  /**
+   * \brief Publish a message into a slot.
+   *
+   * \param p_slot for the slot.
+   * \param message containing the message to publish.
+   *
+   * \return bool indicating if the message was published or not.
+   */
+  bool write(Slot* p_slot, const google::protobuf::MessageLite& message);
+
+  /**
+   * \brief Wait for a message in a slot, that has not been read yet.
+   *
+   * \param p_slot for the slot.
+   * \param last_sequence for the sequence number of the last read message.
+   * \param timeout_ms for specifying a timeout in [ms]. If zero, then the method waits forever.
+   *
+   * \return bool indicating if there is an unread message or not.
+   */
+  bool wait(Slot* p_slot, const boost::uint32_t last_sequence, const unsigned int timeout_ms);
+
+  /**
+   * \brief Read the latest message in a slot.
+   *
+   * \param p_slot for the slot.
+   * \param p_last_sequence for the sequence number of the last read message (updated if a message is read).
+   * \param p_message for containing the message.
+   * \param only_new indicating if the message should only be read if it has not been read yet.
+   *
+   * \return bool indicating if a message was read or not.
+   */
+  bool read(Slot* p_slot,
+            boost::uint32_t* p_last_sequence,
+            google::protobuf::MessageLite* p_message,
+            const bool only_new);
+
+  /**
+   * \brief Static constant for the max number of attempts, for reading a consistent message.
+   *
+   * Note: An attempt only fails if it overlaps with a write, which are short and infrequent.
+   */
+  static const int MAX_READ_ATTEMPTS = 100;
+
+  /**
+   * \brief The mapped segment (null if no segment is open).
+   */
+  Segment* p_segment_;
+
+  /**
+   * \brief The segment's name.
+   */
+  std::string name_;
+
+  /**
+   * \brief Flag indicating if the segment was created by this object or not.
+   */
+  bool owner_;
+
+  /**
+   * \brief Sequence number of the last read inputs.
+   */
+  boost::uint32_t last_inputs_sequence_;
+
+  /**
+   * \brief Sequence number of the last read outputs.
+   */
+  boost::uint32_t last_outputs_sequence_;
+
+  /**
+   * \brief Buffer for a consistent copy of a serialized message (i.e. before it is parsed).
+   */
+  char buffer_[MAX_MESSAGE_SIZE];
+};
+
+/**
+ * \brief Class for an external control loop, in another process than an EGMControllerInterface.
+ *
+ * The class provides the same read/write/waitForMessage semantics as EGMControllerInterface, via a shared memory
+ * segment created by the interface (see EGMControllerInterface::enableSharedMemory).
+ *
+ * Pseudocode for the usage of the class methods (inside the external control loop);
+ * 1. open(...)
+ * 2. if(waitForMessage(...))
+ * 2.1. read(...)
+ * 2.2. write(...)
+ * 2.3. Repeat from 2.
+ */
+class EGMSharedMemoryClient
+{
+public:
+  /**
+   * \brief Open the interface's shared memory segment.
+   *
+   * \param name for the segment's name.
+   *
+   * \return bool indicating if the segment was opened or not.
+   */
+  bool open(const std::string& name);
+
+  /**
+   * \brief Wait for the next EGM message.
+   *
+   * \param timeout_ms for specifying a timeout in [ms]. If omitted, then the method waits forever.
+   *
+   * \return bool indicating if the wait was successful or not. I.e. returns false if a timeout has occurred.
+   */
+  bool waitForMessage(const unsigned int timeout_ms = 0);
+
+  /**
+   * \brief Read EGM inputs received from the robot controller.
+   *
+   * \param p_inputs for containing the inputs.
+   */
+  void read(wrapper::Input* p_inputs);
+
+  /**
+   * \brief Write EGM outputs to send to the robot controller.
+   *
+   * \param outputs containing the outputs.
+   */
+  void write(const wrapper::Output& outputs);
+
+private:
+  /**
+   * \brief The shared memory segment.
+   */
+  EGMSharedMemory shared_memory_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_SHARED_MEMORY_H
@@ -0,0 +1,193 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_SNAPSHOT_PUBLISHER_H
+#define EGM_SNAPSHOT_PUBLISHER_H
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Class for publishing immutable snapshots of a value, from any number of writer threads to one reader thread.
+ *
+ * Each published value is stored in a new, shared snapshot, which the reader picks up with an atomic pointer swap
+ * (i.e. read-copy-update). Checking for a new snapshot only costs one atomic load, and the reader never waits for a
+ * writer (the shared pointer is only accessed, via Boost's atomic shared pointer functions, when the version changes).
+ *
+ * Replaced snapshots are retired, and they are only released by a writer once the reader no longer refers to them.
+ * I.e. the reader never releases any memory.
+ */
+template <typename T>
+class SnapshotPublisher
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param initial specifying the initial value.
+   */
+  explicit SnapshotPublisher(const T& initial)
+  :
+  p_published_(new T(initial)),
+  version_(0),
+  p_current_(p_published_),
+  current_version_(0)
+  {}
+
+  /**
+   * \brief Publish a new value.
+   *
+   * Note: Only to be called by writers.
+   *
+   * \param value to publish.
+   */
+  void publish(const T& value)
+  {
+    boost::shared_ptr<const T> p_snapshot(new T(value));
+
+    boost::lock_guard<boost::mutex> lock(mutex_);
+
+    // Release the retired snapshots that the reader has stopped referring to.
+    retired_.erase(std::remove_if(retired_.begin(), retired_.end(), isReleasable), retired_.end());
+
+    retired_.push_back(boost::atomic_exchange(&p_published_, p_snapshot));
+    version_.fetch_add(1, boost::memory_order_release);
+  }
+
+  /**
+   * \brief Retrieve a copy of the most recently published value.
+   *
+   * \return T containing the value.
+   */
+  T latest() const
+  {
+    return *boost::atomic_load(&p_published_);
+  }
+
+  /**
+   * \brief Refresh the reader's current snapshot, if a new value has been published.
+   *
+   * Note: Only to be called by the reader.
+   *
+   * \return bool indicating if the current snapshot was replaced.
+   */
+  bool refresh()
+  {
+    const boost::uint32_t version = version_.load(boost::memory_order_acquire);
+
+    if (version == current_version_)
+    {
+      return false;
+    }
+
+    p_current_ = boost::atomic_load(&p_published_);
+    current_version_ = version;
+
+    return true;
+  }
+
+  /**
+   * \brief Retrieve the reader's current snapshot.
+   *
+   * Note: Only to be called by the reader.
+   *
+   * \return const T& containing the snapshot's value.
+   */
+  const T& current() const
+  {
+    return *p_current_;
+  }
+
+private:
+  /**
+   * \brief Check if a retired snapshot can be released (i.e. only the retired list refers to it).
+   *
+   * \param p_snapshot to check.
+   *
+   * \return bool indicating if the snapshot can be released.
+   */
+  static bool isReleasable(const boost::shared_ptr<const T>& p_snapshot)
+  {
+    return p_snapshot.unique();
+  }
+
+  /**
+   * \brief The most recently published snapshot.
+   *
+   * Note: Only accessed via Boost's atomic shared pointer functions.
+   */
+  boost::shared_ptr<const T> p_published_;
+
+  /**
+   * \brief The number of published values.
+   */
+  boost::atomic<boost::uint32_t> version_;
+
+  /**
+   * \brief The reader's current snapshot.
+   */
+  boost::shared_ptr<const T> p_current_;
+
+  /**
+   * \brief The version of the reader's current snapshot.
+   */
+  boost::uint32_t current_version_;
+
+  /**
+   * \brief Snapshots that have been replaced, but that might still be referred to by the reader.
+   */
+  std::vector<boost::shared_ptr<const T> > retired_;
+
+  /**
+   * \brief Mutex for serializing the writers.
+   */
+  boost::mutex mutex_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_SNAPSHOT_PUBLISHER_H
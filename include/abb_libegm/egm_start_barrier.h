@@ -0,0 +1,159 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_START_BARRIER_H
+#define EGM_START_BARRIER_H
+
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
+#include <boost/cstdint.hpp>
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Class for aligning the start of trajectories across a group of EGM trajectory interfaces.
+ *
+ * The class provides behavior for:
+ * - Counting the members that are ready to start (i.e. that have reached the synchronized trajectory).
+ * - Deciding a common release time (host clock) when the last member is ready, at least one lead time ahead, so
+ *   that every member still has a message before the release time.
+ * - Letting each member start at its message closest to the release time (i.e. within half a sample time), where
+ *   the message times are estimated via each controller's clock relation.
+ *
+ * Note: Lock-free, since it is used by the EGM communication loops (one per member).
+ */
+class EGMStartBarrier
+{
+public:
+  /**
+   * \brief Enum for the barrier's status, as seen by a member.
+   */
+  enum Status
+  {
+    Waiting,  ///< \brief The member should wait (i.e. not all members are ready, or the release time is ahead).
+    Released, ///< \brief The member should start.
+    Cancelled ///< \brief The member should discard the synchronized trajectory.
+  };
+
+  /**
+   * \brief A constructor.
+   *
+   * \param number_of_members specifying the number of members that must be ready, before the barrier is released.
+   * \param earliest_start specifying the earliest release time (host clock).
+   * \param lead_time specifying the min time [s] between the last member being ready, and the release time.
+   */
+  EGMStartBarrier(const unsigned int number_of_members,
+                  const boost::chrono::steady_clock::time_point& earliest_start,
+                  const double lead_time);
+
+  /**
+   * \brief Mark a member as ready to start.
+   *
+   * Note: Should only be called once per member.
+   *
+   * \param message_time specifying the (host clock) time of the member's current message.
+   */
+  void arrive(const boost::chrono::steady_clock::time_point& message_time);
+
+  /**
+   * \brief Retrieve the barrier's status, for a member's current message.
+   *
+   * \param message_time specifying the (host clock) time of the member's current message.
+   * \param sample_time specifying the member's estimated sample time [s].
+   *
+   * \return Status containing the status.
+   */
+  Status status(const boost::chrono::steady_clock::time_point& message_time, const double sample_time) const;
+
+  /**
+   * \brief Cancel the barrier, i.e. all members discard the synchronized trajectory (that have not yet started it).
+   */
+  void cancel();
+
+  /**
+   * \brief Check if the barrier has been released or cancelled.
+   *
+   * \return bool indicating if the barrier is done or not.
+   */
+  bool isDone() const { return state_.load(boost::memory_order_acquire) != Waiting; };
+
+private:
+  /**
+   * \brief Convert a time point into nanoseconds since the clock's epoch.
+   *
+   * \param time specifying the time point.
+   *
+   * \return boost::int64_t containing the nanoseconds.
+   */
+  static boost::int64_t toNanoseconds(const boost::chrono::steady_clock::time_point& time);
+
+  /**
+   * \brief The number of members that must be ready.
+   */
+  const unsigned int number_of_members_;
+
+  /**
+   * \brief The earliest release time [ns] (host clock).
+   */
+  const boost::int64_t earliest_start_ns_;
+
+  /**
+   * \brief The min time [ns] between the last member being ready, and the release time.
+   */
+  const boost::int64_t lead_time_ns_;
+
+  /**
+   * \brief The number of members that are ready.
+   */
+  boost::atomic<unsigned int> number_of_arrivals_;
+
+  /**
+   * \brief The release time [ns] (host clock), valid when the state is released.
+   */
+  boost::atomic<boost::int64_t> release_time_ns_;
+
+  /**
+   * \brief The barrier's state (i.e. waiting, released or cancelled).
+   */
+  boost::atomic<int> state_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_START_BARRIER_H
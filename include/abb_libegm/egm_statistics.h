@@ -0,0 +1,559 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_STATISTICS_H
+#define EGM_STATISTICS_H
+
+#include <boost/chrono.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/thread.hpp>
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Struct for containing a summary of recorded latencies (or durations).
+ *
+ * Note: All values are in [us], and the percentiles are approximated to within ~3 %.
+ */
+struct LatencyStatistics
+{
+  /**
+   * \brief Default constructor.
+   */
+  LatencyStatistics()
+  :
+  count(0),
+  min(0.0),
+  max(0.0),
+  mean(0.0),
+  p50(0.0),
+  p90(0.0),
+  p99(0.0),
+  p999(0.0)
+  {}
+
+  /**
+   * \brief Number of recorded values.
+   */
+  boost::uint64_t count;
+
+  /**
+   * \brief Smallest recorded value [us].
+   */
+  double min;
+
+  /**
+   * \brief Largest recorded value [us].
+   */
+  double max;
+
+  /**
+   * \brief Mean of the recorded values [us].
+   */
+  double mean;
+
+  /**
+   * \brief 50th percentile (median) of the recorded values [us].
+   */
+  double p50;
+
+  /**
+   * \brief 90th percentile of the recorded values [us].
+   */
+  double p90;
+
+  /**
+   * \brief 99th percentile of the recorded values [us].
+   */
+  double p99;
+
+  /**
+   * \brief 99.9th percentile of the recorded values [us].
+   */
+  double p999;
+};
+
+/**
+ * \brief Struct for containing an interface's timing and packet statistics.
+ */
+struct InterfaceStatistics
+{
+  /**
+   * \brief Default constructor.
+   */
+  InterfaceStatistics()
+  :
+  number_of_messages(0),
+  number_of_missed_messages(0),
+  number_of_reordered_messages(0),
+  number_of_late_messages(0),
+  number_of_overruns(0),
+  number_of_dropped_samples(0)
+  {}
+
+  /**
+   * \brief Duration of the complete callback (i.e. from receiving a message, to having a reply ready).
+   */
+  LatencyStatistics callback;
+
+  /**
+   * \brief Duration of parsing the received message.
+   */
+  LatencyStatistics parse;
+
+  /**
+   * \brief Duration of extracting information from the parsed message (incl. velocity estimations).
+   */
+  LatencyStatistics extract;
+
+  /**
+   * \brief Duration of generating the outputs (e.g. demo outputs, trajectory interpolation or external control loop).
+   */
+  LatencyStatistics outputs;
+
+  /**
+   * \brief Duration of logging the inputs and outputs.
+   */
+  LatencyStatistics logging;
+
+  /**
+   * \brief Duration of constructing and serializing the reply.
+   */
+  LatencyStatistics reply;
+
+  /**
+   * \brief Latency from the UDP server receiving a message, to the reply being ready to send.
+   */
+  LatencyStatistics receive_to_send;
+
+  /**
+   * \brief Time between consecutively received messages (i.e. the packet jitter).
+   */
+  LatencyStatistics inter_arrival;
+
+  /**
+   * \brief Number of processed messages.
+   */
+  boost::uint64_t number_of_messages;
+
+  /**
+   * \brief Number of messages never received (derived from gaps in the header sequence numbers).
+   */
+  boost::uint64_t number_of_missed_messages;
+
+  /**
+   * \brief Number of messages received out of order (or duplicated).
+   */
+  boost::uint64_t number_of_reordered_messages;
+
+  /**
+   * \brief Number of messages arriving later than 1.5 times the estimated sample time, after the previous message.
+   */
+  boost::uint64_t number_of_late_messages;
+
+  /**
+   * \brief Number of messages where the receive-to-send latency exceeded the estimated sample time.
+   */
+  boost::uint64_t number_of_overruns;
+
+  /**
+   * \brief Number of messages whose durations were not recorded, since the statistics were being retrieved for too
+   *        long (the counters above still include them).
+   */
+  boost::uint64_t number_of_dropped_samples;
+};
+
+/**
+ * \brief Class for a fixed-size histogram of latencies, with log-linear buckets (similar to an HDR histogram).
+ *
+ * Values are recorded in [ns], with 32 linear sub-buckets per power of two. Recording a value never allocates.
+ */
+class LatencyHistogram
+{
+public:
+  /**
+   * \brief Default constructor.
+   */
+  LatencyHistogram();
+
+  /**
+   * \brief Record a value.
+   *
+   * \param value_ns to record [ns].
+   */
+  void add(const boost::uint64_t value_ns);
+
+  /**
+   * \brief Reset the histogram, i.e. discard all recorded values.
+   */
+  void reset();
+
+  /**
+   * \brief Summarize the recorded values.
+   *
+   * \return LatencyStatistics containing the summary.
+   */
+  LatencyStatistics summarize() const;
+
+private:
+  /**
+   * \brief Static constant for the number of bits used for the linear sub-buckets.
+   */
+  static const unsigned int SUB_BUCKET_BITS = 5;
+
+  /**
+   * \brief Static constant for the number of linear sub-buckets per power of two.
+   */
+  static const unsigned int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+
+  /**
+   * \brief Static constant for the highest power of two covered by the buckets (2^41 ns, i.e. ~36 minutes).
+   */
+  static const unsigned int MAX_EXPONENT = 40;
+
+  /**
+   * \brief Static constant for the number of buckets.
+   */
+  static const unsigned int NUMBER_OF_BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 2)*SUB_BUCKET_COUNT;
+
+  /**
+   * \brief Map a value to its bucket index.
+   *
+   * \param value_ns to map [ns].
+   *
+   * \return unsigned int containing the bucket index.
+   */
+  static unsigned int bucketIndex(const boost::uint64_t value_ns);
+
+  /**
+   * \brief Retrieve the smallest value represented by a bucket.
+   *
+   * \param index of the bucket.
+   *
+   * \return boost::uint64_t containing the value [ns].
+   */
+  static boost::uint64_t bucketLowerBound(const unsigned int index);
+
+  /**
+   * \brief Calculate an approximate percentile of the recorded values.
+   *
+   * \param fraction specifying the percentile [0, 1].
+   *
+   * \return double containing the percentile [us].
+   */
+  double percentile(const double fraction) const;
+
+  /**
+   * \brief The bucket counters.
+   */
+  boost::uint64_t buckets_[NUMBER_OF_BUCKETS];
+
+  /**
+   * \brief Number of recorded values.
+   */
+  boost::uint64_t count_;
+
+  /**
+   * \brief Smallest recorded value [ns].
+   */
+  boost::uint64_t min_;
+
+  /**
+   * \brief Largest recorded value [ns].
+   */
+  boost::uint64_t max_;
+
+  /**
+   * \brief Sum of the recorded values [ns].
+   */
+  double sum_;
+};
+
+/**
+ * \brief Class for collecting timing and packet statistics of an interface's callbacks.
+ *
+ * The stage durations of a callback are collected locally during the callback (without any locking), and are then
+ * merged into the histograms once per callback.
+ */
+class EGMStatisticsCollector
+{
+public:
+  /**
+   * \brief Enum for the timed stages of a callback.
+   */
+  enum Stage
+  {
+    Parse,           ///< \brief Parsing the received message.
+    Extract,         ///< \brief Extracting information from the parsed message.
+    Outputs,         ///< \brief Generating the outputs.
+    Logging,         ///< \brief Logging the inputs and outputs.
+    Reply,           ///< \brief Constructing the reply.
+    NUMBER_OF_STAGES ///< \brief The number of stages.
+  };
+
+  /**
+   * \brief Default constructor.
+   */
+  EGMStatisticsCollector();
+
+  /**
+   * \brief Start a new callback cycle.
+   *
+   * \param enabled indicating if statistics should be collected during the cycle.
+   * \param receive_time specifying when the UDP server received the message (ignored if it is zero).
+   */
+  void startCycle(const bool enabled, const boost::chrono::steady_clock::time_point& receive_time);
+
+  /**
+   * \brief Mark the end of a stage (which started at the end of the previous stage, or at the start of the cycle).
+   *
+   * \param stage that was finished.
+   */
+  void markStage(const Stage stage);
+
+  /**
+   * \brief Update the packet statistics, based on the received message's header.
+   *
+   * \param first_message indicating if it is the first message in a communication session.
+   * \param sequence_number of the received message.
+   * \param estimated_sample_time [s] of the communication session.
+   */
+  void updateSequence(const bool first_message,
+                      const unsigned int sequence_number,
+                      const double estimated_sample_time);
+
+  /**
+   * \brief End the current callback cycle, and merge the collected durations into the histograms.
+   *
+   * Note: The merge never waits for a user thread retrieving the statistics. The cycle is then kept pending, and it
+   *       is merged by a later cycle. If too many cycles are pending, then the cycle's durations are dropped (and
+   *       counted).
+   */
+  void endCycle();
+
+  /**
+   * \brief Retrieve a summary of the collected statistics.
+   *
+   * \return InterfaceStatistics containing the summary.
+   */
+  InterfaceStatistics getStatistics();
+
+  /**
+   * \brief Reset all collected statistics.
+   *
+   * Note: Cycles that were still pending a merge (see endCycle) are included in the statistics after the reset.
+   */
+  void reset();
+
+private:
+  /**
+   * \brief Struct for containing the durations collected during one callback cycle.
+   */
+  struct CycleSample
+  {
+    /**
+     * \brief Duration [ns] of the complete callback.
+     */
+    boost::uint64_t callback;
+
+    /**
+     * \brief Stage durations [ns].
+     */
+    boost::uint64_t stage_durations[NUMBER_OF_STAGES];
+
+    /**
+     * \brief Flags indicating which stages were finished.
+     */
+    bool stage_finished[NUMBER_OF_STAGES];
+
+    /**
+     * \brief Receive-to-send latency [ns].
+     */
+    boost::uint64_t receive_to_send;
+
+    /**
+     * \brief Flag indicating if the receive-to-send latency is valid.
+     */
+    bool has_receive_to_send;
+
+    /**
+     * \brief Inter-arrival time [ns].
+     */
+    boost::uint64_t inter_arrival;
+
+    /**
+     * \brief Flag indicating if the inter-arrival time is valid.
+     */
+    bool has_inter_arrival;
+  };
+
+  /**
+   * \brief Static constant factor (of the estimated sample time) for when a message is considered to be late.
+   */
+  static const double LATE_FACTOR;
+
+  /**
+   * \brief Static constant for the max number of cycles that can be pending a merge into the histograms.
+   */
+  static const unsigned int MAX_PENDING_SAMPLES = 64;
+
+  /**
+   * \brief Merge the pending cycles into the histograms and counters.
+   *
+   * Note: The mutex must be held by the caller.
+   */
+  void mergePending();
+
+  /**
+   * \brief Calculate the duration between two time points.
+   *
+   * \param start of the duration.
+   * \param end of the duration.
+   *
+   * \return boost::uint64_t containing the duration [ns] (zero if negative).
+   */
+  static boost::uint64_t duration(const boost::chrono::steady_clock::time_point& start,
+                                  const boost::chrono::steady_clock::time_point& end);
+
+  /**
+   * \brief Flag indicating if statistics are collected during the current cycle.
+   */
+  bool enabled_;
+
+  /**
+   * \brief Time when the current cycle started.
+   */
+  boost::chrono::steady_clock::time_point cycle_start_;
+
+  /**
+   * \brief Time when the previous stage was finished.
+   */
+  boost::chrono::steady_clock::time_point stage_start_;
+
+  /**
+   * \brief Time when the current message was received.
+   */
+  boost::chrono::steady_clock::time_point receive_time_;
+
+  /**
+   * \brief Time when the previous message was received.
+   */
+  boost::chrono::steady_clock::time_point previous_receive_time_;
+
+  /**
+   * \brief Stage durations [ns] collected during the current cycle.
+   */
+  boost::uint64_t stage_durations_[NUMBER_OF_STAGES];
+
+  /**
+   * \brief Flags indicating which stages were finished during the current cycle.
+   */
+  bool stage_finished_[NUMBER_OF_STAGES];
+
+  /**
+   * \brief Flag indicating if a sequence number has been received in the current communication session.
+   */
+  bool has_sequence_number_;
+
+  /**
+   * \brief The highest sequence number received in the current communication session.
+   */
+  unsigned int sequence_number_;
+
+  /**
+   * \brief The estimated sample time [s] of the current communication session.
+   */
+  double estimated_sample_time_;
+
+  /**
+   * \brief Cycles pending a merge into the histograms (i.e. if the histograms were busy when the cycles ended).
+   *
+   * Note: Only accessed by the callback thread.
+   */
+  CycleSample pending_samples_[MAX_PENDING_SAMPLES];
+
+  /**
+   * \brief Number of pending cycles.
+   */
+  unsigned int number_of_pending_samples_;
+
+  /**
+   * \brief Packet counter updates pending a merge (the latency summaries are left empty).
+   */
+  InterfaceStatistics pending_counters_;
+
+  /**
+   * \brief Mutex for protecting the histograms and counters.
+   */
+  boost::mutex mutex_;
+
+  /**
+   * \brief Histogram for the callback durations.
+   */
+  LatencyHistogram callback_histogram_;
+
+  /**
+   * \brief Histograms for the stage durations.
+   */
+  LatencyHistogram stage_histograms_[NUMBER_OF_STAGES];
+
+  /**
+   * \brief Histogram for the receive-to-send latencies.
+   */
+  LatencyHistogram receive_to_send_histogram_;
+
+  /**
+   * \brief Histogram for the inter-arrival times.
+   */
+  LatencyHistogram inter_arrival_histogram_;
+
+  /**
+   * \brief The packet counters (the latency summaries are left empty).
+   */
+  InterfaceStatistics counters_;
+
+  /**
+   * \brief Packet counter updates collected during the current cycle.
+   */
+  InterfaceStatistics cycle_counters_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_STATISTICS_H
@@ -0,0 +1,339 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_TELEMETRY_H
+#define EGM_TELEMETRY_H
+
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include "egm_common.h"
+#include "egm_logger.h"
+#include "egm_ring_buffer.h"
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Struct for an aggregated value (over one telemetry window).
+ */
+struct TelemetryValue
+{
+  /**
+   * \brief Default constructor.
+   */
+  TelemetryValue() : min(0.0), max(0.0), mean(0.0) {}
+
+  /**
+   * \brief The minimum value.
+   */
+  double min;
+
+  /**
+   * \brief The maximum value.
+   */
+  double max;
+
+  /**
+   * \brief The mean value.
+   */
+  double mean;
+};
+
+/**
+ * \brief Struct for a telemetry sample (i.e. the values aggregated over one window).
+ */
+struct TelemetrySample
+{
+  /**
+   * \brief Default constructor.
+   */
+  TelemetrySample()
+  :
+  sequence_number(0),
+  first_time_stamp(0),
+  last_time_stamp(0),
+  number_of_messages(0)
+  {}
+
+  /**
+   * \brief The sample's sequence number (incremented for each published sample).
+   */
+  boost::uint32_t sequence_number;
+
+  /**
+   * \brief Header time stamp [ms] of the first message in the window.
+   */
+  boost::uint32_t first_time_stamp;
+
+  /**
+   * \brief Header time stamp [ms] of the last message in the window.
+   */
+  boost::uint32_t last_time_stamp;
+
+  /**
+   * \brief Number of messages aggregated in the window.
+   */
+  boost::uint32_t number_of_messages;
+
+  /**
+   * \brief Indices of the aggregated values, in the same layout as for a log record (see EGMLogRecord).
+   */
+  std::vector<unsigned int> value_indices;
+
+  /**
+   * \brief The aggregated values (one for each index).
+   */
+  std::vector<TelemetryValue> values;
+};
+
+/**
+ * \brief Type for telemetry callbacks (notified from the telemetry publisher's background thread).
+ */
+typedef boost::function<void (const TelemetrySample& sample)> TelemetryCallback;
+
+/**
+ * \brief Class for publishing a decimated telemetry stream, of EGM messages, to multiple subscribers.
+ *
+ * The class provides behavior for:
+ * - Copying inputs and outputs into fixed-size log records (see EGMLogRecord), which are pushed into a lock-free
+ *   single-producer/single-consumer ring buffer. This is the only work done in the calling thread (i.e. the UDP
+ *   server's callback thread).
+ * - Aggregating the selected values (min, max and mean) over time windows, in a background thread.
+ * - Notifying registered callbacks, and optionally sending each sample to a UDP multicast group, for every window.
+ *
+ * Multicast datagram layout (native byte order):
+ * - Header: magic ("EGMT"), sequence number, first and last time stamps, number of messages and number of values
+ *   (all as 32-bit unsigned integers).
+ * - Value indices (32-bit unsigned integers).
+ * - Aggregated values (min, max and mean for each index, as doubles).
+ *
+ * Note: Records are dropped (and counted) if the ring buffer is full, the calling thread never waits for subscribers.
+ */
+class EGMTelemetryPublisher
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param configuration specifying the telemetry stream's configuration.
+   * \param capacity specifying the ring buffer's capacity (i.e. max number of records waiting to be aggregated).
+   */
+  EGMTelemetryPublisher(const TelemetryConfiguration& configuration, const size_t capacity = DEFAULT_CAPACITY);
+
+  /**
+   * \brief A destructor.
+   */
+  ~EGMTelemetryPublisher();
+
+  /**
+   * \brief Add inputs and outputs to the telemetry stream.
+   *
+   * \param inputs containing the inputs from the robot controller.
+   * \param outputs containing the outputs to the robot controller.
+   *
+   * \return bool indicating if the record was accepted or not (i.e. if the ring buffer was full).
+   */
+  bool add(const wrapper::Input& inputs, const wrapper::Output& outputs);
+
+  /**
+   * \brief Register a callback, which is notified with every published sample.
+   *
+   * \param callback for the callback to register.
+   *
+   * \return int containing the subscriber's identifier (used for removing it).
+   */
+  int addSubscriber(const TelemetryCallback& callback);
+
+  /**
+   * \brief Remove a registered callback.
+   *
+   * \param id containing the subscriber's identifier.
+   *
+   * \return bool indicating if the subscriber was removed or not (i.e. false if it was not registered).
+   */
+  bool removeSubscriber(const int id);
+
+  /**
+   * \brief Retrieve the number of records that have been dropped, due to a full ring buffer.
+   *
+   * \return unsigned int containing the number of dropped records.
+   */
+  unsigned int numberOfDroppedRecords() const { return number_of_dropped_records_; };
+
+  /**
+   * \brief Default ring buffer capacity (i.e. approximately 1 second of data at 250 Hz).
+   */
+  static const size_t DEFAULT_CAPACITY = 256;
+
+private:
+  /**
+   * \brief Struct for a registered subscriber.
+   */
+  struct Subscriber
+  {
+    /**
+     * \brief The subscriber's identifier.
+     */
+    int id;
+
+    /**
+     * \brief The subscriber's callback.
+     */
+    TelemetryCallback callback;
+  };
+
+  /**
+   * \brief Aggregate a record into the current window (and publish the window, if it is complete).
+   *
+   * \param record containing the record to aggregate.
+   */
+  void aggregate(const EGMLogRecord& record);
+
+  /**
+   * \brief Publish the current window, to the callbacks and the multicast group.
+   */
+  void publish();
+
+  /**
+   * \brief Send the current sample to the multicast group.
+   */
+  void sendSample();
+
+  /**
+   * \brief Publisher function for the background thread, which drains the ring buffer.
+   */
+  void publisherThread();
+
+  /**
+   * \brief Static constant for the multicast datagrams' identifier.
+   */
+  static const char MAGIC[4];
+
+  /**
+   * \brief Static constant for the max number of records aggregated in one batch.
+   */
+  static const size_t BATCH_SIZE = 64;
+
+  /**
+   * \brief Static constant for the background thread's idle wait time [ms].
+   */
+  static const unsigned int IDLE_WAIT_TIME_MS = 5;
+
+  /**
+   * \brief The window duration [ms].
+   */
+  double window_duration_ms_;
+
+  /**
+   * \brief The number of dropped records.
+   */
+  boost::atomic<unsigned int> number_of_dropped_records_;
+
+  /**
+   * \brief Flag indicating if the background thread should stop.
+   */
+  boost::atomic<bool> stop_requested_;
+
+  /**
+   * \brief Ring buffer for records waiting to be aggregated.
+   */
+  RingBuffer<EGMLogRecord> ring_buffer_;
+
+  /**
+   * \brief The current sample (i.e. the window being aggregated).
+   *
+   * Note: Only accessed by the background thread.
+   */
+  TelemetrySample sample_;
+
+  /**
+   * \brief Sums of the values in the current window.
+   */
+  std::vector<double> sums_;
+
+  /**
+   * \brief Buffer for serializing multicast datagrams.
+   */
+  std::vector<char> datagram_;
+
+  /**
+   * \brief Mutex for protecting the subscribers.
+   */
+  boost::mutex subscribers_mutex_;
+
+  /**
+   * \brief The registered subscribers.
+   */
+  std::vector<Subscriber> subscribers_;
+
+  /**
+   * \brief The identifier for the next registered subscriber.
+   */
+  int next_subscriber_id_;
+
+  /**
+   * \brief Boost asio io_service, for the multicast socket.
+   */
+  boost::asio::io_service io_service_;
+
+  /**
+   * \brief Socket for the multicast stream (only created if a multicast address has been specified).
+   */
+  boost::scoped_ptr<boost::asio::ip::udp::socket> p_socket_;
+
+  /**
+   * \brief The multicast group's endpoint.
+   */
+  boost::asio::ip::udp::endpoint endpoint_;
+
+  /**
+   * \brief Background thread for aggregating and publishing the telemetry.
+   */
+  boost::thread publisher_thread_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_TELEMETRY_H
@@ -0,0 +1,176 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_TRAJECTORY_BLENDER_H
+#define EGM_TRAJECTORY_BLENDER_H
+
+#include <vector>
+
+#include "abb_libegm_export.h"
+
+#include "egm_wrapper_trajectory.pb.h" // Generated by Google Protocol Buffer compiler protoc
+
+#include "egm_common.h"
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Class for blending trajectories through points with zones (i.e. without stopping in the points).
+ *
+ * Velocities are computed, ahead of time, for each point that has a zone, so that the motion flows through the
+ * point instead of stopping in it. The velocities are computed per axis, from the mean of the adjacent segments'
+ * average velocities, and they are set to zero if an axis changes direction in the point (i.e. no overshoot is
+ * introduced).
+ *
+ * Note: Only points with zones, with specified durations and with following points (that also have specified
+ *       durations) are blended. Velocities specified by the user are kept.
+ *
+ * Note: A point's zone is only used as a reach radius (i.e. the point is considered reached when every position
+ *       value is within the zone of the goal) and as a flag (i.e. a zone > 0 enables the blending). The zone's
+ *       magnitude does not affect the blended velocities (e.g. a larger zone does not give a wider blend).
+ *
+ * Note: Orientations (in pose mode) are never blended (i.e. only the position velocities are computed), and an
+ *       orientation is only considered reached when it matches the goal exactly (i.e. when the absolute dot product
+ *       of the quaternions is at least 1.0), regardless of the zone.
+ */
+class EGMTrajectoryBlender
+{
+public:
+  /**
+   * \brief Blend a trajectory, that starts from a known state.
+   *
+   * \param start containing the start state (only the positions are used).
+   * \param p_trajectory for the trajectory to blend.
+   *
+   * \return bool indicating if the trajectory was blended or not.
+   */
+  bool blend(const wrapper::trajectory::PointGoal& start, wrapper::trajectory::TrajectoryGoal* p_trajectory);
+
+  /**
+   * \brief Blend a trajectory, that starts from an unknown state.
+   *
+   * Note: The first point is not blended, since the motion towards it depends on the state when it is executed.
+   *
+   * \param p_trajectory for the trajectory to blend.
+   *
+   * \return bool indicating if the trajectory was blended or not.
+   */
+  bool blend(wrapper::trajectory::TrajectoryGoal* p_trajectory);
+
+  /**
+   * \brief Check if a trajectory contains any points with zones.
+   *
+   * \param trajectory containing the trajectory to check.
+   *
+   * \return bool indicating if the trajectory contains any points with zones.
+   */
+  static bool hasZones(const wrapper::trajectory::TrajectoryGoal& trajectory);
+
+private:
+  /**
+   * \brief Blend a trajectory.
+   *
+   * \param p_start containing the start state (null if unknown).
+   * \param p_trajectory for the trajectory to blend.
+   *
+   * \return bool indicating if the trajectory was blended or not.
+   */
+  bool blend(const wrapper::trajectory::PointGoal* p_start, wrapper::trajectory::TrajectoryGoal* p_trajectory);
+
+  /**
+   * \brief Calculate blended velocities for joint values.
+   *
+   * \param p_velocity for storing the velocities.
+   * \param previous containing the preceding positions.
+   * \param current containing the positions to blend through.
+   * \param next containing the following positions.
+   * \param previous_duration specifying the duration [s] of the preceding segment.
+   * \param next_duration specifying the duration [s] of the following segment.
+   */
+  static void blendValues(wrapper::Joints* p_velocity,
+                          const wrapper::Joints& previous,
+                          const wrapper::Joints& current,
+                          const wrapper::Joints& next,
+                          const double previous_duration,
+                          const double next_duration);
+
+  /**
+   * \brief Calculate blended velocities for Cartesian values.
+   *
+   * \param p_velocity for storing the velocities.
+   * \param previous containing the preceding positions.
+   * \param current containing the positions to blend through.
+   * \param next containing the following positions.
+   * \param previous_duration specifying the duration [s] of the preceding segment.
+   * \param next_duration specifying the duration [s] of the following segment.
+   */
+  static void blendValues(wrapper::Cartesian* p_velocity,
+                          const wrapper::Cartesian& previous,
+                          const wrapper::Cartesian& current,
+                          const wrapper::Cartesian& next,
+                          const double previous_duration,
+                          const double next_duration);
+
+  /**
+   * \brief Calculate a blended velocity.
+   *
+   * \param previous containing the preceding position.
+   * \param current containing the position to blend through.
+   * \param next containing the following position.
+   * \param previous_duration specifying the duration [s] of the preceding segment.
+   * \param next_duration specifying the duration [s] of the following segment.
+   *
+   * \return double containing the velocity.
+   */
+  static double blendValue(const double previous,
+                           const double current,
+                           const double next,
+                           const double previous_duration,
+                           const double next_duration);
+
+  /**
+   * \brief Container for the prepared goals (i.e. the points, after they have been completed with the preceding
+   *        points), preceded by the start state.
+   */
+  std::vector<wrapper::trajectory::PointGoal> goals_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_TRAJECTORY_BLENDER_H
@@ -0,0 +1,135 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_TRAJECTORY_GOAL_H
+#define EGM_TRAJECTORY_GOAL_H
+
+#include "egm_wrapper.pb.h"            // Generated by Google Protocol Buffer compiler protoc
+#include "egm_wrapper_trajectory.pb.h" // Generated by Google Protocol Buffer compiler protoc
+
+#include "egm_common.h"
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Auxiliary functions for preparing trajectory goals, shared by the trajectory motion generation and by the
+ *        offline trajectory tools (i.e. the previewer, the retimer and the blender).
+ *
+ * The current state is either an EGM session's feedback, or an interpolated state (for offline evaluations).
+ *
+ * Note: The goals' Euler fields are used to contain angular velocities.
+ */
+
+/**
+ * \brief Initialize a goal from a start state (i.e. copy the positions and reset the velocities and accelerations).
+ *
+ * \param p_goal for the goal to initialize.
+ * \param start containing the start state.
+ */
+void initializeGoal(wrapper::trajectory::PointGoal* p_goal, const wrapper::trajectory::PointGoal& start);
+
+/**
+ * \brief Reset a goal's velocities and accelerations.
+ *
+ * \param p_goal for the goal to reset.
+ * \param robot_joints specifying the number of robot joints.
+ * \param external_joints specifying the number of external joints.
+ */
+void resetGoalMotion(wrapper::trajectory::PointGoal* p_goal,
+                     const unsigned int robot_joints,
+                     const unsigned int external_joints);
+
+/**
+ * \brief Prepare a goal, with values from a trajectory point.
+ *
+ * Note: If the point has no duration, then the duration is estimated from the position differences (assuming
+ *       1 degree/s and 1 mm/s as desired velocities), and the goal's velocities and accelerations are reset.
+ *
+ * \param p_goal for the goal to prepare (absent values are kept from the preceding goal).
+ * \param point containing the trajectory point.
+ * \param current containing the current state (i.e. the feedback).
+ * \param last_point indicating if it is the trajectory's last point (i.e. if the motion should stop in the point).
+ */
+void prepareGoal(wrapper::trajectory::PointGoal* p_goal,
+                 const wrapper::trajectory::PointGoal& point,
+                 const wrapper::Feedback& current,
+                 const bool last_point);
+
+/**
+ * \brief Prepare a goal, with values from a trajectory point.
+ *
+ * \param p_goal for the goal to prepare (absent values are kept from the preceding goal).
+ * \param point containing the trajectory point.
+ * \param current containing the current (interpolated) state.
+ * \param last_point indicating if it is the trajectory's last point (i.e. if the motion should stop in the point).
+ */
+void prepareGoal(wrapper::trajectory::PointGoal* p_goal,
+                 const wrapper::trajectory::PointGoal& point,
+                 const wrapper::trajectory::PointGoal& current,
+                 const bool last_point);
+
+/**
+ * \brief Check if a goal's positions have been reached (within the goal's zone, or a small default condition).
+ *
+ * Note: Orientations are only considered reached when they match exactly.
+ *
+ * \param goal containing the goal.
+ * \param current containing the current state (i.e. the feedback).
+ * \param mode specifying the goal's mode.
+ *
+ * \return bool indicating if the goal has been reached.
+ */
+bool isGoalReached(const wrapper::trajectory::PointGoal& goal, const wrapper::Feedback& current, const EGMModes mode);
+
+/**
+ * \brief Check if a goal's positions have been reached (within the goal's zone, or a small default condition).
+ *
+ * \param goal containing the goal.
+ * \param current containing the current (interpolated) state.
+ * \param mode specifying the goal's mode.
+ *
+ * \return bool indicating if the goal has been reached.
+ */
+bool isGoalReached(const wrapper::trajectory::PointGoal& goal,
+                   const wrapper::trajectory::PointGoal& current,
+                   const EGMModes mode);
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_TRAJECTORY_GOAL_H
@@ -0,0 +1,192 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_TRAJECTORY_GROUP_H
+#define EGM_TRAJECTORY_GROUP_H
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "egm_start_barrier.h"
+#include "egm_trajectory_interface.h"
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Class for coordinating a group of EGM trajectory interfaces (e.g. for the robots in a multi-robot cell).
+ *
+ * The class provides behavior for:
+ * - Adding one trajectory per member, where the trajectories are started in lockstep. I.e. each member waits until
+ *   all members are ready to start, and they then start at their messages closest to a common release time (the
+ *   message times are estimated via each robot controller's clock relation).
+ * - Stopping, resuming and updating the duration factor for all members, with one call.
+ *
+ * Each member keeps running its own EGM communication loop (i.e. the per-robot evaluation runs in parallel, e.g.
+ * with one io_service thread per member), and the group never blocks any of the loops.
+ *
+ * Note: The group commands are serialized, and if any member rejects a synchronized trajectory, then it is
+ *       discarded by all members (i.e. none of the members start it).
+ */
+class EGMTrajectoryGroup
+{
+public:
+  /**
+   * \brief Default constructor.
+   */
+  EGMTrajectoryGroup();
+
+  /**
+   * \brief Add a member to the group.
+   *
+   * Note: The member must outlive the group.
+   *
+   * \param p_member for the member to add.
+   *
+   * \return bool indicating if the member was added or not (e.g. false if it is already a member).
+   */
+  bool addMember(EGMTrajectoryInterface* p_member);
+
+  /**
+   * \brief Retrieve the number of members in the group.
+   *
+   * \return size_t containing the number of members.
+   */
+  size_t numberOfMembers();
+
+  /**
+   * \brief Add one trajectory per member (in the order the members were added), which are started in lockstep.
+   *
+   * Note: All members' trajectories are validated (see EGMTrajectoryInterface::validateTrajectory) before any of them
+   *       is queued, so a rejected command leaves the members' pending trajectories as they were.
+   *
+   * \param trajectories containing the trajectories to add.
+   * \param override_trajectories indicating if all pending trajectories should be overridden (i.e. removed).
+   * \param start_delay specifying the min delay [s] before the trajectories are started.
+   *
+   * \return bool indicating if all members accepted the command or not.
+   */
+  bool addTrajectories(const std::vector<wrapper::trajectory::TrajectoryGoal>& trajectories,
+                       const bool override_trajectories = false,
+                       const double start_delay = 0.0);
+
+  /**
+   * \brief Add one shared trajectory per member (in the order the members were added), which are started in lockstep.
+   *
+   * Note: All members' trajectories are validated (see EGMTrajectoryInterface::validateTrajectory) before any of them
+   *       is queued, so a rejected command leaves the members' pending trajectories as they were.
+   *
+   * \param trajectories containing the trajectories to add.
+   * \param override_trajectories indicating if all pending trajectories should be overridden (i.e. removed).
+   * \param start_delay specifying the min delay [s] before the trajectories are started.
+   *
+   * \return bool indicating if all members accepted the command or not.
+   */
+  bool addTrajectories(const std::vector<boost::shared_ptr<const wrapper::trajectory::TrajectoryGoal> >& trajectories,
+                       const bool override_trajectories = false,
+                       const double start_delay = 0.0);
+
+  /**
+   * \brief Stop the trajectory motion execution for all members.
+   *
+   * Note: If the trajectories are discarded, then any synchronized trajectories that have not yet been started are
+   *       also discarded by the members.
+   *
+   * \param discard_trajectories indicating if all pending trajectories should be discarded (i.e. removed).
+   *
+   * \return bool indicating if all members accepted the command or not.
+   */
+  bool stopTrajectories(const bool discard_trajectories = false);
+
+  /**
+   * \brief Resume the trajectory motion execution for all members (after a stop has occurred).
+   *
+   * \return bool indicating if all members accepted the command or not.
+   */
+  bool resumeTrajectories();
+
+  /**
+   * \brief Update the duration scaling factor for all members.
+   *
+   * Note: Applied by each member at its next message.
+   *
+   * \param factor containing the new scale factor.
+   *
+   * \return bool indicating if all members accepted the command or not.
+   */
+  bool updateDurationFactor(const double factor);
+
+private:
+  /**
+   * \brief Estimate the lead time for a new barrier, i.e. the longest estimated sample time among the members.
+   *
+   * \return double containing the lead time [s].
+   */
+  double estimateLeadTime();
+
+  /**
+   * \brief Remove the barriers that have been released or cancelled.
+   */
+  void pruneBarriers();
+
+  /**
+   * \brief Static constant for the max number of attempts, when retrieving a member's clock estimate.
+   */
+  static const unsigned int MAX_ESTIMATE_ATTEMPTS = 10;
+
+  /**
+   * \brief The group's members.
+   */
+  std::vector<EGMTrajectoryInterface*> members_;
+
+  /**
+   * \brief The barriers that have not yet been released or cancelled.
+   */
+  std::vector<boost::shared_ptr<EGMStartBarrier> > barriers_;
+
+  /**
+   * \brief Mutex for serializing the group commands.
+   */
+  boost::mutex mutex_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_TRAJECTORY_GROUP_H
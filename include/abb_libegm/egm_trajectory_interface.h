@@ -37,7 +37,9 @@
 #ifndef EGM_TRAJECTORY_INTERFACE_H
 #define EGM_TRAJECTORY_INTERFACE_H
 
+#include <cmath>
 #include <queue>
+#include <vector>
 
 #include "abb_libegm_export.h"
 
@@ -46,6 +48,10 @@
 #include "egm_base_interface.h"
 #include "egm_common.h"
 #include "egm_interpolator.h"
+#include "egm_ring_buffer.h"
+#include "egm_seqlock.h"
+#include "egm_snapshot_publisher.h"
+#include "egm_start_barrier.h"
 
 namespace abb
 {
@@ -62,6 +68,140 @@ namespace egm
 class EGMTrajectoryInterface : public EGMBaseInterface
 {
 public:
+  /**
+   * \brief Struct for the status of the point stream (e.g. used to apply back-pressure when streaming points).
+   */
+  struct StreamStatus
+  {
+    /**
+     * \brief Default constructor.
+     */
+    StreamStatus()
+    :
+    capacity(0),
+    number_of_points(0),
+    queued_duration(0.0),
+    estimated_time_remaining(0.0),
+    active(false)
+    {}
+
+    /**
+     * \brief The max number of points that can be buffered.
+     */
+    size_t capacity;
+
+    /**
+     * \brief The number of currently buffered points.
+     */
+    size_t number_of_points;
+
+    /**
+     * \brief The sum of the buffered points' specified durations [s] (points without durations are not included).
+     */
+    double queued_duration;
+
+    /**
+     * \brief Estimated time [s] until the stream runs dry (i.e. including the remaining time of the active point).
+     */
+    double estimated_time_remaining;
+
+    /**
+     * \brief Flag indicating if points are currently being executed from the stream.
+     */
+    bool active;
+  };
+
+  /**
+   * \brief Struct for a lightweight execution progress snapshot (retrievable without blocking the EGM loop).
+   */
+  struct ProgressSnapshot
+  {
+    /**
+     * \brief Default constructor.
+     */
+    ProgressSnapshot();
+
+    /**
+     * \brief Static constant for the max number of joint values in a snapshot.
+     */
+    static const unsigned int MAX_NUMBER_OF_JOINTS = 12;
+
+    /**
+     * \brief Number of the snapshot (increased for every published snapshot, i.e. for every EGM message).
+     */
+    boost::uint32_t sequence_number;
+
+    /**
+     * \brief The interface's execution state.
+     */
+    wrapper::trajectory::ExecutionProgress_State state;
+
+    /**
+     * \brief The interface's execution sub state.
+     */
+    wrapper::trajectory::ExecutionProgress_SubState sub_state;
+
+    /**
+     * \brief Flag indicating if there is an active goal.
+     */
+    bool goal_active;
+
+    /**
+     * \brief Index of the active goal's point, in the active trajectory (-1 if the goal is not from a trajectory).
+     */
+    int point_index;
+
+    /**
+     * \brief Number of remaining points in the active trajectory (or in the point stream).
+     */
+    unsigned int remaining_points;
+
+    /**
+     * \brief Number of pending trajectories.
+     */
+    unsigned int pending_trajectories;
+
+    /**
+     * \brief Time [s] passed, for the active goal.
+     */
+    double time_passed;
+
+    /**
+     * \brief Duration [s] of the active goal.
+     */
+    double duration;
+
+    /**
+     * \brief Number of valid robot joint values in the goal.
+     */
+    unsigned int number_of_robot_joints;
+
+    /**
+     * \brief The goal's robot joint positions [degrees].
+     */
+    double robot_joints[MAX_NUMBER_OF_JOINTS];
+
+    /**
+     * \brief The goal's Cartesian position (x, y and z) [mm].
+     */
+    double cartesian_position[3];
+
+    /**
+     * \brief The goal's Cartesian orientation (quaternion u0, u1, u2 and u3).
+     */
+    double cartesian_quaternion[4];
+
+    /**
+     * \brief Number of valid external joint values in the goal.
+     */
+    unsigned int number_of_external_joints;
+
+    /**
+     * \brief The goal's external joint positions [degrees or mm].
+     */
+    double external_joints[MAX_NUMBER_OF_JOINTS];
+  };
+
   /**
    * \brief A constructor.
    *
@@ -73,6 +213,13 @@ public:
                          const unsigned short port_number,
                          const TrajectoryConfiguration& configuration = TrajectoryConfiguration());
 
+  /**
+   * \brief A destructor.
+   *
+   * Note: Stops the underlying server, before any of the interface's members are destroyed.
+   */
+  ~EGMTrajectoryInterface();
+
   /**
    * \brief Retrive the interface's current configuration.
    *
@@ -81,7 +228,10 @@ public:
   TrajectoryConfiguration getConfiguration();
 
   /**
-   * \brief Update the interface's configuration (update is only applied for new EGM communication sessions).
+   * \brief Update the interface's configuration.
+   *
+   * Note: The runtime parameters (see TrajectoryConfiguration) are applied from the next received message, and the
+   *       session parameters are applied when the next EGM communication session starts.
    *
    * \param configuration containing the configuration update.
    */
@@ -90,12 +240,105 @@ public:
   /**
    * \brief Add a trajectory to the execution queue.
    *
+   * Note: The trajectory is copied (before any internal locks are acquired). Use the overloads below to avoid that.
+   *
    * \param trajectory containing the trajectory to add.
    * \param override_trajectories indicating if all pending trajectories should be overridden (i.e. removed).
    *
    * \return bool indicating if the interface accepted the command or not.
    */
-  bool addTrajectory(const wrapper::trajectory::TrajectoryGoal trajectory, const bool override_trajectories = false);
+  bool addTrajectory(const wrapper::trajectory::TrajectoryGoal& trajectory, const bool override_trajectories = false);
+
+  /**
+   * \brief Add a trajectory to the execution queue, by moving its points instead of copying them.
+   *
+   * Note: The points are swapped into an internal shared trajectory, so the provided trajectory is empty afterwards.
+   *
+   * \param p_trajectory for the trajectory to add (cleared afterwards).
+   * \param override_trajectories indicating if all pending trajectories should be overridden (i.e. removed).
+   *
+   * \return bool indicating if the interface accepted the command or not.
+   */
+  bool addTrajectory(wrapper::trajectory::TrajectoryGoal* p_trajectory, const bool override_trajectories = false);
+
+  /**
+   * \brief Add a shared trajectory to the execution queue, without copying any of its points.
+   *
+   * Note: The trajectory must not be modified after it has been added. E.g. use TrajectoryGoal::Swap to transfer
+   *       the points of an already built trajectory into the shared trajectory.
+   *
+   * Note: If retiming has been configured, or if any point has a zone, then a retimed and/or blended copy of the
+   *       trajectory is added instead. The first point is kept as it is, since the motion towards it depends on the
+   *       robot's state when it is executed.
+   *
+   * \param p_trajectory containing the trajectory to add.
+   * \param override_trajectories indicating if all pending trajectories should be overridden (i.e. removed).
+   *
+   * \return bool indicating if the interface accepted the command or not.
+   */
+  bool addTrajectory(const boost::shared_ptr<const wrapper::trajectory::TrajectoryGoal>& p_trajectory,
+                     const bool override_trajectories = false);
+
+  /**
+   * \brief Add a shared trajectory to the execution queue, which is started in sync with other interfaces.
+   *
+   * Note: The trajectory is not started before all interfaces, sharing the barrier, are ready to start their
+   *       synchronized trajectories. It is discarded if the barrier is cancelled before then. See the
+   *       EGMTrajectoryGroup class, which manages the barriers for a group of interfaces.
+   *
+   * \param p_trajectory containing the trajectory to add.
+   * \param p_barrier for aligning the trajectory's start with the other interfaces.
+   * \param override_trajectories indicating if all pending trajectories should be overridden (i.e. removed).
+   *
+   * \return bool indicating if the interface accepted the command or not.
+   */
+  bool addSynchronizedTrajectory(const boost::shared_ptr<const wrapper::trajectory::TrajectoryGoal>& p_trajectory,
+                                 const boost::shared_ptr<EGMStartBarrier>& p_barrier,
+                                 const bool override_trajectories = false);
+
+  /**
+   * \brief Validate a trajectory, without adding it.
+   *
+   * I.e. check that the interface currently accepts trajectories, and that the trajectory's joint goals have the same
+   * number of joints as the robot (and the external axes), and that it only has Cartesian goals if the robot has
+   * any robot axes.
+   *
+   * \param trajectory containing the trajectory to validate.
+   *
+   * \return bool indicating if the trajectory is valid or not.
+   */
+  bool validateTrajectory(const wrapper::trajectory::TrajectoryGoal& trajectory);
+
+  /**
+   * \brief Push a point to the point stream.
+   *
+   * Streamed points are executed when no queued trajectory is active, and the stream remains active until it runs
+   * dry. If the stream runs dry, then the last executed point is treated as the last point of a trajectory (i.e. the
+   * robot stops at it). Discarding trajectories also discards any buffered points.
+   *
+   * Note: Lock-free, and intended to be called from one thread at a time (calls are serialized otherwise).
+   *
+   * \param point containing the point to push.
+   *
+   * \return bool indicating if the point was pushed or not (i.e. false if the stream is full).
+   */
+  bool pushPoint(const wrapper::trajectory::PointGoal& point);
+
+  /**
+   * \brief Push points to the point stream (in order, until the stream is full).
+   *
+   * \param trajectory containing the points to push.
+   *
+   * \return size_t containing the number of pushed points.
+   */
+  size_t pushPoints(const wrapper::trajectory::TrajectoryGoal& trajectory);
+
+  /**
+   * \brief Retrieve the status of the point stream.
+   *
+   * \return StreamStatus containing the status.
+   */
+  StreamStatus getStreamStatus();
 
   /**
    * \brief Stop the trajectory motion execution.
@@ -177,6 +420,44 @@ public:
    */
   bool retrieveExecutionProgress(wrapper::trajectory::ExecutionProgress* p_execution_progress);
 
+  /**
+   * \brief Retrieve an execution progress from the trajectory interface, without copying the active trajectory's
+   *        remaining points.
+   *
+   * Note: The remaining points are instead provided as the shared points of the active trajectory, together with the
+   *       index of the first remaining point. The shared points are never modified.
+   *
+   * \param p_execution_progress for containing the execution progress (without the remaining points).
+   * \param p_points for containing the active trajectory's points (a null pointer if there are none).
+   * \param p_first_remaining_point for containing the index of the first remaining point.
+   *
+   * \return bool indicating if the execution progress has been successfully retrieved or not.
+   */
+  bool retrieveExecutionProgress(wrapper::trajectory::ExecutionProgress* p_execution_progress,
+                                 boost::shared_ptr<const wrapper::trajectory::TrajectoryGoal>* p_points,
+                                 int* p_first_remaining_point);
+
+  /**
+   * \brief Release the finished (or discarded) trajectories, that the EGM communication loop has retired.
+   *
+   * Note: This is also done when trajectories are added or stopped, and when the execution progress is retrieved.
+   *       The EGM communication loop never releases any trajectories itself, since that would deallocate memory.
+   */
+  void releaseRetiredTrajectories();
+
+  /**
+   * \brief Retrieve the latest execution progress snapshot.
+   *
+   * Note: Wait-free, and it never blocks the EGM communication loop. Use TrajectoryConfiguration::p_progress_cv to
+   *       get notified about progress changes, instead of polling.
+   *
+   * \param p_snapshot for containing the snapshot.
+   *
+   * \return bool indicating if a snapshot was retrieved (false if none has been published yet, or if the attempt
+   *         overlapped with a publication, in which case it can simply be retried).
+   */
+  bool retrieveProgressSnapshot(ProgressSnapshot* p_snapshot);
+
 private:
   /**
    * \brief Struct for containing the configuration data.
@@ -190,34 +471,55 @@ private:
      */
     ConfigurationContainer(const TrajectoryConfiguration& initial)
     :
-    active(initial),
-    update(initial),
-    has_pending_update(false)
+    p_active(new TrajectoryConfiguration(initial)),
+    snapshots(initial),
+    has_pending_update(false),
+    has_prepared_update(false)
     {}
 
     /**
      * \brief The active configuration.
+     *
+     * Note: Only accessed by the EGM communication loop (after construction). Replaced by swapping it with the
+     *       prepared configuration, so that the EGM communication loop never copies a full configuration.
      */
-    TrajectoryConfiguration active;
+    boost::shared_ptr<TrajectoryConfiguration> p_active;
 
     /**
-     * \brief The configuration update.
+     * \brief The published configuration snapshots (i.e. the most recently requested configuration).
      */
-    TrajectoryConfiguration update;
+    SnapshotPublisher<TrajectoryConfiguration> snapshots;
 
     /**
-     * \brief Flag indicating if the active configuration should be updated.
+     * \brief Flag indicating if the active configuration has session parameters that should be updated, when the
+     *        next EGM communication session starts.
      */
     bool has_pending_update;
 
     /**
-     * \brief Mutex for protecting the configuration.
+     * \brief A copy of the most recently requested configuration, prepared by a user thread for the next session.
+     *
+     * Note: Holds the previously active configuration after a swap, which is then released by a user thread.
+     */
+    boost::shared_ptr<TrajectoryConfiguration> p_prepared;
+
+    /**
+     * \brief Mutex for protecting the prepared configuration (only try-locked by the EGM communication loop).
      */
-    boost::mutex mutex;
+    boost::mutex prepared_mutex;
+
+    /**
+     * \brief Flag indicating if the prepared configuration has not yet been swapped in (protected by the mutex).
+     */
+    bool has_prepared_update;
   };
 
   /**
    * \brief Class for managing the points, in a trajectory, that the robot should pass through.
+   *
+   * The points are shared (and never modified), and a cursor keeps track of the next point to retrive. Points added
+   * to the front of the queue (e.g. an interrupted goal) are stored separately. Duration dependent interpolation
+   * values can optionally be precomputed, and cached alongside the shared points.
    */
   class Trajectory
   {
@@ -225,77 +527,147 @@ private:
     /**
      * \brief Default constructor.
      */
-    Trajectory() {}
+    Trajectory()
+    :
+    index_(0),
+    has_arrived_(false)
+    {}
 
     /**
      * \brief A constructor.
      *
-     * param trajectory for a trajectory to parse.
+     * \param p_trajectory for the trajectory's (shared) points.
+     * \param p_barrier for aligning the trajectory's start with other interfaces (a null pointer if not used).
      */
-    Trajectory(const wrapper::trajectory::TrajectoryGoal& trajectory)
+    Trajectory(const boost::shared_ptr<const wrapper::trajectory::TrajectoryGoal>& p_trajectory,
+               const boost::shared_ptr<EGMStartBarrier>& p_barrier = boost::shared_ptr<EGMStartBarrier>())
+    :
+    p_points_(p_trajectory),
+    index_(0),
+    p_barrier_(p_barrier),
+    has_arrived_(false)
+    {}
+
+    /**
+     * \brief Check if the trajectory can be started, i.e. if any start barrier has been passed.
+     *
+     * Note: The first call marks the interface as ready at the barrier.
+     *
+     * \param message_time specifying the (host clock) time of the current message.
+     * \param sample_time specifying the estimated sample time [s].
+     *
+     * \return EGMStartBarrier::Status containing the status (released if the trajectory has no barrier).
+     */
+    EGMStartBarrier::Status passStartBarrier(const boost::chrono::steady_clock::time_point& message_time,
+                                             const double sample_time)
     {
-      for (int i = 0; i < trajectory.points_size(); ++i)
+      if (!p_barrier_)
       {
-        addTrajectoryPointBack(trajectory.points().Get(i));
+        return EGMStartBarrier::Released;
       }
+
+      if (!has_arrived_)
+      {
+        p_barrier_->arrive(message_time);
+        has_arrived_ = true;
+      }
+
+      return p_barrier_->status(message_time, sample_time);
     }
 
     /**
-     * \brief Add a point to the front of the queue.
+     * \brief Precompute, and cache, the duration dependent interpolation values for the shared points.
      *
-     * \param point to store.
+     * Note: Points without a specified duration are not cached, since their durations are estimated during
+     *       the execution.
+     *
+     * \param duration_factor specifying the expected duration scale factor.
      */
-    void addTrajectoryPointFront(const wrapper::trajectory::PointGoal& point)
+    void precomputeTimings(const double duration_factor)
     {
-      points_.push_front(point);
+      timings_.clear();
+
+      if (p_points_)
+      {
+        timings_.reserve(p_points_->points_size());
+
+        for (int i = 0; i < p_points_->points_size(); ++i)
+        {
+          const wrapper::trajectory::PointGoal& point = p_points_->points(i);
+
+          timings_.push_back(point.has_duration() ? EGMInterpolator::Timing(duration_factor*point.duration()) :
+                                                    EGMInterpolator::Timing());
+        }
+      }
     }
 
     /**
-     * \brief Add a point to the back of the queue.
+     * \brief Add a point to the front of the queue.
      *
      * \param point to store.
      */
-    void addTrajectoryPointBack(const wrapper::trajectory::PointGoal& point)
+    void addTrajectoryPointFront(const wrapper::trajectory::PointGoal& point)
     {
-      points_.push_back(point);
+      front_points_.push_front(point);
     }
 
     /**
      * \brief Retrive a point from the queue.
      *
      * \param p_point for storing the retrived point.
+     * \param p_timing for storing the point's precomputed interpolation values (default values if not cached).
      *
      * \return bool indicating if a point was retrived or not.
      */
-    bool retriveNextTrajectoryPoint(wrapper::trajectory::PointGoal* p_point)
+    bool retriveNextTrajectoryPoint(wrapper::trajectory::PointGoal* p_point, EGMInterpolator::Timing* p_timing)
     {
       bool result = false;
 
-      if (p_point && !points_.empty())
+      if (p_point && p_timing)
       {
-        p_point->CopyFrom(points_.front());
-        points_.pop_front();
-        result = true;
+        if (!front_points_.empty())
+        {
+          p_point->Swap(&front_points_.front());
+          front_points_.pop_front();
+          *p_timing = EGMInterpolator::Timing();
+          result = true;
+        }
+        else if (p_points_ && index_ < p_points_->points_size())
+        {
+          *p_timing = ((size_t) index_ < timings_.size() ? timings_[index_] : EGMInterpolator::Timing());
+          p_point->CopyFrom(p_points_->points(index_++));
+          result = true;
+        }
       }
 
       return result;
     }
 
     /**
-     * \brief Copy the whole queue to a trajectory container.
+     * \brief Copy the points, added to the front of the queue, to a trajectory container, and retrive the
+     *        remaining (shared) points.
      *
-     * \param p_trajectory for containing the queue.
+     * Note: The remaining points are not copied, which allows them to be copied later (e.g. outside of any locks).
+     *
+     * \param p_trajectory for containing the points added to the front of the queue.
+     * \param p_remaining_points for containing the remaining (shared) points.
+     * \param p_remaining_index for containing the index of the first remaining point.
      */
-    void copyTo(wrapper::trajectory::TrajectoryGoal* p_trajectory)
+    void copyTo(wrapper::trajectory::TrajectoryGoal* p_trajectory,
+                boost::shared_ptr<const wrapper::trajectory::TrajectoryGoal>* p_remaining_points,
+                int* p_remaining_index)
     {
       std::deque<wrapper::trajectory::PointGoal>::const_iterator i;
 
-      if (p_trajectory)
+      if (p_trajectory && p_remaining_points && p_remaining_index)
       {
-        for (i = points_.begin(); i != points_.end(); ++i)
+        for (i = front_points_.begin(); i != front_points_.end(); ++i)
         {
           p_trajectory->add_points()->CopyFrom(*i);
         }
+
+        *p_remaining_points = p_points_;
+        *p_remaining_index = index_;
       }
     }
 
@@ -306,14 +678,86 @@ private:
      */
     size_t size()
     {
-      return points_.size();
+      return front_points_.size() + (p_points_ ? (size_t) (p_points_->points_size() - index_) : 0);
+    }
+
+    /**
+     * \brief Retrive the index, in the shared points, of the most recently retrived point.
+     *
+     * \return int containing the index (-1 if no shared point has been retrived).
+     */
+    int lastIndex() const
+    {
+      return p_points_ ? index_ - 1 : -1;
     }
 
   private:
     /**
-     * \brief Container for the points in the trajectory.
+     * \brief Container for points added to the front of the queue.
+     */
+    std::deque<wrapper::trajectory::PointGoal> front_points_;
+
+    /**
+     * \brief The trajectory's shared points.
+     */
+    boost::shared_ptr<const wrapper::trajectory::TrajectoryGoal> p_points_;
+
+    /**
+     * \brief Index of the next point to retrive, in the shared points.
      */
-    std::deque<wrapper::trajectory::PointGoal> points_;
+    int index_;
+
+    /**
+     * \brief Precomputed interpolation values for the shared points (empty if not precomputed).
+     */
+    std::vector<EGMInterpolator::Timing> timings_;
+
+    /**
+     * \brief Barrier for aligning the trajectory's start with other interfaces (a null pointer if not used).
+     */
+    boost::shared_ptr<EGMStartBarrier> p_barrier_;
+
+    /**
+     * \brief Flag indicating if the interface has been marked as ready at the barrier.
+     */
+    bool has_arrived_;
+  };
+
+  /**
+   * \brief Struct for containing the runtime parameters that are used by the trajectory motion.
+   *
+   * Note: A plain copy of the corresponding TrajectoryConfiguration fields, so that the EGM communication loop can
+   *       update it without any allocations or reference counting. The condition variable is owned by the active
+   *       configuration.
+   */
+  struct RuntimeConfiguration
+  {
+    /**
+     * \brief A constructor.
+     *
+     * \param configuration specifying the configuration to take the runtime parameters from.
+     */
+    explicit RuntimeConfiguration(const TrajectoryConfiguration& configuration)
+    :
+    spline_method(configuration.spline_method),
+    use_predictive_outputs(configuration.use_predictive_outputs),
+    p_progress_cv(configuration.p_progress_cv.get())
+    {}
+
+    /**
+     * \brief Value specifying which spline method to use in the interpolation.
+     */
+    TrajectoryConfiguration::SplineMethod spline_method;
+
+    /**
+     * \brief Flag indicating if the next interpolation should be predicted, right after a reply has been sent.
+     */
+    bool use_predictive_outputs;
+
+    /**
+     * \brief Optional condition variable for notifying external threads that the execution progress has changed.
+     */
+    boost::condition_variable* p_progress_cv;
   };
 
   /**
@@ -332,15 +776,16 @@ private:
     DURATION_FACTOR_MIN(1.0),
     DURATION_FACTOR_MAX(5.0),
     configurations_(configurations),
-    motion_step_(configurations)
+    motion_step_(RuntimeConfiguration(configurations)),
+    stream_(configurations.stream_capacity)
     {}
 
     /**
-     * \brief Update the interface's configurations.
+     * \brief Update the interface's runtime configurations.
      *
-     * \param configurations specifying the interface's new configurations.
+     * \param configurations specifying the interface's new runtime configurations.
      */
-    void updateConfigurations(const TrajectoryConfiguration& configurations)
+    void updateConfigurations(const RuntimeConfiguration& configurations)
     {
       configurations_ = configurations;
       motion_step_.updateConfigurations(configurations);
@@ -354,15 +799,37 @@ private:
      */
     void generateOutputs(wrapper::Output* p_outputs, const InputContainer& inputs);
 
+    /**
+     * \brief Predict the next outputs' interpolation, ahead of the next message.
+     *
+     * Note: Should only be called in the EGM communication loop, after a reply has been sent. The data mutex is
+     *       locked, since the motion step's data is shared with the user threads.
+     */
+    void predictOutputs();
+
     /**
      * \brief Add a trajectory to the execution queue.
      *
      * \param trajectory containing the trajectory to add.
      * \param override_trajectories indicating if all pending trajectories should be overridden (i.e. removed).
+     * \param use_segment_cache indicating if duration dependent interpolation values should be precomputed.
+     * \param p_barrier for aligning the trajectory's start with other interfaces (a null pointer if not used).
      *
      * \return bool indicating if the interface accepted the command or not.
      */
-    bool addTrajectory(const wrapper::trajectory::TrajectoryGoal& trajectory, const bool override_trajectories);
+    bool addTrajectory(const boost::shared_ptr<const wrapper::trajectory::TrajectoryGoal>& p_trajectory,
+                       const bool override_trajectories,
+                       const bool use_segment_cache,
+                       const boost::shared_ptr<EGMStartBarrier>& p_barrier);
+
+    /**
+     * \brief Validate a trajectory, i.e. check if it would currently be accepted and if it fits the robot.
+     *
+     * \param trajectory containing the trajectory to validate.
+     *
+     * \return bool indicating if the trajectory is valid or not.
+     */
+    bool validateTrajectory(const wrapper::trajectory::TrajectoryGoal& trajectory);
 
     /**
      * \brief Stop the trajectory motion execution.
@@ -443,6 +910,58 @@ private:
      */
     bool retrieveExecutionProgress(wrapper::trajectory::ExecutionProgress* p_progress);
 
+    /**
+     * \brief Retrieve an execution progress, without copying the active trajectory's remaining points.
+     *
+     * \param p_progress for containing the execution progress (without the remaining points).
+     * \param p_points for containing the active trajectory's shared points.
+     * \param p_index for containing the index of the first remaining point.
+     *
+     * \return bool indicating if the execution progress has been recently updated or not.
+     */
+    bool retrieveExecutionProgress(wrapper::trajectory::ExecutionProgress* p_progress,
+                                   boost::shared_ptr<const wrapper::trajectory::TrajectoryGoal>* p_points,
+                                   int* p_index);
+
+    /**
+     * \brief Release the retired trajectories (outside of the lock), and reserve room for new retirements.
+     */
+    void releaseRetiredTrajectories();
+
+    /**
+     * \brief Retrieve the latest execution progress snapshot (wait-free).
+     *
+     * \param p_snapshot for containing the snapshot.
+     *
+     * \return bool indicating if a snapshot was retrieved or not.
+     */
+    bool retrieveProgressSnapshot(ProgressSnapshot* p_snapshot) const;
+
+    /**
+     * \brief Push a point to the point stream.
+     *
+     * \param point containing the point to push.
+     *
+     * \return bool indicating if the point was pushed or not (i.e. false if the stream is full).
+     */
+    bool pushPoint(const wrapper::trajectory::PointGoal& point);
+
+    /**
+     * \brief Push points to the point stream (in order, until the stream is full).
+     *
+     * \param trajectory containing the points to push.
+     *
+     * \return size_t containing the number of pushed points.
+     */
+    size_t pushPoints(const wrapper::trajectory::TrajectoryGoal& trajectory);
+
+    /**
+     * \brief Retrieve the status of the point stream.
+     *
+     * \return StreamStatus containing the status.
+     */
+    StreamStatus getStreamStatus();
+
   private:
     /**
      * \brief Enum for the different execution states the interface can handle.
@@ -565,7 +1084,8 @@ private:
       :
       has_new_goal(false),
       has_active_goal(false),
-      has_updated_execution_progress(false)
+      has_updated_execution_progress(false),
+      progress_points_index(0)
       {}
 
       /**
@@ -595,6 +1115,18 @@ private:
        */
       wrapper::trajectory::ExecutionProgress execution_progress;
 
+      /**
+       * \brief The active trajectory's remaining (shared) points.
+       *
+       * Note: These are added to the execution progress when it is retrived (i.e. outside of the EGM callback).
+       */
+      boost::shared_ptr<const wrapper::trajectory::TrajectoryGoal> p_progress_points;
+
+      /**
+       * \brief Index of the first remaining point, in the active trajectory's shared points.
+       */
+      int progress_points_index;
+
       /**
        * \brief Mutex for protecting the data.
        */
@@ -621,12 +1153,85 @@ private:
        */
       boost::shared_ptr<Trajectory> p_current;
 
+      /**
+       * \brief Finished (or discarded) trajectories.
+       *
+       * Note: Kept so that they are released by a user thread (when adding, stopping or retrieving progress), and
+       *       not by the EGM communication loop. The capacity is reserved by the user thread, so that retiring never
+       *       allocates.
+       */
+      std::vector<boost::shared_ptr<Trajectory> > retired;
+
       /**
        * \brief Mutex for protecting the data.
        */
       boost::mutex mutex;
     };
 
+    /**
+     * \brief Container for streamed points.
+     *
+     * Note: The ring buffer is filled by the user thread(s) and consumed by the EGM communication loop,
+     *       the remaining fields (except the atomic ones) are only accessed by the EGM communication loop.
+     */
+    struct StreamContainer
+    {
+      /**
+       * \brief A constructor.
+       *
+       * \param capacity specifying the max number of points that can be buffered.
+       */
+      StreamContainer(const size_t capacity)
+      :
+      points(capacity),
+      has_front_goal(false),
+      is_active(false),
+      pushed_duration_us(0),
+      consumed_duration_us(0),
+      active_remaining_us(0)
+      {}
+
+      /**
+       * \brief Ring buffer for the streamed points.
+       */
+      RingBuffer<wrapper::trajectory::PointGoal> points;
+
+      /**
+       * \brief An interrupted stream goal (e.g. by a stop), to execute before any further streamed points.
+       */
+      wrapper::trajectory::PointGoal front_goal;
+
+      /**
+       * \brief Flag indicating if there is an interrupted stream goal.
+       */
+      bool has_front_goal;
+
+      /**
+       * \brief Flag indicating if the current goal was retrived from the stream.
+       */
+      boost::atomic<bool> is_active;
+
+      /**
+       * \brief Sum of the specified durations [us] of all pushed points.
+       */
+      boost::atomic<boost::uint64_t> pushed_duration_us;
+
+      /**
+       * \brief Sum of the specified durations [us] of all consumed points.
+       */
+      boost::atomic<boost::uint64_t> consumed_duration_us;
+
+      /**
+       * \brief Remaining duration [us] of the active stream goal.
+       */
+      boost::atomic<boost::uint64_t> active_remaining_us;
+
+      /**
+       * \brief Mutex for serializing producers (the ring buffer only supports one producer at a time).
+       */
+      boost::mutex producer_mutex;
+    };
+
     /**
      * \brief Class for managing the interface's internal states.
      */
@@ -819,24 +1424,27 @@ private:
       /**
        * \brief A constructor.
        *
-       * \param configurations specifying the trajectory interface's initial configurations.
+       * \param configurations specifying the trajectory interface's initial runtime configurations.
        */
-      MotionStep(const TrajectoryConfiguration& configurations)
+      MotionStep(const RuntimeConfiguration& configurations)
       :
-      CONDITION(0.005),
       RAMP_DOWN_STOP_DURATION(1.0),
       STATIC_GOAL_DURATION(5.0),
       STATIC_GOAL_DURATION_SHORT(0.1),
-      condition_met_(true),
-      configurations_(configurations)
+      PREDICTION_SAMPLE_TIME_TOLERANCE(0.1*Constants::RobotController::LOWEST_SAMPLE_TIME),
+      configurations_(configurations),
+      has_prediction_(false),
+      prediction_base_time_(0.0),
+      prediction_time_(0.0),
+      prediction_sample_time_(0.0)
       {}
 
       /**
-       * \brief Update the interface's configurations.
+       * \brief Update the interface's runtime configurations.
        *
-       * \param configurations specifying the interface's new configurations.
+       * \param configurations specifying the interface's new runtime configurations.
        */
-      void updateConfigurations(const TrajectoryConfiguration& configurations)
+      void updateConfigurations(const RuntimeConfiguration& configurations)
       {
         configurations_ = configurations;
       }
@@ -900,10 +1508,11 @@ private:
        */
       void updateInterpolator()
       {
+        has_prediction_ = false;
         data.time_passed = 0.0;
         interpolation.set_reach(internal_goal.reach());
         interpolation.set_duration(interpolator_conditions_.duration);
-        interpolator.update(interpolation, internal_goal, interpolator_conditions_);
+        interpolator.update(interpolation, internal_goal, interpolator_conditions_, external_goal_timing);
       }
 
       /**
@@ -911,8 +1520,43 @@ private:
        */
       void evaluateInterpolator()
       {
-        data.time_passed += data.estimated_sample_time;
-        interpolator.evaluate(&interpolation, data.estimated_sample_time, data.time_passed);
+        // Use any prediction, if it was made from the current time instance (of the same interpolator, since updating
+        // it discards the prediction), and with a sample time close to the current estimate. The estimate is filtered,
+        // but it can still change slightly between messages (e.g. if it is based on the receive times).
+        if (has_prediction_ &&
+            prediction_base_time_ == data.time_passed &&
+            std::abs(prediction_sample_time_ - data.estimated_sample_time) <= PREDICTION_SAMPLE_TIME_TOLERANCE)
+        {
+          // Step with the sample time that the prediction was evaluated with.
+          data.time_passed = prediction_time_;
+          interpolation.Swap(&predicted_interpolation_);
+        }
+        else
+        {
+          data.time_passed += data.estimated_sample_time;
+          interpolator.evaluate(&interpolation, data.estimated_sample_time, data.time_passed);
+        }
+
+        has_prediction_ = false;
+      }
+
+      /**
+       * \brief Predict the interpolation (at the time instance after the next), if the interpolator allows it.
+       *
+       * Note: The prediction is only used by the next evaluation, if the interpolator has not been updated before it.
+       */
+      void predictInterpolation()
+      {
+        has_prediction_ = interpolator.isStateless();
+
+        if (has_prediction_)
+        {
+          prediction_sample_time_ = data.estimated_sample_time;
+          prediction_base_time_ = data.time_passed;
+          prediction_time_ = data.time_passed + data.estimated_sample_time;
+          predicted_interpolation_.CopyFrom(interpolation);
+          interpolator.evaluate(&predicted_interpolation_, prediction_sample_time_, prediction_time_);
+        }
       }
 
       /**
@@ -930,6 +1574,11 @@ private:
        */
       wrapper::trajectory::PointGoal external_goal;
 
+      /**
+       * \brief The external goal point's precomputed interpolation values (only used if they match the duration).
+       */
+      EGMInterpolator::Timing external_goal_timing;
+
       /**
        * \brief The interpolation (i.e. reference point to the robot controller).
        */
@@ -942,100 +1591,73 @@ private:
 
     private:
       /**
-       * \brief Estimate the duration for the internal goal.
-       *
-       * Note: Should only be used if no duration has been specified externally.
-       *
-       * \return double containing the estimation.
-       */
-      double estimateDuration();
-
-      /**
-       * \brief Check if the conditions has been satisfied for a joint goal.
-       *
-       * \param goal containing the goal.
-       * \param feedback containing the feedback.
-       */
-      void checkConditions(const wrapper::Joints& goal, const wrapper::Joints& feedback);
-
-      /**
-       * \brief Check if the conditions has been satisfied for a Cartesian goal.
+       * \brief Transfer values from an external static position goal to the internal goal.
        *
-       * \param goal containing the goal.
-       * \param feedback containing the feedback.
+       * \param source containing the values to transfer.
        */
-      void checkConditions(const wrapper::Cartesian& goal, const wrapper::Cartesian& feedback);
+      void transfer(const wrapper::trajectory::StaticPositionGoal& source);
 
       /**
-       * \brief Check if the conditions has been satisfied for a quaternion goal.
+       * \brief Transfer values from an external static velocity goal to the internal goal.
        *
-       * \param goal containing the goal.
-       * \param feedback containing the feedback.
+       * \param source containing the values to transfer.
        */
-      void checkConditions(const wrapper::Quaternion& goal, const wrapper::Quaternion& feedback);
+      void transfer(const wrapper::trajectory::StaticVelocityGoal& source);
 
       /**
-       * \brief Transfer values from an external robot goal to the internal goal.
-       *
-       * \param source containing the values to transfer.
+       * \brief Constant for ramp down stop duration [s].
        */
-      void transfer(const wrapper::trajectory::RobotGoal& source);
+      const double RAMP_DOWN_STOP_DURATION;
 
       /**
-       * \brief Transfer values from an external external goal to the internal goal.
-       *
-       * \param source containing the values to transfer.
+       * \brief Constant for static goal ramp in duration [s].
        */
-      void transfer(const wrapper::trajectory::ExternalGoal& source);
+      const double STATIC_GOAL_DURATION;
 
       /**
-       * \brief Transfer values from an external static position goal to the internal goal.
-       *
-       * \param source containing the values to transfer.
+       * \brief Constant for static goal ramp in short duration [s].
        */
-      void transfer(const wrapper::trajectory::StaticPositionGoal& source);
+      const double STATIC_GOAL_DURATION_SHORT;
 
       /**
-       * \brief Transfer values from an external static velocity goal to the internal goal.
-       *
-       * \param source containing the values to transfer.
+       * \brief Constant for the max difference [s] between the current and a prediction's sample time, to use it.
        */
-      void transfer(const wrapper::trajectory::StaticVelocityGoal& source);
+      const double PREDICTION_SAMPLE_TIME_TOLERANCE;
 
       /**
-       * \brief Constant for a condition [degrees or mm] for when a point is considered to be reached.
+       * \brief Conditions for the interpolator.
        */
-      const double CONDITION;
+      EGMInterpolator::Conditions interpolator_conditions_;
 
       /**
-       * \brief Constant for ramp down stop duration [s].
+       * \brief The trajectory interface's runtime configurations.
        */
-      const double RAMP_DOWN_STOP_DURATION;
+      RuntimeConfiguration configurations_;
 
       /**
-       * \brief Constant for static goal ramp in duration [s].
+       * \brief The predicted interpolation (evaluated ahead of time).
        */
-      const double STATIC_GOAL_DURATION;
+      wrapper::trajectory::PointGoal predicted_interpolation_;
 
       /**
-       * \brief Constant for static goal ramp in short duration [s].
+       * \brief Flag indicating if there is a valid prediction.
        */
-      const double STATIC_GOAL_DURATION_SHORT;
+      bool has_prediction_;
 
       /**
-       * \brief Conditions for the interpolator.
+       * \brief The time instance [s] that the prediction was made from.
        */
-      EGMInterpolator::Conditions interpolator_conditions_;
+      double prediction_base_time_;
 
       /**
-       * \brief Flag indicating if the joint position and Cartesian pose conditions has been met.
+       * \brief The time instance [s] that the prediction was evaluated at.
        */
-      bool condition_met_;
+      double prediction_time_;
 
       /**
-       * \brief The trajectory interface's configurations.
+       * \brief The sample time [s] that the prediction was evaluated with.
        */
-      TrajectoryConfiguration configurations_;
+      double prediction_sample_time_;
     };
 
     /**
@@ -1071,7 +1693,7 @@ private:
        */
       void update(const States state,
                   const MotionStep& motion_step,
-                  const TrajectoryConfiguration& configurations);
+                  const RuntimeConfiguration& configurations);
 
       /**
        * \brief Calculate the outputs to the robot controller.
@@ -1187,6 +1809,11 @@ private:
      */
     void prepare(const InputContainer& inputs);
 
+    /**
+     * \brief Publish a snapshot of the execution progress, and notify any listener if the progress has changed.
+     */
+    void publishProgressSnapshot();
+
     /**
      * \brief Reset the trajectory motion data.
      */
@@ -1213,10 +1840,71 @@ private:
     void updateNormalGoal();
 
     /**
-     * \brief Store the current goal, in the front of the currently active trajectory.
+     * \brief Store the current goal, in the front of the currently active trajectory (or the point stream).
      */
     void storeNormalGoal();
 
+    /**
+     * \brief Retrive the next point from the point stream.
+     *
+     * \param p_point for storing the retrived point.
+     *
+     * \return bool indicating if a point was retrived or not.
+     */
+    bool retriveNextStreamPoint(wrapper::trajectory::PointGoal* p_point);
+
+    /**
+     * \brief Check if the point stream has any points to retrive.
+     *
+     * \return bool indicating if there are any points.
+     */
+    bool hasStreamPoints();
+
+    /**
+     * \brief Discard all points in the point stream.
+     */
+    void clearStream();
+
+    /**
+     * \brief Retire a trajectory, so that it is released by a user thread instead of the EGM communication loop.
+     *
+     * \param p_trajectory for the trajectory to retire (reset afterwards).
+     */
+    void retireTrajectory(boost::shared_ptr<Trajectory>* p_trajectory);
+
+    /**
+     * \brief Retire all trajectories in a queue.
+     *
+     * \param p_queue for the queue to retire (empty afterwards).
+     */
+    void retireQueue(std::deque<boost::shared_ptr<Trajectory> >* p_queue);
+
+    /**
+     * \brief Reserve room for retiring every trajectory that the EGM communication loop currently knows about.
+     *
+     * Note: Must be called by a user thread, with the trajectory mutex locked.
+     */
+    void reserveRetirements();
+
+    /**
+     * \brief Check if a joint goal's present fields all have the specified number of joints.
+     *
+     * \param goal containing the joint goal to check.
+     * \param number_of_joints specifying the expected number of joints.
+     *
+     * \return bool indicating if the joint goal has the number of joints or not.
+     */
+    static bool hasNumberOfJoints(const wrapper::trajectory::JointGoal& goal, const int number_of_joints);
+
+    /**
+     * \brief Convert a point's specified duration to microseconds.
+     *
+     * \param point containing the point.
+     *
+     * \return boost::uint64_t containing the duration [us] (zero if no duration is specified).
+     */
+    static boost::uint64_t durationInMicroseconds(const wrapper::trajectory::PointGoal& point);
+
     /**
      * \brief Constant for the minimum duration scale factor.
      */
@@ -1254,11 +1942,39 @@ private:
     TrajectoryContainer trajectories_;
 
     /**
-     * \brief The trajectory interface's configurations.
+     * \brief The trajectory interface's runtime configurations.
      */
-    TrajectoryConfiguration configurations_;
+    RuntimeConfiguration configurations_;
+
+    /**
+     * \brief Container for the streamed points.
+     */
+    StreamContainer stream_;
+
+    /**
+     * \brief Scratch snapshot, filled by the EGM communication loop before it is published.
+     */
+    ProgressSnapshot snapshot_;
+
+    /**
+     * \brief The published execution progress snapshots.
+     */
+    SeqLock<ProgressSnapshot> snapshots_;
+
+    /**
+     * \brief The (host clock) time of the current message, estimated via the controller's clock relation.
+     */
+    boost::chrono::steady_clock::time_point message_time_;
   };
 
+  /**
+   * \brief Refresh the active configuration, if a new configuration has been requested.
+   *
+   * Note: Lock-free. The runtime parameters are applied directly, and the session parameters are applied when the
+   *       next EGM communication session starts (see initializeCallback).
+   */
+  void refreshConfiguration();
+
   /**
    * \brief Initialize the callback.
    *
@@ -1277,6 +1993,26 @@ private:
    */
   const std::string& callback(const UDPServerData& server_data);
 
+  /**
+   * \brief Handle notifications from an UDP server, that the reply has been sent.
+   *
+   * Note: Used for predicting the next interpolation, if the configuration specifies that it should be done.
+   */
+  void postReply();
+
+  /**
+   * \brief Process (e.g. retime and blend) a shared trajectory, and add it to the execution queue.
+   *
+   * \param p_trajectory containing the trajectory to add.
+   * \param override_trajectories indicating if all pending trajectories should be overridden (i.e. removed).
+   * \param p_barrier for aligning the trajectory's start with other interfaces (a null pointer if not used).
+   *
+   * \return bool indicating if the interface accepted the command or not.
+   */
+  bool queueTrajectory(const boost::shared_ptr<const wrapper::trajectory::TrajectoryGoal>& p_trajectory,
+                       const bool override_trajectories,
+                       const boost::shared_ptr<EGMStartBarrier>& p_barrier);
+
   /**
    * \brief The interface's configuration.
    */
@@ -0,0 +1,305 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_TRAJECTORY_PREVIEW_H
+#define EGM_TRAJECTORY_PREVIEW_H
+
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include "abb_libegm_export.h"
+
+#include "egm_wrapper_trajectory.pb.h" // Generated by Google Protocol Buffer compiler protoc
+
+#include "egm_common.h"
+#include "egm_interpolator.h"
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Struct for a sampled trajectory preview (i.e. the interpolated references a trajectory motion would produce).
+ *
+ * Note: The containers are never shrunk, so that a preview can be reused without reallocations. Only the first
+ *       number_of_segments segments and the first number_of_samples samples are valid.
+ */
+struct TrajectoryPreview
+{
+  /**
+   * \brief Struct for a previewed trajectory segment (i.e. the motion towards one of the trajectory's points).
+   */
+  struct Segment
+  {
+    /**
+     * \brief Default constructor.
+     */
+    Segment()
+    :
+    point_index(0),
+    sample_offset(0),
+    number_of_samples(0),
+    start_time(0.0)
+    {}
+
+    /**
+     * \brief Index of the segment's goal point, in the previewed trajectory.
+     */
+    int point_index;
+
+    /**
+     * \brief Index of the segment's first sample.
+     */
+    size_t sample_offset;
+
+    /**
+     * \brief Number of samples in the segment.
+     */
+    size_t number_of_samples;
+
+    /**
+     * \brief Time [s] when the segment starts, relative to the start of the trajectory.
+     */
+    double start_time;
+
+    /**
+     * \brief The segment's interpolation start state.
+     */
+    wrapper::trajectory::PointGoal start;
+
+    /**
+     * \brief The segment's goal (i.e. the goal point, after it has been completed with the preceding goals).
+     */
+    wrapper::trajectory::PointGoal goal;
+
+    /**
+     * \brief The segment's interpolator (can e.g. be used to evaluate the segment at arbitrary time instances).
+     */
+    EGMInterpolator interpolator;
+  };
+
+  /**
+   * \brief Default constructor.
+   */
+  TrajectoryPreview()
+  :
+  number_of_segments(0),
+  number_of_samples(0),
+  duration(0.0)
+  {}
+
+  /**
+   * \brief Number of valid segments.
+   */
+  size_t number_of_segments;
+
+  /**
+   * \brief Number of valid samples.
+   */
+  size_t number_of_samples;
+
+  /**
+   * \brief Total duration [s] of the previewed trajectory.
+   */
+  double duration;
+
+  /**
+   * \brief Container for the segments.
+   */
+  std::vector<Segment> segments;
+
+  /**
+   * \brief Container for the samples (i.e. positions, velocities and accelerations at each sample time instance).
+   */
+  std::vector<wrapper::trajectory::PointGoal> samples;
+
+  /**
+   * \brief Container for the samples' time instances [s], relative to the start of the trajectory.
+   */
+  std::vector<double> sample_times;
+};
+
+/**
+ * \brief Class for previewing trajectories offline (i.e. without running them through an EGM session).
+ *
+ * The preview uses the same goal preparation and interpolation logic as the trajectory interface's motion
+ * generation, under the assumption that the robot tracks the references perfectly. E.g. points that require to be
+ * reached are considered reached as soon as their interpolation has finished.
+ *
+ * The segment boundaries are first determined sequentially (which is cheap), and then the segments are sampled in
+ * parallel by a pool of worker threads (together with the calling thread).
+ *
+ * Note: The samples are the interpolated references, i.e. the position and velocity controller that is applied
+ *       before sending the outputs to the robot controller is not included.
+ */
+class EGMTrajectoryPreviewer
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param number_of_workers specifying the number of worker threads (0 means that all sampling is done by the
+   *                          calling thread).
+   */
+  EGMTrajectoryPreviewer(const unsigned int number_of_workers = boost::thread::hardware_concurrency());
+
+  /**
+   * \brief A destructor.
+   */
+  ~EGMTrajectoryPreviewer();
+
+  /**
+   * \brief Preview a trajectory.
+   *
+   * Note: Preview calls are thread-safe, as long as different preview containers are used.
+   *
+   * \param start containing the start state (only the positions are used, i.e. the motion starts from standstill).
+   * \param trajectory containing the trajectory to preview.
+   * \param configuration containing the trajectory configuration to use (e.g. the spline method).
+   * \param p_preview for storing the preview.
+   * \param sample_time for the sample time [s] to use.
+   *
+   * \return bool indicating if the preview was successful or not.
+   */
+  bool preview(const wrapper::trajectory::PointGoal& start,
+               const wrapper::trajectory::TrajectoryGoal& trajectory,
+               const TrajectoryConfiguration& configuration,
+               TrajectoryPreview* p_preview,
+               const double sample_time = Constants::RobotController::LOWEST_SAMPLE_TIME);
+
+  /**
+   * \brief Retrieve the number of worker threads.
+   *
+   * \return unsigned int containing the number of worker threads.
+   */
+  unsigned int numberOfWorkers() const;
+
+private:
+  /**
+   * \brief Struct for tracking the completion of parallel sampling tasks.
+   */
+  struct Completion
+  {
+    /**
+     * \brief Default constructor.
+     */
+    Completion()
+    :
+    remaining(0)
+    {}
+
+    /**
+     * \brief Mutex for protecting the number of remaining tasks.
+     */
+    boost::mutex mutex;
+
+    /**
+     * \brief Condition variable for signaling that all tasks have completed.
+     */
+    boost::condition_variable condition;
+
+    /**
+     * \brief Number of remaining tasks.
+     */
+    unsigned int remaining;
+  };
+
+  /**
+   * \brief The worker threads' main loop.
+   */
+  void workerThread();
+
+  /**
+   * \brief Sample a range of segments, and signal the completion afterwards.
+   *
+   * \param p_preview for the preview containing the segments.
+   * \param begin for the first segment to sample.
+   * \param end for the segment after the last segment to sample.
+   * \param sample_time for the sample time [s] to use.
+   * \param p_completion for signaling the completion.
+   */
+  static void sampleTask(TrajectoryPreview* p_preview,
+                         const size_t begin,
+                         const size_t end,
+                         const double sample_time,
+                         Completion* p_completion);
+
+  /**
+   * \brief Sample a range of segments.
+   *
+   * \param p_preview for the preview containing the segments.
+   * \param begin for the first segment to sample.
+   * \param end for the segment after the last segment to sample.
+   * \param sample_time for the sample time [s] to use.
+   */
+  static void sampleSegments(TrajectoryPreview* p_preview,
+                             const size_t begin,
+                             const size_t end,
+                             const double sample_time);
+
+  /**
+   * \brief Static constant for the minimum number of samples per parallel task.
+   */
+  static const size_t MIN_SAMPLES_PER_TASK = 256;
+
+  /**
+   * \brief The worker threads' I/O service (used as a task queue).
+   */
+  boost::asio::io_service io_service_;
+
+  /**
+   * \brief Work object keeping the I/O service running while there are no tasks.
+   */
+  boost::scoped_ptr<boost::asio::io_service::work> p_work_;
+
+  /**
+   * \brief The worker threads.
+   */
+  boost::thread_group worker_threads_;
+
+  /**
+   * \brief Number of worker threads.
+   */
+  unsigned int number_of_workers_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_TRAJECTORY_PREVIEW_H
@@ -0,0 +1,210 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_TRAJECTORY_RETIMER_H
+#define EGM_TRAJECTORY_RETIMER_H
+
+#include <vector>
+
+#include "abb_libegm_export.h"
+
+#include "egm_wrapper_trajectory.pb.h" // Generated by Google Protocol Buffer compiler protoc
+
+#include "egm_common.h"
+#include "egm_interpolator.h"
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Class for retiming trajectories, according to velocity, acceleration and jerk limits.
+ *
+ * Each point's duration is replaced with the shortest duration (rounded up to whole sample times) for which the
+ * spline interpolation towards the point stays within the limits. The goals are prepared in the same way as by the
+ * trajectory interface's motion generation, under the assumption that each point is reached before the motion
+ * towards the next point starts.
+ *
+ * Note: Points without specified durations get their velocities and accelerations removed (i.e. they are retimed
+ *       as stops, just as they are executed). Orientations (in pose mode) are not limited. The limits are not
+ *       guaranteed if the durations are scaled with a duration factor less than one, and velocity and acceleration
+ *       discontinuities between segments (e.g. for the linear spline method) are not considered.
+ */
+class EGMTrajectoryRetimer
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param configuration specifying the trajectory configuration to use (e.g. the spline method and the limits).
+   */
+  EGMTrajectoryRetimer(const TrajectoryConfiguration& configuration);
+
+  /**
+   * \brief Retime a trajectory, that starts from a known state.
+   *
+   * \param start containing the start state (only the positions are used, i.e. the motion starts from standstill).
+   * \param p_trajectory for the trajectory to retime.
+   * \param sample_time for the sample time [s] to round the durations to.
+   *
+   * \return bool indicating if all points were retimed (points that can't be retimed keep their durations).
+   */
+  bool retime(const wrapper::trajectory::PointGoal& start,
+              wrapper::trajectory::TrajectoryGoal* p_trajectory,
+              const double sample_time = Constants::RobotController::LOWEST_SAMPLE_TIME);
+
+  /**
+   * \brief Retime a trajectory, that starts from an unknown state.
+   *
+   * Note: The first point's duration is kept, since the motion towards it depends on the state when it is executed.
+   *
+   * \param p_trajectory for the trajectory to retime.
+   * \param sample_time for the sample time [s] to round the durations to.
+   *
+   * \return bool indicating if all points were retimed (points that can't be retimed keep their durations).
+   */
+  bool retime(wrapper::trajectory::TrajectoryGoal* p_trajectory,
+              const double sample_time = Constants::RobotController::LOWEST_SAMPLE_TIME);
+
+private:
+  /**
+   * \brief Retime a trajectory.
+   *
+   * \param p_start containing the start state (null if unknown).
+   * \param p_trajectory for the trajectory to retime.
+   * \param sample_time for the sample time [s] to round the durations to.
+   *
+   * \return bool indicating if all points were retimed.
+   */
+  bool retime(const wrapper::trajectory::PointGoal* p_start,
+              wrapper::trajectory::TrajectoryGoal* p_trajectory,
+              const double sample_time);
+
+  /**
+   * \brief Find the shortest feasible duration for the motion from the current state to the goal.
+   *
+   * \param p_duration for storing the duration [s].
+   * \param mode specifying the goal's mode.
+   * \param sample_time for the sample time [s] to round the duration to.
+   *
+   * \return bool indicating if a feasible duration was found.
+   */
+  bool findDuration(double* p_duration, const EGMModes mode, const double sample_time);
+
+  /**
+   * \brief Check if the motion from the current state to the goal stays within the limits, for a duration.
+   *
+   * \param duration specifying the duration [s] to check.
+   * \param mode specifying the goal's mode.
+   *
+   * \return bool indicating if the motion stays within the limits.
+   */
+  bool isFeasible(const double duration, const EGMModes mode);
+
+  /**
+   * \brief Check if max absolute values stay within axis limits.
+   *
+   * \param velocities containing the max absolute velocities.
+   * \param accelerations containing the max absolute accelerations.
+   * \param jerks containing the max absolute jerks.
+   * \param offset to the first value to check.
+   * \param number_of_axes specifying the number of axes to check.
+   * \param limits containing the axes' limits.
+   *
+   * \return bool indicating if the values stay within the limits.
+   */
+  static bool withinLimits(const double* velocities,
+                           const double* accelerations,
+                           const double* jerks,
+                           const int offset,
+                           const int number_of_axes,
+                           const std::vector<AxisLimits>& limits);
+
+  /**
+   * \brief Check if a max absolute value stays within a limit.
+   *
+   * \param value containing the max absolute value.
+   * \param limit containing the limit (not positive means unlimited).
+   *
+   * \return bool indicating if the value stays within the limit.
+   */
+  static bool withinLimit(const double value, const double limit);
+
+  /**
+   * \brief Static constant for the longest duration [s] that is considered.
+   */
+  static const double MAX_DURATION;
+
+  /**
+   * \brief Static constant for the tolerance [s] of the found durations (before they are rounded).
+   */
+  static const double DURATION_TOLERANCE;
+
+  /**
+   * \brief Static constant for the relative tolerance used when comparing values to limits.
+   */
+  static const double LIMIT_TOLERANCE;
+
+  /**
+   * \brief The trajectory configuration.
+   */
+  TrajectoryConfiguration configuration_;
+
+  /**
+   * \brief The interpolator's conditions.
+   */
+  EGMInterpolator::Conditions conditions_;
+
+  /**
+   * \brief Interpolator used for evaluating the motions.
+   */
+  EGMInterpolator interpolator_;
+
+  /**
+   * \brief The current state (i.e. the preceding goal).
+   */
+  wrapper::trajectory::PointGoal current_;
+
+  /**
+   * \brief The goal being retimed.
+   */
+  wrapper::trajectory::PointGoal goal_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_TRAJECTORY_RETIMER_H
@@ -0,0 +1,169 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_TRIPLE_BUFFER_H
+#define EGM_TRIPLE_BUFFER_H
+
+#include <boost/atomic.hpp>
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Class for a wait-free triple buffer, for handing over data from one producer thread to one consumer thread.
+ *
+ * The producer fills its private write buffer and publishes it, while the consumer picks up the most recently
+ * published buffer into its private read buffer. Neither side ever waits for the other, intermediate values are simply
+ * overwritten if the consumer is slower than the producer.
+ *
+ * Note: Only one producer thread and one consumer thread are supported. The buffered objects are reused, so objects
+ *       that retain their storage between assignments (e.g. Protocol Buffers messages) don't allocate once warmed up.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+  /**
+   * \brief Default constructor.
+   */
+  TripleBuffer()
+  :
+  write_index_(0),
+  middle_(1),
+  read_index_(2)
+  {}
+
+  /**
+   * \brief Retrieve the producer's write buffer.
+   *
+   * Note: Only to be called by the producer.
+   *
+   * \return T& reference to the write buffer.
+   */
+  T& writeBuffer()
+  {
+    return buffers_[write_index_];
+  }
+
+  /**
+   * \brief Publish the content of the write buffer, and take over the previously published buffer for writing.
+   *
+   * Note: Only to be called by the producer.
+   */
+  void publish()
+  {
+    write_index_ = middle_.exchange(write_index_ | NEW_DATA_FLAG, boost::memory_order_acq_rel) & INDEX_MASK;
+  }
+
+  /**
+   * \brief Check if there is published data, that the consumer has not yet picked up.
+   *
+   * \return bool indicating if there is new data or not.
+   */
+  bool hasNewData() const
+  {
+    return (middle_.load(boost::memory_order_acquire) & NEW_DATA_FLAG) != 0;
+  }
+
+  /**
+   * \brief Pick up the most recently published data (if any) into the read buffer.
+   *
+   * Note: Only to be called by the consumer.
+   *
+   * \return bool indicating if new data was picked up or not. If not, then the read buffer is left unchanged.
+   */
+  bool update()
+  {
+    bool updated = false;
+
+    if (hasNewData())
+    {
+      read_index_ = middle_.exchange(read_index_, boost::memory_order_acq_rel) & INDEX_MASK;
+      updated = true;
+    }
+
+    return updated;
+  }
+
+  /**
+   * \brief Retrieve the consumer's read buffer.
+   *
+   * Note: Only to be called by the consumer.
+   *
+   * \return const T& reference to the read buffer.
+   */
+  const T& readBuffer() const
+  {
+    return buffers_[read_index_];
+  }
+
+private:
+  /**
+   * \brief Static constant mask for extracting a buffer index.
+   */
+  static const unsigned int INDEX_MASK = 0x3;
+
+  /**
+   * \brief Static constant flag, marking that the middle buffer contains unread data.
+   */
+  static const unsigned int NEW_DATA_FLAG = 0x4;
+
+  /**
+   * \brief The three buffers.
+   */
+  T buffers_[3];
+
+  /**
+   * \brief Index of the producer's write buffer.
+   */
+  unsigned int write_index_;
+
+  /**
+   * \brief Index of the middle (i.e. most recently published) buffer, combined with the new data flag.
+   */
+  boost::atomic<unsigned int> middle_;
+
+  /**
+   * \brief Index of the consumer's read buffer.
+   */
+  unsigned int read_index_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_TRIPLE_BUFFER_H
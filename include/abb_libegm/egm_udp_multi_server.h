@@ -0,0 +1,203 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef EGM_UDP_MULTI_SERVER_H
+#define EGM_UDP_MULTI_SERVER_H
+
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/atomic.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include "egm_udp_server.h"
+
+namespace abb
+{
+namespace egm
+{
+/**
+ * \brief Class for a UDP server that hosts several EGM sessions (i.e. one per robot controller port).
+ *
+ * The server owns one UDP socket per session, and the sessions are distributed over a small pool of worker threads.
+ * Each worker waits for any of its sockets to become readable, and then receives and replies to messages in batches
+ * (using recvmmsg/sendmmsg on Linux, to reduce the number of system calls).
+ *
+ * The interfaces that are added as sessions should have been created with UDPServerConfiguration::External, so that
+ * their own UDPServer instances don't open any sockets. Each interface is only ever called from one worker thread.
+ * The server must be stopped (or destroyed) before any of the interfaces are destroyed.
+ */
+class UDPMultiServer
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param number_of_workers specifying the number of worker threads (at least one is used).
+   */
+  UDPMultiServer(const unsigned int number_of_workers = 1);
+
+  /**
+   * \brief A destructor.
+   */
+  ~UDPMultiServer();
+
+  /**
+   * \brief Add a session, which opens a UDP socket for the port and dispatches the received messages to the interface.
+   *
+   * Note: Sessions can only be added before the server has been started.
+   *
+   * \param port_number for the session's UDP socket.
+   * \param p_interface that processes the received messages.
+   *
+   * \return bool indicating if the session was added or not.
+   */
+  bool addSession(const unsigned short port_number, AbstractUDPServerInterface* p_interface);
+
+  /**
+   * \brief Start the worker threads.
+   *
+   * \return bool indicating if the server was started or not.
+   */
+  bool start();
+
+  /**
+   * \brief Stop the worker threads.
+   */
+  void stop();
+
+  /**
+   * \brief Retrieve the number of added sessions.
+   *
+   * \return size_t containing the number of sessions.
+   */
+  size_t numberOfSessions() const;
+
+private:
+  /**
+   * \brief Struct for a session (i.e. a socket and its dispatcher).
+   */
+  struct Session
+  {
+    /**
+     * \brief A constructor.
+     *
+     * \param io_service for creating the socket.
+     * \param port_number for the socket.
+     * \param p_interface that processes the received messages.
+     */
+    Session(boost::asio::io_service& io_service,
+            const unsigned short port_number,
+            AbstractUDPServerInterface* p_interface);
+
+    /**
+     * \brief The session's UDP socket.
+     */
+    boost::asio::ip::udp::socket socket;
+
+    /**
+     * \brief Dispatcher for passing the received messages to the session's interface.
+     */
+    UDPDispatcher dispatcher;
+  };
+
+  /**
+   * \brief Run a worker's receive/send loop.
+   *
+   * \param worker_index of the worker, which determines the sessions it is responsible for.
+   */
+  void workerThread(const size_t worker_index);
+
+  /**
+   * \brief Receive, dispatch and reply to all pending messages of a session (in batches).
+   *
+   * \param p_session to process.
+   * \param p_receive_buffers for storing the received messages (BATCH_SIZE*BUFFER_SIZE bytes).
+   * \param p_send_buffers for storing the replies (BATCH_SIZE*BUFFER_SIZE bytes).
+   */
+  void processSession(Session* p_session, char* p_receive_buffers, char* p_send_buffers);
+
+  /**
+   * \brief Static constant for the size of the buffer used for each message.
+   */
+  static const size_t BUFFER_SIZE = 1024;
+
+  /**
+   * \brief Static constant for the maximum number of messages received/sent per system call.
+   */
+  static const size_t BATCH_SIZE = 16;
+
+  /**
+   * \brief Static constant for how long [ms] a worker waits for messages, before checking if it should stop.
+   */
+  static const int WAIT_TIMEOUT_MS = 100;
+
+  /**
+   * \brief The io_service used for creating the sockets (no asynchronous operations are executed on it).
+   */
+  boost::asio::io_service io_service_;
+
+  /**
+   * \brief The server's sessions.
+   */
+  std::vector<boost::shared_ptr<Session> > sessions_;
+
+  /**
+   * \brief The number of worker threads.
+   */
+  const unsigned int number_of_workers_;
+
+  /**
+   * \brief The worker threads.
+   */
+  boost::thread_group workers_;
+
+  /**
+   * \brief Flag indicating if the server has been started.
+   */
+  bool started_;
+
+  /**
+   * \brief Flag indicating if the worker threads should stop.
+   */
+  boost::atomic<bool> stop_requested_;
+};
+
+} // end namespace egm
+} // end namespace abb
+
+#endif // EGM_UDP_MULTI_SERVER_H
@@ -38,11 +38,18 @@
 #define EGM_UDP_SERVER_H
 
 #include <boost/asio.hpp>
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread.hpp>
+
+#include "egm_common.h"
 
 namespace abb
 {
 namespace egm
 {
+class EGMCaptureWriter;
+
 /**
  * \brief Struct for containing data from the UDPServer class.
  */
@@ -71,6 +78,11 @@ struct UDPServerData
    * \brief Bytes transferred to the server.
    */
   int bytes_transferred;
+
+  /**
+   * \brief Time when the data was received by the server.
+   */
+  boost::chrono::steady_clock::time_point receive_time;
 };
 
 /**
@@ -83,6 +95,11 @@ class AbstractUDPServerInterface
  */
 friend class UDPServer;
 
+/**
+ * \brief A friend to the interface.
+ */
+friend class UDPDispatcher;
+
 private:
   /**
    * \brief Pure virtual method for handling callback requests from a UDPServer instance.
@@ -92,26 +109,50 @@ private:
    * \return string& containing the reply.
    */
   virtual const std::string& callback(const UDPServerData& data) = 0;
+
+  /**
+   * \brief Virtual method for handling notifications, from a UDPServer instance, that the reply has been sent.
+   *
+   * Note: Called in the same thread as the callback, e.g. to let the interface prepare for the next message.
+   */
+  virtual void postReply() {}
 };
 
 /**
- * \brief Class for an asynchronous UDP server.
+ * \brief Class for a UDP server.
  *
  * The server receives UDP messages from a client, passes the messages to a callback and returns a reply to the client.
+ *
+ * The server can either operate asynchronously, via a user provided boost asio io_service, or in a dedicated thread
+ * (with optional CPU pinning, real-time scheduling and memory locking) that uses blocking or busy-polled operations.
  */
 class UDPServer
 {
 public:
+  /**
+   * \brief An enum for the status of the dedicated thread's attributes (i.e. CPU affinity, priority and memory locking).
+   */
+  enum ThreadAttributesStatus
+  {
+    NotApplied, ///< \brief The dedicated thread has not (yet) applied the attributes.
+    Applied,    ///< \brief All the requested attributes were applied.
+    Failed      ///< \brief At least one of the requested attributes could not be applied.
+  };
+
   /**
    * \brief A constructor.
    *
+   * Note: The server does not receive anything until start has been called.
+   *
    * \param io_service for operating boost asio's asynchronous functions.
    * \param port_number for the server's UDP socket.
    * \param p_interface that processes the received messages.
+   * \param configuration specifying how the server's socket should be operated.
    */
   UDPServer(boost::asio::io_service& io_service,
             unsigned short port_number,
-            AbstractUDPServerInterface* p_interface);
+            AbstractUDPServerInterface* p_interface,
+            const UDPServerConfiguration& configuration = UDPServerConfiguration());
 
   /**
    * \brief A destructor.
@@ -125,6 +166,38 @@ public:
    */
   bool isInitialized() const;
 
+  /**
+   * \brief Start receiving messages (i.e. start the dedicated thread, or the first asynchronous receive).
+   *
+   * Note: Should be called once the interface, which processes the received messages, has been fully constructed.
+   *
+   * \return bool indicating if the server was started or not (false if uninitialized or already started).
+   */
+  bool start();
+
+  /**
+   * \brief Stop the dedicated thread (if it is running), and wait for it to finish.
+   *
+   * Note: Should be called before the interface, which processes the received messages, is destroyed.
+   */
+  void stop();
+
+  /**
+   * \brief Retrieve the status of the dedicated thread's attributes.
+   *
+   * \return ThreadAttributesStatus with the status.
+   */
+  ThreadAttributesStatus getThreadAttributesStatus() const;
+
+  /**
+   * \brief Retrieve the number of replies that could not be sent to the robot controller.
+   *
+   * Note: When busy-polling, sends that would block are retried, so only actual send errors are counted.
+   *
+   * \return unsigned int containing the number of failed replies.
+   */
+  unsigned int getNumberOfFailedReplies() const;
+
 private:
   /**
    * \brief Start an asynchronous receive.
@@ -147,6 +220,18 @@ private:
    */
   void sendCallback(const boost::system::error_code& error, const std::size_t bytes_transferred);
 
+  /**
+   * \brief Run the receive/send loop, in the server's dedicated thread.
+   */
+  void dedicatedThread();
+
+  /**
+   * \brief Apply the configured CPU affinity, scheduling priority and memory locking to the calling thread.
+   *
+   * \return bool indicating if all the requested attributes were applied or not.
+   */
+  bool applyThreadAttributes();
+
   /**
    * \brief Static constant for the socket's buffer size.
    */
@@ -181,6 +266,99 @@ private:
    * \brief Flag indicating if the server was initialized successfully or not.
    */
   bool initialized_;
+
+  /**
+   * \brief The server's configuration.
+   */
+  UDPServerConfiguration configuration_;
+
+  /**
+   * \brief Flag indicating if the server has been started or not.
+   */
+  bool started_;
+
+  /**
+   * \brief Flag indicating if the dedicated thread should stop.
+   */
+  boost::atomic<bool> stop_requested_;
+
+  /**
+   * \brief The status of the dedicated thread's attributes (stored as an int, to allow atomic access).
+   */
+  boost::atomic<int> thread_attributes_status_;
+
+  /**
+   * \brief Number of replies that could not be sent to the robot controller.
+   */
+  boost::atomic<unsigned int> number_of_failed_replies_;
+
+  /**
+   * \brief The server's dedicated thread (only used in the dedicated modes).
+   */
+  boost::thread dedicated_thread_;
+
+  /**
+   * \brief Writer for capturing the received datagrams (only used if a capture file has been specified).
+   */
+  boost::shared_ptr<EGMCaptureWriter> p_capture_writer_;
+};
+
+/**
+ * \brief Class for dispatching received UDP messages to an interface, without owning any socket.
+ *
+ * Intended for servers that manage the sockets themselves (e.g. UDPMultiServer), where the interface's own UDPServer
+ * has been configured to use the external mode.
+ */
+class UDPDispatcher
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param port_number that the messages are received on.
+   * \param p_interface that processes the received messages.
+   */
+  UDPDispatcher(const unsigned short port_number, AbstractUDPServerInterface* p_interface);
+
+  /**
+   * \brief Dispatch a received message to the interface.
+   *
+   * \param p_data containing the received message.
+   * \param bytes_transferred is the number of bytes received.
+   *
+   * \return string& containing the reply (empty if no reply should be sent).
+   */
+  const std::string& dispatch(char* p_data, const int bytes_transferred);
+
+  /**
+   * \brief Notify the interface that the most recent reply has been sent.
+   *
+   * Note: Should be called in the same thread as dispatch, right after the reply has been sent.
+   */
+  void postReply();
+
+  /**
+   * \brief Retrieve the port number that the messages are received on.
+   *
+   * \return unsigned short containing the port number.
+   */
+  unsigned short getPortNumber() const;
+
+private:
+  /**
+   * \brief Pointer to an object that is derived from AbstractUDPSeverInterface, which processes the received messages.
+   */
+  AbstractUDPServerInterface* p_interface_;
+
+  /**
+   * \brief Container for server data.
+   */
+  UDPServerData server_data_;
+
+  /**
+   * \brief Empty reply, used if there is no interface.
+   */
+  std::string empty_reply_;
 };
 
 } // end namespace egm
@@ -56,42 +56,77 @@ namespace egm
 
 EGMBaseInterface::InputContainer::InputContainer()
 :
+use_robot_data_(false),
 has_new_data_(false),
 first_call_(true),
-first_message_(false),
-estimated_sample_time_(Constants::RobotController::LOWEST_SAMPLE_TIME)
+first_message_(false)
 {};
 
-bool EGMBaseInterface::InputContainer::parseFromArray(const char* data, const int bytes_transferred)
+bool EGMBaseInterface::InputContainer::parseFromArray(const char* data,
+                                                     const int bytes_transferred,
+                                                     const bool use_fast_parsing)
 {
   has_new_data_ = false;
+  use_robot_data_ = use_fast_parsing;
 
   if (data)
   {
-    has_new_data_ = egm_robot_.ParseFromArray(data, bytes_transferred);
+    if (use_robot_data_)
+    {
+      has_new_data_ = decode(&robot_data_, data, bytes_transferred);
+    }
+    else
+    {
+      has_new_data_ = egm_robot_.ParseFromArray(data, bytes_transferred);
+    }
   }
 
   if (has_new_data_)
   {
-    first_message_ = (first_call_ || egm_robot_.header().seqno() == 0);
+    const unsigned int seqno = (use_robot_data_ ? robot_data_.header.seqno : egm_robot_.header().seqno());
+    first_message_ = (first_call_ || seqno == 0);
     first_call_ = false;
   }
 
   return has_new_data_;
 }
 
-bool EGMBaseInterface::InputContainer::extractParsedInformation(const RobotAxes& axes)
+bool EGMBaseInterface::InputContainer::extractParsedInformation(const RobotAxes& axes,
+                                                               const boost::chrono::steady_clock::time_point& receive_time)
 {
   bool success = false;
 
   detectRWAndEGMVersions();
 
-  if (has_new_data_ &&
-      parse(current_.mutable_header(), egm_robot_.header()) &&
-      parse(current_.mutable_feedback(), egm_robot_.feedback(), axes) &&
-      parse(current_.mutable_planned(), egm_robot_.planned(), axes) &&
-      parse(current_.mutable_status(), egm_robot_) &&
-      parse(current_.mutable_measuredforce(), egm_robot_.measuredforce()))
+  // Select the joint mappings once, instead of branching on the axes configuration for every message.
+  if (joint_mapper_.axes != axes)
+  {
+    joint_mapper_ = JointMapper(axes);
+  }
+
+  bool parsed = false;
+
+  if (has_new_data_)
+  {
+    if (use_robot_data_)
+    {
+      parsed = (parse(current_.mutable_header(), robot_data_.header) &&
+                parse(current_.mutable_feedback(), robot_data_.feedback, joint_mapper_) &&
+                parse(current_.mutable_planned(), robot_data_.planned, joint_mapper_) &&
+                parse(current_.mutable_status(), robot_data_) &&
+                parse(current_.mutable_measuredforce(), robot_data_.measured_force));
+    }
+    else
+    {
+      parsed = (parse(current_.mutable_header(), egm_robot_.header()) &&
+                parse(current_.mutable_feedback(), egm_robot_.feedback(), joint_mapper_) &&
+                parse(current_.mutable_planned(), egm_robot_.planned(), joint_mapper_) &&
+                parse(current_.mutable_status(), egm_robot_) &&
+                parse(current_.mutable_measuredforce(), egm_robot_.measuredforce()));
+    }
+  }
+
+  if (parsed)
   {
     if (first_message_)
     {
@@ -99,7 +134,7 @@ bool EGMBaseInterface::InputContainer::extractParsedInformation(const RobotAxes&
       previous_.CopyFrom(current_);
     }
 
-    estimated_sample_time_ = estimateSampleTime();
+    clock_estimator_.update(current_.header(), current_.feedback(), receive_time, first_message_);
     success = estimateAllVelocities();
 
     has_new_data_ = false;
@@ -110,7 +145,9 @@ bool EGMBaseInterface::InputContainer::extractParsedInformation(const RobotAxes&
 
 void EGMBaseInterface::InputContainer::updatePrevious()
 {
-  previous_.CopyFrom(current_);
+  // Swapping only exchanges the internal pointers, and all fields in the current inputs are overwritten when the next
+  // message is extracted (i.e. the allocated memory is reused).
+  previous_.Swap(&current_);
 }
 
 bool EGMBaseInterface::InputContainer::statesOk() const
@@ -137,8 +174,12 @@ void EGMBaseInterface::InputContainer::detectRWAndEGMVersions()
 {
   if(has_new_data_)
   {
+    const bool has_time = (use_robot_data_ ? robot_data_.feedback.has_time : egm_robot_.feedback().has_time());
+    const bool has_utilization_rate = (use_robot_data_ ? robot_data_.has_utilization_rate :
+                                                         egm_robot_.has_utilizationrate());
+
     // Time field was added in RobotWare '6.07', as well as fix of inconsistent units (e.g. radians and degrees).
-    if(egm_robot_.feedback().has_time())
+    if(has_time)
     {
       // If time field present:
       // - RW greater than or equal to '6.07'.
@@ -146,7 +187,7 @@ void EGMBaseInterface::InputContainer::detectRWAndEGMVersions()
       current_.mutable_header()->set_egm_version(wrapper::Header_EGMVersion_EGM_1_1);
 
       // Utilization field was added in RobotWare '6.10'.
-      if(egm_robot_.has_utilizationrate())
+      if(has_utilization_rate)
       {
         // If utilization field present:
         // - RW greater than or equal to '6.10'.
@@ -175,49 +216,25 @@ void EGMBaseInterface::InputContainer::detectRWAndEGMVersions()
   }
 }
 
-double EGMBaseInterface::InputContainer::estimateSampleTime()
-{
-  double estimate = 0.0;
-
-  if (current_.has_feedback() && previous_.has_feedback() &&
-      current_.feedback().has_time() && previous_.feedback().has_time() &&
-      current_.feedback().time().has_sec() && previous_.feedback().time().has_sec() &&
-      current_.feedback().time().has_usec() && previous_.feedback().time().has_usec())
-  {
-    google::protobuf::uint64 diff_s = (current_.feedback().time().sec() - previous_.feedback().time().sec());
-    google::protobuf::uint64 diff_us = (current_.feedback().time().usec() - previous_.feedback().time().usec());
-    if (diff_s > 0)
-    {
-      diff_us += diff_s*((google::protobuf::uint64) Constants::Conversion::S_TO_US);
-    }
-
-    estimate = std::floor(((double) diff_us) * Constants::Conversion::MS_TO_S) * Constants::Conversion::MS_TO_S;
-  }
-
-  if (estimate < Constants::RobotController::LOWEST_SAMPLE_TIME)
-  {
-    estimate = Constants::RobotController::LOWEST_SAMPLE_TIME;
-  }
-
-  return estimate;
-}
-
 bool EGMBaseInterface::InputContainer::estimateAllVelocities()
 {
+  // Note: The time between the messages includes any lost messages.
+  const double elapsed_time = clock_estimator_.elapsedTime();
+
   //---------------------------------------------------------
   // Feedback
   //---------------------------------------------------------
   bool success = estimateVelocities(current_.mutable_feedback()->mutable_robot()->mutable_joints()->mutable_velocity(),
                                     current_.feedback().robot().joints().position(),
                                     previous_.feedback().robot().joints().position(),
-                                    estimated_sample_time_);
+                                    elapsed_time);
 
   if (success)
   {
     success = estimateVelocities(current_.mutable_feedback()->mutable_robot()->mutable_cartesian()->mutable_velocity(),
                                  current_.feedback().robot().cartesian().pose(),
                                  previous_.feedback().robot().cartesian().pose(),
-                                 estimated_sample_time_);
+                                 elapsed_time);
   }
 
   if (success)
@@ -225,7 +242,7 @@ bool EGMBaseInterface::InputContainer::estimateAllVelocities()
     success = estimateVelocities(current_.mutable_feedback()->mutable_external()->mutable_joints()->mutable_velocity(),
                                  current_.feedback().external().joints().position(),
                                  previous_.feedback().external().joints().position(),
-                                 estimated_sample_time_);
+                                 elapsed_time);
   }
 
   //---------------------------------------------------------
@@ -236,7 +253,7 @@ bool EGMBaseInterface::InputContainer::estimateAllVelocities()
     success = estimateVelocities(current_.mutable_planned()->mutable_robot()->mutable_joints()->mutable_velocity(),
                                  current_.planned().robot().joints().position(),
                                  previous_.planned().robot().joints().position(),
-                                 estimated_sample_time_);
+                                 elapsed_time);
   }
 
   if (success)
@@ -244,7 +261,7 @@ bool EGMBaseInterface::InputContainer::estimateAllVelocities()
     success = estimateVelocities(current_.mutable_planned()->mutable_robot()->mutable_cartesian()->mutable_velocity(),
                                  current_.planned().robot().cartesian().pose(),
                                  previous_.planned().robot().cartesian().pose(),
-                                 estimated_sample_time_);
+                                 elapsed_time);
   }
 
   if (success)
@@ -252,7 +269,7 @@ bool EGMBaseInterface::InputContainer::estimateAllVelocities()
     success = estimateVelocities(current_.mutable_planned()->mutable_external()->mutable_joints()->mutable_velocity(),
                                  current_.planned().external().joints().position(),
                                  previous_.planned().external().joints().position(),
-                                 estimated_sample_time_);
+                                 elapsed_time);
   }
 
   return success;
@@ -269,7 +286,16 @@ bool EGMBaseInterface::InputContainer::estimateAllVelocities()
  * Primary methods
  */
 
-EGMBaseInterface::OutputContainer::OutputContainer() : sequence_number_(0) {}
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const size_t EGMBaseInterface::OutputContainer::MAX_REPLY_SIZE;
+
+EGMBaseInterface::OutputContainer::OutputContainer()
+:
+sequence_number_(0)
+{
+  // Preallocate the reply's storage, so that the serialization never needs to reallocate.
+  reply_.reserve(MAX_REPLY_SIZE);
+}
 
 void EGMBaseInterface::OutputContainer::prepareOutputs(const InputContainer& inputs)
 {
@@ -398,6 +424,11 @@ void EGMBaseInterface::OutputContainer::generateDemoOutputs(const InputContainer
 
 void EGMBaseInterface::OutputContainer::constructReply(const BaseConfiguration& configuration)
 {
+  if (joint_mapper_.axes != configuration.axes)
+  {
+    joint_mapper_ = JointMapper(configuration.axes);
+  }
+
   constructHeader();
   bool success = constructJointBody(configuration);
 
@@ -408,7 +439,15 @@ void EGMBaseInterface::OutputContainer::constructReply(const BaseConfiguration&
 
   if (success)
   {
-    success = egm_sensor_.SerializeToString(&reply_);
+    // Serialize directly into the reply's preallocated storage.
+    const size_t size = egm_sensor_.ByteSizeLong();
+    success = (size <= MAX_REPLY_SIZE);
+
+    if (success)
+    {
+      reply_.resize(size);
+      egm_sensor_.SerializeWithCachedSizesToArray(reinterpret_cast<google::protobuf::uint8*>(&reply_[0]));
+    }
   }
 
   if (!success)
@@ -503,8 +542,10 @@ bool EGMBaseInterface::OutputContainer::constructJointBody(const BaseConfigurati
   bool position_ok = false;
   bool speed_ok = !configuration.use_velocity_outputs;
 
-  int rob_condition = Constants::RobotController::DEFAULT_NUMBER_OF_ROBOT_JOINTS;
-  int ext_condition = Constants::RobotController::DEFAULT_NUMBER_OF_EXTERNAL_JOINTS;
+  double robot_values[RobotData::MAX_NUMBER_OF_VALUES];
+  double external_values[RobotData::MAX_NUMBER_OF_VALUES];
+  int robot_size = 0;
+  int external_size = 0;
 
   if (current.robot().joints().has_position())
   {
@@ -518,68 +559,29 @@ bool EGMBaseInterface::OutputContainer::constructJointBody(const BaseConfigurati
       return false;
     }
 
+    position_ok = joint_mapper_.map(robot_values, &robot_size,
+                                    external_values, &external_size,
+                                    robot_position, external_position);
+
     // EGM sensor message.
     EgmPlanned* planned = egm_sensor_.mutable_planned();
-    planned->clear_joints();
-    planned->clear_externaljoints();
 
-    switch (configuration.axes)
+    if (position_ok && robot_size > 0)
     {
-      case None:
-      {
-        if (robot_position.values_size() == 0)
-        {
-          for (int i = 0; i < external_position.values_size() && i < ext_condition; ++i)
-          {
-            planned->mutable_externaljoints()->add_joints(external_position.values(i));
-          }
-
-          position_ok = true;
-        }
-      }
-      break;
-
-      case Six:
-      {
-        if (robot_position.values_size() == rob_condition)
-        {
-          for (int i = 0; i < robot_position.values_size(); ++i)
-          {
-            planned->mutable_joints()->add_joints(robot_position.values(i));
-          }
-
-          for (int i = 0; i < external_position.values_size() && i < ext_condition; ++i)
-          {
-            planned->mutable_externaljoints()->add_joints(external_position.values(i));
-          }
-
-          position_ok = true;
-        }
-      }
-      break;
+      assign(planned->mutable_joints(), robot_values, robot_size);
+    }
+    else
+    {
+      planned->clear_joints();
+    }
 
-      case Seven:
-      {
-        // If using a seven axes robot (e.g. IRB14000): Map to special case.
-        if (robot_position.values_size() == rob_condition + 1)
-        {
-          planned->mutable_joints()->add_joints(robot_position.values(0));
-          planned->mutable_joints()->add_joints(robot_position.values(1));
-          planned->mutable_joints()->add_joints(robot_position.values(3));
-          planned->mutable_joints()->add_joints(robot_position.values(4));
-          planned->mutable_joints()->add_joints(robot_position.values(5));
-          planned->mutable_joints()->add_joints(robot_position.values(6));
-          planned->mutable_externaljoints()->add_joints(robot_position.values(2));
-
-          for (int i = 0; i < external_position.values_size() && i < ext_condition - 1; ++i)
-          {
-            planned->mutable_externaljoints()->add_joints(external_position.values(i));
-          }
-
-          position_ok = true;
-        }
-      }
-      break;
+    if (position_ok && external_size > 0)
+    {
+      assign(planned->mutable_externaljoints(), external_values, external_size);
+    }
+    else
+    {
+      planned->clear_externaljoints();
     }
   }
 
@@ -595,74 +597,52 @@ bool EGMBaseInterface::OutputContainer::constructJointBody(const BaseConfigurati
       return false;
     }
 
+    speed_ok = joint_mapper_.map(robot_values, &robot_size,
+                                 external_values, &external_size,
+                                 robot_velocity, external_velocity);
+
     // EGM sensor message.
     EgmSpeedRef* speed_reference = egm_sensor_.mutable_speedref();
-    speed_reference->clear_joints();
-    speed_reference->clear_externaljoints();
 
-    switch (configuration.axes)
+    if (speed_ok && robot_size > 0)
     {
-      case None:
-      {
-        if (robot_velocity.values_size() == 0)
-        {
-          for (int i = 0; i < external_velocity.values_size() && i < ext_condition; ++i)
-          {
-            speed_reference->mutable_externaljoints()->add_joints(external_velocity.values(i));
-          }
-
-          speed_ok = true;
-        }
-      }
-      break;
-
-      case Six:
-      {
-        if (robot_velocity.values_size() == rob_condition)
-        {
-          for (int i = 0; i < robot_velocity.values_size(); ++i)
-          {
-            speed_reference->mutable_joints()->add_joints(robot_velocity.values(i));
-          }
-
-          for (int i = 0; i < external_velocity.values_size() && i < ext_condition; ++i)
-          {
-            speed_reference->mutable_externaljoints()->add_joints(external_velocity.values(i));
-          }
-
-          speed_ok = true;
-        }
-      }
-      break;
+      assign(speed_reference->mutable_joints(), robot_values, robot_size);
+    }
+    else
+    {
+      speed_reference->clear_joints();
+    }
 
-      case Seven:
-      {
-        // If using a seven axes robot (e.g. IRB14000): Map to special case.
-        if (robot_velocity.values_size() == rob_condition + 1)
-        {
-          speed_reference->mutable_joints()->add_joints(robot_velocity.values(0));
-          speed_reference->mutable_joints()->add_joints(robot_velocity.values(1));
-          speed_reference->mutable_joints()->add_joints(robot_velocity.values(3));
-          speed_reference->mutable_joints()->add_joints(robot_velocity.values(4));
-          speed_reference->mutable_joints()->add_joints(robot_velocity.values(5));
-          speed_reference->mutable_joints()->add_joints(robot_velocity.values(6));
-          speed_reference->mutable_externaljoints()->add_joints(robot_velocity.values(2));
-
-          for (int i = 0; i < external_velocity.values_size() && i < ext_condition - 1; ++i)
-          {
-            speed_reference->mutable_externaljoints()->add_joints(external_velocity.values(i));
-          }
-
-          speed_ok = true;
-        }
-      }
-      break;
+    if (speed_ok && external_size > 0)
+    {
+      assign(speed_reference->mutable_externaljoints(), external_values, external_size);
+    }
+    else
+    {
+      speed_reference->clear_externaljoints();
     }
   }
+  else if (!configuration.use_velocity_outputs && egm_sensor_.has_speedref())
+  {
+    // Velocity outputs can be disabled during a session, so drop any previous (joint and Cartesian) speed references.
+    egm_sensor_.clear_speedref();
+  }
 
   return (position_ok && speed_ok);
 }
 
+void EGMBaseInterface::OutputContainer::assign(EgmJoints* p_target, const double* p_values, const int size)
+{
+  // Resizing keeps the allocated capacity, and the values are then set in place.
+  google::protobuf::RepeatedField<double>* p_joints = p_target->mutable_joints();
+  p_joints->Resize(size, 0.0);
+
+  for (int i = 0; i < size; ++i)
+  {
+    p_joints->Set(i, p_values[i]);
+  }
+}
+
 bool EGMBaseInterface::OutputContainer::constructCartesianBody(const BaseConfiguration& configuration)
 {
   bool position_ok = false;
@@ -719,38 +699,25 @@ bool EGMBaseInterface::OutputContainer::constructCartesianBody(const BaseConfigu
       return false;
     }
 
-    // EGM sensor message.
+    // EGM sensor message (resized and set in place, i.e. reusing the already allocated capacity).
     EgmSpeedRef* speed_reference = egm_sensor_.mutable_speedref();
-    speed_reference->clear_cartesians();
+    google::protobuf::RepeatedField<double>* p_values = speed_reference->mutable_cartesians()->mutable_value();
+    p_values->Resize(6, 0.0);
 
-    if (velocity.has_linear())
-    {
-      speed_reference->mutable_cartesians()->add_value(velocity.linear().x());
-      speed_reference->mutable_cartesians()->add_value(velocity.linear().y());
-      speed_reference->mutable_cartesians()->add_value(velocity.linear().z());
-    }
-    else
-    {
-      speed_reference->mutable_cartesians()->add_value(0.0);
-      speed_reference->mutable_cartesians()->add_value(0.0);
-      speed_reference->mutable_cartesians()->add_value(0.0);
-    }
+    p_values->Set(0, velocity.has_linear() ? velocity.linear().x() : 0.0);
+    p_values->Set(1, velocity.has_linear() ? velocity.linear().y() : 0.0);
+    p_values->Set(2, velocity.has_linear() ? velocity.linear().z() : 0.0);
 
-    if (velocity.has_angular())
-    {
-      speed_reference->mutable_cartesians()->add_value(velocity.angular().x());
-      speed_reference->mutable_cartesians()->add_value(velocity.angular().y());
-      speed_reference->mutable_cartesians()->add_value(velocity.angular().z());
-    }
-    else
-    {
-      speed_reference->mutable_cartesians()->add_value(0.0);
-      speed_reference->mutable_cartesians()->add_value(0.0);
-      speed_reference->mutable_cartesians()->add_value(0.0);
-    }
+    p_values->Set(3, velocity.has_angular() ? velocity.angular().x() : 0.0);
+    p_values->Set(4, velocity.has_angular() ? velocity.angular().y() : 0.0);
+    p_values->Set(5, velocity.has_angular() ? velocity.angular().z() : 0.0);
 
     speed_ok = true;
   }
+  else if (!configuration.use_velocity_outputs && egm_sensor_.has_speedref())
+  {
+    egm_sensor_.clear_speedref();
+  }
 
   return (position_ok && speed_ok);
 }
@@ -762,30 +729,49 @@ bool EGMBaseInterface::OutputContainer::constructCartesianBody(const BaseConfigu
  * Class definitions: EGMBaseInterface
  */
 
-// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
-const unsigned int EGMBaseInterface::WAIT_TIME_MS;
-
 /************************************************************
  * Primary methods
  */
 
 EGMBaseInterface::EGMBaseInterface(boost::asio::io_service& io_service,
                                    const unsigned short port_number,
-                                   const BaseConfiguration& configuration)
+                                   const BaseConfiguration& configuration,
+                                   const bool start_server)
 :
-udp_server_(io_service, port_number, this),
+connection_monitor_(configuration.connection_callback),
+event_notifier_(configuration.use_event_descriptor),
+udp_server_(io_service, port_number, this, configuration.udp_server),
 configuration_(configuration)
 {
-  if (configuration_.active.use_logging)
+  initializeLogger(port_number, configuration_.active);
+
+  if (configuration.telemetry.use_telemetry)
   {
-    std::stringstream ss;
-    ss << "port_" << port_number << +"_log.csv";
-    p_logger_.reset(new EGMLogger(ss.str()));
+    p_telemetry_.reset(new EGMTelemetryPublisher(configuration.telemetry));
+  }
+
+  if (start_server)
+  {
+    udp_server_.start();
   }
 }
 
+EGMBaseInterface::~EGMBaseInterface()
+{
+  udp_server_.stop();
+}
+
 const std::string& EGMBaseInterface::callback(const UDPServerData& server_data)
 {
+  // Check the callback's real-time safety (if built with the checks).
+  ScopedRealTimeSection real_time_section(rt_checker_);
+
+  // Apply any requested configuration changes (that are allowed during a session).
+  refreshConfiguration();
+
+  // Start collecting statistics for the callback, if set to do so.
+  statistics_.startCycle(configuration_.active.use_statistics, server_data.receive_time);
+
   // Initialize the callback by:
   // - Parsing and extracting data from the received message.
   // - Updating any pending configuration changes.
@@ -798,20 +784,35 @@ const std::string& EGMBaseInterface::callback(const UDPServerData& server_data)
       outputs_.generateDemoOutputs(inputs_);
     }
 
+    statistics_.markStage(EGMStatisticsCollector::Outputs);
+
     // Log inputs and outputs.
-    if (configuration_.active.use_logging && p_logger_)
+    if (configuration_.active.use_logging)
     {
       logData(inputs_, outputs_, configuration_.active.max_logging_duration);
+      statistics_.markStage(EGMStatisticsCollector::Logging);
     }
 
     // Constuct the reply message.
     outputs_.constructReply(configuration_.active);
+    statistics_.markStage(EGMStatisticsCollector::Reply);
+
+    // Publish the (optional) telemetry.
+    if (p_telemetry_)
+    {
+      p_telemetry_->add(inputs_.current(), outputs_.current);
+    }
 
     // Prepare for the next callback.
     inputs_.updatePrevious();
     outputs_.updatePrevious();
+
+    // Signal the (optional) event descriptor.
+    event_notifier_.notify();
   }
 
+  statistics_.endCycle();
+
   // Return the reply.
   return outputs_.reply();
 }
@@ -820,9 +821,73 @@ const std::string& EGMBaseInterface::callback(const UDPServerData& server_data)
  * Auxiliary methods
  */
 
+void EGMBaseInterface::applyRuntimeParameters(BaseConfiguration* p_active, const BaseConfiguration& latest)
+{
+  if (p_active)
+  {
+    p_active->use_velocity_outputs = latest.use_velocity_outputs;
+    p_active->use_logging = latest.use_logging;
+    p_active->max_logging_duration = latest.max_logging_duration;
+    p_active->use_non_blocking_outputs = latest.use_non_blocking_outputs;
+    p_active->use_output_extrapolation = latest.use_output_extrapolation;
+    p_active->extrapolation_duration = latest.extrapolation_duration;
+    p_active->use_statistics = latest.use_statistics;
+    p_active->p_new_message_cv = latest.p_new_message_cv;
+  }
+}
+
+void EGMBaseInterface::refreshConfiguration()
+{
+  if (configuration_.snapshots.refresh())
+  {
+    applyRuntimeParameters(&configuration_.active, configuration_.snapshots.current());
+    configuration_.has_pending_update = true;
+  }
+}
+
+void EGMBaseInterface::initializeLogger(const unsigned short port_number, const BaseConfiguration& configuration)
+{
+  if (configuration.use_logging)
+  {
+    std::stringstream ss;
+    ss << "port_" << port_number;
+
+    p_logger_.reset();
+    p_async_logger_.reset();
+    p_columnar_logger_.reset();
+
+    if (configuration.use_columnar_logging)
+    {
+      p_columnar_logger_.reset(new EGMColumnarLogger(ss.str() + "_log"));
+    }
+    else if (configuration.use_asynchronous_logging)
+    {
+      p_async_logger_.reset(new EGMAsyncLogger(ss.str() + "_log.bin"));
+    }
+    else
+    {
+      p_logger_.reset(new EGMLogger(ss.str() + "_log.csv"));
+    }
+  }
+}
+
 void EGMBaseInterface::logData(const InputContainer& inputs, const OutputContainer& outputs, const double max_time)
 {
-  if (p_logger_ && p_logger_->calculateTimeLogged(inputs_.estimatedSampleTime()) <= max_time)
+  if (p_columnar_logger_)
+  {
+    if (p_columnar_logger_->calculateTimeLogged(inputs.estimatedSampleTime()) <= max_time)
+    {
+      p_columnar_logger_->add(inputs.current(), outputs.current);
+    }
+  }
+  else if (p_async_logger_)
+  {
+    if (p_async_logger_->calculateTimeLogged(inputs.estimatedSampleTime()) <= max_time)
+    {
+      p_async_logger_->add(inputs.current(), outputs.current);
+    }
+  }
+  else if (p_logger_ && p_logger_->calculateTimeLogged(inputs_.estimatedSampleTime()) <= max_time)
   {
     const wrapper::Feedback& feedback = inputs.current().feedback();
     const wrapper::Planned& planned = inputs.current().planned();
@@ -861,28 +926,36 @@ bool EGMBaseInterface::initializeCallback(const UDPServerData& server_data)
   // Parse the received message.
   if (server_data.p_data)
   {
-    success = inputs_.parseFromArray(server_data.p_data, server_data.bytes_transferred);
+    success = inputs_.parseFromArray(server_data.p_data,
+                                     server_data.bytes_transferred,
+                                     configuration_.active.use_fast_input_parsing);
+
+    statistics_.markStage(EGMStatisticsCollector::Parse);
   }
 
-  // Update configuration, if requested to do so.
-  if (success && inputs_.isFirstMessage())
+  // Update the session parameters, if requested to do so.
+  if (success && inputs_.isFirstMessage() && configuration_.has_pending_update)
   {
-    boost::lock_guard<boost::mutex> lock(configuration_.mutex);
-
-    if (configuration_.has_pending_update)
-    {
-      configuration_.active = configuration_.update;
-      configuration_.has_pending_update = false;
-    }
+    configuration_.active = configuration_.snapshots.current();
+    configuration_.has_pending_update = false;
   }
 
   // Extract information from the parsed message.
   if (success)
   {
-    success = inputs_.extractParsedInformation(configuration_.active.axes);
+    success = inputs_.extractParsedInformation(configuration_.active.axes, server_data.receive_time);
+
+    statistics_.markStage(EGMStatisticsCollector::Extract);
 
+    if (success)
     {
-      boost::lock_guard<boost::mutex> lock(session_data_.mutex);
+      statistics_.updateSequence(inputs_.isFirstMessage(),
+                                 inputs_.current().header().sequence_number(),
+                                 inputs_.estimatedSampleTime());
+    }
+
+    {
+      RealTimeLockGuard<boost::mutex> lock(session_data_.mutex);
 
       // Update the session data.
       if (success)
@@ -896,6 +969,16 @@ bool EGMBaseInterface::initializeCallback(const UDPServerData& server_data)
         session_data_.status.Clear();
       }
     }
+
+    // Update the connection's liveness.
+    if (success)
+    {
+      connection_monitor_.update(server_data.receive_time, inputs_.isFirstMessage());
+    }
+    else
+    {
+      connection_monitor_.invalidate();
+    }
   }
 
   // Prepare the outputs.
@@ -919,33 +1002,60 @@ bool EGMBaseInterface::isInitialized()
 
 bool EGMBaseInterface::isConnected()
 {
-  wrapper::Header header_1;
-  wrapper::Header header_2;
+  return connection_monitor_.isConnected();
+}
+
+ConnectionStatus EGMBaseInterface::getConnectionStatus()
+{
+  return connection_monitor_.getStatus();
+}
+
+int EGMBaseInterface::getEventDescriptor()
+{
+  return event_notifier_.descriptor();
+}
+
+unsigned int EGMBaseInterface::acknowledgeEvents()
+{
+  return event_notifier_.acknowledge();
+}
+
+int EGMBaseInterface::addTelemetrySubscriber(const TelemetryCallback& callback)
+{
+  return (p_telemetry_ ? p_telemetry_->addSubscriber(callback) : -1);
+}
+
+bool EGMBaseInterface::removeTelemetrySubscriber(const int id)
+{
+  return (p_telemetry_ ? p_telemetry_->removeSubscriber(id) : false);
+}
+
+bool EGMBaseInterface::retrieveClockEstimate(ClockEstimate* p_estimate)
+{
+  bool result = false;
 
+  if (p_estimate)
   {
-    boost::lock_guard<boost::mutex> lock(session_data_.mutex);
-    header_1.CopyFrom(session_data_.header);
+    result = inputs_.clockEstimator().retrieveEstimate(p_estimate);
   }
 
-  boost::this_thread::sleep(boost::posix_time::milliseconds(WAIT_TIME_MS));
+  return result;
+}
 
-  {
-    boost::lock_guard<boost::mutex> lock(session_data_.mutex);
-    header_2.CopyFrom(session_data_.header);
-  }
-
-  // Check for if an EGM communication session is connected or not. This is determined by comparing
-  // two header messages, received at two different time instances, according to:
-  // 1. Both headers must have a sequence number and a time stamp.
-  // 2. The sequence number of the second header must be larger than that of the first header.
-  // 3. The time stamp of the second header must be larger than that of the first header.
-  // 4. The difference in time stamp must be near the wait time.
-  return (header_1.has_sequence_number() && header_1.has_time_stamp()) &&
-         (header_2.has_sequence_number() && header_2.has_time_stamp()) &&
-         (header_2.sequence_number() > header_1.sequence_number()) &&
-         (header_2.time_stamp() > header_1.time_stamp()) &&
-         (header_2.time_stamp() - header_1.time_stamp() <= 2 * WAIT_TIME_MS);
-};
+bool EGMBaseInterface::retrieveRealTimeReport(RealTimeReport* p_report)
+{
+  return rt_checker_.retrieveReport(p_report);
+}
+
+UDPServer::ThreadAttributesStatus EGMBaseInterface::getThreadAttributesStatus()
+{
+  return udp_server_.getThreadAttributesStatus();
+}
+
+unsigned int EGMBaseInterface::getNumberOfFailedReplies()
+{
+  return udp_server_.getNumberOfFailedReplies();
+}
 
 wrapper::Status EGMBaseInterface::getStatus()
 {
@@ -959,19 +1069,24 @@ wrapper::Status EGMBaseInterface::getStatus()
   return status;
 };
 
-BaseConfiguration EGMBaseInterface::getConfiguration()
+InterfaceStatistics EGMBaseInterface::getStatistics()
+{
+  return statistics_.getStatistics();
+}
+
+void EGMBaseInterface::resetStatistics()
 {
-  boost::lock_guard<boost::mutex> lock(configuration_.mutex);
+  statistics_.reset();
+}
 
-  return configuration_.update;
+BaseConfiguration EGMBaseInterface::getConfiguration()
+{
+  return configuration_.snapshots.latest();
 }
 
 void EGMBaseInterface::setConfiguration(const BaseConfiguration& configuration)
 {
-  boost::lock_guard<boost::mutex> lock(configuration_.mutex);
-
-  configuration_.update = configuration;
-  configuration_.has_pending_update = true;
+  configuration_.snapshots.publish(configuration);
 }
 
 } // end namespace egm
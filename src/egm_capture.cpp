@@ -0,0 +1,285 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <cstring>
+
+#include <boost/bind/bind.hpp>
+
+#include "abb_libegm/egm_capture.h"
+
+namespace abb
+{
+namespace egm
+{
+/***********************************************************************************************************************
+ * Struct definitions: CaptureRecord
+ */
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const size_t CaptureRecord::MAX_DATA_SIZE;
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: EGMCaptureWriter
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const size_t EGMCaptureWriter::DEFAULT_CAPACITY;
+const size_t EGMCaptureWriter::BATCH_SIZE;
+const unsigned int EGMCaptureWriter::IDLE_WAIT_TIME_MS;
+const char EGMCaptureWriter::MAGIC[8] = {'E', 'G', 'M', 'C', 'A', 'P', '0', '1'};
+
+EGMCaptureWriter::EGMCaptureWriter(const std::string& filename, const size_t capacity)
+:
+start_time_(boost::chrono::steady_clock::now()),
+number_of_dropped_datagrams_(0),
+stop_requested_(false),
+ring_buffer_(capacity)
+{
+  capture_stream_.open(filename.c_str(), std::ios::trunc | std::ios::binary);
+  capture_stream_.write(MAGIC, sizeof(MAGIC));
+  capture_stream_.flush();
+
+  writer_thread_ = boost::thread(&EGMCaptureWriter::writerThread, this);
+}
+
+EGMCaptureWriter::~EGMCaptureWriter()
+{
+  stop_requested_ = true;
+  writer_thread_.join();
+  capture_stream_.close();
+}
+
+bool EGMCaptureWriter::isOpen() const
+{
+  return capture_stream_.is_open();
+}
+
+bool EGMCaptureWriter::add(const UDPServerData& server_data)
+{
+  if (!server_data.p_data ||
+      server_data.bytes_transferred < 0 ||
+      server_data.bytes_transferred > (int) CaptureRecord::MAX_DATA_SIZE)
+  {
+    ++number_of_dropped_datagrams_;
+    return false;
+  }
+
+  CaptureRecord* p_record = ring_buffer_.writeSlot();
+
+  if (!p_record)
+  {
+    ++number_of_dropped_datagrams_;
+    return false;
+  }
+
+  const boost::chrono::nanoseconds time = server_data.receive_time - start_time_;
+
+  p_record->time_ns = (time.count() > 0 ? (boost::uint64_t) time.count() : 0);
+  p_record->port_number = (boost::uint16_t) server_data.port_number;
+  p_record->size = (boost::uint16_t) server_data.bytes_transferred;
+  std::memcpy(p_record->data, server_data.p_data, p_record->size);
+  ring_buffer_.publish();
+
+  return true;
+}
+
+size_t EGMCaptureWriter::numberOfDroppedDatagrams() const
+{
+  return number_of_dropped_datagrams_;
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+void EGMCaptureWriter::writerThread()
+{
+  consumeRingBuffer(&ring_buffer_,
+                    stop_requested_,
+                    BATCH_SIZE,
+                    IDLE_WAIT_TIME_MS,
+                    boost::bind(&EGMCaptureWriter::writeRecord, this, boost::placeholders::_1),
+                    boost::bind(&EGMCaptureWriter::flushCapture, this));
+}
+
+void EGMCaptureWriter::writeRecord(const CaptureRecord& record)
+{
+  capture_stream_.write(reinterpret_cast<const char*>(&record.time_ns), sizeof(record.time_ns));
+  capture_stream_.write(reinterpret_cast<const char*>(&record.port_number), sizeof(record.port_number));
+  capture_stream_.write(reinterpret_cast<const char*>(&record.size), sizeof(record.size));
+  capture_stream_.write(record.data, record.size);
+}
+
+void EGMCaptureWriter::flushCapture()
+{
+  capture_stream_.flush();
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: EGMCaptureReader
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+EGMCaptureReader::EGMCaptureReader(const std::string& filename)
+:
+capture_stream_(filename.c_str(), std::ios::binary),
+valid_(false)
+{
+  char magic[sizeof(EGMCaptureWriter::MAGIC)];
+
+  if (capture_stream_.read(magic, sizeof(magic)))
+  {
+    valid_ = (std::memcmp(magic, EGMCaptureWriter::MAGIC, sizeof(magic)) == 0);
+  }
+}
+
+bool EGMCaptureReader::isOpen() const
+{
+  return valid_;
+}
+
+bool EGMCaptureReader::next(CaptureRecord* p_record)
+{
+  bool success = false;
+
+  if (valid_ && p_record)
+  {
+    capture_stream_.read(reinterpret_cast<char*>(&p_record->time_ns), sizeof(p_record->time_ns));
+    capture_stream_.read(reinterpret_cast<char*>(&p_record->port_number), sizeof(p_record->port_number));
+    capture_stream_.read(reinterpret_cast<char*>(&p_record->size), sizeof(p_record->size));
+
+    if (capture_stream_ && p_record->size <= CaptureRecord::MAX_DATA_SIZE)
+    {
+      success = (bool) capture_stream_.read(p_record->data, p_record->size);
+    }
+  }
+
+  return success;
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: EGMReplayDriver
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+EGMReplayDriver::EGMReplayDriver(AbstractUDPServerInterface* p_interface)
+:
+p_interface_(p_interface),
+number_of_replayed_datagrams_(0),
+number_of_replies_(0)
+{}
+
+bool EGMReplayDriver::replay(const std::string& filename, const double speed_factor, const unsigned short port_number)
+{
+  EGMCaptureReader reader(filename);
+
+  if (!p_interface_ || !reader.isOpen())
+  {
+    return false;
+  }
+
+  number_of_replayed_datagrams_ = 0;
+  number_of_replies_ = 0;
+
+  CaptureRecord record;
+  bool has_first_time = false;
+  boost::uint64_t first_time_ns = 0;
+  const boost::chrono::steady_clock::time_point start_time = boost::chrono::steady_clock::now();
+
+  while (reader.next(&record))
+  {
+    if (port_number != 0 && record.port_number != port_number)
+    {
+      continue;
+    }
+
+    if (!has_first_time)
+    {
+      first_time_ns = record.time_ns;
+      has_first_time = true;
+    }
+
+    if (speed_factor > 0.0)
+    {
+      // Pace the replay according to the recorded receive times.
+      const double offset_ns = (record.time_ns - first_time_ns) / speed_factor;
+      boost::this_thread::sleep_until(start_time + boost::chrono::nanoseconds((boost::int64_t) offset_ns));
+    }
+
+    UDPDispatcher dispatcher(record.port_number, p_interface_);
+
+    if (!dispatcher.dispatch(record.data, record.size).empty())
+    {
+      ++number_of_replies_;
+    }
+
+    ++number_of_replayed_datagrams_;
+  }
+
+  return true;
+}
+
+size_t EGMReplayDriver::numberOfReplayedDatagrams() const
+{
+  return number_of_replayed_datagrams_;
+}
+
+size_t EGMReplayDriver::numberOfReplies() const
+{
+  return number_of_replies_;
+}
+
+} // end namespace egm
+} // end namespace abb
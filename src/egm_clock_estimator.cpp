@@ -0,0 +1,253 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "abb_libegm/egm_clock_estimator.h"
+#include "abb_libegm/egm_common.h"
+
+namespace abb
+{
+namespace egm
+{
+/***********************************************************************************************************************
+ * Class definitions: EGMClockEstimator
+ */
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const double EGMClockEstimator::SAMPLE_TIME_SMOOTHING = 0.05;
+const double EGMClockEstimator::SAMPLE_TIME_TOLERANCE = 0.5;
+const double EGMClockEstimator::FORGETTING_FACTOR = 0.999;
+const double EGMClockEstimator::INITIAL_COVARIANCE = 1.0;
+const double EGMClockEstimator::JITTER_SMOOTHING = 0.05;
+const unsigned int EGMClockEstimator::MAX_OUTLIERS;
+const unsigned int EGMClockEstimator::MAX_SEQUENCE_GAP;
+
+/************************************************************
+ * Primary methods
+ */
+
+EGMClockEstimator::EGMClockEstimator()
+:
+number_of_outliers_(0),
+number_of_skipped_messages_(0),
+previous_sequence_number_(0),
+first_controller_time_(0),
+previous_controller_time_(0),
+first_offset_(0.0),
+variance_(0.0)
+{
+  estimate_.sample_time = Constants::RobotController::LOWEST_SAMPLE_TIME;
+
+  theta_[0] = 0.0;
+  theta_[1] = 0.0;
+  covariance_[0] = INITIAL_COVARIANCE;
+  covariance_[1] = 0.0;
+  covariance_[2] = 0.0;
+  covariance_[3] = INITIAL_COVARIANCE;
+}
+
+void EGMClockEstimator::update(const wrapper::Header& header,
+                               const wrapper::Feedback& feedback,
+                               const boost::chrono::steady_clock::time_point& receive_time,
+                               const bool first_message)
+{
+  typedef boost::chrono::duration<double> Seconds;
+
+  const boost::chrono::steady_clock::time_point receive = (receive_time != boost::chrono::steady_clock::time_point() ?
+                                                           receive_time : boost::chrono::steady_clock::now());
+
+  const bool has_controller_clock = (feedback.has_time() && feedback.time().has_sec() && feedback.time().has_usec());
+
+  const boost::uint64_t controller_time = (has_controller_clock ?
+                                           feedback.time().sec()*((boost::uint64_t) Constants::Conversion::S_TO_US) +
+                                           feedback.time().usec() : 0);
+
+  // Note: The sequence numbers wrap around, so a reordered message gives a negative (signed) gap.
+  const boost::int32_t sequence_gap = (boost::int32_t) (header.sequence_number() - previous_sequence_number_);
+
+  const bool new_session = (first_message || estimate_.number_of_samples == 0 ||
+                            has_controller_clock != estimate_.has_controller_clock);
+
+  if (!new_session && sequence_gap < 0 && number_of_skipped_messages_ < MAX_OUTLIERS)
+  {
+    // Skip the reordered message, the estimates are only based on messages that move forward.
+    ++number_of_skipped_messages_;
+    return;
+  }
+
+  number_of_skipped_messages_ = 0;
+
+  if (new_session || sequence_gap < 0 || sequence_gap > (boost::int32_t) MAX_SEQUENCE_GAP ||
+      (has_controller_clock && controller_time < previous_controller_time_))
+  {
+    // Restart the estimation (e.g. for a new session, or if the controller clock or sequence numbers have been reset).
+    estimate_ = ClockEstimate();
+    estimate_.sample_time = Constants::RobotController::LOWEST_SAMPLE_TIME;
+    estimate_.has_controller_clock = has_controller_clock;
+
+    number_of_outliers_ = 0;
+    first_controller_time_ = controller_time;
+    first_receive_time_ = receive;
+    first_offset_ = Seconds(receive.time_since_epoch()).count() - controller_time/Constants::Conversion::S_TO_US;
+    theta_[0] = 0.0;
+    theta_[1] = 0.0;
+    covariance_[0] = INITIAL_COVARIANCE;
+    covariance_[1] = 0.0;
+    covariance_[2] = 0.0;
+    covariance_[3] = INITIAL_COVARIANCE;
+    variance_ = 0.0;
+  }
+  else
+  {
+    if (has_controller_clock)
+    {
+      const double difference = (controller_time - previous_controller_time_)/Constants::Conversion::S_TO_US;
+      const double elapsed = (controller_time - first_controller_time_)/Constants::Conversion::S_TO_US;
+
+      updateSampleTime(difference, (boost::uint32_t) sequence_gap);
+      updateClockRelation(difference, Seconds(receive - first_receive_time_).count() - elapsed);
+    }
+    else
+    {
+      updateSampleTime(Seconds(receive - estimate_.last_receive_time).count(), (boost::uint32_t) sequence_gap);
+    }
+  }
+
+  ++estimate_.number_of_samples;
+  previous_sequence_number_ = header.sequence_number();
+  previous_controller_time_ = controller_time;
+  estimate_.last_receive_time = receive;
+
+  // Predict when the next message will be received.
+  if (has_controller_clock)
+  {
+    const double elapsed = (controller_time - first_controller_time_)/Constants::Conversion::S_TO_US;
+
+    estimate_.clock_offset = first_offset_ + theta_[0];
+    estimate_.clock_drift = theta_[1];
+    estimate_.filtered_receive_time = first_receive_time_ +
+                                      boost::chrono::duration_cast<boost::chrono::steady_clock::duration>(
+                                        Seconds(elapsed + theta_[0]));
+    estimate_.next_receive_time = first_receive_time_ +
+                                  boost::chrono::duration_cast<boost::chrono::steady_clock::duration>(
+                                    Seconds(elapsed + estimate_.sample_time +
+                                            theta_[0] + theta_[1]*estimate_.sample_time));
+  }
+  else
+  {
+    estimate_.filtered_receive_time = receive;
+    estimate_.next_receive_time = receive + boost::chrono::duration_cast<boost::chrono::steady_clock::duration>(
+                                              Seconds(estimate_.sample_time));
+  }
+
+  estimate_.receive_jitter = std::sqrt(variance_);
+
+  estimates_.store(estimate_);
+}
+
+bool EGMClockEstimator::retrieveEstimate(ClockEstimate* p_estimate) const
+{
+  return estimates_.tryLoad(p_estimate);
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+void EGMClockEstimator::updateSampleTime(const double difference, const boost::uint32_t sequence_gap)
+{
+  // Note: A zero gap means that the sequence numbers are missing, so assume that no message was lost.
+  estimate_.sample_gap = (sequence_gap > 0 ? sequence_gap : 1);
+
+  if (difference > 0.0)
+  {
+    const double sample_time = difference/estimate_.sample_gap;
+
+    if (estimate_.number_of_samples == 1 || number_of_outliers_ >= MAX_OUTLIERS)
+    {
+      // Initialize (or restart) the filter.
+      estimate_.sample_time = std::max(Constants::RobotController::LOWEST_SAMPLE_TIME, sample_time);
+      number_of_outliers_ = 0;
+    }
+    else if (std::abs(sample_time - estimate_.sample_time) <= SAMPLE_TIME_TOLERANCE*estimate_.sample_time)
+    {
+      estimate_.sample_time += SAMPLE_TIME_SMOOTHING*(sample_time - estimate_.sample_time);
+      number_of_outliers_ = 0;
+    }
+    else
+    {
+      ++number_of_outliers_;
+    }
+  }
+}
+
+void EGMClockEstimator::updateClockRelation(const double difference, const double offset)
+{
+  // Move the relation forward to the most recent message, i.e. apply [1 difference; 0 1] to the parameters,
+  // and to both sides of the covariance.
+  theta_[0] += theta_[1]*difference;
+
+  covariance_[0] += difference*(covariance_[1] + covariance_[2] + difference*covariance_[3]);
+  covariance_[1] += difference*covariance_[3];
+  covariance_[2] += difference*covariance_[3];
+
+  // Update with the measured offset (i.e. the regressor is [1 0] at the most recent message).
+  const double error = offset - theta_[0];
+  const double denominator = FORGETTING_FACTOR + covariance_[0];
+  const double gain[2] = {covariance_[0]/denominator, covariance_[2]/denominator};
+
+  theta_[0] += gain[0]*error;
+  theta_[1] += gain[1]*error;
+
+  const double p_00 = covariance_[0];
+  const double p_01 = covariance_[1];
+
+  covariance_[0] = (covariance_[0] - gain[0]*p_00)/FORGETTING_FACTOR;
+  covariance_[1] = (covariance_[1] - gain[0]*p_01)/FORGETTING_FACTOR;
+  covariance_[2] = (covariance_[2] - gain[1]*p_00)/FORGETTING_FACTOR;
+  covariance_[3] = (covariance_[3] - gain[1]*p_01)/FORGETTING_FACTOR;
+
+  // Track the variance of the (a priori) errors, once the relation has settled.
+  if (estimate_.number_of_samples > 2)
+  {
+    variance_ += JITTER_SMOOTHING*(error*error - variance_);
+  }
+}
+
+} // end namespace egm
+} // end namespace abb
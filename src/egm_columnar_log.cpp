@@ -0,0 +1,618 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <boost/bind/bind.hpp>
+
+#include "abb_libegm/egm_columnar_log.h"
+
+namespace abb
+{
+namespace egm
+{
+/***********************************************************************************************************************
+ * Struct definitions: EGMColumnarLogLayout
+ */
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const char EGMColumnarLogLayout::MAGIC[8] = {'E', 'G', 'M', 'C', 'O', 'L', '0', '1'};
+const boost::uint32_t EGMColumnarLogLayout::VERSION;
+const size_t EGMColumnarLogLayout::ALIGNMENT;
+const size_t EGMColumnarLogLayout::COLUMN_TABLE_SIZE;
+
+size_t EGMColumnarLogLayout::dataOffset(const size_t max_blocks)
+{
+  return align(sizeof(FileHeader) + max_blocks*sizeof(BlockIndex));
+}
+
+size_t EGMColumnarLogLayout::maxBlockSize(const size_t block_capacity)
+{
+  return COLUMN_TABLE_SIZE +
+         align(block_capacity*sizeof(boost::uint32_t)) +
+         EGMLogRecord::NUMBER_OF_VALUES*block_capacity*sizeof(double);
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: EGMColumnarLogger
+ */
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const size_t EGMColumnarLogger::DEFAULT_BLOCK_CAPACITY;
+const size_t EGMColumnarLogger::DEFAULT_MAX_BLOCKS;
+const size_t EGMColumnarLogger::BATCH_SIZE;
+const unsigned int EGMColumnarLogger::IDLE_WAIT_TIME_MS;
+
+/************************************************************
+ * Primary methods
+ */
+
+EGMColumnarLogger::EGMColumnarLogger(const std::string& base_filename,
+                                     const bool use_compression,
+                                     const size_t block_capacity,
+                                     const size_t max_blocks,
+                                     const size_t capacity)
+:
+base_filename_(base_filename),
+use_compression_(use_compression),
+block_capacity_(std::max(block_capacity, (size_t) 1)),
+max_blocks_(std::max(max_blocks, (size_t) 1)),
+number_of_logged_messages_(0),
+number_of_dropped_records_(0),
+number_of_files_(0),
+stop_requested_(false),
+ring_buffer_(capacity),
+block_time_stamps_(block_capacity_),
+block_values_(EGMLogRecord::NUMBER_OF_VALUES*block_capacity_),
+block_rows_(0)
+{
+  // Preallocate the first file upfront, so that the background thread only has to write into mapped memory.
+  openFile();
+
+  writer_thread_ = boost::thread(&EGMColumnarLogger::writerThread, this);
+}
+
+EGMColumnarLogger::~EGMColumnarLogger()
+{
+  stop_requested_ = true;
+  writer_thread_.join();
+  closeFile();
+}
+
+bool EGMColumnarLogger::add(const wrapper::Input& inputs, const wrapper::Output& outputs)
+{
+  // Count the record as logged regardless, so that the logged duration follows the session's duration.
+  ++number_of_logged_messages_;
+
+  EGMLogRecord* p_record = ring_buffer_.writeSlot();
+
+  if (!p_record)
+  {
+    ++number_of_dropped_records_;
+    return false;
+  }
+
+  p_record->set(inputs, outputs);
+  ring_buffer_.publish();
+
+  return true;
+}
+
+double EGMColumnarLogger::calculateTimeLogged(const double sample_time)
+{
+  return (double)number_of_logged_messages_*sample_time;
+}
+
+std::string EGMColumnarLogger::createFilename(const std::string& base_filename, const unsigned int file_index)
+{
+  std::stringstream ss;
+  ss << base_filename << "_" << file_index << ".col";
+
+  return ss.str();
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+void EGMColumnarLogger::writerThread()
+{
+  consumeRingBuffer(&ring_buffer_,
+                    stop_requested_,
+                    BATCH_SIZE,
+                    IDLE_WAIT_TIME_MS,
+                    boost::bind(&EGMColumnarLogger::addToBlock, this, boost::placeholders::_1),
+                    NoIdleAction());
+
+  // Write the last (partial) block.
+  writeBlock();
+}
+
+void EGMColumnarLogger::addToBlock(const EGMLogRecord& record)
+{
+  block_time_stamps_[block_rows_] = record.time_stamp;
+
+  for (size_t i = 0; i < EGMLogRecord::NUMBER_OF_VALUES; ++i)
+  {
+    block_values_[i*block_capacity_ + block_rows_] = record.values[i];
+  }
+
+  if (++block_rows_ == block_capacity_)
+  {
+    writeBlock();
+  }
+}
+
+bool EGMColumnarLogger::writeBlock()
+{
+  if (block_rows_ == 0)
+  {
+    return false;
+  }
+
+  EGMColumnarLogLayout::FileHeader* p_header = 0;
+
+  if (p_region_)
+  {
+    p_header = static_cast<EGMColumnarLogLayout::FileHeader*>(p_region_->get_address());
+  }
+
+  // Roll over to the next file, if the current file is full.
+  if (!p_header || p_header->number_of_blocks >= max_blocks_)
+  {
+    if (!openFile())
+    {
+      number_of_dropped_records_ += (unsigned int) block_rows_;
+      block_rows_ = 0;
+      return false;
+    }
+
+    p_header = static_cast<EGMColumnarLogLayout::FileHeader*>(p_region_->get_address());
+  }
+
+  char* p_file = static_cast<char*>(p_region_->get_address());
+  const size_t offset = EGMColumnarLogLayout::dataOffset(max_blocks_) + (size_t) p_header->data_size;
+  char* p_block = p_file + offset;
+
+  // Time stamp column.
+  size_t position = EGMColumnarLogLayout::COLUMN_TABLE_SIZE;
+  std::memcpy(p_block + position, &block_time_stamps_[0], block_rows_*sizeof(boost::uint32_t));
+  position += EGMColumnarLogLayout::align(block_rows_*sizeof(boost::uint32_t));
+
+  // Value columns (constant columns are stored as a single value, if compression is used).
+  boost::uint32_t column_table[EGMLogRecord::NUMBER_OF_VALUES + 1];
+
+  for (size_t i = 0; i < EGMLogRecord::NUMBER_OF_VALUES; ++i)
+  {
+    const double* p_column = &block_values_[i*block_capacity_];
+    size_t count = block_rows_;
+
+    if (use_compression_)
+    {
+      bool constant = true;
+
+      for (size_t j = 1; j < block_rows_ && constant; ++j)
+      {
+        constant = (std::memcmp(&p_column[j], &p_column[0], sizeof(double)) == 0);
+      }
+
+      count = (constant ? 1 : block_rows_);
+    }
+
+    column_table[i] = (boost::uint32_t) position;
+    std::memcpy(p_block + position, p_column, count*sizeof(double));
+    position += count*sizeof(double);
+  }
+
+  column_table[EGMLogRecord::NUMBER_OF_VALUES] = (boost::uint32_t) position;
+  std::memcpy(p_block, column_table, sizeof(column_table));
+
+  // Index entry.
+  EGMColumnarLogLayout::BlockIndex* p_index =
+    reinterpret_cast<EGMColumnarLogLayout::BlockIndex*>(p_file + sizeof(EGMColumnarLogLayout::FileHeader));
+
+  EGMColumnarLogLayout::BlockIndex& block = p_index[p_header->number_of_blocks];
+  block.first_time_stamp = block_time_stamps_[0];
+  block.last_time_stamp = block_time_stamps_[block_rows_ - 1];
+  block.number_of_rows = (boost::uint32_t) block_rows_;
+  block.reserved = 0;
+  block.first_row = p_header->number_of_rows;
+  block.offset = offset;
+  block.size = position;
+
+  // Update the header last, so that the file is consistent after each block.
+  boost::atomic_thread_fence(boost::memory_order_release);
+  p_header->number_of_rows += block_rows_;
+  p_header->data_size += position;
+  ++p_header->number_of_blocks;
+
+  block_rows_ = 0;
+
+  return true;
+}
+
+bool EGMColumnarLogger::openFile()
+{
+  closeFile();
+
+  const std::string filename = createFilename(base_filename_, number_of_files_);
+  const size_t file_size = EGMColumnarLogLayout::dataOffset(max_blocks_) +
+                           max_blocks_*EGMColumnarLogLayout::maxBlockSize(block_capacity_);
+
+  // Preallocate the file (typically as a sparse file, i.e. only the written parts occupy disk space).
+  {
+    std::ofstream stream(filename.c_str(), std::ios::trunc | std::ios::binary);
+    stream.seekp(file_size - 1);
+    stream.put('\0');
+
+    if (!stream)
+    {
+      return false;
+    }
+  }
+
+  try
+  {
+    p_mapping_.reset(new boost::interprocess::file_mapping(filename.c_str(), boost::interprocess::read_write));
+    p_region_.reset(new boost::interprocess::mapped_region(*p_mapping_, boost::interprocess::read_write, 0, file_size));
+  }
+  catch (const boost::interprocess::interprocess_exception&)
+  {
+    p_region_.reset();
+    p_mapping_.reset();
+    return false;
+  }
+
+  // Note: The preallocated file is zero-filled, i.e. all counters in the header start at zero.
+  EGMColumnarLogLayout::FileHeader* p_header =
+    static_cast<EGMColumnarLogLayout::FileHeader*>(p_region_->get_address());
+
+  std::memcpy(p_header->magic, EGMColumnarLogLayout::MAGIC, sizeof(EGMColumnarLogLayout::MAGIC));
+  p_header->version = EGMColumnarLogLayout::VERSION;
+  p_header->number_of_values = EGMLogRecord::NUMBER_OF_VALUES;
+  p_header->block_capacity = (boost::uint32_t) block_capacity_;
+  p_header->max_blocks = (boost::uint32_t) max_blocks_;
+
+  ++number_of_files_;
+
+  return true;
+}
+
+void EGMColumnarLogger::closeFile()
+{
+  if (p_region_)
+  {
+    p_region_->flush();
+  }
+
+  p_region_.reset();
+  p_mapping_.reset();
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: EGMColumnarLogReader
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+EGMColumnarLogReader::EGMColumnarLogReader()
+:
+p_header_(0),
+p_index_(0),
+p_data_(0)
+{}
+
+bool EGMColumnarLogReader::open(const std::string& filename)
+{
+  close();
+
+  try
+  {
+    p_mapping_.reset(new boost::interprocess::file_mapping(filename.c_str(), boost::interprocess::read_only));
+    p_region_.reset(new boost::interprocess::mapped_region(*p_mapping_, boost::interprocess::read_only));
+  }
+  catch (const boost::interprocess::interprocess_exception&)
+  {
+    close();
+    return false;
+  }
+
+  const char* p_data = static_cast<const char*>(p_region_->get_address());
+  const size_t size = p_region_->get_size();
+
+  const EGMColumnarLogLayout::FileHeader* p_header =
+    reinterpret_cast<const EGMColumnarLogLayout::FileHeader*>(p_data);
+
+  const EGMColumnarLogLayout::BlockIndex* p_index =
+    reinterpret_cast<const EGMColumnarLogLayout::BlockIndex*>(p_data + sizeof(EGMColumnarLogLayout::FileHeader));
+
+  bool success = (size >= sizeof(EGMColumnarLogLayout::FileHeader) &&
+                  std::memcmp(p_header->magic, EGMColumnarLogLayout::MAGIC, sizeof(EGMColumnarLogLayout::MAGIC)) == 0 &&
+                  p_header->version == EGMColumnarLogLayout::VERSION &&
+                  p_header->number_of_values == EGMLogRecord::NUMBER_OF_VALUES &&
+                  p_header->number_of_blocks <= p_header->max_blocks &&
+                  EGMColumnarLogLayout::dataOffset(p_header->max_blocks) + p_header->data_size <= size);
+
+  // Validate the block index and the blocks' column tables, so that the read methods can rely on them.
+  boost::uint64_t number_of_rows = 0;
+
+  for (size_t i = 0; success && i < p_header->number_of_blocks; ++i)
+  {
+    const EGMColumnarLogLayout::BlockIndex& block = p_index[i];
+    const size_t rows = block.number_of_rows;
+
+    success = (rows > 0 &&
+               block.first_row == number_of_rows &&
+               block.offset % EGMColumnarLogLayout::ALIGNMENT == 0 &&
+               block.offset + block.size <= size &&
+               block.size >= EGMColumnarLogLayout::COLUMN_TABLE_SIZE);
+
+    if (success)
+    {
+      const boost::uint32_t* p_table = reinterpret_cast<const boost::uint32_t*>(p_data + block.offset);
+
+      success = (p_table[0] == EGMColumnarLogLayout::COLUMN_TABLE_SIZE +
+                               EGMColumnarLogLayout::align(rows*sizeof(boost::uint32_t)) &&
+                 p_table[EGMLogRecord::NUMBER_OF_VALUES] == block.size);
+
+      for (size_t j = 0; success && j < EGMLogRecord::NUMBER_OF_VALUES; ++j)
+      {
+        const size_t column_size = p_table[j + 1] - p_table[j];
+        success = (p_table[j + 1] > p_table[j] &&
+                   (column_size == sizeof(double) || column_size == rows*sizeof(double)));
+      }
+    }
+
+    number_of_rows += rows;
+  }
+
+  if (success && number_of_rows == p_header->number_of_rows)
+  {
+    p_header_ = p_header;
+    p_index_ = p_index;
+    p_data_ = p_data;
+  }
+  else
+  {
+    close();
+    success = false;
+  }
+
+  return success;
+}
+
+void EGMColumnarLogReader::close()
+{
+  p_header_ = 0;
+  p_index_ = 0;
+  p_data_ = 0;
+  p_region_.reset();
+  p_mapping_.reset();
+}
+
+size_t EGMColumnarLogReader::numberOfRows() const
+{
+  return (p_header_ ? (size_t) p_header_->number_of_rows : 0);
+}
+
+size_t EGMColumnarLogReader::numberOfBlocks() const
+{
+  return (p_header_ ? (size_t) p_header_->number_of_blocks : 0);
+}
+
+bool EGMColumnarLogReader::findRow(const boost::uint32_t time_stamp, size_t* p_row) const
+{
+  if (!p_row || numberOfBlocks() == 0)
+  {
+    return false;
+  }
+
+  // Find the first block that ends at, or after, the time stamp.
+  size_t lower = 0;
+  size_t upper = numberOfBlocks();
+
+  while (lower < upper)
+  {
+    const size_t middle = lower + (upper - lower)/2;
+
+    if (p_index_[middle].last_time_stamp < time_stamp)
+    {
+      lower = middle + 1;
+    }
+    else
+    {
+      upper = middle;
+    }
+  }
+
+  if (lower == numberOfBlocks())
+  {
+    return false;
+  }
+
+  const EGMColumnarLogLayout::BlockIndex& block = p_index_[lower];
+  const boost::uint32_t* p_time_stamps = timeStamps(block);
+
+  *p_row = (size_t) block.first_row +
+           (std::lower_bound(p_time_stamps, p_time_stamps + block.number_of_rows, time_stamp) - p_time_stamps);
+
+  return true;
+}
+
+bool EGMColumnarLogReader::readRecord(const size_t row, EGMLogRecord* p_record) const
+{
+  const EGMColumnarLogLayout::BlockIndex* p_block = findBlock(row);
+
+  if (!p_block || !p_record)
+  {
+    return false;
+  }
+
+  const size_t block_row = row - (size_t) p_block->first_row;
+
+  p_record->time_stamp = timeStamps(*p_block)[block_row];
+
+  for (size_t i = 0; i < EGMLogRecord::NUMBER_OF_VALUES; ++i)
+  {
+    p_record->values[i] = readValue(*p_block, i, block_row);
+  }
+
+  return true;
+}
+
+bool EGMColumnarLogReader::readColumn(const size_t value_index,
+                                      const size_t first_row,
+                                      const size_t number_of_rows,
+                                      std::vector<double>* p_values) const
+{
+  if (!p_values || value_index >= EGMLogRecord::NUMBER_OF_VALUES || first_row >= numberOfRows())
+  {
+    return false;
+  }
+
+  const size_t end_row = first_row + std::min(number_of_rows, numberOfRows() - first_row);
+
+  p_values->clear();
+  p_values->reserve(end_row - first_row);
+
+  size_t row = first_row;
+
+  while (row < end_row)
+  {
+    const EGMColumnarLogLayout::BlockIndex* p_block = findBlock(row);
+    const size_t block_row = row - (size_t) p_block->first_row;
+    const size_t count = std::min(end_row - row, (size_t) p_block->number_of_rows - block_row);
+
+    const boost::uint32_t* p_table = reinterpret_cast<const boost::uint32_t*>(p_data_ + p_block->offset);
+    const double* p_column = reinterpret_cast<const double*>(p_data_ + p_block->offset + p_table[value_index]);
+
+    if (p_table[value_index + 1] - p_table[value_index] == sizeof(double))
+    {
+      p_values->insert(p_values->end(), count, p_column[0]);
+    }
+    else
+    {
+      p_values->insert(p_values->end(), p_column + block_row, p_column + block_row + count);
+    }
+
+    row += count;
+  }
+
+  return true;
+}
+
+bool EGMColumnarLogReader::convertToCSV(const std::string& columnar_filename, const std::string& csv_filename)
+{
+  EGMColumnarLogReader reader;
+
+  if (!reader.open(columnar_filename))
+  {
+    return false;
+  }
+
+  EGMLogger csv_logger(csv_filename);
+  EGMLogRecord record;
+
+  for (size_t i = 0; i < reader.numberOfRows(); ++i)
+  {
+    reader.readRecord(i, &record);
+    csv_logger.add(record);
+  }
+
+  return true;
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+const EGMColumnarLogLayout::BlockIndex* EGMColumnarLogReader::findBlock(const size_t row) const
+{
+  if (row >= numberOfRows())
+  {
+    return 0;
+  }
+
+  // Find the last block that starts at, or before, the row.
+  size_t lower = 0;
+  size_t upper = numberOfBlocks();
+
+  while (upper - lower > 1)
+  {
+    const size_t middle = lower + (upper - lower)/2;
+
+    if (p_index_[middle].first_row <= row)
+    {
+      lower = middle;
+    }
+    else
+    {
+      upper = middle;
+    }
+  }
+
+  return &p_index_[lower];
+}
+
+double EGMColumnarLogReader::readValue(const EGMColumnarLogLayout::BlockIndex& block,
+                                       const size_t value_index,
+                                       const size_t block_row) const
+{
+  const boost::uint32_t* p_table = reinterpret_cast<const boost::uint32_t*>(p_data_ + block.offset);
+  const double* p_column = reinterpret_cast<const double*>(p_data_ + block.offset + p_table[value_index]);
+
+  // Note: A column containing a single value is constant within the block.
+  return (p_table[value_index + 1] - p_table[value_index] == sizeof(double) ? p_column[0] : p_column[block_row]);
+}
+
+const boost::uint32_t* EGMColumnarLogReader::timeStamps(const EGMColumnarLogLayout::BlockIndex& block) const
+{
+  return reinterpret_cast<const boost::uint32_t*>(p_data_ + block.offset + EGMColumnarLogLayout::COLUMN_TABLE_SIZE);
+}
+
+} // end namespace egm
+} // end namespace abb
@@ -52,10 +52,11 @@ typedef Constants::RobotController RobotController;
 
 const double RobotController::LOWEST_SAMPLE_TIME = 0.004;
 const unsigned short RobotController::DEFAULT_PORT_NUMBER = 6511;
-const int RobotController::DEFAULT_NUMBER_OF_ROBOT_JOINTS = 6;
-const int RobotController::DEFAULT_NUMBER_OF_EXTERNAL_JOINTS = 6;
-const int RobotController::MAX_NUMBER_OF_JOINTS = RobotController::DEFAULT_NUMBER_OF_ROBOT_JOINTS +
-                                                  RobotController::DEFAULT_NUMBER_OF_EXTERNAL_JOINTS;
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const int RobotController::DEFAULT_NUMBER_OF_ROBOT_JOINTS;
+const int RobotController::DEFAULT_NUMBER_OF_EXTERNAL_JOINTS;
+const int RobotController::MAX_NUMBER_OF_JOINTS;
 
 const double Constants::Conversion::RAD_TO_DEG = 180.0 / M_PI;
 const double Constants::Conversion::DEG_TO_RAD = M_PI / 180.0;
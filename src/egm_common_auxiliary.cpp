@@ -38,8 +38,6 @@
 
 #include <cmath>
 
-#include <boost/math/quaternion.hpp>
-
 #include "abb_libegm/egm_common_auxiliary.h"
 
 namespace abb
@@ -90,47 +88,50 @@ void multiply(wrapper::Quaternion* p_q, const double factor)
 {
   if (p_q)
   {
-    p_q->set_u0(p_q->u0()*factor);
-    p_q->set_u1(p_q->u1()*factor);
-    p_q->set_u2(p_q->u2()*factor);
-    p_q->set_u3(p_q->u3()*factor);
+    math::Quaternion q;
+    copy(&q, *p_q);
+    copy(p_q, math::multiply(q, factor));
   }
 }
 
 wrapper::Quaternion multiply(const wrapper::Quaternion& q1, const wrapper::Quaternion& q2)
 {
-  wrapper::Quaternion result;
+  math::Quaternion a;
+  math::Quaternion b;
+  copy(&a, q1);
+  copy(&b, q2);
 
-  result.set_u0(q1.u0()*q2.u0() - q1.u1()*q2.u1() - q1.u2()*q2.u2() - q1.u3()*q2.u3());
-  result.set_u1(q1.u0()*q2.u1() + q1.u1()*q2.u0() + q1.u2()*q2.u3() - q1.u3()*q2.u2());
-  result.set_u2(q1.u0()*q2.u2() + q1.u2()*q2.u0() + q1.u3()*q2.u1() - q1.u1()*q2.u3());
-  result.set_u3(q1.u0()*q2.u3() + q1.u3()*q2.u0() + q1.u1()*q2.u2() - q1.u2()*q2.u1());
+  wrapper::Quaternion result;
+  copy(&result, math::multiply(a, b));
 
   return result;
 }
 
 double dotProduct(const wrapper::Quaternion& q1, const wrapper::Quaternion& q2)
 {
-  return q1.u0()*q2.u0() + q1.u1()*q2.u1() + q1.u2()*q2.u2() + q1.u3()*q2.u3();
+  math::Quaternion a;
+  math::Quaternion b;
+  copy(&a, q1);
+  copy(&b, q2);
+
+  return math::dotProduct(a, b);
 }
 
 double euclideanNorm(const wrapper::Quaternion& q)
 {
-  return std::sqrt(dotProduct(q, q));
+  math::Quaternion a;
+  copy(&a, q);
+
+  return math::euclideanNorm(a);
 }
 
 void normalize(wrapper::Quaternion* p_q)
 {
   if (p_q)
   {
-    double norm = euclideanNorm(*p_q);
-    if (norm != 0.0)
-    {
-      p_q->set_u0(p_q->u0() / norm);
-      p_q->set_u1(p_q->u1() / norm);
-      p_q->set_u2(p_q->u2() / norm);
-      p_q->set_u3(p_q->u3() / norm);
-    }
+    math::Quaternion q;
+    copy(&q, *p_q);
+    copy(p_q, math::normalize(q));
   }
 }
 
@@ -138,76 +139,23 @@ void convert(wrapper::Quaternion* p_q, const wrapper::Euler& e)
 {
   if (p_q)
   {
-    double z = e.z() * Constants::Conversion::DEG_TO_RAD;
-    double y = e.y() * Constants::Conversion::DEG_TO_RAD;
-    double x = e.x() * Constants::Conversion::DEG_TO_RAD;
-
-    // Convert ZYX Euler angles to a rotation matrix.
-    // See for example https://en.wikipedia.org/wiki/Conversion_between_quaternions_and_Euler_angles for the equations.
-
-    double cx = std::cos(0.5*x);
-    double sx = std::sin(0.5*x);
-    double cy = std::cos(0.5*y);
-    double sy = std::sin(0.5*y);
-    double cz = std::cos(0.5*z);
-    double sz = std::sin(0.5*z);
-
-    p_q->set_u0(sx*sy*sz + cx*cy*cz);
-    p_q->set_u1(-cx*sy*sz + sx*cy*cz);
-    p_q->set_u2(sx*cy*sz + cx*sy*cz);
-    p_q->set_u3(cx*cy*sz - sx*sy*cz);
-
-    normalize(p_q);
+    math::Euler euler;
+    copy(&euler, e);
+    copy(p_q, math::toQuaternion(euler));
   }
 }
 
 void convert(wrapper::Euler* p_e, const wrapper::Quaternion& q)
 {
-  if(p_e && euclideanNorm(q) != 0.0)
+  if (p_e)
   {
-    // Convert a quaternion to ZYX Euler angles.
-    // See for example https://en.wikipedia.org/wiki/Conversion_between_quaternions_and_Euler_angles for the equations.
-    //
-    // Handle singularities.
-    // See for example http://www.euclideanspace.com/maths/geometry/rotations/conversions/quaternionToEuler/index.htm
-    // for indications of how to derive the equations.
-
-    double y = 0.0;
-    double z = 0.0;
-    double x = 0.0;
-
-    double u0 = q.u0();
-    double u1 = q.u1();
-    double u2 = q.u2();
-    double u3 = q.u3();
-
-    const double SINGULARITY_THRESHOLD = 0.000001;
-    double singularity_check = u0*u2 - u1*u3;
-
-    // Check for singularity (i.e. when y is close to +- 90 degrees).
-    // This occur when the argument of y = sin(2*(u0*u2 - u1*u3)) is close to 1.0 -> u0*u2 - u1*u3 = 0.5.
-    if (std::abs(singularity_check - 0.5) <= SINGULARITY_THRESHOLD)
-    {
-      // Y is close to 90 degrees.
-      x = 2.0*std::atan2(u1, u0);
-      y = M_PI_2;
-    }
-    else if (std::abs(singularity_check + 0.5) <= SINGULARITY_THRESHOLD)
-    {
-      // Y is close to -90 degrees.
-      x = 2.0*std::atan2(u1, u0);
-      y = -M_PI_2;
-    }
-    else
+    math::Quaternion quaternion;
+    copy(&quaternion, q);
+
+    if (math::euclideanNorm(quaternion) != 0.0)
     {
-      x = std::atan2(2.0*(u0*u1 + u2*u3), 1.0 - 2.0*(u1*u1 + u2*u2));
-      y = std::asin(2.0*(u0*u2 - u1*u3));
-      z = std::atan2(2.0*(u0*u3 + u1*u2), 1.0 - 2.0*(u2*u2 + u3*u3));
+      copy(p_e, math::toEuler(quaternion));
     }
-
-    p_e->set_x(x*Constants::Conversion::RAD_TO_DEG);
-    p_e->set_y(y*Constants::Conversion::RAD_TO_DEG);
-    p_e->set_z(z*Constants::Conversion::RAD_TO_DEG);
   }
 }
 
@@ -215,20 +163,14 @@ void convert(wrapper::Quaternion* p_dq, const wrapper::Quaternion& previous_q, c
 {
   if (p_dq)
   {
-    wrapper::Quaternion temp;
-    temp.set_u0(0.0);
-    temp.set_u1(av.x()*Constants::Conversion::DEG_TO_RAD);
-    temp.set_u2(av.y()*Constants::Conversion::DEG_TO_RAD);
-    temp.set_u3(av.z()*Constants::Conversion::DEG_TO_RAD);
-
-    p_dq->CopyFrom(multiply(temp, previous_q));
-    multiply(p_dq, 0.5);
+    math::Quaternion q;
+    math::Vector3 angular_velocity;
+    copy(&q, previous_q);
+    copy(&angular_velocity, av);
+    copy(p_dq, math::derivate(q, angular_velocity));
   }
 }
 
-
-
-
 /***********************************************************************************************************************
  * Estimation functions
  */
@@ -266,20 +208,11 @@ bool estimateVelocities(wrapper::Euler* p_estimate,
   if (p_estimate && sample_time > 0.0)
   {
     // Estimate the angular velocity.
-    // See for example https://en.wikipedia.org/wiki/Rotation_formalisms_in_three_dimensions for equations.
-    // Note: Only valid for orientations, for the same object, at two points close in time.
-    // Also assumes constant angular velocity between the points.
-    boost::math::quaternion<double> q1(previous.u0(), previous.u1(),
-                                       previous.u2(), previous.u3());
-
-    boost::math::quaternion<double> q2(current.u0(), current.u1(),
-                                       current.u2(), current.u3());
-
-    boost::math::quaternion<double> estimation = ((2.0*(q2 - q1) / sample_time)*boost::math::conj(q1));
-
-    p_estimate->set_x(estimation.R_component_2()*Constants::Conversion::RAD_TO_DEG);
-    p_estimate->set_y(estimation.R_component_3()*Constants::Conversion::RAD_TO_DEG);
-    p_estimate->set_z(estimation.R_component_4()*Constants::Conversion::RAD_TO_DEG);
+    math::Quaternion q1;
+    math::Quaternion q2;
+    copy(&q1, previous);
+    copy(&q2, current);
+    copy(p_estimate, math::estimateAngularVelocity(q2, q1, sample_time));
 
     success = true;
   }
@@ -297,9 +230,15 @@ bool estimateVelocities(wrapper::CartesianVelocity* p_estimate,
   if (p_estimate && sample_time > 0.0)
   {
     // Estimate the linear velocity.
-    p_estimate->mutable_linear()->set_x((current.position().x() - previous.position().x()) / sample_time);
-    p_estimate->mutable_linear()->set_y((current.position().y() - previous.position().y()) / sample_time);
-    p_estimate->mutable_linear()->set_z((current.position().z() - previous.position().z()) / sample_time);
+    math::Vector3 p1;
+    math::Vector3 p2;
+    copy(&p1, previous.position());
+    copy(&p2, current.position());
+
+    const math::Vector3 linear = {(p2.x - p1.x) / sample_time,
+                                  (p2.y - p1.y) / sample_time,
+                                  (p2.z - p1.z) / sample_time};
+    copy(p_estimate->mutable_linear(), linear);
 
     // Estimate the angular velocity.
     success = estimateVelocities(p_estimate->mutable_angular(),
@@ -355,6 +294,50 @@ double findMaxDifference(const wrapper::Euler& e1, const wrapper::Euler& e2)
  * Copy functions
  */
 
+void copy(math::Vector3* p_target, const wrapper::Cartesian& source)
+{
+  p_target->x = source.x();
+  p_target->y = source.y();
+  p_target->z = source.z();
+}
+
+void copy(wrapper::Cartesian* p_target, const math::Vector3& source)
+{
+  p_target->set_x(source.x);
+  p_target->set_y(source.y);
+  p_target->set_z(source.z);
+}
+
+void copy(math::Vector3* p_target, const wrapper::Euler& source)
+{
+  p_target->x = source.x();
+  p_target->y = source.y();
+  p_target->z = source.z();
+}
+
+void copy(wrapper::Euler* p_target, const math::Vector3& source)
+{
+  p_target->set_x(source.x);
+  p_target->set_y(source.y);
+  p_target->set_z(source.z);
+}
+
+void copy(math::Quaternion* p_target, const wrapper::Quaternion& source)
+{
+  p_target->u0 = source.u0();
+  p_target->u1 = source.u1();
+  p_target->u2 = source.u2();
+  p_target->u3 = source.u3();
+}
+
+void copy(wrapper::Quaternion* p_target, const math::Quaternion& source)
+{
+  p_target->set_u0(source.u0);
+  p_target->set_u1(source.u1);
+  p_target->set_u2(source.u2);
+  p_target->set_u3(source.u3);
+}
+
 void copyPresent(wrapper::Joints* p_target, const wrapper::Joints& source)
 {
   if (p_target)
@@ -464,13 +447,24 @@ void copyPresent(wrapper::CartesianPose* p_target, const wrapper::CartesianPose&
     if (source.has_euler())
     {
       copyPresent(p_target->mutable_euler(), source.euler());
-      convert(p_target->mutable_quaternion(), p_target->euler());
+
+      math::Euler euler;
+      copy(&euler, p_target->euler());
+      copy(p_target->mutable_quaternion(), math::toQuaternion(euler));
     }
     else if (source.has_quaternion())
     {
       copyPresent(p_target->mutable_quaternion(), source.quaternion());
-      normalize(p_target->mutable_quaternion());
-      convert(p_target->mutable_euler(), p_target->quaternion());
+
+      math::Quaternion quaternion;
+      copy(&quaternion, p_target->quaternion());
+      quaternion = math::normalize(quaternion);
+      copy(p_target->mutable_quaternion(), quaternion);
+
+      if (math::euclideanNorm(quaternion) != 0.0)
+      {
+        copy(p_target->mutable_euler(), math::toEuler(quaternion));
+      }
     }
   }
 }
@@ -689,6 +683,11 @@ bool parse(wrapper::Status* p_target, const EgmRobot& source)
     {
       p_target->set_utilization_rate(source.utilizationrate());
     }
+    else
+    {
+      // Note: The target can be reused (swapped) between messages, so absent optional fields must be cleared.
+      p_target->clear_utilization_rate();
+    }
 
     success = true;
   }
@@ -717,74 +716,19 @@ bool parse(wrapper::Joints* p_target_robot,
            wrapper::Joints* p_target_external,
            const EgmJoints& source_robot,
            const EgmJoints& source_external,
-           const RobotAxes axes)
+           const JointMapper& mapper)
 {
   bool success = false;
 
   if (p_target_robot && p_target_external)
   {
+    // Note: Clearing keeps the allocated capacity, so no heap allocations are done after the first message.
     p_target_robot->Clear();
     p_target_external->Clear();
 
-    switch (axes)
-    {
-      case None:
-      {
-        if (source_robot.joints_size() == 0)
-        {
-          for (int i = 0; i < source_external.joints_size(); ++i)
-          {
-            p_target_external->add_values(source_external.joints(i));
-          }
-
-          success = true;
-        }
-      }
-      break;
-
-      case Six:
-      {
-        if (source_robot.joints_size() == Constants::RobotController::DEFAULT_NUMBER_OF_ROBOT_JOINTS)
-        {
-          for (int i = 0; i < source_robot.joints_size(); ++i)
-          {
-            p_target_robot->add_values(source_robot.joints(i));
-          }
-
-          for (int i = 0; i < source_external.joints_size(); ++i)
-          {
-            p_target_external->add_values(source_external.joints(i));
-          }
-
-          success = true;
-        }
-      }
-      break;
-
-      case Seven:
-      {
-        // If using a seven axes robot (e.g. IRB14000): Map to special case.
-        if (source_robot.joints_size() == Constants::RobotController::DEFAULT_NUMBER_OF_ROBOT_JOINTS &&
-            source_external.joints_size() >= 1)
-        {
-          p_target_robot->add_values(source_robot.joints(0));
-          p_target_robot->add_values(source_robot.joints(1));
-          p_target_robot->add_values(source_external.joints(0));
-          p_target_robot->add_values(source_robot.joints(2));
-          p_target_robot->add_values(source_robot.joints(3));
-          p_target_robot->add_values(source_robot.joints(4));
-          p_target_robot->add_values(source_robot.joints(5));
-
-          for (int i = 1; i < source_external.joints_size(); ++i)
-          {
-            p_target_external->add_values(source_external.joints(i));
-          }
-
-          success = true;
-        }
-      }
-      break;
-    }
+    success = mapper.parse(p_target_robot, p_target_external,
+                           source_robot.joints().data(), source_robot.joints_size(),
+                           source_external.joints().data(), source_external.joints_size());
   }
 
   return success;
@@ -844,7 +788,7 @@ bool parse(wrapper::CartesianPose* p_target, const EgmPose& source)
   return success;
 }
 
-bool parse(wrapper::Feedback* p_target, const EgmFeedBack& source, const RobotAxes axes)
+bool parse(wrapper::Feedback* p_target, const EgmFeedBack& source, const JointMapper& mapper)
 {
   bool success = false;
 
@@ -852,13 +796,14 @@ bool parse(wrapper::Feedback* p_target, const EgmFeedBack& source, const RobotAx
   {
     success = parse(p_target->mutable_robot()->mutable_joints()->mutable_position(),
                     p_target->mutable_external()->mutable_joints()->mutable_position(),
-                    source.joints(), source.externaljoints(), axes);
+                    source.joints(), source.externaljoints(), mapper);
 
     if (success)
     {
-      if(axes == None)
+      if(mapper.axes == None)
       {
         success = !source.has_cartesian();
+        p_target->mutable_robot()->mutable_cartesian()->clear_pose();
       }
       else
       {
@@ -875,7 +820,7 @@ bool parse(wrapper::Feedback* p_target, const EgmFeedBack& source, const RobotAx
   return success;
 }
 
-bool parse(wrapper::Planned* p_target, const EgmPlanned& source, const RobotAxes axes)
+bool parse(wrapper::Planned* p_target, const EgmPlanned& source, const JointMapper& mapper)
 {
   bool success = false;
 
@@ -883,13 +828,14 @@ bool parse(wrapper::Planned* p_target, const EgmPlanned& source, const RobotAxes
   {
     success = parse(p_target->mutable_robot()->mutable_joints()->mutable_position(),
                     p_target->mutable_external()->mutable_joints()->mutable_position(),
-                    source.joints(), source.externaljoints(), axes);
+                    source.joints(), source.externaljoints(), mapper);
 
     if (success)
     {
-      if(axes == None)
+      if(mapper.axes == None)
       {
         success = !source.has_cartesian();
+        p_target->mutable_robot()->mutable_cartesian()->clear_pose();
       }
       else
       {
@@ -930,6 +876,284 @@ bool parse(wrapper::MeasuredForce* p_target, const EgmMeasuredForce& source)
   return success;
 }
 
+bool parse(wrapper::Header* p_target, const RobotData::Header& source)
+{
+  bool success = false;
+
+  if (p_target && source.has_seqno && source.has_tm && source.has_mtype)
+  {
+    p_target->set_sequence_number(source.seqno);
+    p_target->set_time_stamp(source.tm);
+
+    if (source.mtype == EgmHeader_MessageType_MSGTYPE_DATA)
+    {
+      p_target->set_message_type(wrapper::Header_MessageType_DATA);
+      success = true;
+    }
+    else
+    {
+      p_target->set_message_type(wrapper::Header_MessageType_UNDEFINED);
+    }
+  }
+
+  return success;
+}
+
+bool parse(wrapper::Status* p_target, const RobotData& source)
+{
+  bool success = false;
+
+  if (p_target &&
+      source.has_motor_state &&
+      source.has_mci_state &&
+      source.has_rapid_exec_state &&
+      source.has_mci_convergence_met)
+  {
+    switch (source.motor_state)
+    {
+      case EgmMotorState_MotorStateType_MOTORS_ON:
+      {
+        p_target->set_motor_state(wrapper::Status_MotorState_MOTORS_ON);
+      }
+      break;
+
+      case EgmMotorState_MotorStateType_MOTORS_OFF:
+      {
+        p_target->set_motor_state(wrapper::Status_MotorState_MOTORS_OFF);
+      }
+      break;
+
+      case EgmMotorState_MotorStateType_MOTORS_UNDEFINED:
+      default:
+      {
+        p_target->set_motor_state(wrapper::Status_MotorState_MOTORS_UNDEFINED);
+      }
+    }
+
+    switch (source.mci_state)
+    {
+      case EgmMCIState_MCIStateType_MCI_ERROR:
+      {
+        p_target->set_egm_state(wrapper::Status_EGMState_EGM_ERROR);
+      }
+      break;
+
+      case EgmMCIState_MCIStateType_MCI_STOPPED:
+      {
+        p_target->set_egm_state(wrapper::Status_EGMState_EGM_STOPPED);
+      }
+      break;
+
+      case EgmMCIState_MCIStateType_MCI_RUNNING:
+      {
+        p_target->set_egm_state(wrapper::Status_EGMState_EGM_RUNNING);
+      }
+      break;
+
+      case EgmMCIState_MCIStateType_MCI_UNDEFINED:
+      default:
+      {
+        p_target->set_egm_state(wrapper::Status_EGMState_EGM_UNDEFINED);
+      }
+    }
+
+    switch (source.rapid_exec_state)
+    {
+      case EgmRapidCtrlExecState_RapidCtrlExecStateType_RAPID_STOPPED:
+      {
+        p_target->set_rapid_execution_state(wrapper::Status_RAPIDExecutionState_RAPID_STOPPED);
+      }
+      break;
+
+      case EgmRapidCtrlExecState_RapidCtrlExecStateType_RAPID_RUNNING:
+      {
+        p_target->set_rapid_execution_state(wrapper::Status_RAPIDExecutionState_RAPID_RUNNING);
+      }
+      break;
+
+      case EgmRapidCtrlExecState_RapidCtrlExecStateType_RAPID_UNDEFINED:
+      default:
+      {
+        p_target->set_rapid_execution_state(wrapper::Status_RAPIDExecutionState_RAPID_UNDEFINED);
+      }
+    }
+
+    p_target->set_egm_convergence_met(source.mci_convergence_met);
+
+    if (source.has_utilization_rate)
+    {
+      p_target->set_utilization_rate(source.utilization_rate);
+    }
+    else
+    {
+      // Note: The target can be reused (swapped) between messages, so absent optional fields must be cleared.
+      p_target->clear_utilization_rate();
+    }
+
+    success = true;
+  }
+
+  return success;
+}
+
+bool parse(wrapper::Joints* p_target_robot,
+           wrapper::Joints* p_target_external,
+           const RobotData::Values& source_robot,
+           const RobotData::Values& source_external,
+           const JointMapper& mapper)
+{
+  bool success = false;
+
+  if (p_target_robot && p_target_external)
+  {
+    // Note: Clearing keeps the allocated capacity, so no heap allocations are done after the first message.
+    p_target_robot->Clear();
+    p_target_external->Clear();
+
+    success = mapper.parse(p_target_robot, p_target_external,
+                           source_robot.data, source_robot.size,
+                           source_external.data, source_external.size);
+  }
+
+  return success;
+}
+
+bool parse(wrapper::CartesianPose* p_target, const RobotData::Pose& source)
+{
+  bool success = false;
+
+  if (p_target)
+  {
+    p_target->Clear();
+
+    if (source.has_pos && source.has_orient)
+    {
+      p_target->mutable_position()->set_x(source.pos[0]);
+      p_target->mutable_position()->set_y(source.pos[1]);
+      p_target->mutable_position()->set_z(source.pos[2]);
+
+      p_target->mutable_quaternion()->set_u0(source.orient[0]);
+      p_target->mutable_quaternion()->set_u1(source.orient[1]);
+      p_target->mutable_quaternion()->set_u2(source.orient[2]);
+      p_target->mutable_quaternion()->set_u3(source.orient[3]);
+
+      if (source.has_euler)
+      {
+        p_target->mutable_euler()->set_x(source.euler[0]);
+        p_target->mutable_euler()->set_y(source.euler[1]);
+        p_target->mutable_euler()->set_z(source.euler[2]);
+      }
+      else
+      {
+        convert(p_target->mutable_euler(), p_target->quaternion());
+      }
+
+      success = true;
+    }
+  }
+
+  return success;
+}
+
+bool parse(wrapper::Feedback* p_target, const RobotData::Motion& source, const JointMapper& mapper)
+{
+  bool success = false;
+
+  if (p_target)
+  {
+    success = parse(p_target->mutable_robot()->mutable_joints()->mutable_position(),
+                    p_target->mutable_external()->mutable_joints()->mutable_position(),
+                    source.joints, source.external_joints, mapper);
+
+    if (success)
+    {
+      if (mapper.axes == None)
+      {
+        success = !source.has_cartesian;
+        p_target->mutable_robot()->mutable_cartesian()->clear_pose();
+      }
+      else
+      {
+        success = parse(p_target->mutable_robot()->mutable_cartesian()->mutable_pose(), source.cartesian);
+      }
+
+      if (success && source.has_time)
+      {
+        p_target->mutable_time()->set_sec(source.time.sec);
+        p_target->mutable_time()->set_usec(source.time.usec);
+      }
+      else
+      {
+        success = false;
+      }
+    }
+  }
+
+  return success;
+}
+
+bool parse(wrapper::Planned* p_target, const RobotData::Motion& source, const JointMapper& mapper)
+{
+  bool success = false;
+
+  if (p_target)
+  {
+    success = parse(p_target->mutable_robot()->mutable_joints()->mutable_position(),
+                    p_target->mutable_external()->mutable_joints()->mutable_position(),
+                    source.joints, source.external_joints, mapper);
+
+    if (success)
+    {
+      if (mapper.axes == None)
+      {
+        success = !source.has_cartesian;
+        p_target->mutable_robot()->mutable_cartesian()->clear_pose();
+      }
+      else
+      {
+        success = parse(p_target->mutable_robot()->mutable_cartesian()->mutable_pose(), source.cartesian);
+      }
+
+      if (success && source.has_time)
+      {
+        p_target->mutable_time()->set_sec(source.time.sec);
+        p_target->mutable_time()->set_usec(source.time.usec);
+      }
+      else
+      {
+        success = false;
+      }
+    }
+  }
+
+  return success;
+}
+
+bool parse(wrapper::MeasuredForce* p_target, const RobotData::Values& source)
+{
+  bool success = true;
+
+  if (p_target)
+  {
+    p_target->Clear();
+
+    // Should have 6 values [linear x, linear y, linear z, rot x, rot y, rot z].
+    if (source.size == 6)
+    {
+      for (int i = 0; i < source.size; ++i)
+      {
+        p_target->add_force(source.data[i]);
+      }
+    }
+    else
+    {
+      success = false;
+    }
+  }
+
+  return success;
+}
+
 
 /***********************************************************************************************************************
  * Reset functions
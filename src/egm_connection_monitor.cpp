@@ -0,0 +1,174 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <algorithm>
+
+#include "abb_libegm/egm_connection_monitor.h"
+
+namespace abb
+{
+namespace egm
+{
+/***********************************************************************************************************************
+ * Class definitions: EGMConnectionMonitor
+ */
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const unsigned int EGMConnectionMonitor::MIN_TIMEOUT_MS;
+const unsigned int EGMConnectionMonitor::TIMEOUT_PERIODS;
+const unsigned int EGMConnectionMonitor::POLL_TIME_MS;
+const double EGMConnectionMonitor::PERIOD_SMOOTHING = 0.125;
+
+/************************************************************
+ * Primary methods
+ */
+
+EGMConnectionMonitor::EGMConnectionMonitor(const EventCallback& event_callback)
+:
+last_receive_time_(0),
+estimated_period_(0),
+period_(0.0),
+stop_requested_(false),
+event_callback_(event_callback)
+{
+  if (event_callback_)
+  {
+    monitor_thread_ = boost::thread(&EGMConnectionMonitor::monitorThread, this);
+  }
+}
+
+EGMConnectionMonitor::~EGMConnectionMonitor()
+{
+  stop_requested_ = true;
+
+  if (monitor_thread_.joinable())
+  {
+    monitor_thread_.join();
+  }
+}
+
+void EGMConnectionMonitor::update(const boost::chrono::steady_clock::time_point& receive_time,
+                                  const bool first_message)
+{
+  const boost::int64_t time = (receive_time != boost::chrono::steady_clock::time_point() ?
+                                boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+                                  receive_time.time_since_epoch()).count() : now());
+  const boost::int64_t previous = last_receive_time_.load(boost::memory_order_relaxed);
+
+  // Estimate the message period (restarted for every new session).
+  if (first_message || previous == 0 || time <= previous)
+  {
+    period_ = 0.0;
+  }
+  else if (period_ == 0.0)
+  {
+    period_ = (double) (time - previous);
+  }
+  else
+  {
+    period_ += PERIOD_SMOOTHING*((double) (time - previous) - period_);
+  }
+
+  estimated_period_.store((boost::int64_t) period_, boost::memory_order_relaxed);
+  last_receive_time_.store(time, boost::memory_order_release);
+}
+
+void EGMConnectionMonitor::invalidate()
+{
+  period_ = 0.0;
+  estimated_period_.store(0, boost::memory_order_relaxed);
+  last_receive_time_.store(0, boost::memory_order_release);
+}
+
+bool EGMConnectionMonitor::isConnected() const
+{
+  boost::int64_t age = 0;
+
+  return isConnected(now(), &age);
+}
+
+ConnectionStatus EGMConnectionMonitor::getStatus() const
+{
+  ConnectionStatus status;
+  boost::int64_t age = 0;
+
+  status.connected = isConnected(now(), &age);
+  status.time_since_last_message = age*1e-9;
+  status.estimated_message_period = estimated_period_.load(boost::memory_order_relaxed)*1e-9;
+
+  return status;
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+boost::int64_t EGMConnectionMonitor::now()
+{
+  return boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+           boost::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool EGMConnectionMonitor::isConnected(const boost::int64_t time, boost::int64_t* p_age) const
+{
+  const boost::int64_t last = last_receive_time_.load(boost::memory_order_acquire);
+  const boost::int64_t timeout = std::max((boost::int64_t) MIN_TIMEOUT_MS*1000000,
+                                          (boost::int64_t) TIMEOUT_PERIODS*estimated_period_.load());
+
+  // Note: The receive time can be slightly newer than the time, if a message arrived during the check.
+  *p_age = (last != 0 ? std::max(time - last, (boost::int64_t) 0) : 0);
+
+  return last != 0 && *p_age <= timeout;
+}
+
+void EGMConnectionMonitor::monitorThread()
+{
+  bool connected = false;
+
+  while (!stop_requested_)
+  {
+    if (isConnected() != connected)
+    {
+      connected = !connected;
+      event_callback_(connected);
+    }
+
+    boost::this_thread::sleep(boost::posix_time::milliseconds(POLL_TIME_MS));
+  }
+}
+
+} // end namespace egm
+} // end namespace abb
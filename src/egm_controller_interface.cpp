@@ -58,40 +58,85 @@ void EGMControllerInterface::ControllerMotion::initialize(const bool first_messa
 {
   if (first_message)
   {
-    boost::lock_guard<boost::mutex> lock(read_mutex_);
-    boost::lock_guard<boost::mutex> lock2(write_mutex_);
+    RealTimeLockGuard<boost::mutex> lock(read_mutex_);
+    RealTimeLockGuard<boost::mutex> lock2(write_mutex_);
 
     read_data_ready_ = false;
     write_data_ready_ = false;
+
+    // Discard any outputs published during a previous communication session.
+    outputs_.update();
+
+    if (use_shared_memory_.load(boost::memory_order_acquire))
+    {
+      shared_memory_.discardOutputs();
+    }
   }
 }
 
 void EGMControllerInterface::ControllerMotion::writeInputs(const wrapper::Input& inputs)
 {
- boost::lock_guard<boost::mutex> lock(read_mutex_);
+  inputs_.writeBuffer().CopyFrom(inputs);
+  inputs_.publish();
 
- inputs_.CopyFrom(inputs);
+  if (use_shared_memory_.load(boost::memory_order_acquire))
+  {
+    shared_memory_.writeInputs(inputs);
+  }
 
- read_data_ready_ = true;
- read_condition_variable_.notify_all();
+  {
+    RealTimeLockGuard<boost::mutex> lock(read_mutex_);
+    read_data_ready_ = true;
+  }
+
+  read_condition_variable_.notify_all();
 }
 
-void EGMControllerInterface::ControllerMotion::readOutputs(wrapper::Output* p_outputs)
+bool EGMControllerInterface::ControllerMotion::readOutputs(wrapper::Output* p_outputs, const bool wait)
 {
-  bool timed_out = false;
+  bool success = false;
 
-  boost::unique_lock<boost::mutex> lock(write_mutex_);
-
-  while (!write_data_ready_ && !timed_out)
+  if (use_shared_memory_.load(boost::memory_order_acquire))
   {
-    timed_out = !write_condition_variable_.timed_wait(lock, boost::posix_time::milliseconds(WRITE_TIMEOUT_MS));
+    // Without waiting (or on a timeout), the previous outputs are kept if no new outputs have been written.
+    success = ((!wait || shared_memory_.waitForOutputs(WRITE_TIMEOUT_MS)) &&
+               shared_memory_.readOutputs(&shared_outputs_));
+
+    if (success && p_outputs)
+    {
+      copyPresent(p_outputs, shared_outputs_);
+    }
+
+    return success;
   }
 
-  if (!timed_out && p_outputs)
+  bool timed_out = false;
+
   {
-    copyPresent(p_outputs, outputs_);
+    boost::unique_lock<boost::mutex> lock(write_mutex_);
+
+    if (wait)
+    {
+      while (!write_data_ready_ && !timed_out)
+      {
+        timed_out = !write_condition_variable_.timed_wait(lock, boost::posix_time::milliseconds(WRITE_TIMEOUT_MS));
+      }
+    }
+
+    // Note: Also cleared without waiting, since the waiting can be switched on during a session. Otherwise, a stale
+    //       flag would skip the next wait.
     write_data_ready_ = false;
   }
+
+  // Without waiting, the previous outputs are kept if the external loop has not written any new outputs.
+  success = !timed_out && outputs_.update();
+
+  if (success && p_outputs)
+  {
+    copyPresent(p_outputs, outputs_.readBuffer());
+  }
+
+  return success;
 }
 
 bool EGMControllerInterface::ControllerMotion::waitForMessage(const unsigned int timeout_ms)
@@ -117,19 +162,48 @@ bool EGMControllerInterface::ControllerMotion::waitForMessage(const unsigned int
 
 void EGMControllerInterface::ControllerMotion::readInputs(wrapper::Input* p_inputs)
 {
-  boost::lock_guard<boost::mutex> lock(read_mutex_);
+  {
+    boost::lock_guard<boost::mutex> lock(read_mutex_);
+    read_data_ready_ = false;
+  }
 
-  p_inputs->CopyFrom(inputs_);
-  read_data_ready_ = false;
+  // Note: The triple buffer only supports one reader, so concurrent external loop threads are serialized here (the
+  //       inner loop never takes this mutex).
+  boost::lock_guard<boost::mutex> lock(inputs_consumer_mutex_);
+  inputs_.update();
+  p_inputs->CopyFrom(inputs_.readBuffer());
+}
+
+bool EGMControllerInterface::ControllerMotion::createSharedMemory(const std::string& name)
+{
+  // Note: A segment in use by the inner loop is never replaced.
+  if (use_shared_memory_.load(boost::memory_order_acquire))
+  {
+    return false;
+  }
+
+  bool success = shared_memory_.create(name);
+
+  use_shared_memory_.store(success, boost::memory_order_release);
+
+  return success;
 }
 
 void EGMControllerInterface::ControllerMotion::writeOutputs(const wrapper::Output& outputs)
 {
-  boost::lock_guard<boost::mutex> lock(write_mutex_);
+  {
+    // Note: The triple buffer only supports one writer, so concurrent external loop threads are serialized here (the
+    //       inner loop never takes this mutex).
+    boost::lock_guard<boost::mutex> lock(outputs_producer_mutex_);
+    outputs_.writeBuffer().CopyFrom(outputs);
+    outputs_.publish();
+  }
 
-  outputs_.CopyFrom(outputs);
+  {
+    boost::lock_guard<boost::mutex> lock(write_mutex_);
+    write_data_ready_ = true;
+  }
 
-  write_data_ready_ = true;
   write_condition_variable_.notify_all();
 }
 
@@ -148,18 +222,28 @@ EGMControllerInterface::EGMControllerInterface(boost::asio::io_service& io_servi
                                                const unsigned short port_number,
                                                const BaseConfiguration& configuration)
 :
-EGMBaseInterface(io_service, port_number, configuration)
+EGMBaseInterface(io_service, port_number, configuration, false)
 {
-  if (configuration_.active.use_logging)
-  {
-    std::stringstream ss;
-    ss << "port_" << port_number << +"_log.csv";
-    p_logger_.reset(new EGMLogger(ss.str()));
-  }
+  // Start the server once the interface has been fully constructed, so the callbacks never see a partial object.
+  udp_server_.start();
+}
+
+EGMControllerInterface::~EGMControllerInterface()
+{
+  udp_server_.stop();
 }
 
 const std::string& EGMControllerInterface::callback(const UDPServerData& server_data)
 {
+  // Check the callback's real-time safety (if built with the checks).
+  ScopedRealTimeSection real_time_section(rt_checker_);
+
+  // Apply any requested configuration changes (that are allowed during a session).
+  refreshConfiguration();
+
+  // Start collecting statistics for the callback, if set to do so.
+  statistics_.startCycle(configuration_.active.use_statistics, server_data.receive_time);
+
   // Initialize the callback by:
   // - Parsing and extracting data from the received message.
   // - Updating any pending configuration changes.
@@ -185,27 +269,74 @@ const std::string& EGMControllerInterface::callback(const UDPServerData& server_
         configuration_.active.p_new_message_cv->notify_all();
       }
 
+      // Signal the (optional) event descriptor.
+      event_notifier_.notify();
+
       if (inputs_.isFirstMessage() || inputs_.statesOk())
       {
-        // Wait for new outputs (from the external control loop), or until a timeout occurs.
-        controller_motion_.readOutputs(&outputs_.current);
+        // Wait for new outputs (from the external control loop), or until a timeout occurs. Unless configured to
+        // use the latest available outputs directly.
+        const bool new_outputs = controller_motion_.readOutputs(&outputs_.current,
+                                                                !configuration_.active.use_non_blocking_outputs);
+
+        // Extrapolate late outputs, if set to do so.
+        if (configuration_.active.use_output_extrapolation)
+        {
+          const unsigned int sequence_number = inputs_.current().header().sequence_number();
+
+          if (inputs_.isFirstMessage())
+          {
+            output_extrapolator_.reset();
+          }
+
+          if (new_outputs || inputs_.isFirstMessage())
+          {
+            output_extrapolator_.update(outputs_.current, sequence_number, inputs_.estimatedSampleTime());
+          }
+          else
+          {
+            output_extrapolator_.extrapolate(&outputs_.current,
+                                             sequence_number,
+                                             inputs_.estimatedSampleTime(),
+                                             configuration_.active.extrapolation_duration);
+          }
+
+          extrapolation_statistics_.store(output_extrapolator_.getStatistics());
+        }
+        else
+        {
+          // Note: Avoids extrapolating from stale outputs, if the extrapolation is enabled again later.
+          output_extrapolator_.reset();
+        }
       }
     }
 
+    statistics_.markStage(EGMStatisticsCollector::Outputs);
+
     // Log inputs and outputs, if set to do so.
-    if (configuration_.active.use_logging && p_logger_)
+    if (configuration_.active.use_logging)
     {
       logData(inputs_, outputs_, configuration_.active.max_logging_duration);
+      statistics_.markStage(EGMStatisticsCollector::Logging);
     }
 
     // Constuct the reply message.
     outputs_.constructReply(configuration_.active);
+    statistics_.markStage(EGMStatisticsCollector::Reply);
+
+    // Publish the (optional) telemetry.
+    if (p_telemetry_)
+    {
+      p_telemetry_->add(inputs_.current(), outputs_.current);
+    }
 
     // Prepare for the next callback.
     inputs_.updatePrevious();
     outputs_.updatePrevious();
   }
 
+  statistics_.endCycle();
+
   // Return the reply.
   return outputs_.reply();
 }
@@ -229,5 +360,15 @@ void EGMControllerInterface::write(const wrapper::Output& outputs)
   controller_motion_.writeOutputs(outputs);
 }
 
+bool EGMControllerInterface::enableSharedMemory(const std::string& name)
+{
+  return controller_motion_.createSharedMemory(name);
+}
+
+bool EGMControllerInterface::retrieveExtrapolationStatistics(ExtrapolationStatistics* p_statistics) const
+{
+  return extrapolation_statistics_.tryLoad(p_statistics);
+}
+
 } // end namespace egm
 } // end namespace abb
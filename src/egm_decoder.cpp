@@ -0,0 +1,710 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <cstring>
+
+#include <boost/static_assert.hpp>
+
+#include "egm.pb.h" // Generated by Google Protocol Buffer compiler protoc
+
+#include "abb_libegm/egm_common.h"
+#include "abb_libegm/egm_decoder.h"
+
+namespace abb
+{
+namespace egm
+{
+// The decoded values must have room for every joint (e.g. a robot and its external axes).
+BOOST_STATIC_ASSERT(RobotData::MAX_NUMBER_OF_VALUES == Constants::RobotController::MAX_NUMBER_OF_JOINTS);
+
+/***********************************************************************************************************************
+ * Auxiliary functions (wire format)
+ */
+
+/**
+ * \brief Enum for the Google Protocol Buffer wire types.
+ */
+enum WireType
+{
+  Varint          = 0, ///< \brief int32, int64, uint32, uint64, sint32, sint64, bool and enum.
+  Fixed64         = 1, ///< \brief fixed64, sfixed64 and double.
+  LengthDelimited = 2, ///< \brief string, bytes, embedded messages and packed repeated fields.
+  StartGroup      = 3, ///< \brief Groups (deprecated).
+  EndGroup        = 4, ///< \brief Groups (deprecated).
+  Fixed32         = 5  ///< \brief fixed32, sfixed32 and float.
+};
+
+/**
+ * \brief Struct for a range of bytes, that is being decoded.
+ */
+struct WireRange
+{
+  /**
+   * \brief A constructor.
+   *
+   * \param begin for the first byte in the range.
+   * \param end for one past the last byte in the range.
+   */
+  WireRange(const unsigned char* begin, const unsigned char* end) : p(begin), end(end) {}
+
+  /**
+   * \brief Pointer to the next byte to decode.
+   */
+  const unsigned char* p;
+
+  /**
+   * \brief Pointer to one past the last byte in the range.
+   */
+  const unsigned char* end;
+};
+
+/**
+ * \brief Read a varint encoded value.
+ */
+static bool readVarint(WireRange* p_range, boost::uint64_t* p_value)
+{
+  boost::uint64_t value = 0;
+
+  for (int shift = 0; shift < 64 && p_range->p < p_range->end; shift += 7)
+  {
+    const unsigned char byte = *(p_range->p++);
+    value |= ((boost::uint64_t) (byte & 0x7F)) << shift;
+
+    if ((byte & 0x80) == 0)
+    {
+      *p_value = value;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * \brief Read a little-endian encoded double value.
+ */
+static bool readDouble(WireRange* p_range, double* p_value)
+{
+  if (p_range->end - p_range->p < 8)
+  {
+    return false;
+  }
+
+  // The wire format is always little-endian.
+  boost::uint64_t bits = 0;
+  for (int i = 7; i >= 0; --i)
+  {
+    bits = (bits << 8) | p_range->p[i];
+  }
+  p_range->p += 8;
+
+  std::memcpy(p_value, &bits, sizeof(double));
+
+  return true;
+}
+
+/**
+ * \brief Read a field tag (i.e. the field number and the wire type).
+ */
+static bool readTag(WireRange* p_range, boost::uint32_t* p_field, int* p_wire_type)
+{
+  boost::uint64_t tag = 0;
+
+  if (!readVarint(p_range, &tag))
+  {
+    return false;
+  }
+
+  *p_field = (boost::uint32_t) (tag >> 3);
+  *p_wire_type = (int) (tag & 0x07);
+
+  return (*p_field != 0);
+}
+
+/**
+ * \brief Read the length of a length-delimited field, and extract the corresponding sub range.
+ */
+static bool readSubRange(WireRange* p_range, WireRange* p_sub_range)
+{
+  boost::uint64_t length = 0;
+
+  if (!readVarint(p_range, &length) || length > (boost::uint64_t) (p_range->end - p_range->p))
+  {
+    return false;
+  }
+
+  p_sub_range->p = p_range->p;
+  p_sub_range->end = p_range->p + length;
+  p_range->p += length;
+
+  return true;
+}
+
+/**
+ * \brief Skip an unknown, or unused, field.
+ */
+static bool skipField(WireRange* p_range, const int wire_type)
+{
+  boost::uint64_t value = 0;
+  WireRange sub_range(0, 0);
+
+  switch (wire_type)
+  {
+    case Varint:
+    {
+      return readVarint(p_range, &value);
+    }
+
+    case Fixed64:
+    case Fixed32:
+    {
+      const long size = (wire_type == Fixed64 ? 8 : 4);
+
+      if (p_range->end - p_range->p < size)
+      {
+        return false;
+      }
+
+      p_range->p += size;
+      return true;
+    }
+
+    case LengthDelimited:
+    {
+      return readSubRange(p_range, &sub_range);
+    }
+
+    case StartGroup:
+    case EndGroup:
+    default:
+    {
+      // Groups are not used in the EGM protocol.
+      return false;
+    }
+  }
+}
+
+/**
+ * \brief Read a repeated double field (packed or unpacked) into a fixed-capacity array.
+ */
+static bool readValues(WireRange* p_range, const int wire_type, RobotData::Values* p_values)
+{
+  if (wire_type == Fixed64)
+  {
+    // Unpacked repeated field (one value at a time).
+    return (p_values->size < RobotData::MAX_NUMBER_OF_VALUES &&
+            readDouble(p_range, &p_values->data[p_values->size++]));
+  }
+  else if (wire_type == LengthDelimited)
+  {
+    // Packed repeated field.
+    WireRange sub_range(0, 0);
+
+    if (!readSubRange(p_range, &sub_range))
+    {
+      return false;
+    }
+
+    while (sub_range.p < sub_range.end)
+    {
+      if (p_values->size >= RobotData::MAX_NUMBER_OF_VALUES ||
+          !readDouble(&sub_range, &p_values->data[p_values->size++]))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+/**
+ * \brief Read a message only containing required double fields (e.g. abb::egm::EgmCartesian).
+ */
+static bool readDoubles(WireRange* p_range, const int wire_type, double* p_values, const boost::uint32_t size)
+{
+  WireRange sub_range(0, 0);
+  boost::uint32_t field = 0;
+  int field_wire_type = 0;
+  unsigned int present = 0;
+
+  if (wire_type != LengthDelimited || !readSubRange(p_range, &sub_range))
+  {
+    return false;
+  }
+
+  while (sub_range.p < sub_range.end)
+  {
+    if (!readTag(&sub_range, &field, &field_wire_type))
+    {
+      return false;
+    }
+
+    if (field <= size && field_wire_type == Fixed64)
+    {
+      if (!readDouble(&sub_range, &p_values[field - 1]))
+      {
+        return false;
+      }
+
+      present |= (1u << (field - 1));
+    }
+    else if (!skipField(&sub_range, field_wire_type))
+    {
+      return false;
+    }
+  }
+
+  // All fields are required.
+  return (present == ((1u << size) - 1));
+}
+
+/**
+ * \brief Read a message only containing one required enum field (e.g. abb::egm::EgmMotorState).
+ *
+ * Note: Unknown enum values are treated as absent (same as for the Google Protocol Buffer parser), which means that
+ *       the required field is missing.
+ */
+static bool readState(WireRange* p_range, const int wire_type, int* p_state, bool (*is_valid)(int))
+{
+  WireRange sub_range(0, 0);
+  boost::uint32_t field = 0;
+  int field_wire_type = 0;
+  boost::uint64_t value = 0;
+  bool present = false;
+
+  if (wire_type != LengthDelimited || !readSubRange(p_range, &sub_range))
+  {
+    return false;
+  }
+
+  while (sub_range.p < sub_range.end)
+  {
+    if (!readTag(&sub_range, &field, &field_wire_type))
+    {
+      return false;
+    }
+
+    if (field == 1 && field_wire_type == Varint)
+    {
+      if (!readVarint(&sub_range, &value))
+      {
+        return false;
+      }
+
+      if (is_valid((int) value))
+      {
+        *p_state = (int) value;
+        present = true;
+      }
+    }
+    else if (!skipField(&sub_range, field_wire_type))
+    {
+      return false;
+    }
+  }
+
+  return present;
+}
+
+/**
+ * \brief Read an abb::egm::EgmHeader message.
+ */
+static bool readHeader(WireRange* p_range, const int wire_type, RobotData::Header* p_header)
+{
+  WireRange sub_range(0, 0);
+  boost::uint32_t field = 0;
+  int field_wire_type = 0;
+  boost::uint64_t value = 0;
+
+  if (wire_type != LengthDelimited || !readSubRange(p_range, &sub_range))
+  {
+    return false;
+  }
+
+  while (sub_range.p < sub_range.end)
+  {
+    if (!readTag(&sub_range, &field, &field_wire_type))
+    {
+      return false;
+    }
+
+    if (field >= 1 && field <= 3 && field_wire_type == Varint)
+    {
+      if (!readVarint(&sub_range, &value))
+      {
+        return false;
+      }
+
+      switch (field)
+      {
+        case 1:
+        {
+          p_header->seqno = (boost::uint32_t) value;
+          p_header->has_seqno = true;
+        }
+        break;
+
+        case 2:
+        {
+          p_header->tm = (boost::uint32_t) value;
+          p_header->has_tm = true;
+        }
+        break;
+
+        case 3:
+        {
+          // Unknown enum values are treated as absent (same as for the Google Protocol Buffer parser).
+          if (EgmHeader_MessageType_IsValid((int) value))
+          {
+            p_header->mtype = (int) value;
+            p_header->has_mtype = true;
+          }
+        }
+        break;
+      }
+    }
+    else if (!skipField(&sub_range, field_wire_type))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * \brief Read an abb::egm::EgmClock message.
+ */
+static bool readClock(WireRange* p_range, const int wire_type, RobotData::Clock* p_clock)
+{
+  WireRange sub_range(0, 0);
+  boost::uint32_t field = 0;
+  int field_wire_type = 0;
+  bool has_sec = false;
+  bool has_usec = false;
+
+  if (wire_type != LengthDelimited || !readSubRange(p_range, &sub_range))
+  {
+    return false;
+  }
+
+  while (sub_range.p < sub_range.end)
+  {
+    if (!readTag(&sub_range, &field, &field_wire_type))
+    {
+      return false;
+    }
+
+    if (field == 1 && field_wire_type == Varint)
+    {
+      has_sec = readVarint(&sub_range, &p_clock->sec);
+
+      if (!has_sec)
+      {
+        return false;
+      }
+    }
+    else if (field == 2 && field_wire_type == Varint)
+    {
+      has_usec = readVarint(&sub_range, &p_clock->usec);
+
+      if (!has_usec)
+      {
+        return false;
+      }
+    }
+    else if (!skipField(&sub_range, field_wire_type))
+    {
+      return false;
+    }
+  }
+
+  return (has_sec && has_usec);
+}
+
+/**
+ * \brief Read an abb::egm::EgmPose message.
+ */
+static bool readPose(WireRange* p_range, const int wire_type, RobotData::Pose* p_pose)
+{
+  WireRange sub_range(0, 0);
+  boost::uint32_t field = 0;
+  int field_wire_type = 0;
+  bool ok = true;
+
+  if (wire_type != LengthDelimited || !readSubRange(p_range, &sub_range))
+  {
+    return false;
+  }
+
+  while (ok && sub_range.p < sub_range.end)
+  {
+    if (!readTag(&sub_range, &field, &field_wire_type))
+    {
+      return false;
+    }
+
+    switch (field)
+    {
+      case 1:
+      {
+        ok = p_pose->has_pos = readDoubles(&sub_range, field_wire_type, p_pose->pos, 3);
+      }
+      break;
+
+      case 2:
+      {
+        ok = p_pose->has_orient = readDoubles(&sub_range, field_wire_type, p_pose->orient, 4);
+      }
+      break;
+
+      case 3:
+      {
+        ok = p_pose->has_euler = readDoubles(&sub_range, field_wire_type, p_pose->euler, 3);
+      }
+      break;
+
+      default:
+      {
+        ok = skipField(&sub_range, field_wire_type);
+      }
+    }
+  }
+
+  return ok;
+}
+
+/**
+ * \brief Read a joints message (i.e. abb::egm::EgmJoints or abb::egm::EgmMeasuredForce).
+ */
+static bool readJoints(WireRange* p_range, const int wire_type, RobotData::Values* p_values)
+{
+  WireRange sub_range(0, 0);
+  boost::uint32_t field = 0;
+  int field_wire_type = 0;
+  bool ok = true;
+
+  if (wire_type != LengthDelimited || !readSubRange(p_range, &sub_range))
+  {
+    return false;
+  }
+
+  while (ok && sub_range.p < sub_range.end)
+  {
+    if (!readTag(&sub_range, &field, &field_wire_type))
+    {
+      return false;
+    }
+
+    if (field == 1)
+    {
+      ok = readValues(&sub_range, field_wire_type, p_values);
+    }
+    else
+    {
+      ok = skipField(&sub_range, field_wire_type);
+    }
+  }
+
+  return ok;
+}
+
+/**
+ * \brief Read an abb::egm::EgmFeedBack or an abb::egm::EgmPlanned message (they share the same layout).
+ */
+static bool readMotion(WireRange* p_range, const int wire_type, RobotData::Motion* p_motion)
+{
+  WireRange sub_range(0, 0);
+  boost::uint32_t field = 0;
+  int field_wire_type = 0;
+  bool ok = true;
+
+  if (wire_type != LengthDelimited || !readSubRange(p_range, &sub_range))
+  {
+    return false;
+  }
+
+  while (ok && sub_range.p < sub_range.end)
+  {
+    if (!readTag(&sub_range, &field, &field_wire_type))
+    {
+      return false;
+    }
+
+    switch (field)
+    {
+      case 1:
+      {
+        ok = readJoints(&sub_range, field_wire_type, &p_motion->joints);
+      }
+      break;
+
+      case 2:
+      {
+        ok = p_motion->has_cartesian = readPose(&sub_range, field_wire_type, &p_motion->cartesian);
+      }
+      break;
+
+      case 3:
+      {
+        ok = readJoints(&sub_range, field_wire_type, &p_motion->external_joints);
+      }
+      break;
+
+      case 4:
+      {
+        ok = p_motion->has_time = readClock(&sub_range, field_wire_type, &p_motion->time);
+      }
+      break;
+
+      default:
+      {
+        ok = skipField(&sub_range, field_wire_type);
+      }
+    }
+  }
+
+  return ok;
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Function definitions
+ */
+
+bool decode(RobotData* p_target, const char* data, const int bytes_transferred)
+{
+  if (!p_target || !data || bytes_transferred < 0)
+  {
+    return false;
+  }
+
+  std::memset(p_target, 0, sizeof(RobotData));
+
+  const unsigned char* begin = reinterpret_cast<const unsigned char*>(data);
+  WireRange range(begin, begin + bytes_transferred);
+  boost::uint32_t field = 0;
+  int wire_type = 0;
+  boost::uint64_t value = 0;
+  bool ok = true;
+
+  while (ok && range.p < range.end)
+  {
+    if (!readTag(&range, &field, &wire_type))
+    {
+      return false;
+    }
+
+    switch (field)
+    {
+      case 1:
+      {
+        ok = p_target->has_header = readHeader(&range, wire_type, &p_target->header);
+      }
+      break;
+
+      case 2:
+      {
+        ok = readMotion(&range, wire_type, &p_target->feedback);
+      }
+      break;
+
+      case 3:
+      {
+        ok = readMotion(&range, wire_type, &p_target->planned);
+      }
+      break;
+
+      case 4:
+      {
+        ok = p_target->has_motor_state = readState(&range, wire_type, &p_target->motor_state,
+                                                   EgmMotorState_MotorStateType_IsValid);
+      }
+      break;
+
+      case 5:
+      {
+        ok = p_target->has_mci_state = readState(&range, wire_type, &p_target->mci_state,
+                                                 EgmMCIState_MCIStateType_IsValid);
+      }
+      break;
+
+      case 6:
+      {
+        ok = (wire_type == Varint && readVarint(&range, &value));
+        p_target->mci_convergence_met = (value != 0);
+        p_target->has_mci_convergence_met = ok;
+      }
+      break;
+
+      case 8:
+      {
+        ok = p_target->has_rapid_exec_state = readState(&range, wire_type, &p_target->rapid_exec_state,
+                                                        EgmRapidCtrlExecState_RapidCtrlExecStateType_IsValid);
+      }
+      break;
+
+      case 9:
+      {
+        ok = readJoints(&range, wire_type, &p_target->measured_force);
+      }
+      break;
+
+      case 10:
+      {
+        ok = (wire_type == Fixed64 && readDouble(&range, &p_target->utilization_rate));
+        p_target->has_utilization_rate = ok;
+      }
+      break;
+
+      default:
+      {
+        // E.g. test signals (field 7), which are not used.
+        ok = skipField(&range, wire_type);
+      }
+    }
+  }
+
+  return ok;
+}
+
+} // end namespace egm
+} // end namespace abb
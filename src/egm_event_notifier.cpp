@@ -0,0 +1,117 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#include <boost/cstdint.hpp>
+
+#include "abb_libegm/egm_event_notifier.h"
+
+namespace abb
+{
+namespace egm
+{
+/***********************************************************************************************************************
+ * Class definitions: EGMEventNotifier
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+EGMEventNotifier::EGMEventNotifier(const bool enable)
+:
+descriptor_(-1)
+{
+#ifdef __linux__
+  if (enable)
+  {
+    // Note: Non-blocking, so that neither signalling nor acknowledging can block.
+    descriptor_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  }
+#else
+  (void) enable;
+#endif
+}
+
+EGMEventNotifier::~EGMEventNotifier()
+{
+#ifdef __linux__
+  if (descriptor_ >= 0)
+  {
+    close(descriptor_);
+  }
+#endif
+}
+
+int EGMEventNotifier::descriptor() const
+{
+  return descriptor_;
+}
+
+void EGMEventNotifier::notify()
+{
+#ifdef __linux__
+  if (descriptor_ >= 0)
+  {
+    // Note: Only fails if the counter would overflow, i.e. if the events are never acknowledged.
+    const boost::uint64_t value = 1;
+    ssize_t result = write(descriptor_, &value, sizeof(value));
+    (void) result;
+  }
+#endif
+}
+
+unsigned int EGMEventNotifier::acknowledge()
+{
+  boost::uint64_t value = 0;
+
+#ifdef __linux__
+  if (descriptor_ >= 0 && read(descriptor_, &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value)))
+  {
+    // I.e. no events have been signalled.
+    value = 0;
+  }
+#endif
+
+  return static_cast<unsigned int>(value);
+}
+
+} // end namespace egm
+} // end namespace abb
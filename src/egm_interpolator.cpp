@@ -36,6 +36,7 @@
 
 #define _USE_MATH_DEFINES
 
+#include <algorithm>
 #include <cmath>
 
 #include "abb_libegm/egm_common_auxiliary.h"
@@ -45,6 +46,41 @@ namespace abb
 {
 namespace egm
 {
+/***********************************************************************************************************************
+ * Class definitions: EGMInterpolator::Timing
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+EGMInterpolator::Timing::Timing()
+:
+duration(0.0)
+{
+  for (size_t i = 0; i < sizeof(inverse_powers) / sizeof(inverse_powers[0]); ++i)
+  {
+    inverse_powers[i] = 0.0;
+  }
+}
+
+EGMInterpolator::Timing::Timing(const double segment_duration)
+:
+duration(std::max(Constants::RobotController::LOWEST_SAMPLE_TIME, segment_duration))
+{
+  const double inverse_duration = 1.0 / duration;
+
+  inverse_powers[0] = 1.0;
+
+  for (size_t i = 1; i < sizeof(inverse_powers) / sizeof(inverse_powers[0]); ++i)
+  {
+    inverse_powers[i] = inverse_powers[i - 1]*inverse_duration;
+  }
+}
+
+
+
+
 /***********************************************************************************************************************
  * Class definitions: EGMInterpolator::SplineConditions
  */
@@ -110,18 +146,41 @@ void EGMInterpolator::SplineConditions::setConditions(const EGMInterpolator::Axi
 
 
 /***********************************************************************************************************************
- * Class definitions: EGMInterpolator::SplinePolynomial
+ * Class definitions: EGMInterpolator::SplineBlock
  */
 
 /************************************************************
  * Primary methods
  */
 
-void EGMInterpolator::SplinePolynomial::update(const SplineConditions& conditions)
+EGMInterpolator::SplineBlock::SplineBlock()
+:
+p_evaluate_(&SplineBlock::evaluateDegree<5>)
+{
+  for (size_t i = 0; i < MAX_NUMBER_OF_SPLINES; ++i)
+  {
+    a_[i] = 0.0;
+    b_[i] = 0.0;
+    c_[i] = 0.0;
+    d_[i] = 0.0;
+    e_[i] = 0.0;
+    f_[i] = 0.0;
+  }
+}
+
+void EGMInterpolator::SplineBlock::update(const int index, const SplineConditions& conditions)
 {
+  if (index < 0 || index >= static_cast<int>(MAX_NUMBER_OF_SPLINES))
+  {
+    return;
+  }
+
   const double T = conditions.duration;
   const double K = saturate(conditions.ramp_down_factor, 0.0, 1.0);
 
+  // Precomputed inverse powers of T. I.e. 1/T, ..., 1/T^5.
+  const double* inv_T = conditions.timing.inverse_powers;
+
   // Support variables.
   double c1 = 0.0;
   double c2 = 0.0;
@@ -132,6 +191,12 @@ void EGMInterpolator::SplinePolynomial::update(const SplineConditions& condition
   double beta    = conditions.beta;
   double d_beta  = conditions.d_beta;
   double dd_beta = conditions.dd_beta;
+  double a = 0.0;
+  double b = 0.0;
+  double c = 0.0;
+  double d = 0.0;
+  double e = 0.0;
+  double f = 0.0;
 
   if (conditions.do_ramp_down)
   {
@@ -153,12 +218,12 @@ void EGMInterpolator::SplinePolynomial::update(const SplineConditions& condition
     // d_S(T) = K*d_alfa, K = [0.0, 1.0];
     // dd_S(T) = 0.0
     //---------------------------------------------------------------
-    a_ = alfa;
-    b_ = d_alfa;
-    c_ = ((K - 1.0)*d_alfa) / T;
-    d_ = (-c_)/(3.0*T);
-    e_ = 0.0;
-    f_ = 0.0;
+    a = alfa;
+    b = d_alfa;
+    c = ((K - 1.0)*d_alfa)*inv_T[1];
+    d = (-c)*inv_T[1] / 3.0;
+    e = 0.0;
+    f = 0.0;
   }
   else
   {
@@ -178,12 +243,12 @@ void EGMInterpolator::SplinePolynomial::update(const SplineConditions& condition
         // S(0) = alfa
         // S(T) = beta
         //---------------------------------------------------------------
-        a_ = alfa;
-        b_ = (beta - alfa) / T;
-        c_ = 0.0;
-        d_ = 0.0;
-        e_ = 0.0;
-        f_ = 0.0;
+        a = alfa;
+        b = (beta - alfa)*inv_T[1];
+        c = 0.0;
+        d = 0.0;
+        e = 0.0;
+        f = 0.0;
       }
       break;
 
@@ -203,12 +268,12 @@ void EGMInterpolator::SplinePolynomial::update(const SplineConditions& condition
         //
         // S(T) = beta
         //---------------------------------------------------------------
-        a_ = alfa;
-        b_ = d_alfa;
-        c_ = (beta - alfa - d_alfa*T) / std::pow(T, 2);
-        d_ = 0.0;
-        e_ = 0.0;
-        f_ = 0.0;
+        a = alfa;
+        b = d_alfa;
+        c = (beta - alfa - d_alfa*T)*inv_T[2];
+        d = 0.0;
+        e = 0.0;
+        f = 0.0;
       }
       break;
 
@@ -229,16 +294,16 @@ void EGMInterpolator::SplinePolynomial::update(const SplineConditions& condition
         // S(T) = beta
         // d_S(T) = d_beta
         //---------------------------------------------------------------
-        a_ = alfa;
-        b_ = d_alfa;
+        a = alfa;
+        b = d_alfa;
 
         c1 = beta - alfa - d_alfa*T;
         c2 = d_beta - d_alfa;
 
-        c_ = 3.0*c1 / std::pow(T, 2) - c2 / T;
-        d_ = c1 / std::pow(T, 3) - c_ / T;
-        e_ = 0.0;
-        f_ = 0.0;
+        c = 3.0*c1*inv_T[2] - c2*inv_T[1];
+        d = c1*inv_T[3] - c*inv_T[1];
+        e = 0.0;
+        f = 0.0;
       }
       break;
 
@@ -261,78 +326,287 @@ void EGMInterpolator::SplinePolynomial::update(const SplineConditions& condition
         // d_S(T) = d_beta
         // dd_S(T) = dd_beta
         //---------------------------------------------------------------
-        a_ = alfa;
-        b_ = d_alfa;
-        c_ = dd_alfa / 2.0;
+        a = alfa;
+        b = d_alfa;
+        c = dd_alfa / 2.0;
 
-        c1 = beta - alfa - d_alfa*T - (dd_alfa / 2.0)*std::pow(T, 2);
+        c1 = beta - alfa - d_alfa*T - (dd_alfa / 2.0)*T*T;
         c2 = d_beta - d_alfa - dd_alfa*T;
         c3 = dd_beta - dd_alfa;
 
-        d_ = 10.0*c1 / std::pow(T, 3) - 4.0 * c2 / std::pow(T, 2) + c3 / (2.0*T);
-        e_ = 5.0*c1 / std::pow(T, 4) - c2 / std::pow(T, 3) - 2.0*d_ / T;
-        f_ = c1 / std::pow(T, 5) - d_ / std::pow(T, 2) - e_ / T;
+        d = 10.0*c1*inv_T[3] - 4.0*c2*inv_T[2] + 0.5*c3*inv_T[1];
+        e = 5.0*c1*inv_T[4] - c2*inv_T[3] - 2.0*d*inv_T[1];
+        f = c1*inv_T[5] - d*inv_T[2] - e*inv_T[1];
       }
       break;
     }
   }
+
+  a_[index] = a;
+  b_[index] = b;
+  c_[index] = c;
+  d_[index] = d;
+  e_[index] = e;
+  f_[index] = f;
+}
+
+void EGMInterpolator::SplineBlock::selectEvaluation(const SplineConditions& conditions)
+{
+  // Note: Ramping down always uses a cubic polynomial.
+  TrajectoryConfiguration::SplineMethod method = TrajectoryConfiguration::Cubic;
+
+  if (!conditions.do_ramp_down)
+  {
+    method = conditions.spline_method;
+  }
+
+  switch (method)
+  {
+    case TrajectoryConfiguration::Linear:
+    {
+      p_evaluate_ = &SplineBlock::evaluateDegree<1>;
+    }
+    break;
+
+    case TrajectoryConfiguration::Square:
+    {
+      p_evaluate_ = &SplineBlock::evaluateDegree<2>;
+    }
+    break;
+
+    case TrajectoryConfiguration::Cubic:
+    {
+      p_evaluate_ = &SplineBlock::evaluateDegree<3>;
+    }
+    break;
+
+    case TrajectoryConfiguration::Quintic:
+    default:
+    {
+      p_evaluate_ = &SplineBlock::evaluateDegree<5>;
+    }
+    break;
+  }
 }
 
-void EGMInterpolator::SplinePolynomial::evaluate(wrapper::trajectory::JointGoal* p_output,
-                                                 const int index,
-                                                 const double t)
+void EGMInterpolator::SplineBlock::evaluate(double* p_positions,
+                                            double* p_velocities,
+                                            double* p_accelerations,
+                                            const double t) const
+{
+  (this->*p_evaluate_)(p_positions, p_velocities, p_accelerations, t);
+}
+
+void EGMInterpolator::SplineBlock::evaluateExtremes(double* p_velocities,
+                                                    double* p_accelerations,
+                                                    double* p_jerks,
+                                                    const double duration) const
 {
   //---------------------------------------------------------------
-  // Evaluate:
-  //   S(t) = A + B*t + C*t^2 + D*t^3 + E*t^4 + F*t^5
+  // The derivatives are:
   //   S_prime(t) = B + 2C*t + 3D*t^2 + 4E*t^3 + 5F*t^4
   //   S_bis(t) = 2C + 6D*t + 12E*t^2 + 20F*t^3
+  //   S_tri(t) = 6D + 24E*t + 60F*t^2
   //
   // Condition: 0 <= t <= T
+  //
+  // Note: The extremes are found at the interval's end points,
+  //       or at the roots of the next derivative. The roots
+  //       of S_bis are searched for (by bisection) between the
+  //       roots of S_tri, where S_bis is monotonic.
   //---------------------------------------------------------------
-  p_output->mutable_position()->set_values(index, calculatePosition(t));
-  p_output->mutable_velocity()->set_values(index, calculateVelocity(t));
-  p_output->mutable_acceleration()->set_values(index, calculateAcceleration(t));
+  const double T = duration;
+  const int MAX_ITERATIONS = 60;
+
+  for (size_t i = 0; i < MAX_NUMBER_OF_SPLINES; ++i)
+  {
+    const double b = b_[i];
+    const double c = 2.0*c_[i];
+    const double d = 3.0*d_[i];
+    const double e = 4.0*e_[i];
+    const double f = 5.0*f_[i];
+
+    // Velocities, accelerations and jerks at the end points.
+    double max_v = std::max(std::abs(b), std::abs(b + T*(c + T*(d + T*(e + T*f)))));
+    double max_a = std::max(std::abs(c), std::abs(c + T*(2.0*d + T*(3.0*e + T*4.0*f))));
+    double max_j = std::max(std::abs(2.0*d), std::abs(2.0*d + T*(6.0*e + T*12.0*f)));
+
+    // Jerk extreme, at the root of S_quad(t) = 24E + 120F*t.
+    if (f != 0.0)
+    {
+      const double t = -6.0*e / (24.0*f);
+
+      if (t > 0.0 && t < T)
+      {
+        max_j = std::max(max_j, std::abs(2.0*d + t*(6.0*e + t*12.0*f)));
+      }
+    }
+
+    // Acceleration extremes, at the roots of S_tri(t).
+    double jerk_roots[2];
+    const int number_of_jerk_roots = findRoots(jerk_roots, 2.0*d, 6.0*e, 12.0*f, T);
+
+    for (int j = 0; j < number_of_jerk_roots; ++j)
+    {
+      const double t = jerk_roots[j];
+      max_a = std::max(max_a, std::abs(c + t*(2.0*d + t*(3.0*e + t*4.0*f))));
+    }
+
+    // Velocity extremes, at the roots of S_bis(t) (searched for in each monotonic interval).
+    double bounds[4];
+    int number_of_bounds = 0;
+    bounds[number_of_bounds++] = 0.0;
+
+    for (int j = 0; j < number_of_jerk_roots; ++j)
+    {
+      bounds[number_of_bounds++] = jerk_roots[j];
+    }
+
+    bounds[number_of_bounds++] = T;
+
+    for (int j = 0; j < number_of_bounds - 1; ++j)
+    {
+      double low = bounds[j];
+      double high = bounds[j + 1];
+      double a_low = c + low*(2.0*d + low*(3.0*e + low*4.0*f));
+      const double a_high = c + high*(2.0*d + high*(3.0*e + high*4.0*f));
+
+      if ((a_low < 0.0) != (a_high < 0.0))
+      {
+        for (int k = 0; k < MAX_ITERATIONS && high - low > 0.0; ++k)
+        {
+          const double t = 0.5*(low + high);
+          const double a_t = c + t*(2.0*d + t*(3.0*e + t*4.0*f));
+
+          if ((a_t < 0.0) == (a_low < 0.0))
+          {
+            low = t;
+            a_low = a_t;
+          }
+          else
+          {
+            high = t;
+          }
+        }
+
+        const double t = 0.5*(low + high);
+        max_v = std::max(max_v, std::abs(b + t*(c + t*(d + t*(e + t*f)))));
+      }
+    }
+
+    p_velocities[i] = max_v;
+    p_accelerations[i] = max_a;
+    p_jerks[i] = max_j;
+  }
 }
 
-void EGMInterpolator::SplinePolynomial::evaluate(wrapper::trajectory::CartesianGoal* p_output,
-                                                 const Axis axis,
-                                                 const double t)
+/************************************************************
+ * Auxiliary methods
+ */
+
+template <int DEGREE>
+void EGMInterpolator::SplineBlock::evaluateDegree(double* p_positions,
+                                                  double* p_velocities,
+                                                  double* p_accelerations,
+                                                  const double t) const
 {
   //---------------------------------------------------------------
-  // Evaluate:
-  //   S(t) = A + B*t + C*t^2 + D*t^3 + E*t^4 + F*t^5
-  //   S_prime(t) = B + 2C*t + 3D*t^2 + 4E*t^3 + 5F*t^4
-  //   S_bis(t) = 2C + 6D*t + 12E*t^2 + 20F*t^3
+  // Evaluate (in Horner form):
+  //   S(t) = A + t*(B + t*(C + t*(D + t*(E + t*F))))
+  //   S_prime(t) = B + t*(2C + t*(3D + t*(4E + t*5F)))
+  //   S_bis(t) = 2C + t*(6D + t*(12E + t*20F))
   //
   // Condition: 0 <= t <= T
+  //
+  // Note: The degree is a compile-time constant, so the switch is
+  //       resolved by the compiler, and the terms above the degree
+  //       are never computed. The loop has no dependencies between
+  //       iterations, which allows the compiler to vectorize it.
   //---------------------------------------------------------------
-  switch (axis)
+  for (size_t i = 0; i < MAX_NUMBER_OF_SPLINES; ++i)
   {
-    case X:
+    switch (DEGREE)
     {
-      p_output->mutable_pose()->mutable_position()->set_x(calculatePosition(t));
-      p_output->mutable_velocity()->set_x(calculateVelocity(t));
-      p_output->mutable_acceleration()->set_x(calculateAcceleration(t));
+      case 1:
+      {
+        p_positions[i] = a_[i] + t*b_[i];
+        p_velocities[i] = b_[i];
+        p_accelerations[i] = 0.0;
+      }
+      break;
+
+      case 2:
+      {
+        p_positions[i] = a_[i] + t*(b_[i] + t*c_[i]);
+        p_velocities[i] = b_[i] + t*(2.0*c_[i]);
+        p_accelerations[i] = 2.0*c_[i];
+      }
+      break;
+
+      case 3:
+      {
+        p_positions[i] = a_[i] + t*(b_[i] + t*(c_[i] + t*d_[i]));
+        p_velocities[i] = b_[i] + t*(2.0*c_[i] + t*(3.0*d_[i]));
+        p_accelerations[i] = 2.0*c_[i] + t*(6.0*d_[i]);
+      }
+      break;
+
+      default:
+      {
+        p_positions[i] = a_[i] + t*(b_[i] + t*(c_[i] + t*(d_[i] + t*(e_[i] + t*f_[i]))));
+        p_velocities[i] = b_[i] + t*(2.0*c_[i] + t*(3.0*d_[i] + t*(4.0*e_[i] + t*5.0*f_[i])));
+        p_accelerations[i] = 2.0*c_[i] + t*(6.0*d_[i] + t*(12.0*e_[i] + t*20.0*f_[i]));
+      }
+      break;
     }
-    break;
+  }
+}
+
+int EGMInterpolator::SplineBlock::findRoots(double* p_roots,
+                                            const double c0,
+                                            const double c1,
+                                            const double c2,
+                                            const double duration)
+{
+  int number_of_roots = 0;
+  double roots[2];
+
+  if (c2 != 0.0)
+  {
+    const double discriminant = c1*c1 - 4.0*c0*c2;
 
-    case Y:
+    if (discriminant >= 0.0)
     {
-      p_output->mutable_pose()->mutable_position()->set_y(calculatePosition(t));
-      p_output->mutable_velocity()->set_y(calculateVelocity(t));
-      p_output->mutable_acceleration()->set_y(calculateAcceleration(t));
+      const double sqrt_discriminant = std::sqrt(discriminant);
+      roots[0] = (-c1 - sqrt_discriminant) / (2.0*c2);
+      roots[1] = (-c1 + sqrt_discriminant) / (2.0*c2);
+
+      if (roots[0] > roots[1])
+      {
+        std::swap(roots[0], roots[1]);
+      }
+
+      number_of_roots = 2;
     }
-    break;
+  }
+  else if (c1 != 0.0)
+  {
+    roots[0] = -c0 / c1;
+    number_of_roots = 1;
+  }
+
+  // Only keep the roots within the interval.
+  int result = 0;
 
-    case Z:
+  for (int i = 0; i < number_of_roots; ++i)
+  {
+    if (roots[i] > 0.0 && roots[i] < duration)
     {
-      p_output->mutable_pose()->mutable_position()->set_z(calculatePosition(t));
-      p_output->mutable_velocity()->set_z(calculateVelocity(t));
-      p_output->mutable_acceleration()->set_z(calculateAcceleration(t));
+      p_roots[result++] = roots[i];
     }
-    break;
   }
+
+  return result;
 }
 
 
@@ -351,14 +625,15 @@ void EGMInterpolator::Slerp::update(const wrapper::Quaternion& start,
                                     const Conditions& conditions)
 {
   duration_ = conditions.duration;
+  inverse_duration_ = 1.0 / duration_;
 
-  q0_.CopyFrom(start);
-  q1_.CopyFrom(goal);
+  copy(&q0_, start);
+  copy(&q1_, goal);
 
-  normalize(&q0_);
-  normalize(&q1_);
+  q0_ = math::normalize(q0_);
+  q1_ = math::normalize(q1_);
 
-  double dot_product = dotProduct(q0_, q1_);
+  double dot_product = math::dotProduct(q0_, q1_);
 
   // Check if Slerp or linear interpolation should be used.
   use_linear_ = std::abs(dot_product) > DOT_PRODUCT_THRESHOLD;
@@ -369,15 +644,16 @@ void EGMInterpolator::Slerp::update(const wrapper::Quaternion& start,
     // This is to make the Slerp to take the shorter path.
     if (dot_product < 0.0)
     {
-      multiply(&q1_, -1.0);
+      q1_ = math::multiply(q1_, -1.0);
       dot_product = -dot_product;
     }
 
     // Saturate the dot product to be within acos input range.
     dot_product = saturate(dot_product, -1.0, 1.0);
 
-    // Calculate the coefficient.
+    // Calculate the coefficients.
     omega_ = std::acos(dot_product);
+    k_ = 1.0 / std::sin(omega_);
   }
 }
 
@@ -388,15 +664,9 @@ void EGMInterpolator::Slerp::evaluate(wrapper::trajectory::CartesianGoal* p_outp
   double b = 0.0;
   double c = 1.0;
   double d = 0.0;
-  double k = 1.0 / std::sin(omega_);
-
-  // Quaternion and angular velocity output to set.
-  // Note: The Euler field is internally used to contain angular velocities.
-  wrapper::Quaternion* p_q = p_output->mutable_pose()->mutable_quaternion();
-  wrapper::Euler* p_av = p_output->mutable_pose()->mutable_euler();
 
   // Saturate t to be within 0.0 and 1.0.
-  t = saturate(t / duration_, 0.0, 1.0);
+  t = saturate(t*inverse_duration_, 0.0, 1.0);
 
   if (use_linear_)
   {
@@ -409,38 +679,29 @@ void EGMInterpolator::Slerp::evaluate(wrapper::trajectory::CartesianGoal* p_outp
   else
   {
     // Calculate quaternion and angular velocity with Slerp interpolation.
-    a = k*std::sin((1.0 - t)*omega_);
-    b = k*std::sin(t*omega_);
-    c = -omega_*k*std::cos((1.0 - t)*omega_) / duration_;
-    d = omega_*k*std::cos(t*omega_) / duration_;
+    a = k_*std::sin((1.0 - t)*omega_);
+    b = k_*std::sin(t*omega_);
+    c = -omega_*k_*std::cos((1.0 - t)*omega_)*inverse_duration_;
+    d = omega_*k_*std::cos(t*omega_)*inverse_duration_;
   }
 
   // Calculate the quaternion output.
-  p_q->set_u0(a*q0_.u0() + b*q1_.u0());
-  p_q->set_u1(a*q0_.u1() + b*q1_.u1());
-  p_q->set_u2(a*q0_.u2() + b*q1_.u2());
-  p_q->set_u3(a*q0_.u3() + b*q1_.u3());
-  normalize(p_q);
-
-  // Conjugate of the normalized quaternion output.
-  wrapper::Quaternion conj_q;
-  conj_q.set_u0(p_q->u0());
-  conj_q.set_u1(-p_q->u1());
-  conj_q.set_u2(-p_q->u2());
-  conj_q.set_u3(-p_q->u3());
+  math::Quaternion q = {a*q0_.u0 + b*q1_.u0, a*q0_.u1 + b*q1_.u1, a*q0_.u2 + b*q1_.u2, a*q0_.u3 + b*q1_.u3};
+  q = math::normalize(q);
 
   // Derivate of either linear or Slerp interpolation.
-  wrapper::Quaternion d_q;
-  d_q.set_u0(c*q0_.u0() + d*q1_.u0());
-  d_q.set_u1(c*q0_.u1() + d*q1_.u1());
-  d_q.set_u2(c*q0_.u2() + d*q1_.u2());
-  d_q.set_u3(c*q0_.u3() + d*q1_.u3());
-
-  // Calculate the angular velocity output.
-  wrapper::Quaternion mult_q(multiply(d_q, conj_q));
-  p_av->set_x(2.0*mult_q.u1()*Constants::Conversion::RAD_TO_DEG);
-  p_av->set_y(2.0*mult_q.u2()*Constants::Conversion::RAD_TO_DEG);
-  p_av->set_z(2.0*mult_q.u3()*Constants::Conversion::RAD_TO_DEG);
+  const math::Quaternion d_q = {c*q0_.u0 + d*q1_.u0, c*q0_.u1 + d*q1_.u1, c*q0_.u2 + d*q1_.u2, c*q0_.u3 + d*q1_.u3};
+
+  // Calculate the angular velocity output (with the conjugate of the normalized quaternion output).
+  const math::Quaternion mult_q = math::multiply(d_q, math::conjugate(q));
+  const math::Vector3 av = {2.0*mult_q.u1*Constants::Conversion::RAD_TO_DEG,
+                            2.0*mult_q.u2*Constants::Conversion::RAD_TO_DEG,
+                            2.0*mult_q.u3*Constants::Conversion::RAD_TO_DEG};
+
+  // Set the quaternion and angular velocity outputs.
+  // Note: The Euler field is internally used to contain angular velocities.
+  copy(p_output->mutable_pose()->mutable_quaternion(), q);
+  copy(p_output->mutable_pose()->mutable_euler(), av);
 }
 
 
@@ -466,7 +727,7 @@ void EGMInterpolator::SoftRamp::update(const wrapper::trajectory::PointGoal& sta
     case RampDown:
     {
       // Note: The Euler field is internally used to contain angular velocities.
-      start_angular_velocity_.CopyFrom(start.robot().cartesian().pose().euler());
+      copy(&start_angular_velocity_, start.robot().cartesian().pose().euler());
     }
     break;
 
@@ -557,7 +818,10 @@ void EGMInterpolator::SoftRamp::evaluate(wrapper::trajectory::CartesianGoal* p_o
 {
   double ramp_factor = 0.0;
   double d_ramp_factor = 0.0;
-  wrapper::Quaternion previous_q(p_output->mutable_pose()->quaternion());
+
+  // Note: p_output contain the previously calculated quaternion.
+  math::Quaternion previous_q;
+  copy(&previous_q, p_output->pose().quaternion());
 
   // Saturate t to be within 0.0 and 1.0.
   t = saturate(t / duration_, 0.0, 1.0);
@@ -566,39 +830,34 @@ void EGMInterpolator::SoftRamp::evaluate(wrapper::trajectory::CartesianGoal* p_o
   {
     case RampDown:
     {
-      // Output to set. Note: The Euler field is internally used to contain angular velocities.
-      wrapper::Quaternion* p_q = p_output->mutable_pose()->mutable_quaternion();
-      wrapper::Euler* p_av = p_output->mutable_pose()->mutable_euler();
-
       // Ramp factor that goes from 1.0 to 0.0.
       ramp_factor = 0.5*std::cos(M_PI*t) + 0.5;
 
       // Calculate the angular velocity output.
-      p_av->set_x(ramp_factor*start_angular_velocity_.x());
-      p_av->set_y(ramp_factor*start_angular_velocity_.y());
-      p_av->set_z(ramp_factor*start_angular_velocity_.z());
-
-      // Calculate the quaternion derivate. Note: p_output contain the previously calculated quaternion.
-      wrapper::Quaternion d_q;
-      convert(&d_q, p_output->mutable_pose()->quaternion(), *p_av);
-
-      // Calculate the quaternion output.
-      p_q->set_u0(p_q->u0() + sample_time*d_q.u0());
-      p_q->set_u1(p_q->u1() + sample_time*d_q.u1());
-      p_q->set_u2(p_q->u2() + sample_time*d_q.u2());
-      p_q->set_u3(p_q->u3() + sample_time*d_q.u3());
-      normalize(p_q);
+      const math::Vector3 av = {ramp_factor*start_angular_velocity_.x,
+                                ramp_factor*start_angular_velocity_.y,
+                                ramp_factor*start_angular_velocity_.z};
+
+      // Calculate the quaternion derivate, and then the quaternion output.
+      const math::Quaternion d_q = math::derivate(previous_q, av);
+      math::Quaternion q = {previous_q.u0 + sample_time*d_q.u0,
+                            previous_q.u1 + sample_time*d_q.u1,
+                            previous_q.u2 + sample_time*d_q.u2,
+                            previous_q.u3 + sample_time*d_q.u3};
+      q = math::normalize(q);
+
+      // Set the outputs. Note: The Euler field is internally used to contain angular velocities.
+      copy(p_output->mutable_pose()->mutable_quaternion(), q);
+      copy(p_output->mutable_pose()->mutable_euler(), av);
     }
     break;
 
     case RampInPosition:
     {
-      // Output to set. Note: The Euler field is internally used to contain angular velocities.
+      // Output to set.
       wrapper::Cartesian* p_p = p_output->mutable_pose()->mutable_position();
       wrapper::Cartesian* p_v = p_output->mutable_velocity();
       wrapper::Cartesian* p_a = p_output->mutable_acceleration();
-      wrapper::Quaternion* p_q = p_output->mutable_pose()->mutable_quaternion();
-      wrapper::Euler* p_av = p_output->mutable_pose()->mutable_euler();
 
       // Ramp factor that goes from 0.0 to 1.0 and its derivate.
       ramp_factor = 0.5*std::cos(M_PI*t + M_PI) + 0.5;
@@ -618,28 +877,29 @@ void EGMInterpolator::SoftRamp::evaluate(wrapper::trajectory::CartesianGoal* p_o
       p_a->set_y(0.0);
       p_a->set_z(0.0);
 
-      const wrapper::Quaternion& start_q = start_.robot().cartesian().pose().quaternion();
-      const wrapper::Quaternion& goal_q = goal_.robot().cartesian().pose().quaternion();
+      math::Quaternion start_q;
+      math::Quaternion goal_q;
+      copy(&start_q, start_.robot().cartesian().pose().quaternion());
+      copy(&goal_q, goal_.robot().cartesian().pose().quaternion());
 
       // Calculate the quaternion and angular velocity outputs.
-      p_q->set_u0(start_q.u0() + ramp_factor*(goal_q.u0() - start_q.u0()));
-      p_q->set_u1(start_q.u1() + ramp_factor*(goal_q.u1() - start_q.u1()));
-      p_q->set_u2(start_q.u2() + ramp_factor*(goal_q.u2() - start_q.u2()));
-      p_q->set_u3(start_q.u3() + ramp_factor*(goal_q.u3() - start_q.u3()));
-
-      normalize(p_q);
+      math::Quaternion q = {start_q.u0 + ramp_factor*(goal_q.u0 - start_q.u0),
+                            start_q.u1 + ramp_factor*(goal_q.u1 - start_q.u1),
+                            start_q.u2 + ramp_factor*(goal_q.u2 - start_q.u2),
+                            start_q.u3 + ramp_factor*(goal_q.u3 - start_q.u3)};
+      q = math::normalize(q);
 
-      estimateVelocities(p_av, *p_q, previous_q, sample_time);
+      // Note: The Euler field is internally used to contain angular velocities.
+      copy(p_output->mutable_pose()->mutable_quaternion(), q);
+      copy(p_output->mutable_pose()->mutable_euler(), math::estimateAngularVelocity(q, previous_q, sample_time));
     }
 
     case RampInVelocity:
     {
-      // Output to set. Note: The Euler field is internally used to contain angular velocities.
+      // Output to set.
       wrapper::Cartesian* p_p = p_output->mutable_pose()->mutable_position();
       wrapper::Cartesian* p_v = p_output->mutable_velocity();
       wrapper::Cartesian* p_a = p_output->mutable_acceleration();
-      wrapper::Quaternion* p_q = p_output->mutable_pose()->mutable_quaternion();
-      wrapper::Euler* p_av = p_output->mutable_pose()->mutable_euler();
 
       // Ramp factor that goes from 0.0 to 1.0.
       ramp_factor = 0.5*std::cos(M_PI*t + M_PI) + 0.5;
@@ -659,22 +919,29 @@ void EGMInterpolator::SoftRamp::evaluate(wrapper::trajectory::CartesianGoal* p_o
       p_p->set_z(p_p->z() + sample_time*p_v->z());
 
       // Note: The Euler field is internally used to contain angular velocities.
-      const wrapper::Euler& start_av = start_.robot().cartesian().pose().euler();
-      const wrapper::Euler& goal_av = goal_.robot().cartesian().pose().euler();
+      math::Vector3 start_av;
+      math::Vector3 goal_av;
+      copy(&start_av, start_.robot().cartesian().pose().euler());
+      copy(&goal_av, goal_.robot().cartesian().pose().euler());
 
       // Calculate the quaternion and angular velocity outputs.
-      p_av->set_x(start_av.x() + ramp_factor*(goal_av.x() - start_av.x()));
-      p_av->set_y(start_av.y() + ramp_factor*(goal_av.y() - start_av.y()));
-      p_av->set_z(start_av.z() + ramp_factor*(goal_av.z() - start_av.z()));
-
-      wrapper::Quaternion d_q;
-      convert(&d_q, previous_q, *p_av);
-
-      p_q->set_u0(p_q->u0() + sample_time*d_q.u0());
-      p_q->set_u1(p_q->u1() + sample_time*d_q.u1());
-      p_q->set_u2(p_q->u2() + sample_time*d_q.u2());
-      p_q->set_u3(p_q->u3() + sample_time*d_q.u3());
-      normalize(p_q);
+      const math::Vector3 av = {start_av.x + ramp_factor*(goal_av.x - start_av.x),
+                                start_av.y + ramp_factor*(goal_av.y - start_av.y),
+                                start_av.z + ramp_factor*(goal_av.z - start_av.z)};
+
+      // Note: The quaternion output (possibly just set above) is integrated.
+      math::Quaternion q;
+      copy(&q, p_output->pose().quaternion());
+
+      const math::Quaternion d_q = math::derivate(previous_q, av);
+      q.u0 += sample_time*d_q.u0;
+      q.u1 += sample_time*d_q.u1;
+      q.u2 += sample_time*d_q.u2;
+      q.u3 += sample_time*d_q.u3;
+      q = math::normalize(q);
+
+      copy(p_output->mutable_pose()->mutable_quaternion(), q);
+      copy(p_output->mutable_pose()->mutable_euler(), av);
     }
     break;
   }
@@ -691,37 +958,60 @@ void EGMInterpolator::SoftRamp::evaluate(wrapper::trajectory::CartesianGoal* p_o
  * Primary methods
  */
 
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const size_t EGMInterpolator::MAX_NUMBER_OF_SPLINES;
+
 void EGMInterpolator::update(const wrapper::trajectory::PointGoal& start,
                              const wrapper::trajectory::PointGoal& goal,
                              const Conditions& conditions)
+{
+  update(start, goal, conditions, Timing());
+}
+
+void EGMInterpolator::update(const wrapper::trajectory::PointGoal& start,
+                             const wrapper::trajectory::PointGoal& goal,
+                             const Conditions& conditions,
+                             const Timing& timing)
 {
   conditions_ = conditions;
   conditions_.duration = std::max(Constants::RobotController::LOWEST_SAMPLE_TIME, conditions_.duration);
 
+  // Only compute the duration dependent values, if the precomputed values are not valid for the duration.
+  Timing computed_timing;
+  const Timing* p_timing = &timing;
+
+  if (timing.duration != conditions_.duration)
+  {
+    computed_timing = Timing(conditions_.duration);
+    p_timing = &computed_timing;
+  }
+
   switch (conditions_.operation)
   {
     case Normal:
     case RampDown:
     {
       offset_ = start.robot().joints().position().values_size();
-      SplineConditions spline_conditions(conditions_);
+      const int number_of_splines = static_cast<int>(MAX_NUMBER_OF_SPLINES);
+      SplineConditions spline_conditions(conditions_, *p_timing);
+      spline_block_.selectEvaluation(spline_conditions);
 
       switch (conditions_.mode)
       {
         case EGMJoint:
         {
           // Robot joints.
-          for (int i = 0; i < start.robot().joints().position().values_size() && i < spline_polynomials_.size(); ++i)
+          for (int i = 0; i < start.robot().joints().position().values_size() && i < number_of_splines; ++i)
           {
             spline_conditions.setConditions(i, start.robot().joints(), goal.robot().joints());
-            spline_polynomials_[i].update(spline_conditions);
+            spline_block_.update(i, spline_conditions);
           }
 
           // External joints.
-          for (int i = 0; i < start.external().joints().position().values_size() && i < spline_polynomials_.size(); ++i)
+          for (int i = 0; i < start.external().joints().position().values_size() && i < number_of_splines; ++i)
           {
             spline_conditions.setConditions(i, start.external().joints(), goal.external().joints());
-            spline_polynomials_[i + offset_].update(spline_conditions);
+            spline_block_.update(i + offset_, spline_conditions);
           }
         }
         break;
@@ -730,11 +1020,11 @@ void EGMInterpolator::update(const wrapper::trajectory::PointGoal& start,
         {
           // X, Y and Z.
           spline_conditions.setConditions(X, start.robot().cartesian(), goal.robot().cartesian());
-          spline_polynomials_[X].update(spline_conditions);
+          spline_block_.update(X, spline_conditions);
           spline_conditions.setConditions(Y, start.robot().cartesian(), goal.robot().cartesian());
-          spline_polynomials_[Y].update(spline_conditions);
+          spline_block_.update(Y, spline_conditions);
           spline_conditions.setConditions(Z, start.robot().cartesian(), goal.robot().cartesian());
-          spline_polynomials_[Z].update(spline_conditions);
+          spline_block_.update(Z, spline_conditions);
 
           // Orientation.
           if (conditions_.operation == Normal)
@@ -748,10 +1038,10 @@ void EGMInterpolator::update(const wrapper::trajectory::PointGoal& start,
           }
 
           // External joints.
-          for (int i = 0; i < start.external().joints().position().values_size() && i < spline_polynomials_.size(); ++i)
+          for (int i = 0; i < start.external().joints().position().values_size() && i < number_of_splines; ++i)
           {
             spline_conditions.setConditions(i, start.external().joints(), goal.external().joints());
-            spline_polynomials_[i + offset_].update(spline_conditions);
+            spline_block_.update(i + offset_, spline_conditions);
           }
         }
         break;
@@ -777,32 +1067,38 @@ void EGMInterpolator::evaluate(wrapper::trajectory::PointGoal* p_output, const d
     case Normal:
     case RampDown:
     {
+      // Evaluate all spline polynomials in one pass, and then convert the results into the output.
+      double positions[MAX_NUMBER_OF_SPLINES];
+      double velocities[MAX_NUMBER_OF_SPLINES];
+      double accelerations[MAX_NUMBER_OF_SPLINES];
+      spline_block_.evaluate(positions, velocities, accelerations, t);
+
       switch (conditions_.mode)
       {
         case EGMJoint:
         {
           // Robot joints.
-          for (int i = 0;
-               i < p_output->robot().joints().position().values_size() && i < spline_polynomials_.size(); ++i)
-          {
-            spline_polynomials_[i].evaluate(p_output->mutable_robot()->mutable_joints(), i, t);
-          }
+          copySplineValues(p_output->mutable_robot()->mutable_joints(), 0, positions, velocities, accelerations);
 
           // External joints.
-          for (int i = 0;
-               i < p_output->external().joints().position().values_size() && i < spline_polynomials_.size(); ++i)
-          {
-            spline_polynomials_[i + offset_].evaluate(p_output->mutable_external()->mutable_joints(), i, t);
-          }
+          copySplineValues(p_output->mutable_external()->mutable_joints(),
+                           offset_, positions, velocities, accelerations);
         }
         break;
 
         case EGMPose:
         {
           // X, Y and Z.
-          spline_polynomials_[X].evaluate(p_output->mutable_robot()->mutable_cartesian(), X, t);
-          spline_polynomials_[Y].evaluate(p_output->mutable_robot()->mutable_cartesian(), Y, t);
-          spline_polynomials_[Z].evaluate(p_output->mutable_robot()->mutable_cartesian(), Z, t);
+          wrapper::trajectory::CartesianGoal* p_cartesian = p_output->mutable_robot()->mutable_cartesian();
+          p_cartesian->mutable_pose()->mutable_position()->set_x(positions[X]);
+          p_cartesian->mutable_pose()->mutable_position()->set_y(positions[Y]);
+          p_cartesian->mutable_pose()->mutable_position()->set_z(positions[Z]);
+          p_cartesian->mutable_velocity()->set_x(velocities[X]);
+          p_cartesian->mutable_velocity()->set_y(velocities[Y]);
+          p_cartesian->mutable_velocity()->set_z(velocities[Z]);
+          p_cartesian->mutable_acceleration()->set_x(accelerations[X]);
+          p_cartesian->mutable_acceleration()->set_y(accelerations[Y]);
+          p_cartesian->mutable_acceleration()->set_z(accelerations[Z]);
 
           // Orientation.
           if (conditions_.operation == Normal)
@@ -815,11 +1111,8 @@ void EGMInterpolator::evaluate(wrapper::trajectory::PointGoal* p_output, const d
           }
 
           // External joints.
-          for (int i = 0;
-               i < p_output->external().joints().position().values_size() && i < spline_polynomials_.size(); ++i)
-          {
-            spline_polynomials_[i + offset_].evaluate(p_output->mutable_external()->mutable_joints(), i, t);
-          }
+          copySplineValues(p_output->mutable_external()->mutable_joints(),
+                           offset_, positions, velocities, accelerations);
         }
         break;
       }
@@ -856,5 +1149,49 @@ void EGMInterpolator::evaluate(wrapper::trajectory::PointGoal* p_output, const d
   }
 }
 
+void EGMInterpolator::evaluateSplines(double* p_positions,
+                                      double* p_velocities,
+                                      double* p_accelerations,
+                                      double t) const
+{
+  t = saturate(t, 0.0, conditions_.duration);
+
+  spline_block_.evaluate(p_positions, p_velocities, p_accelerations, t);
+}
+
+void EGMInterpolator::evaluateSplineExtremes(double* p_velocities, double* p_accelerations, double* p_jerks) const
+{
+  spline_block_.evaluateExtremes(p_velocities, p_accelerations, p_jerks, conditions_.duration);
+}
+
+
+
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+void EGMInterpolator::copySplineValues(wrapper::trajectory::JointGoal* p_output,
+                                       const int offset,
+                                       const double* positions,
+                                       const double* velocities,
+                                       const double* accelerations)
+{
+  // Write directly into the (already sized) repeated fields, instead of using one setter call per value.
+  const int size = std::min(std::min(p_output->position().values_size(), p_output->velocity().values_size()),
+                            std::min(p_output->acceleration().values_size(),
+                                     static_cast<int>(MAX_NUMBER_OF_SPLINES) - offset));
+  double* p_position = p_output->mutable_position()->mutable_values()->mutable_data();
+  double* p_velocity = p_output->mutable_velocity()->mutable_values()->mutable_data();
+  double* p_acceleration = p_output->mutable_acceleration()->mutable_values()->mutable_data();
+
+  for (int i = 0; i < size; ++i)
+  {
+    p_position[i] = positions[i + offset];
+    p_velocity[i] = velocities[i + offset];
+    p_acceleration[i] = accelerations[i + offset];
+  }
+}
+
 } // end namespace egm
 } // end namespace abb
@@ -34,8 +34,11 @@
  ***********************************************************************************************************************
  */
 
+#include <cstring>
 #include <sstream>
 
+#include <boost/bind/bind.hpp>
+
 #include "abb_libegm/egm_common.h"
 #include "abb_libegm/egm_logger.h"
 
@@ -43,6 +46,173 @@ namespace abb
 {
 namespace egm
 {
+/***********************************************************************************************************************
+ * Struct definitions: EGMLogRecord
+ */
+
+/**
+ * \brief Copy joint data (i.e. robot and external joints) into a record's joint block.
+ *
+ * \param p_values for the joint block to copy into.
+ * \param robot containing the robot joint data.
+ * \param external containing the external joint data.
+ */
+static void copyJoints(double* p_values, const wrapper::Joints& robot, const wrapper::Joints& external)
+{
+  size_t index = 0;
+
+  for (int i = 0; i < robot.values_size() && index < EGMLogRecord::NUMBER_OF_JOINT_VALUES; ++i)
+  {
+    p_values[index++] = robot.values(i);
+  }
+
+  // Add mock values for the missing robot joint data.
+  for (; index < (size_t) Constants::RobotController::DEFAULT_NUMBER_OF_ROBOT_JOINTS; ++index)
+  {
+    p_values[index] = 0.0;
+  }
+
+  for (int i = 0; i < external.values_size() && index < EGMLogRecord::NUMBER_OF_JOINT_VALUES; ++i)
+  {
+    p_values[index++] = external.values(i);
+  }
+
+  // Add mock values for the missing external joint data.
+  for (; index < EGMLogRecord::NUMBER_OF_JOINT_VALUES; ++index)
+  {
+    p_values[index] = 0.0;
+  }
+}
+
+/**
+ * \brief Copy Cartesian pose and velocity data into a record.
+ *
+ * \param p_values for the record values to copy into.
+ * \param pose containing the pose data.
+ * \param velocity containing the velocity data.
+ */
+static void copyCartesian(double* p_values,
+                          const wrapper::CartesianPose& pose,
+                          const wrapper::CartesianVelocity& velocity)
+{
+  p_values[0] = pose.position().x();
+  p_values[1] = pose.position().y();
+  p_values[2] = pose.position().z();
+
+  p_values[3] = pose.euler().x();
+  p_values[4] = pose.euler().y();
+  p_values[5] = pose.euler().z();
+
+  p_values[6] = pose.quaternion().u0();
+  p_values[7] = pose.quaternion().u1();
+  p_values[8] = pose.quaternion().u2();
+  p_values[9] = pose.quaternion().u3();
+
+  p_values[10] = velocity.linear().x();
+  p_values[11] = velocity.linear().y();
+  p_values[12] = velocity.linear().z();
+
+  p_values[13] = velocity.angular().x();
+  p_values[14] = velocity.angular().y();
+  p_values[15] = velocity.angular().z();
+}
+
+/**
+ * \brief Copy robot and external data into a record's section.
+ *
+ * \param p_values for the section to copy into.
+ * \param robot containing the robot data.
+ * \param external containing the external data.
+ */
+static void copySection(double* p_values, const wrapper::Robot& robot, const wrapper::External& external)
+{
+  copyJoints(p_values, robot.joints().position(), external.joints().position());
+  copyJoints(p_values + EGMLogRecord::NUMBER_OF_JOINT_VALUES, robot.joints().velocity(), external.joints().velocity());
+  copyCartesian(p_values + 2*EGMLogRecord::NUMBER_OF_JOINT_VALUES,
+                robot.cartesian().pose(),
+                robot.cartesian().velocity());
+}
+
+/**
+ * \brief Encode an unsigned integer in little-endian byte order.
+ *
+ * \param p_bytes for containing the encoded bytes.
+ * \param value to encode.
+ * \param size specifying the number of bytes to encode.
+ *
+ * \return char* pointing to the byte after the encoded bytes.
+ */
+static char* encodeLittleEndian(char* p_bytes, const boost::uint64_t value, const size_t size)
+{
+  for (size_t i = 0; i < size; ++i)
+  {
+    p_bytes[i] = (char) ((value >> (8*i)) & 0xFF);
+  }
+
+  return p_bytes + size;
+}
+
+/**
+ * \brief Decode an unsigned integer in little-endian byte order.
+ *
+ * \param p_bytes containing the encoded bytes.
+ * \param p_value for containing the decoded value.
+ * \param size specifying the number of bytes to decode.
+ *
+ * \return const char* pointing to the byte after the decoded bytes.
+ */
+static const char* decodeLittleEndian(const char* p_bytes, boost::uint64_t* p_value, const size_t size)
+{
+  *p_value = 0;
+
+  for (size_t i = 0; i < size; ++i)
+  {
+    *p_value |= ((boost::uint64_t) (unsigned char) p_bytes[i]) << (8*i);
+  }
+
+  return p_bytes + size;
+}
+
+void EGMLogRecord::set(const wrapper::Input& inputs, const wrapper::Output& outputs)
+{
+  const wrapper::Feedback& feedback = inputs.feedback();
+  const wrapper::Planned& planned = inputs.planned();
+
+  time_stamp = inputs.header().time_stamp();
+  copySection(values, feedback.robot(), feedback.external());
+  copySection(values + SECTION_SIZE, planned.robot(), planned.external());
+  copySection(values + 2*SECTION_SIZE, outputs.robot(), outputs.external());
+}
+
+void EGMLogRecord::serialize(char* p_bytes) const
+{
+  p_bytes = encodeLittleEndian(p_bytes, time_stamp, 4);
+
+  for (size_t i = 0; i < NUMBER_OF_VALUES; ++i)
+  {
+    boost::uint64_t bits = 0;
+    std::memcpy(&bits, &values[i], sizeof(double));
+    p_bytes = encodeLittleEndian(p_bytes, bits, 8);
+  }
+}
+
+void EGMLogRecord::parse(const char* p_bytes)
+{
+  boost::uint64_t bits = 0;
+
+  p_bytes = decodeLittleEndian(p_bytes, &bits, 4);
+  time_stamp = (boost::uint32_t) bits;
+
+  for (size_t i = 0; i < NUMBER_OF_VALUES; ++i)
+  {
+    p_bytes = decodeLittleEndian(p_bytes, &bits, 8);
+    std::memcpy(&values[i], &bits, sizeof(double));
+  }
+}
+
+
+
+
 /***********************************************************************************************************************
  * Class definitions: EGMLogger
  */
@@ -158,6 +328,18 @@ void EGMLogger::add(const wrapper::CartesianVelocity& velocity, const bool last)
               << velocity.angular().z() << (last ? "" : ",");
 }
 
+void EGMLogger::add(const EGMLogRecord& record)
+{
+  log_stream_ << record.time_stamp;
+
+  for (size_t i = 0; i < EGMLogRecord::NUMBER_OF_VALUES; ++i)
+  {
+    log_stream_ << "," << record.values[i];
+  }
+
+  flush();
+}
+
 /************************************************************
  * Auxiliary methods
  */
@@ -189,5 +371,178 @@ double EGMLogger::calculateTimeLogged(const double sample_time)
   return (double)number_of_logged_messages_*sample_time;
 }
 
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: EGMAsyncLogger
+ */
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const size_t EGMAsyncLogger::DEFAULT_CAPACITY;
+const size_t EGMAsyncLogger::BATCH_SIZE;
+const unsigned int EGMAsyncLogger::IDLE_WAIT_TIME_MS;
+const char EGMAsyncLogger::MAGIC[8] = {'E', 'G', 'M', 'L', 'O', 'G', '0', '1'};
+
+/************************************************************
+ * Primary methods
+ */
+
+EGMAsyncLogger::EGMAsyncLogger(const std::string& filename, const size_t capacity)
+:
+number_of_logged_messages_(0),
+number_of_dropped_records_(0),
+stop_requested_(false),
+write_failed_(false),
+ring_buffer_(capacity)
+{
+  log_stream_.open(filename.c_str(), std::ios::trunc | std::ios::binary);
+
+  // Without a log file, the writer is never started (and all records are dropped).
+  if (!log_stream_.is_open())
+  {
+    write_failed_ = true;
+    return;
+  }
+
+  char header[FileHeader::SERIALIZED_SIZE];
+  std::memcpy(header, MAGIC, sizeof(MAGIC));
+  char* p_bytes = encodeLittleEndian(header + sizeof(MAGIC), EGMLogRecord::SERIALIZED_SIZE, 4);
+  encodeLittleEndian(p_bytes, EGMLogRecord::NUMBER_OF_VALUES, 4);
+
+  log_stream_.write(header, sizeof(header));
+  log_stream_.flush();
+
+  writer_thread_ = boost::thread(&EGMAsyncLogger::writerThread, this);
+}
+
+EGMAsyncLogger::~EGMAsyncLogger()
+{
+  stop_requested_ = true;
+
+  if (writer_thread_.joinable())
+  {
+    writer_thread_.join();
+  }
+
+  log_stream_.close();
+}
+
+bool EGMAsyncLogger::isOpen() const
+{
+  return !write_failed_;
+}
+
+bool EGMAsyncLogger::add(const wrapper::Input& inputs, const wrapper::Output& outputs)
+{
+  // Count the record as logged regardless, so that the logged duration follows the session's duration.
+  ++number_of_logged_messages_;
+
+  EGMLogRecord* p_record = (write_failed_ ? 0 : ring_buffer_.writeSlot());
+
+  if (!p_record)
+  {
+    ++number_of_dropped_records_;
+    return false;
+  }
+
+  p_record->set(inputs, outputs);
+  ring_buffer_.publish();
+
+  return true;
+}
+
+bool EGMAsyncLogger::convertToCSV(const std::string& binary_filename, const std::string& csv_filename)
+{
+  std::ifstream binary_stream(binary_filename.c_str(), std::ios::binary);
+
+  if (!binary_stream.is_open())
+  {
+    return false;
+  }
+
+  char bytes[EGMLogRecord::SERIALIZED_SIZE];
+  FileHeader header;
+  boost::uint64_t value = 0;
+
+  if (!binary_stream.read(bytes, FileHeader::SERIALIZED_SIZE))
+  {
+    return false;
+  }
+
+  std::memcpy(header.magic, bytes, sizeof(MAGIC));
+  const char* p_bytes = decodeLittleEndian(bytes + sizeof(MAGIC), &value, 4);
+  header.record_size = (boost::uint32_t) value;
+  decodeLittleEndian(p_bytes, &value, 4);
+  header.number_of_values = (boost::uint32_t) value;
+
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header.record_size != EGMLogRecord::SERIALIZED_SIZE ||
+      header.number_of_values != EGMLogRecord::NUMBER_OF_VALUES)
+  {
+    return false;
+  }
+
+  EGMLogger csv_logger(csv_filename);
+  EGMLogRecord record;
+
+  while (binary_stream.read(bytes, EGMLogRecord::SERIALIZED_SIZE))
+  {
+    record.parse(bytes);
+    csv_logger.add(record);
+  }
+
+  return true;
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+void EGMAsyncLogger::writerThread()
+{
+  consumeRingBuffer(&ring_buffer_,
+                    stop_requested_,
+                    BATCH_SIZE,
+                    IDLE_WAIT_TIME_MS,
+                    boost::bind(&EGMAsyncLogger::writeRecord, this, boost::placeholders::_1),
+                    boost::bind(&EGMAsyncLogger::flushLog, this));
+}
+
+void EGMAsyncLogger::writeRecord(const EGMLogRecord& record)
+{
+  if (write_failed_)
+  {
+    ++number_of_dropped_records_;
+    return;
+  }
+
+  // Note: The record is serialized explicitly, so that the file doesn't depend on the platform's padding or byte order.
+  char bytes[EGMLogRecord::SERIALIZED_SIZE];
+  record.serialize(bytes);
+  log_stream_.write(bytes, sizeof(bytes));
+
+  // Stop writing (and drop the remaining records) if writing to the log file has failed, e.g. if the disk is full.
+  if (!log_stream_)
+  {
+    write_failed_ = true;
+  }
+}
+
+void EGMAsyncLogger::flushLog()
+{
+  log_stream_.flush();
+
+  if (!log_stream_)
+  {
+    write_failed_ = true;
+  }
+}
+
+double EGMAsyncLogger::calculateTimeLogged(const double sample_time)
+{
+  return (double)number_of_logged_messages_*sample_time;
+}
+
 } // end namespace egm
 } // end namespace abb
@@ -0,0 +1,336 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <algorithm>
+
+#include "abb_libegm/egm_output_extrapolator.h"
+
+namespace abb
+{
+namespace egm
+{
+/***********************************************************************************************************************
+ * Class definitions: EGMOutputExtrapolator
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+EGMOutputExtrapolator::EGMOutputExtrapolator()
+:
+has_reference_(false),
+has_extrapolation_(false),
+has_sequence_number_(false),
+sequence_number_(0),
+reference_sequence_number_(0),
+duration_(0.0)
+{}
+
+void EGMOutputExtrapolator::reset()
+{
+  has_reference_ = false;
+  has_extrapolation_ = false;
+  has_sequence_number_ = false;
+}
+
+void EGMOutputExtrapolator::update(const wrapper::Output& outputs,
+                                   const unsigned int sequence_number,
+                                   const double sample_time)
+{
+  updateSequence(sequence_number, sample_time);
+
+  // Note: The velocities and accelerations are only estimated from new outputs within the same session.
+  const double dt = (has_reference_ ? (sequence_number - reference_sequence_number_)*sample_time : 0.0);
+
+  updateReference(joint_reference_.mutable_robot()->mutable_joints(), outputs.robot().joints(), dt);
+  updateReference(joint_reference_.mutable_external()->mutable_joints(), outputs.external().joints(), dt);
+  updateReference(pose_reference_.mutable_robot()->mutable_cartesian(), outputs.robot().cartesian(), dt);
+
+  reference_sequence_number_ = sequence_number;
+  has_reference_ = true;
+  has_extrapolation_ = false;
+}
+
+bool EGMOutputExtrapolator::extrapolate(wrapper::Output* p_outputs,
+                                        const unsigned int sequence_number,
+                                        const double sample_time,
+                                        const double duration)
+{
+  const double elapsed = updateSequence(sequence_number, sample_time);
+
+  ++statistics_.number_of_late_outputs;
+
+  if (!p_outputs || !has_reference_)
+  {
+    return false;
+  }
+
+  // Set up the interpolators, the first time that the current reference is extrapolated.
+  if (!has_extrapolation_ || duration_ != duration)
+  {
+    EGMInterpolator::Conditions conditions;
+    conditions.duration = duration;
+    conditions.operation = EGMInterpolator::Normal;
+    conditions.spline_method = TrajectoryConfiguration::Quintic;
+
+    conditions.mode = EGMJoint;
+    setupGoal(joint_goal_.mutable_robot()->mutable_joints(), joint_reference_.robot().joints(), duration);
+    setupGoal(joint_goal_.mutable_external()->mutable_joints(), joint_reference_.external().joints(), duration);
+    joint_interpolator_.update(joint_reference_, joint_goal_, conditions);
+
+    conditions.mode = EGMPose;
+    setupGoal(pose_goal_.mutable_robot()->mutable_cartesian(), pose_reference_.robot().cartesian(), duration);
+    pose_interpolator_.update(pose_reference_, pose_goal_, conditions);
+
+    duration_ = duration;
+    has_extrapolation_ = true;
+  }
+
+  if (elapsed < joint_interpolator_.getDuration())
+  {
+    ++statistics_.number_of_extrapolated_outputs;
+  }
+  else
+  {
+    ++statistics_.number_of_held_outputs;
+  }
+
+  double positions[EGMInterpolator::MAX_NUMBER_OF_SPLINES];
+  double velocities[EGMInterpolator::MAX_NUMBER_OF_SPLINES];
+  double accelerations[EGMInterpolator::MAX_NUMBER_OF_SPLINES];
+
+  // Robot and external joints.
+  joint_interpolator_.evaluateSplines(positions, velocities, accelerations, elapsed);
+  const int offset = joint_interpolator_.getExternalJointsOffset();
+
+  copyExtrapolated(p_outputs->mutable_robot()->mutable_joints(), joint_reference_.robot().joints(), 0,
+                   positions, velocities);
+  copyExtrapolated(p_outputs->mutable_external()->mutable_joints(), joint_reference_.external().joints(), offset,
+                   positions, velocities);
+
+  // Cartesian position.
+  pose_interpolator_.evaluateSplines(positions, velocities, accelerations, elapsed);
+  copyExtrapolated(p_outputs->mutable_robot()->mutable_cartesian(), positions, velocities);
+
+  return true;
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+double EGMOutputExtrapolator::updateSequence(const unsigned int sequence_number, const double sample_time)
+{
+  if (has_sequence_number_ && sequence_number > sequence_number_)
+  {
+    statistics_.number_of_missed_messages += sequence_number - sequence_number_ - 1;
+  }
+
+  if (!has_sequence_number_ || sequence_number > sequence_number_)
+  {
+    sequence_number_ = sequence_number;
+    has_sequence_number_ = true;
+  }
+
+  return (has_reference_ ? (sequence_number - reference_sequence_number_)*sample_time : 0.0);
+}
+
+void EGMOutputExtrapolator::updateReference(wrapper::trajectory::JointGoal* p_reference,
+                                            const wrapper::JointSpace& outputs,
+                                            const double dt)
+{
+  const int size = outputs.position().values_size();
+  const bool has_previous = (dt > 0.0 &&
+                             p_reference->position().values_size() == size &&
+                             p_reference->velocity().values_size() == size &&
+                             p_reference->acceleration().values_size() == size);
+
+  if (!has_previous)
+  {
+    // Note: Clearing keeps the allocated capacity.
+    p_reference->Clear();
+
+    for (int i = 0; i < size; ++i)
+    {
+      p_reference->mutable_position()->add_values(outputs.position().values(i));
+      p_reference->mutable_velocity()->add_values(0.0);
+      p_reference->mutable_acceleration()->add_values(0.0);
+    }
+
+    return;
+  }
+
+  for (int i = 0; i < size; ++i)
+  {
+    const double position = outputs.position().values(i);
+    const double velocity = (position - p_reference->position().values(i)) / dt;
+
+    p_reference->mutable_acceleration()->set_values(i, (velocity - p_reference->velocity().values(i)) / dt);
+    p_reference->mutable_velocity()->set_values(i, velocity);
+    p_reference->mutable_position()->set_values(i, position);
+  }
+}
+
+void EGMOutputExtrapolator::updateReference(wrapper::trajectory::CartesianGoal* p_reference,
+                                            const wrapper::CartesianSpace& outputs,
+                                            const double dt)
+{
+  const wrapper::Cartesian& position = outputs.pose().position();
+  const bool has_previous = (dt > 0.0 && p_reference->pose().has_position());
+
+  const double positions[] = {position.x(), position.y(), position.z()};
+  double velocities[] = {0.0, 0.0, 0.0};
+  double accelerations[] = {0.0, 0.0, 0.0};
+
+  if (has_previous)
+  {
+    const wrapper::Cartesian& previous_position = p_reference->pose().position();
+    const double previous_positions[] = {previous_position.x(), previous_position.y(), previous_position.z()};
+    const double previous_velocities[] = {p_reference->velocity().x(),
+                                          p_reference->velocity().y(),
+                                          p_reference->velocity().z()};
+
+    for (int i = 0; i < 3; ++i)
+    {
+      velocities[i] = (positions[i] - previous_positions[i]) / dt;
+      accelerations[i] = (velocities[i] - previous_velocities[i]) / dt;
+    }
+  }
+
+  p_reference->mutable_pose()->mutable_position()->set_x(positions[0]);
+  p_reference->mutable_pose()->mutable_position()->set_y(positions[1]);
+  p_reference->mutable_pose()->mutable_position()->set_z(positions[2]);
+  p_reference->mutable_velocity()->set_x(velocities[0]);
+  p_reference->mutable_velocity()->set_y(velocities[1]);
+  p_reference->mutable_velocity()->set_z(velocities[2]);
+  p_reference->mutable_acceleration()->set_x(accelerations[0]);
+  p_reference->mutable_acceleration()->set_y(accelerations[1]);
+  p_reference->mutable_acceleration()->set_z(accelerations[2]);
+
+  // Note: The orientation is held, so an identity quaternion is used (to keep the interpolator's Slerp well defined).
+  wrapper::Quaternion* p_quaternion = p_reference->mutable_pose()->mutable_quaternion();
+  p_quaternion->set_u0(1.0);
+  p_quaternion->set_u1(0.0);
+  p_quaternion->set_u2(0.0);
+  p_quaternion->set_u3(0.0);
+}
+
+void EGMOutputExtrapolator::setupGoal(wrapper::trajectory::JointGoal* p_goal,
+                                      const wrapper::trajectory::JointGoal& reference,
+                                      const double duration)
+{
+  p_goal->Clear();
+
+  // Note: Stopping distance, for a linear decrease of the velocity during the extrapolation duration.
+  for (int i = 0; i < reference.position().values_size(); ++i)
+  {
+    p_goal->mutable_position()->add_values(reference.position().values(i) +
+                                           0.5*reference.velocity().values(i)*duration);
+    p_goal->mutable_velocity()->add_values(0.0);
+    p_goal->mutable_acceleration()->add_values(0.0);
+  }
+}
+
+void EGMOutputExtrapolator::setupGoal(wrapper::trajectory::CartesianGoal* p_goal,
+                                      const wrapper::trajectory::CartesianGoal& reference,
+                                      const double duration)
+{
+  p_goal->CopyFrom(reference);
+
+  // Note: Stopping distance, for a linear decrease of the velocity during the extrapolation duration.
+  wrapper::Cartesian* p_position = p_goal->mutable_pose()->mutable_position();
+  p_position->set_x(p_position->x() + 0.5*reference.velocity().x()*duration);
+  p_position->set_y(p_position->y() + 0.5*reference.velocity().y()*duration);
+  p_position->set_z(p_position->z() + 0.5*reference.velocity().z()*duration);
+
+  p_goal->mutable_velocity()->set_x(0.0);
+  p_goal->mutable_velocity()->set_y(0.0);
+  p_goal->mutable_velocity()->set_z(0.0);
+  p_goal->mutable_acceleration()->set_x(0.0);
+  p_goal->mutable_acceleration()->set_y(0.0);
+  p_goal->mutable_acceleration()->set_z(0.0);
+}
+
+void EGMOutputExtrapolator::copyExtrapolated(wrapper::JointSpace* p_outputs,
+                                             const wrapper::trajectory::JointGoal& reference,
+                                             const int offset,
+                                             const double* p_positions,
+                                             const double* p_velocities)
+{
+  const int size = reference.position().values_size();
+  const int limit = std::min(size, static_cast<int>(EGMInterpolator::MAX_NUMBER_OF_SPLINES) - offset);
+
+  if (p_outputs->position().values_size() == size)
+  {
+    for (int i = 0; i < limit; ++i)
+    {
+      p_outputs->mutable_position()->set_values(i, p_positions[i + offset]);
+    }
+  }
+
+  if (p_outputs->velocity().values_size() == size)
+  {
+    for (int i = 0; i < limit; ++i)
+    {
+      p_outputs->mutable_velocity()->set_values(i, p_velocities[i + offset]);
+    }
+  }
+}
+
+void EGMOutputExtrapolator::copyExtrapolated(wrapper::CartesianSpace* p_outputs,
+                                             const double* p_positions,
+                                             const double* p_velocities)
+{
+  if (p_outputs->pose().has_position())
+  {
+    wrapper::Cartesian* p_position = p_outputs->mutable_pose()->mutable_position();
+    p_position->set_x(p_positions[0]);
+    p_position->set_y(p_positions[1]);
+    p_position->set_z(p_positions[2]);
+  }
+
+  if (p_outputs->velocity().has_linear())
+  {
+    wrapper::Cartesian* p_linear = p_outputs->mutable_velocity()->mutable_linear();
+    p_linear->set_x(p_velocities[0]);
+    p_linear->set_y(p_velocities[1]);
+    p_linear->set_z(p_velocities[2]);
+  }
+}
+
+} // end namespace egm
+} // end namespace abb
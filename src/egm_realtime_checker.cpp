@@ -0,0 +1,200 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include <boost/atomic.hpp>
+
+#include "abb_libegm/egm_realtime_checker.h"
+
+#ifdef ABB_LIBEGM_RT_CHECKS
+#if defined(_MSC_VER)
+#define ABB_LIBEGM_THREAD_LOCAL __declspec(thread)
+#else
+#define ABB_LIBEGM_THREAD_LOCAL __thread
+#endif
+
+/**
+ * \brief The calling thread's section nesting depth (zero if outside of any section).
+ */
+static ABB_LIBEGM_THREAD_LOCAL unsigned int section_depth = 0;
+
+/**
+ * \brief The number of memory allocations, in the calling thread's current section.
+ */
+static ABB_LIBEGM_THREAD_LOCAL unsigned int section_allocations = 0;
+
+/**
+ * \brief The number of lock acquisitions that had to wait, in the calling thread's current section.
+ */
+static ABB_LIBEGM_THREAD_LOCAL unsigned int section_lock_waits = 0;
+
+/**
+ * \brief The longest wait [s] for a lock, in the calling thread's current section.
+ */
+static ABB_LIBEGM_THREAD_LOCAL double section_max_lock_wait = 0.0;
+
+/**
+ * \brief Flag indicating if any allocation has been recorded (i.e. if the allocation hooks have been installed).
+ */
+static boost::atomic<bool> allocation_recorded(false);
+#endif
+
+namespace abb
+{
+namespace egm
+{
+/***********************************************************************************************************************
+ * Class definitions: EGMRealTimeChecker
+ */
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const unsigned int EGMRealTimeChecker::WARM_UP_SECTIONS;
+
+/************************************************************
+ * Primary methods
+ */
+
+EGMRealTimeChecker::EGMRealTimeChecker()
+:
+number_of_ended_sections_(0)
+{}
+
+void EGMRealTimeChecker::beginSection()
+{
+#ifdef ABB_LIBEGM_RT_CHECKS
+  if (section_depth++ == 0)
+  {
+    section_allocations = 0;
+    section_lock_waits = 0;
+    section_max_lock_wait = 0.0;
+    start_time_ = boost::chrono::steady_clock::now();
+  }
+#endif
+}
+
+void EGMRealTimeChecker::endSection()
+{
+#ifdef ABB_LIBEGM_RT_CHECKS
+  if (section_depth == 0 || --section_depth > 0)
+  {
+    return;
+  }
+
+  const double duration = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start_time_).count();
+
+  if (++number_of_ended_sections_ <= WARM_UP_SECTIONS)
+  {
+    return;
+  }
+
+  ++report_.number_of_sections;
+  report_.number_of_allocations += section_allocations;
+  report_.max_allocations = std::max(report_.max_allocations, section_allocations);
+  report_.number_of_lock_waits += section_lock_waits;
+  report_.max_lock_wait = std::max(report_.max_lock_wait, section_max_lock_wait);
+  report_.max_duration = std::max(report_.max_duration, duration);
+  report_.last_duration = duration;
+
+  if (section_allocations > 0 || section_lock_waits > 0)
+  {
+    ++report_.number_of_violations;
+
+#ifdef ABB_LIBEGM_RT_CHECKS_ABORT
+    std::fprintf(stderr,
+                 "abb_libegm: Real-time violation (%u allocation(s) and %u lock wait(s) in a checked section)\n",
+                 section_allocations,
+                 section_lock_waits);
+    std::abort();
+#endif
+  }
+
+  reports_.store(report_);
+#endif
+}
+
+bool EGMRealTimeChecker::retrieveReport(RealTimeReport* p_report) const
+{
+  return isEnabled() && p_report && reports_.tryLoad(p_report);
+}
+
+bool EGMRealTimeChecker::isEnabled()
+{
+#ifdef ABB_LIBEGM_RT_CHECKS
+  return true;
+#else
+  return false;
+#endif
+}
+
+void EGMRealTimeChecker::recordAllocation()
+{
+#ifdef ABB_LIBEGM_RT_CHECKS
+  allocation_recorded.store(true, boost::memory_order_relaxed);
+
+  if (section_depth > 0)
+  {
+    ++section_allocations;
+  }
+#endif
+}
+
+bool EGMRealTimeChecker::hasAllocationHooks()
+{
+#ifdef ABB_LIBEGM_RT_CHECKS
+  return allocation_recorded.load(boost::memory_order_relaxed);
+#else
+  return false;
+#endif
+}
+
+void EGMRealTimeChecker::recordLockWait(const double wait_time)
+{
+#ifdef ABB_LIBEGM_RT_CHECKS
+  if (section_depth > 0)
+  {
+    ++section_lock_waits;
+    section_max_lock_wait = std::max(section_max_lock_wait, wait_time);
+  }
+#else
+  (void) wait_time;
+#endif
+}
+
+} // end namespace egm
+} // end namespace abb
@@ -0,0 +1,491 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <cstring>
+
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
+#include <boost/static_assert.hpp>
+
+#ifdef __linux__
+#include <cerrno>
+#include <climits>
+#include <ctime>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "abb_libegm/egm_shared_memory.h"
+
+namespace abb
+{
+namespace egm
+{
+/***********************************************************************************************************************
+ * Struct definitions: EGMSharedMemory::Slot and EGMSharedMemory::Segment
+ */
+
+// Note: The atomics are shared between processes, and used as futex words, so they must be plain lock-free integers.
+BOOST_STATIC_ASSERT(BOOST_ATOMIC_INT32_LOCK_FREE == 2);
+BOOST_STATIC_ASSERT(sizeof(boost::atomic<boost::uint32_t>) == sizeof(boost::uint32_t));
+
+struct EGMSharedMemory::Slot
+{
+  /**
+   * \brief Sequence number, which is odd while a message is being written (and also used as futex word).
+   *
+   * Note: The number of published messages is half the sequence number.
+   */
+  boost::atomic<boost::uint32_t> sequence;
+
+  /**
+   * \brief Number of threads waiting on the sequence number (i.e. if a futex wake up is needed or not).
+   */
+  boost::atomic<boost::uint32_t> waiters;
+
+  /**
+   * \brief Size [bytes] of the serialized message.
+   */
+  boost::uint32_t size;
+
+  /**
+   * \brief The serialized message.
+   */
+  char data[MAX_MESSAGE_SIZE];
+};
+
+struct EGMSharedMemory::Segment
+{
+  /**
+   * \brief Static constant marking an initialized segment.
+   */
+  static const boost::uint32_t MAGIC = 0x4547534d;
+
+  /**
+   * \brief Static constant for the segment's layout version.
+   */
+  static const boost::uint32_t VERSION = 1;
+
+  /**
+   * \brief MAGIC, when the segment has been initialized.
+   */
+  boost::atomic<boost::uint32_t> magic;
+
+  /**
+   * \brief The segment's layout version.
+   */
+  boost::uint32_t version;
+
+  /**
+   * \brief The slot's max message size [bytes].
+   */
+  boost::uint32_t max_message_size;
+
+  /**
+   * \brief Slot for the inputs (written by the interface's process).
+   */
+  Slot inputs;
+
+  /**
+   * \brief Slot for the outputs (written by the external control loop's process).
+   */
+  Slot outputs;
+};
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const boost::uint32_t EGMSharedMemory::Segment::MAGIC;
+const boost::uint32_t EGMSharedMemory::Segment::VERSION;
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: EGMSharedMemory
+ */
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const unsigned int EGMSharedMemory::MAX_MESSAGE_SIZE;
+const int EGMSharedMemory::MAX_READ_ATTEMPTS;
+
+/************************************************************
+ * Primary methods
+ */
+
+EGMSharedMemory::EGMSharedMemory()
+:
+p_segment_(0),
+owner_(false),
+last_inputs_sequence_(0),
+last_outputs_sequence_(0)
+{}
+
+EGMSharedMemory::~EGMSharedMemory()
+{
+  close();
+}
+
+bool EGMSharedMemory::create(const std::string& name)
+{
+  return map(name, true);
+}
+
+bool EGMSharedMemory::open(const std::string& name)
+{
+  return map(name, false);
+}
+
+void EGMSharedMemory::close()
+{
+#ifdef __linux__
+  if (p_segment_)
+  {
+    munmap(p_segment_, sizeof(Segment));
+
+    if (owner_)
+    {
+      shm_unlink(name_.c_str());
+    }
+  }
+#endif
+
+  p_segment_ = 0;
+  owner_ = false;
+}
+
+bool EGMSharedMemory::isOpen() const
+{
+  return p_segment_ != 0;
+}
+
+bool EGMSharedMemory::writeInputs(const wrapper::Input& inputs)
+{
+  return p_segment_ && write(&p_segment_->inputs, inputs);
+}
+
+bool EGMSharedMemory::waitForInputs(const unsigned int timeout_ms)
+{
+  return p_segment_ && wait(&p_segment_->inputs, last_inputs_sequence_, timeout_ms);
+}
+
+bool EGMSharedMemory::readInputs(wrapper::Input* p_inputs)
+{
+  return p_segment_ && read(&p_segment_->inputs, &last_inputs_sequence_, p_inputs, false);
+}
+
+bool EGMSharedMemory::writeOutputs(const wrapper::Output& outputs)
+{
+  return p_segment_ && write(&p_segment_->outputs, outputs);
+}
+
+bool EGMSharedMemory::waitForOutputs(const unsigned int timeout_ms)
+{
+  return p_segment_ && wait(&p_segment_->outputs, last_outputs_sequence_, timeout_ms);
+}
+
+bool EGMSharedMemory::readOutputs(wrapper::Output* p_outputs)
+{
+  return p_segment_ && read(&p_segment_->outputs, &last_outputs_sequence_, p_outputs, true);
+}
+
+void EGMSharedMemory::discardOutputs()
+{
+  if (p_segment_)
+  {
+    // Note: Rounded down to the last completed write.
+    last_outputs_sequence_ = p_segment_->outputs.sequence.load(boost::memory_order_acquire) & ~1u;
+  }
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+bool EGMSharedMemory::map(const std::string& name, const bool create)
+{
+  close();
+
+  bool success = false;
+
+#ifdef __linux__
+  int descriptor = -1;
+
+  if (create)
+  {
+    // Remove any stale segment (e.g. from a crashed process), so that the new segment starts zero-initialized.
+    shm_unlink(name.c_str());
+    descriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+
+    if (descriptor >= 0 && ftruncate(descriptor, sizeof(Segment)) != 0)
+    {
+      ::close(descriptor);
+      shm_unlink(name.c_str());
+      descriptor = -1;
+    }
+  }
+  else
+  {
+    descriptor = shm_open(name.c_str(), O_RDWR, 0);
+
+    struct stat status;
+
+    if (descriptor >= 0 && (fstat(descriptor, &status) != 0 || status.st_size < (off_t) sizeof(Segment)))
+    {
+      ::close(descriptor);
+      descriptor = -1;
+    }
+  }
+
+  if (descriptor >= 0)
+  {
+    void* p_memory = mmap(0, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+
+    // Note: The mapping stays valid after the descriptor has been closed.
+    ::close(descriptor);
+
+    if (p_memory != MAP_FAILED)
+    {
+      // Note: A new segment is zero-filled, which is a valid initial state for the atomics.
+      Segment* p_segment = static_cast<Segment*>(p_memory);
+
+      if (create)
+      {
+        p_segment->version = Segment::VERSION;
+        p_segment->max_message_size = MAX_MESSAGE_SIZE;
+        p_segment->magic.store(Segment::MAGIC, boost::memory_order_release);
+        success = true;
+      }
+      else
+      {
+        success = (p_segment->magic.load(boost::memory_order_acquire) == Segment::MAGIC &&
+                   p_segment->version == Segment::VERSION &&
+                   p_segment->max_message_size == MAX_MESSAGE_SIZE);
+      }
+
+      if (success)
+      {
+        p_segment_ = p_segment;
+        name_ = name;
+        owner_ = create;
+        last_inputs_sequence_ = 0;
+        last_outputs_sequence_ = 0;
+      }
+      else
+      {
+        munmap(p_memory, sizeof(Segment));
+
+        if (create)
+        {
+          shm_unlink(name.c_str());
+        }
+      }
+    }
+    else if (create)
+    {
+      shm_unlink(name.c_str());
+    }
+  }
+#else
+  (void) name;
+  (void) create;
+#endif
+
+  return success;
+}
+
+bool EGMSharedMemory::write(Slot* p_slot, const google::protobuf::MessageLite& message)
+{
+  const size_t size = message.ByteSizeLong();
+
+  if (size > MAX_MESSAGE_SIZE)
+  {
+    return false;
+  }
+
+  const boost::uint32_t sequence = p_slot->sequence.load(boost::memory_order_relaxed);
+
+  // Note: An odd sequence number indicates that a write is in progress.
+  p_slot->sequence.store(sequence + 1, boost::memory_order_relaxed);
+  boost::atomic_thread_fence(boost::memory_order_release);
+
+  // Serialize directly into the slot (the size has already been computed and cached above).
+  message.SerializeWithCachedSizesToArray(reinterpret_cast<google::protobuf::uint8*>(p_slot->data));
+  p_slot->size = static_cast<boost::uint32_t>(size);
+
+  // Note: Sequentially consistent, so that either the store is seen by a waiter, or the waiter is seen here.
+  p_slot->sequence.store(sequence + 2, boost::memory_order_seq_cst);
+
+#ifdef __linux__
+  if (p_slot->waiters.load(boost::memory_order_seq_cst) > 0)
+  {
+    syscall(SYS_futex, reinterpret_cast<boost::uint32_t*>(&p_slot->sequence), FUTEX_WAKE, INT_MAX, 0, 0, 0);
+  }
+#endif
+
+  return true;
+}
+
+bool EGMSharedMemory::wait(Slot* p_slot, const boost::uint32_t last_sequence, const unsigned int timeout_ms)
+{
+  bool available = false;
+
+#ifdef __linux__
+  const boost::chrono::steady_clock::time_point deadline =
+    boost::chrono::steady_clock::now() + boost::chrono::milliseconds(timeout_ms);
+
+  p_slot->waiters.fetch_add(1, boost::memory_order_seq_cst);
+
+  while (true)
+  {
+    const boost::uint32_t sequence = p_slot->sequence.load(boost::memory_order_seq_cst);
+
+    if ((sequence & 1) == 0 && sequence != last_sequence)
+    {
+      available = true;
+      break;
+    }
+
+    struct timespec timeout;
+    struct timespec* p_timeout = 0;
+
+    if (timeout_ms > 0)
+    {
+      const boost::int64_t remaining =
+        boost::chrono::duration_cast<boost::chrono::nanoseconds>(deadline - boost::chrono::steady_clock::now()).count();
+
+      if (remaining <= 0)
+      {
+        break;
+      }
+
+      timeout.tv_sec = static_cast<time_t>(remaining / 1000000000);
+      timeout.tv_nsec = static_cast<long>(remaining % 1000000000);
+      p_timeout = &timeout;
+    }
+
+    // Note: Returns directly if the sequence number has already changed (or on interruptions), and it is then
+    //       checked again above.
+    syscall(SYS_futex, reinterpret_cast<boost::uint32_t*>(&p_slot->sequence), FUTEX_WAIT, sequence, p_timeout, 0, 0);
+  }
+
+  p_slot->waiters.fetch_sub(1, boost::memory_order_seq_cst);
+#else
+  (void) p_slot;
+  (void) last_sequence;
+  (void) timeout_ms;
+#endif
+
+  return available;
+}
+
+bool EGMSharedMemory::read(Slot* p_slot,
+                           boost::uint32_t* p_last_sequence,
+                           google::protobuf::MessageLite* p_message,
+                           const bool only_new)
+{
+  if (!p_message)
+  {
+    return false;
+  }
+
+  for (int i = 0; i < MAX_READ_ATTEMPTS; ++i)
+  {
+    const boost::uint32_t before = p_slot->sequence.load(boost::memory_order_acquire);
+
+    if (before == 0 || (only_new && before == *p_last_sequence))
+    {
+      return false;
+    }
+
+    if ((before & 1) == 0)
+    {
+      const boost::uint32_t size = p_slot->size;
+
+      if (size <= MAX_MESSAGE_SIZE)
+      {
+        std::memcpy(buffer_, p_slot->data, size);
+        boost::atomic_thread_fence(boost::memory_order_acquire);
+
+        // Only parse a consistent copy (i.e. if no write overlapped with the copy).
+        if (p_slot->sequence.load(boost::memory_order_relaxed) == before)
+        {
+          *p_last_sequence = before;
+          return p_message->ParseFromArray(buffer_, static_cast<int>(size));
+        }
+      }
+    }
+  }
+
+  return false;
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: EGMSharedMemoryClient
+ */
+
+/************************************************************
+ * User interaction methods
+ */
+
+bool EGMSharedMemoryClient::open(const std::string& name)
+{
+  return shared_memory_.open(name);
+}
+
+bool EGMSharedMemoryClient::waitForMessage(const unsigned int timeout_ms)
+{
+  return shared_memory_.waitForInputs(timeout_ms);
+}
+
+void EGMSharedMemoryClient::read(wrapper::Input* p_inputs)
+{
+  shared_memory_.readInputs(p_inputs);
+}
+
+void EGMSharedMemoryClient::write(const wrapper::Output& outputs)
+{
+  shared_memory_.writeOutputs(outputs);
+}
+
+} // end namespace egm
+} // end namespace abb
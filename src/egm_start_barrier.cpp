@@ -0,0 +1,113 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <algorithm>
+
+#include "abb_libegm/egm_start_barrier.h"
+
+namespace abb
+{
+namespace egm
+{
+/***********************************************************************************************************************
+ * Class definitions: EGMStartBarrier
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+EGMStartBarrier::EGMStartBarrier(const unsigned int number_of_members,
+                                 const boost::chrono::steady_clock::time_point& earliest_start,
+                                 const double lead_time)
+:
+number_of_members_(number_of_members),
+earliest_start_ns_(toNanoseconds(earliest_start)),
+lead_time_ns_((boost::int64_t) (std::max(lead_time, 0.0)*1e9)),
+number_of_arrivals_(0),
+release_time_ns_(0),
+state_(Waiting)
+{}
+
+void EGMStartBarrier::arrive(const boost::chrono::steady_clock::time_point& message_time)
+{
+  // The last member to arrive decides the release time, so that the other (waiting) members all still have a
+  // message closer to the release time than their current one.
+  if (number_of_arrivals_.fetch_add(1, boost::memory_order_acq_rel) + 1 == number_of_members_)
+  {
+    release_time_ns_.store(std::max(earliest_start_ns_, toNanoseconds(message_time) + lead_time_ns_),
+                           boost::memory_order_relaxed);
+
+    int expected = Waiting;
+    state_.compare_exchange_strong(expected, Released, boost::memory_order_release);
+  }
+}
+
+EGMStartBarrier::Status EGMStartBarrier::status(const boost::chrono::steady_clock::time_point& message_time,
+                                                const double sample_time) const
+{
+  const int state = state_.load(boost::memory_order_acquire);
+
+  if (state == Released)
+  {
+    // Start at the message closest to the release time.
+    const boost::int64_t half_sample_time_ns = (boost::int64_t) (0.5*sample_time*1e9);
+
+    if (toNanoseconds(message_time) + half_sample_time_ns >= release_time_ns_.load(boost::memory_order_relaxed))
+    {
+      return Released;
+    }
+  }
+
+  return (state == Cancelled ? Cancelled : Waiting);
+}
+
+void EGMStartBarrier::cancel()
+{
+  state_.store(Cancelled, boost::memory_order_release);
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+boost::int64_t EGMStartBarrier::toNanoseconds(const boost::chrono::steady_clock::time_point& time)
+{
+  return boost::chrono::duration_cast<boost::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+} // end namespace egm
+} // end namespace abb
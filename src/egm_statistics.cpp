@@ -0,0 +1,428 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "abb_libegm/egm_statistics.h"
+
+namespace abb
+{
+namespace egm
+{
+/***********************************************************************************************************************
+ * Class definitions: LatencyHistogram
+ */
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const unsigned int LatencyHistogram::SUB_BUCKET_BITS;
+const unsigned int LatencyHistogram::SUB_BUCKET_COUNT;
+const unsigned int LatencyHistogram::MAX_EXPONENT;
+const unsigned int LatencyHistogram::NUMBER_OF_BUCKETS;
+
+/************************************************************
+ * Primary methods
+ */
+
+LatencyHistogram::LatencyHistogram()
+{
+  reset();
+}
+
+void LatencyHistogram::add(const boost::uint64_t value_ns)
+{
+  ++buckets_[bucketIndex(value_ns)];
+
+  min_ = (count_ == 0 ? value_ns : std::min(min_, value_ns));
+  max_ = (count_ == 0 ? value_ns : std::max(max_, value_ns));
+  sum_ += (double) value_ns;
+  ++count_;
+}
+
+void LatencyHistogram::reset()
+{
+  std::memset(buckets_, 0, sizeof(buckets_));
+  count_ = 0;
+  min_ = 0;
+  max_ = 0;
+  sum_ = 0.0;
+}
+
+LatencyStatistics LatencyHistogram::summarize() const
+{
+  LatencyStatistics statistics;
+
+  if (count_ > 0)
+  {
+    statistics.count = count_;
+    statistics.min = min_*1.0e-3;
+    statistics.max = max_*1.0e-3;
+    statistics.mean = (sum_ / count_)*1.0e-3;
+    statistics.p50 = percentile(0.5);
+    statistics.p90 = percentile(0.9);
+    statistics.p99 = percentile(0.99);
+    statistics.p999 = percentile(0.999);
+  }
+
+  return statistics;
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+unsigned int LatencyHistogram::bucketIndex(const boost::uint64_t value_ns)
+{
+  if (value_ns < SUB_BUCKET_COUNT)
+  {
+    return (unsigned int) value_ns;
+  }
+
+  // Find the most significant bit (at least SUB_BUCKET_BITS).
+  unsigned int msb = SUB_BUCKET_BITS;
+  while (msb <= MAX_EXPONENT && (value_ns >> (msb + 1)) != 0)
+  {
+    ++msb;
+  }
+
+  if (msb > MAX_EXPONENT)
+  {
+    // Saturate values beyond the covered range.
+    return NUMBER_OF_BUCKETS - 1;
+  }
+
+  const unsigned int exponent = msb - SUB_BUCKET_BITS + 1;
+  const unsigned int sub_bucket = (unsigned int) (value_ns >> (msb - SUB_BUCKET_BITS)) - SUB_BUCKET_COUNT;
+
+  return exponent*SUB_BUCKET_COUNT + sub_bucket;
+}
+
+boost::uint64_t LatencyHistogram::bucketLowerBound(const unsigned int index)
+{
+  if (index < SUB_BUCKET_COUNT)
+  {
+    return index;
+  }
+
+  const unsigned int exponent = index / SUB_BUCKET_COUNT;
+  const unsigned int sub_bucket = index % SUB_BUCKET_COUNT;
+
+  return ((boost::uint64_t) (SUB_BUCKET_COUNT + sub_bucket)) << (exponent - 1);
+}
+
+double LatencyHistogram::percentile(const double fraction) const
+{
+  const boost::uint64_t target = std::max((boost::uint64_t) 1, (boost::uint64_t) std::ceil(fraction*count_));
+
+  boost::uint64_t cumulative = 0;
+  boost::uint64_t value = max_;
+
+  for (unsigned int i = 0; i < NUMBER_OF_BUCKETS; ++i)
+  {
+    cumulative += buckets_[i];
+
+    if (cumulative >= target)
+    {
+      // Use the middle of the bucket, limited by the recorded extremes.
+      const boost::uint64_t lower = bucketLowerBound(i);
+      const boost::uint64_t upper = (i + 1 < NUMBER_OF_BUCKETS ? bucketLowerBound(i + 1) : lower + 1);
+
+      value = std::min(max_, std::max(min_, lower + (upper - lower) / 2));
+      break;
+    }
+  }
+
+  return value*1.0e-3;
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: EGMStatisticsCollector
+ */
+
+const double EGMStatisticsCollector::LATE_FACTOR = 1.5;
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const unsigned int EGMStatisticsCollector::MAX_PENDING_SAMPLES;
+
+/************************************************************
+ * Primary methods
+ */
+
+EGMStatisticsCollector::EGMStatisticsCollector()
+:
+enabled_(false),
+has_sequence_number_(false),
+sequence_number_(0),
+estimated_sample_time_(0.0),
+number_of_pending_samples_(0)
+{
+  std::memset(stage_durations_, 0, sizeof(stage_durations_));
+  std::memset(stage_finished_, 0, sizeof(stage_finished_));
+}
+
+void EGMStatisticsCollector::startCycle(const bool enabled,
+                                        const boost::chrono::steady_clock::time_point& receive_time)
+{
+  enabled_ = enabled;
+
+  if (enabled_)
+  {
+    cycle_start_ = boost::chrono::steady_clock::now();
+    stage_start_ = cycle_start_;
+    receive_time_ = receive_time;
+
+    std::memset(stage_finished_, 0, sizeof(stage_finished_));
+    cycle_counters_ = InterfaceStatistics();
+  }
+}
+
+void EGMStatisticsCollector::markStage(const Stage stage)
+{
+  if (enabled_ && stage < NUMBER_OF_STAGES)
+  {
+    const boost::chrono::steady_clock::time_point now = boost::chrono::steady_clock::now();
+
+    stage_durations_[stage] = duration(stage_start_, now);
+    stage_finished_[stage] = true;
+    stage_start_ = now;
+  }
+}
+
+void EGMStatisticsCollector::updateSequence(const bool first_message,
+                                            const unsigned int sequence_number,
+                                            const double estimated_sample_time)
+{
+  if (enabled_)
+  {
+    if (first_message)
+    {
+      has_sequence_number_ = false;
+      previous_receive_time_ = boost::chrono::steady_clock::time_point();
+    }
+
+    if (has_sequence_number_)
+    {
+      if (sequence_number > sequence_number_)
+      {
+        cycle_counters_.number_of_missed_messages = sequence_number - sequence_number_ - 1;
+        sequence_number_ = sequence_number;
+      }
+      else
+      {
+        cycle_counters_.number_of_reordered_messages = 1;
+      }
+    }
+    else
+    {
+      sequence_number_ = sequence_number;
+      has_sequence_number_ = true;
+    }
+
+    estimated_sample_time_ = estimated_sample_time;
+  }
+}
+
+void EGMStatisticsCollector::endCycle()
+{
+  if (enabled_)
+  {
+    const boost::chrono::steady_clock::time_point now = boost::chrono::steady_clock::now();
+    const boost::chrono::steady_clock::time_point zero;
+    const boost::uint64_t sample_time_ns = (boost::uint64_t) (estimated_sample_time_*1.0e9);
+
+    CycleSample sample;
+
+    sample.callback = duration(cycle_start_, now);
+    std::memcpy(sample.stage_durations, stage_durations_, sizeof(stage_durations_));
+    std::memcpy(sample.stage_finished, stage_finished_, sizeof(stage_finished_));
+    sample.has_receive_to_send = false;
+    sample.has_inter_arrival = false;
+
+    if (receive_time_ != zero)
+    {
+      sample.has_receive_to_send = true;
+      sample.receive_to_send = duration(receive_time_, now);
+
+      if (sample_time_ns > 0 && sample.receive_to_send > sample_time_ns)
+      {
+        cycle_counters_.number_of_overruns = 1;
+      }
+
+      if (previous_receive_time_ != zero)
+      {
+        sample.has_inter_arrival = true;
+        sample.inter_arrival = duration(previous_receive_time_, receive_time_);
+
+        if (sample_time_ns > 0 && sample.inter_arrival > LATE_FACTOR*sample_time_ns)
+        {
+          cycle_counters_.number_of_late_messages = 1;
+        }
+      }
+
+      previous_receive_time_ = receive_time_;
+    }
+
+    // Drop the durations (but keep the counters) if too many cycles are already pending.
+    if (number_of_pending_samples_ < MAX_PENDING_SAMPLES)
+    {
+      pending_samples_[number_of_pending_samples_++] = sample;
+    }
+    else
+    {
+      ++pending_counters_.number_of_dropped_samples;
+    }
+
+    ++pending_counters_.number_of_messages;
+    pending_counters_.number_of_missed_messages += cycle_counters_.number_of_missed_messages;
+    pending_counters_.number_of_reordered_messages += cycle_counters_.number_of_reordered_messages;
+    pending_counters_.number_of_late_messages += cycle_counters_.number_of_late_messages;
+    pending_counters_.number_of_overruns += cycle_counters_.number_of_overruns;
+
+    // Only merge if no user thread is retrieving the statistics (i.e. never wait for the lock).
+    boost::unique_lock<boost::mutex> lock(mutex_, boost::try_to_lock);
+
+    if (lock.owns_lock())
+    {
+      mergePending();
+    }
+  }
+}
+
+InterfaceStatistics EGMStatisticsCollector::getStatistics()
+{
+  InterfaceStatistics statistics;
+  LatencyHistogram callback_histogram;
+  LatencyHistogram stage_histograms[NUMBER_OF_STAGES];
+  LatencyHistogram receive_to_send_histogram;
+  LatencyHistogram inter_arrival_histogram;
+
+  // Note: Only copy under the lock, so that the callback's merges are kept pending for as short as possible.
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+
+    statistics = counters_;
+    callback_histogram = callback_histogram_;
+    for (unsigned int i = 0; i < NUMBER_OF_STAGES; ++i)
+    {
+      stage_histograms[i] = stage_histograms_[i];
+    }
+    receive_to_send_histogram = receive_to_send_histogram_;
+    inter_arrival_histogram = inter_arrival_histogram_;
+  }
+
+  statistics.callback = callback_histogram.summarize();
+  statistics.parse = stage_histograms[Parse].summarize();
+  statistics.extract = stage_histograms[Extract].summarize();
+  statistics.outputs = stage_histograms[Outputs].summarize();
+  statistics.logging = stage_histograms[Logging].summarize();
+  statistics.reply = stage_histograms[Reply].summarize();
+  statistics.receive_to_send = receive_to_send_histogram.summarize();
+  statistics.inter_arrival = inter_arrival_histogram.summarize();
+
+  return statistics;
+}
+
+void EGMStatisticsCollector::reset()
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+
+  callback_histogram_.reset();
+  for (int i = 0; i < NUMBER_OF_STAGES; ++i)
+  {
+    stage_histograms_[i].reset();
+  }
+  receive_to_send_histogram_.reset();
+  inter_arrival_histogram_.reset();
+
+  counters_ = InterfaceStatistics();
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+void EGMStatisticsCollector::mergePending()
+{
+  for (unsigned int i = 0; i < number_of_pending_samples_; ++i)
+  {
+    const CycleSample& sample = pending_samples_[i];
+
+    callback_histogram_.add(sample.callback);
+
+    for (int j = 0; j < NUMBER_OF_STAGES; ++j)
+    {
+      if (sample.stage_finished[j])
+      {
+        stage_histograms_[j].add(sample.stage_durations[j]);
+      }
+    }
+
+    if (sample.has_receive_to_send)
+    {
+      receive_to_send_histogram_.add(sample.receive_to_send);
+    }
+
+    if (sample.has_inter_arrival)
+    {
+      inter_arrival_histogram_.add(sample.inter_arrival);
+    }
+  }
+
+  counters_.number_of_messages += pending_counters_.number_of_messages;
+  counters_.number_of_missed_messages += pending_counters_.number_of_missed_messages;
+  counters_.number_of_reordered_messages += pending_counters_.number_of_reordered_messages;
+  counters_.number_of_late_messages += pending_counters_.number_of_late_messages;
+  counters_.number_of_overruns += pending_counters_.number_of_overruns;
+  counters_.number_of_dropped_samples += pending_counters_.number_of_dropped_samples;
+
+  number_of_pending_samples_ = 0;
+  pending_counters_ = InterfaceStatistics();
+}
+
+boost::uint64_t EGMStatisticsCollector::duration(const boost::chrono::steady_clock::time_point& start,
+                                                 const boost::chrono::steady_clock::time_point& end)
+{
+  const boost::int64_t nanoseconds = boost::chrono::duration_cast<boost::chrono::nanoseconds>(end - start).count();
+
+  return (nanoseconds > 0 ? (boost::uint64_t) nanoseconds : 0);
+}
+
+} // end namespace egm
+} // end namespace abb
@@ -0,0 +1,289 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <algorithm>
+
+#include <boost/bind/bind.hpp>
+
+#include "abb_libegm/egm_telemetry.h"
+
+namespace abb
+{
+namespace egm
+{
+/***********************************************************************************************************************
+ * Class definitions: EGMTelemetryPublisher
+ */
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const size_t EGMTelemetryPublisher::DEFAULT_CAPACITY;
+const size_t EGMTelemetryPublisher::BATCH_SIZE;
+const unsigned int EGMTelemetryPublisher::IDLE_WAIT_TIME_MS;
+const char EGMTelemetryPublisher::MAGIC[4] = {'E', 'G', 'M', 'T'};
+
+/************************************************************
+ * Primary methods
+ */
+
+EGMTelemetryPublisher::EGMTelemetryPublisher(const TelemetryConfiguration& configuration, const size_t capacity)
+:
+window_duration_ms_(configuration.window_duration/Constants::Conversion::MS_TO_S),
+number_of_dropped_records_(0),
+stop_requested_(false),
+ring_buffer_(capacity),
+next_subscriber_id_(1)
+{
+  // Select the values to aggregate (defaults to the robot feedback section).
+  for (size_t i = 0; i < configuration.value_indices.size(); ++i)
+  {
+    if (configuration.value_indices[i] < EGMLogRecord::NUMBER_OF_VALUES)
+    {
+      sample_.value_indices.push_back(configuration.value_indices[i]);
+    }
+  }
+
+  if (configuration.value_indices.empty())
+  {
+    for (unsigned int i = 0; i < EGMLogRecord::SECTION_SIZE; ++i)
+    {
+      sample_.value_indices.push_back(i);
+    }
+  }
+
+  sample_.values.resize(sample_.value_indices.size());
+  sums_.resize(sample_.value_indices.size(), 0.0);
+
+  // Set up the (optional) multicast stream.
+  if (!configuration.multicast_address.empty())
+  {
+    boost::system::error_code error_code;
+    boost::asio::ip::address address(boost::asio::ip::address::from_string(configuration.multicast_address,
+                                                                           error_code));
+
+    if (!error_code)
+    {
+      endpoint_ = boost::asio::ip::udp::endpoint(address, configuration.multicast_port);
+      p_socket_.reset(new boost::asio::ip::udp::socket(io_service_));
+      p_socket_->open(endpoint_.protocol(), error_code);
+
+      if (error_code)
+      {
+        p_socket_.reset();
+      }
+    }
+  }
+
+  publisher_thread_ = boost::thread(&EGMTelemetryPublisher::publisherThread, this);
+}
+
+EGMTelemetryPublisher::~EGMTelemetryPublisher()
+{
+  stop_requested_ = true;
+  publisher_thread_.join();
+}
+
+bool EGMTelemetryPublisher::add(const wrapper::Input& inputs, const wrapper::Output& outputs)
+{
+  EGMLogRecord* p_record = ring_buffer_.writeSlot();
+
+  if (!p_record)
+  {
+    ++number_of_dropped_records_;
+    return false;
+  }
+
+  p_record->set(inputs, outputs);
+  ring_buffer_.publish();
+
+  return true;
+}
+
+int EGMTelemetryPublisher::addSubscriber(const TelemetryCallback& callback)
+{
+  boost::lock_guard<boost::mutex> lock(subscribers_mutex_);
+
+  Subscriber subscriber;
+  subscriber.id = next_subscriber_id_++;
+  subscriber.callback = callback;
+  subscribers_.push_back(subscriber);
+
+  return subscriber.id;
+}
+
+bool EGMTelemetryPublisher::removeSubscriber(const int id)
+{
+  boost::lock_guard<boost::mutex> lock(subscribers_mutex_);
+
+  for (std::vector<Subscriber>::iterator i = subscribers_.begin(); i != subscribers_.end(); ++i)
+  {
+    if (i->id == id)
+    {
+      subscribers_.erase(i);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+void EGMTelemetryPublisher::aggregate(const EGMLogRecord& record)
+{
+  // Publish the current window, if it is complete (or if the time stamps have restarted, e.g. for a new session).
+  if (sample_.number_of_messages > 0 &&
+      (record.time_stamp < sample_.first_time_stamp ||
+       record.time_stamp - sample_.first_time_stamp >= window_duration_ms_))
+  {
+    publish();
+  }
+
+  if (sample_.number_of_messages == 0)
+  {
+    sample_.first_time_stamp = record.time_stamp;
+    std::fill(sums_.begin(), sums_.end(), 0.0);
+  }
+
+  for (size_t i = 0; i < sample_.value_indices.size(); ++i)
+  {
+    const double value = record.values[sample_.value_indices[i]];
+    TelemetryValue& aggregated = sample_.values[i];
+
+    if (sample_.number_of_messages == 0)
+    {
+      aggregated.min = value;
+      aggregated.max = value;
+    }
+    else
+    {
+      aggregated.min = std::min(aggregated.min, value);
+      aggregated.max = std::max(aggregated.max, value);
+    }
+
+    sums_[i] += value;
+  }
+
+  sample_.last_time_stamp = record.time_stamp;
+  ++sample_.number_of_messages;
+}
+
+void EGMTelemetryPublisher::publish()
+{
+  for (size_t i = 0; i < sample_.values.size(); ++i)
+  {
+    sample_.values[i].mean = sums_[i]/sample_.number_of_messages;
+  }
+
+  // Note: The callbacks are notified without holding the mutex, so that they can e.g. remove themselves.
+  std::vector<Subscriber> subscribers;
+
+  {
+    boost::lock_guard<boost::mutex> lock(subscribers_mutex_);
+    subscribers = subscribers_;
+  }
+
+  for (size_t i = 0; i < subscribers.size(); ++i)
+  {
+    if (subscribers[i].callback)
+    {
+      subscribers[i].callback(sample_);
+    }
+  }
+
+  if (p_socket_)
+  {
+    sendSample();
+  }
+
+  ++sample_.sequence_number;
+  sample_.number_of_messages = 0;
+}
+
+void EGMTelemetryPublisher::sendSample()
+{
+  const boost::uint32_t header[] = {sample_.sequence_number,
+                                    sample_.first_time_stamp,
+                                    sample_.last_time_stamp,
+                                    sample_.number_of_messages,
+                                    static_cast<boost::uint32_t>(sample_.value_indices.size())};
+
+  datagram_.clear();
+  datagram_.insert(datagram_.end(), MAGIC, MAGIC + sizeof(MAGIC));
+  datagram_.insert(datagram_.end(),
+                   reinterpret_cast<const char*>(header),
+                   reinterpret_cast<const char*>(header) + sizeof(header));
+
+  for (size_t i = 0; i < sample_.value_indices.size(); ++i)
+  {
+    const boost::uint32_t index = sample_.value_indices[i];
+    datagram_.insert(datagram_.end(),
+                     reinterpret_cast<const char*>(&index),
+                     reinterpret_cast<const char*>(&index) + sizeof(index));
+  }
+
+  for (size_t i = 0; i < sample_.values.size(); ++i)
+  {
+    const double values[] = {sample_.values[i].min, sample_.values[i].max, sample_.values[i].mean};
+    datagram_.insert(datagram_.end(),
+                     reinterpret_cast<const char*>(values),
+                     reinterpret_cast<const char*>(values) + sizeof(values));
+  }
+
+  // Note: Send errors are ignored, the stream is best effort (like the EGM communication itself).
+  boost::system::error_code error_code;
+  p_socket_->send_to(boost::asio::buffer(datagram_), endpoint_, 0, error_code);
+}
+
+void EGMTelemetryPublisher::publisherThread()
+{
+  consumeRingBuffer(&ring_buffer_,
+                    stop_requested_,
+                    BATCH_SIZE,
+                    IDLE_WAIT_TIME_MS,
+                    boost::bind(&EGMTelemetryPublisher::aggregate, this, boost::placeholders::_1),
+                    NoIdleAction());
+
+  // Publish any partial window.
+  if (sample_.number_of_messages > 0)
+  {
+    publish();
+  }
+}
+
+} // end namespace egm
+} // end namespace abb
@@ -0,0 +1,213 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include "abb_libegm/egm_trajectory_blender.h"
+#include "abb_libegm/egm_trajectory_goal.h"
+
+namespace abb
+{
+namespace egm
+{
+using namespace wrapper;
+using namespace wrapper::trajectory;
+
+/***********************************************************************************************************************
+ * Class definitions: EGMTrajectoryBlender
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+bool EGMTrajectoryBlender::blend(const PointGoal& start, TrajectoryGoal* p_trajectory)
+{
+  return blend(&start, p_trajectory);
+}
+
+bool EGMTrajectoryBlender::blend(TrajectoryGoal* p_trajectory)
+{
+  return blend(0, p_trajectory);
+}
+
+bool EGMTrajectoryBlender::hasZones(const TrajectoryGoal& trajectory)
+{
+  bool result = false;
+
+  for (int i = 0; i < trajectory.points_size() && !result; ++i)
+  {
+    result = trajectory.points(i).zone() > 0.0;
+  }
+
+  return result;
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+bool EGMTrajectoryBlender::blend(const PointGoal* p_start, TrajectoryGoal* p_trajectory)
+{
+  if (!p_trajectory || p_trajectory->points_size() == 0)
+  {
+    return false;
+  }
+
+  const int number_of_points = p_trajectory->points_size();
+
+  // Prepare the goals. Note: The first point is used as start state if it is unknown.
+  goals_.resize(number_of_points + 1);
+  initializeGoal(&goals_[0], (p_start ? *p_start : p_trajectory->points(0)));
+
+  for (int i = 0; i < number_of_points; ++i)
+  {
+    goals_[i + 1].CopyFrom(goals_[i]);
+    prepareGoal(&goals_[i + 1], p_trajectory->points(i), goals_[i], i == number_of_points - 1);
+  }
+
+  bool blended = false;
+
+  for (int i = (p_start ? 0 : 1); i < number_of_points - 1; ++i)
+  {
+    PointGoal* p_point = p_trajectory->mutable_points(i);
+    const PointGoal& next_point = p_trajectory->points(i + 1);
+    const bool pose = p_point->robot().has_cartesian();
+
+    if (p_point->zone() <= 0.0 ||
+        p_point->duration() <= 0.0 ||
+        next_point.duration() <= 0.0 ||
+        next_point.robot().has_cartesian() != pose)
+    {
+      continue;
+    }
+
+    const PointGoal& previous = goals_[i];
+    const PointGoal& current = goals_[i + 1];
+    const PointGoal& next = goals_[i + 2];
+
+    // Robot joints, or the Cartesian position.
+    if (pose)
+    {
+      if (!p_point->robot().cartesian().has_velocity())
+      {
+        blendValues(p_point->mutable_robot()->mutable_cartesian()->mutable_velocity(),
+                    previous.robot().cartesian().pose().position(),
+                    current.robot().cartesian().pose().position(),
+                    next.robot().cartesian().pose().position(),
+                    p_point->duration(),
+                    next_point.duration());
+      }
+    }
+    else
+    {
+      if (!p_point->robot().joints().has_velocity())
+      {
+        blendValues(p_point->mutable_robot()->mutable_joints()->mutable_velocity(),
+                    previous.robot().joints().position(),
+                    current.robot().joints().position(),
+                    next.robot().joints().position(),
+                    p_point->duration(),
+                    next_point.duration());
+      }
+    }
+
+    // External joints.
+    if (!p_point->external().joints().has_velocity() && current.external().joints().position().values_size() > 0)
+    {
+      blendValues(p_point->mutable_external()->mutable_joints()->mutable_velocity(),
+                  previous.external().joints().position(),
+                  current.external().joints().position(),
+                  next.external().joints().position(),
+                  p_point->duration(),
+                  next_point.duration());
+    }
+
+    blended = true;
+  }
+
+  return blended;
+}
+
+void EGMTrajectoryBlender::blendValues(Joints* p_velocity,
+                                       const Joints& previous,
+                                       const Joints& current,
+                                       const Joints& next,
+                                       const double previous_duration,
+                                       const double next_duration)
+{
+  p_velocity->Clear();
+
+  for (int i = 0; i < current.values_size() && i < previous.values_size() && i < next.values_size(); ++i)
+  {
+    p_velocity->add_values(blendValue(previous.values(i),
+                                      current.values(i),
+                                      next.values(i),
+                                      previous_duration,
+                                      next_duration));
+  }
+}
+
+void EGMTrajectoryBlender::blendValues(Cartesian* p_velocity,
+                                       const Cartesian& previous,
+                                       const Cartesian& current,
+                                       const Cartesian& next,
+                                       const double previous_duration,
+                                       const double next_duration)
+{
+  p_velocity->set_x(blendValue(previous.x(), current.x(), next.x(), previous_duration, next_duration));
+  p_velocity->set_y(blendValue(previous.y(), current.y(), next.y(), previous_duration, next_duration));
+  p_velocity->set_z(blendValue(previous.z(), current.z(), next.z(), previous_duration, next_duration));
+}
+
+double EGMTrajectoryBlender::blendValue(const double previous,
+                                        const double current,
+                                        const double next,
+                                        const double previous_duration,
+                                        const double next_duration)
+{
+  const double previous_velocity = (current - previous) / previous_duration;
+  const double next_velocity = (next - current) / next_duration;
+
+  // Stop in the point, if the direction changes (or if the axis stands still on either side).
+  if (previous_velocity*next_velocity <= 0.0)
+  {
+    return 0.0;
+  }
+
+  return 0.5*(previous_velocity + next_velocity);
+}
+
+} // end namespace egm
+} // end namespace abb
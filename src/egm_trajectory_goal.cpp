@@ -0,0 +1,321 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "abb_libegm/egm_common_auxiliary.h"
+#include "abb_libegm/egm_trajectory_goal.h"
+
+namespace abb
+{
+namespace egm
+{
+using namespace wrapper;
+using namespace wrapper::trajectory;
+
+/***********************************************************************************************************************
+ * Auxiliary functions
+ */
+
+/**
+ * \brief Static constant for the condition [degrees or mm] used when checking if positions have been reached.
+ */
+static const double REACH_CONDITION = 0.005;
+
+/**
+ * \brief Transfer the present values of a robot goal into a goal.
+ *
+ * \param p_goal for the goal to transfer into.
+ * \param source containing the robot goal.
+ */
+static void transfer(PointGoal* p_goal, const RobotGoal& source)
+{
+  JointGoal* p_joints = p_goal->mutable_robot()->mutable_joints();
+  CartesianGoal* p_cartesian = p_goal->mutable_robot()->mutable_cartesian();
+
+  // Set up the robot joint goal.
+  copyPresent(p_joints->mutable_position(), source.joints().position());
+  copyPresent(p_joints->mutable_velocity(), source.joints().velocity());
+  copyPresent(p_joints->mutable_acceleration(), source.joints().acceleration());
+
+  // Set up the robot Cartesian goal.
+  copyPresent(p_cartesian->mutable_pose()->mutable_position(), source.cartesian().pose().position());
+  copyPresent(p_cartesian->mutable_velocity(), source.cartesian().velocity());
+  copyPresent(p_cartesian->mutable_acceleration(), source.cartesian().acceleration());
+
+  // Note: The goal's Euler field is used to contain angular velocities.
+  //       Therefore, convert any Euler goal to quaternions.
+  if (source.cartesian().pose().has_euler())
+  {
+    Euler temp;
+    convert(&temp, p_cartesian->pose().quaternion());
+    copyPresent(&temp, source.cartesian().pose().euler());
+    convert(p_cartesian->mutable_pose()->mutable_quaternion(), temp);
+    normalize(p_cartesian->mutable_pose()->mutable_quaternion());
+  }
+  else if (source.cartesian().pose().has_quaternion())
+  {
+    copyPresent(p_cartesian->mutable_pose()->mutable_quaternion(), source.cartesian().pose().quaternion());
+  }
+}
+
+/**
+ * \brief Transfer the present values of an external goal into a goal.
+ *
+ * \param p_goal for the goal to transfer into.
+ * \param source containing the external goal.
+ */
+static void transfer(PointGoal* p_goal, const ExternalGoal& source)
+{
+  JointGoal* p_joints = p_goal->mutable_external()->mutable_joints();
+
+  // Set up the external joint goal.
+  copyPresent(p_joints->mutable_position(), source.joints().position());
+  copyPresent(p_joints->mutable_velocity(), source.joints().velocity());
+  copyPresent(p_joints->mutable_acceleration(), source.joints().acceleration());
+}
+
+/**
+ * \brief Check if joint positions have been reached.
+ *
+ * \param goal containing the goal positions.
+ * \param current containing the current positions.
+ * \param condition specifying the condition [degrees or mm].
+ *
+ * \return bool indicating if the positions have been reached.
+ */
+static bool jointsReached(const Joints& goal, const Joints& current, const double condition)
+{
+  bool reached = true;
+
+  for (int i = 0; reached && i < goal.values_size() && i < current.values_size(); ++i)
+  {
+    reached = (std::abs(goal.values(i) - current.values(i)) < condition);
+  }
+
+  return reached;
+}
+
+/**
+ * \brief Estimate a goal's duration, based on the position differences to the current state.
+ *
+ * Note: Assumes 1 degree/s and 1 mm/s as desired velocities. The state can either be an EGM session's feedback, or
+ *       an interpolated state (i.e. both provide the same position accessors).
+ *
+ * \param goal containing the goal.
+ * \param current containing the current state.
+ * \param mode specifying the goal's mode.
+ *
+ * \return double containing the estimated duration [s].
+ */
+template <typename State>
+static double estimateDuration(const PointGoal& goal, const State& current, const EGMModes mode)
+{
+  double estimate = 0.0;
+
+  switch (mode)
+  {
+    case EGMJoint:
+    {
+      estimate = std::max(estimate, findMaxDifference(goal.robot().joints().position(),
+                                                      current.robot().joints().position()));
+    }
+    break;
+
+    case EGMPose:
+    {
+      estimate = findMaxDifference(goal.robot().cartesian().pose().position(),
+                                   current.robot().cartesian().pose().position());
+
+      Euler goal_euler;
+      Euler current_euler;
+      convert(&goal_euler, goal.robot().cartesian().pose().quaternion());
+      convert(&current_euler, current.robot().cartesian().pose().quaternion());
+      estimate = std::max(estimate, findMaxDifference(goal_euler, current_euler));
+    }
+    break;
+  }
+
+  estimate = std::max(estimate, findMaxDifference(goal.external().joints().position(),
+                                                  current.external().joints().position()));
+
+  return estimate;
+}
+
+/**
+ * \brief Prepare a goal, with values from a trajectory point.
+ *
+ * \param p_goal for the goal to prepare (absent values are kept from the preceding goal).
+ * \param point containing the trajectory point.
+ * \param current containing the current state.
+ * \param last_point indicating if it is the trajectory's last point.
+ */
+template <typename State>
+static void prepare(PointGoal* p_goal, const PointGoal& point, const State& current, const bool last_point)
+{
+  const unsigned int robot_joints = current.robot().joints().position().values_size();
+  const unsigned int external_joints = current.external().joints().position().values_size();
+
+  resetGoalMotion(p_goal, robot_joints, external_joints);
+
+  // Set up the goal's reach condition and zone.
+  p_goal->set_reach(point.has_reach() ? point.reach() : false);
+  p_goal->set_zone(point.has_zone() ? point.zone() : 0.0);
+
+  // Transfer the point's values.
+  transfer(p_goal, point.robot());
+  transfer(p_goal, point.external());
+
+  // Stop in the trajectory's last point.
+  if (last_point)
+  {
+    p_goal->set_reach(true);
+    p_goal->set_zone(0.0);
+    resetGoalMotion(p_goal, robot_joints, external_joints);
+  }
+
+  // Set up the goal's duration.
+  if (point.has_duration())
+  {
+    p_goal->set_duration(point.duration());
+  }
+  else
+  {
+    resetGoalMotion(p_goal, robot_joints, external_joints);
+    p_goal->set_duration(estimateDuration(*p_goal, current, (point.robot().has_cartesian() ? EGMPose : EGMJoint)));
+  }
+}
+
+/**
+ * \brief Check if a goal's positions have been reached.
+ *
+ * \param goal containing the goal.
+ * \param current containing the current state.
+ * \param mode specifying the goal's mode.
+ *
+ * \return bool indicating if the goal has been reached.
+ */
+template <typename State>
+static bool isReached(const PointGoal& goal, const State& current, const EGMModes mode)
+{
+  bool reached = true;
+  const double condition = std::max(REACH_CONDITION, goal.zone());
+
+  switch (mode)
+  {
+    case EGMJoint:
+    {
+      reached = jointsReached(goal.robot().joints().position(), current.robot().joints().position(), condition);
+    }
+    break;
+
+    case EGMPose:
+    {
+      const Cartesian& goal_position = goal.robot().cartesian().pose().position();
+      const Cartesian& current_position = current.robot().cartesian().pose().position();
+
+      // Note: The zone is not applied to the orientation, which must match exactly.
+      reached = (std::abs(goal_position.x() - current_position.x()) < condition &&
+                 std::abs(goal_position.y() - current_position.y()) < condition &&
+                 std::abs(goal_position.z() - current_position.z()) < condition &&
+                 std::abs(dotProduct(goal.robot().cartesian().pose().quaternion(),
+                                     current.robot().cartesian().pose().quaternion())) >= 1.0);
+    }
+    break;
+  }
+
+  return (reached &&
+          jointsReached(goal.external().joints().position(), current.external().joints().position(), condition));
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Trajectory goal functions
+ */
+
+void initializeGoal(PointGoal* p_goal, const PointGoal& start)
+{
+  p_goal->Clear();
+
+  // Copy the positions. Note: The goal's Euler field is used to contain angular velocities.
+  CartesianPose* p_pose = p_goal->mutable_robot()->mutable_cartesian()->mutable_pose();
+  p_goal->mutable_robot()->mutable_joints()->mutable_position()->CopyFrom(start.robot().joints().position());
+  p_pose->mutable_position()->CopyFrom(start.robot().cartesian().pose().position());
+  p_pose->mutable_quaternion()->CopyFrom(start.robot().cartesian().pose().quaternion());
+  p_goal->mutable_external()->mutable_joints()->mutable_position()->CopyFrom(start.external().joints().position());
+
+  resetGoalMotion(p_goal,
+                  p_goal->robot().joints().position().values_size(),
+                  p_goal->external().joints().position().values_size());
+}
+
+void resetGoalMotion(PointGoal* p_goal, const unsigned int robot_joints, const unsigned int external_joints)
+{
+  // Note: The goal's Euler field is used to contain angular velocities.
+  reset(p_goal->mutable_robot()->mutable_joints()->mutable_velocity(), robot_joints);
+  reset(p_goal->mutable_robot()->mutable_joints()->mutable_acceleration(), robot_joints);
+  reset(p_goal->mutable_robot()->mutable_cartesian()->mutable_velocity());
+  reset(p_goal->mutable_robot()->mutable_cartesian()->mutable_acceleration());
+  reset(p_goal->mutable_robot()->mutable_cartesian()->mutable_pose()->mutable_euler());
+  reset(p_goal->mutable_external()->mutable_joints()->mutable_velocity(), external_joints);
+  reset(p_goal->mutable_external()->mutable_joints()->mutable_acceleration(), external_joints);
+}
+
+void prepareGoal(PointGoal* p_goal, const PointGoal& point, const Feedback& current, const bool last_point)
+{
+  prepare(p_goal, point, current, last_point);
+}
+
+void prepareGoal(PointGoal* p_goal, const PointGoal& point, const PointGoal& current, const bool last_point)
+{
+  prepare(p_goal, point, current, last_point);
+}
+
+bool isGoalReached(const PointGoal& goal, const Feedback& current, const EGMModes mode)
+{
+  return isReached(goal, current, mode);
+}
+
+bool isGoalReached(const PointGoal& goal, const PointGoal& current, const EGMModes mode)
+{
+  return isReached(goal, current, mode);
+}
+
+} // end namespace egm
+} // end namespace abb
@@ -0,0 +1,253 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <algorithm>
+
+#include <boost/chrono.hpp>
+
+#include "abb_libegm/egm_common.h"
+#include "abb_libegm/egm_trajectory_group.h"
+
+namespace abb
+{
+namespace egm
+{
+/***********************************************************************************************************************
+ * Class definitions: EGMTrajectoryGroup
+ */
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const unsigned int EGMTrajectoryGroup::MAX_ESTIMATE_ATTEMPTS;
+
+/************************************************************
+ * Primary methods
+ */
+
+EGMTrajectoryGroup::EGMTrajectoryGroup()
+{}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+double EGMTrajectoryGroup::estimateLeadTime()
+{
+  double lead_time = Constants::RobotController::LOWEST_SAMPLE_TIME;
+
+  for (size_t i = 0; i < members_.size(); ++i)
+  {
+    ClockEstimate estimate;
+    bool retrieved = false;
+
+    // Note: A retrieval only fails if it overlaps with a publication, so it can simply be retried.
+    for (unsigned int j = 0; j < MAX_ESTIMATE_ATTEMPTS && !retrieved; ++j)
+    {
+      retrieved = members_[i]->retrieveClockEstimate(&estimate);
+    }
+
+    if (retrieved)
+    {
+      lead_time = std::max(lead_time, estimate.sample_time);
+    }
+  }
+
+  return lead_time;
+}
+
+void EGMTrajectoryGroup::pruneBarriers()
+{
+  std::vector<boost::shared_ptr<EGMStartBarrier> > remaining;
+
+  for (size_t i = 0; i < barriers_.size(); ++i)
+  {
+    if (!barriers_[i]->isDone())
+    {
+      remaining.push_back(barriers_[i]);
+    }
+  }
+
+  barriers_.swap(remaining);
+}
+
+/************************************************************
+ * User interaction methods
+ */
+
+bool EGMTrajectoryGroup::addMember(EGMTrajectoryInterface* p_member)
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+
+  if (!p_member || std::find(members_.begin(), members_.end(), p_member) != members_.end())
+  {
+    return false;
+  }
+
+  members_.push_back(p_member);
+
+  return true;
+}
+
+size_t EGMTrajectoryGroup::numberOfMembers()
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+
+  return members_.size();
+}
+
+bool EGMTrajectoryGroup::addTrajectories(const std::vector<wrapper::trajectory::TrajectoryGoal>& trajectories,
+                                         const bool override_trajectories,
+                                         const double start_delay)
+{
+  std::vector<boost::shared_ptr<const wrapper::trajectory::TrajectoryGoal> > shared_trajectories;
+
+  for (size_t i = 0; i < trajectories.size(); ++i)
+  {
+    shared_trajectories.push_back(boost::shared_ptr<const wrapper::trajectory::TrajectoryGoal>(
+                                    new wrapper::trajectory::TrajectoryGoal(trajectories[i])));
+  }
+
+  return addTrajectories(shared_trajectories, override_trajectories, start_delay);
+}
+
+bool EGMTrajectoryGroup::addTrajectories(
+  const std::vector<boost::shared_ptr<const wrapper::trajectory::TrajectoryGoal> >& trajectories,
+  const bool override_trajectories,
+  const double start_delay)
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+
+  if (members_.empty() || trajectories.size() != members_.size())
+  {
+    return false;
+  }
+
+  // Validate all members' trajectories before queueing any of them. Otherwise, with overriding, the members that had
+  // already accepted would have dropped their previous trajectories when a later member rejected.
+  for (size_t i = 0; i < trajectories.size(); ++i)
+  {
+    if (!trajectories[i] || !members_[i]->validateTrajectory(*trajectories[i]))
+    {
+      return false;
+    }
+  }
+
+  pruneBarriers();
+
+  const boost::chrono::steady_clock::time_point earliest_start =
+    boost::chrono::steady_clock::now() +
+    boost::chrono::duration_cast<boost::chrono::steady_clock::duration>(
+      boost::chrono::duration<double>(std::max(start_delay, 0.0)));
+
+  boost::shared_ptr<EGMStartBarrier> p_barrier(new EGMStartBarrier((unsigned int) members_.size(),
+                                                                   earliest_start,
+                                                                   estimateLeadTime()));
+
+  bool accepted = true;
+
+  for (size_t i = 0; i < members_.size() && accepted; ++i)
+  {
+    accepted = members_[i]->addSynchronizedTrajectory(trajectories[i], p_barrier, override_trajectories);
+  }
+
+  if (accepted)
+  {
+    barriers_.push_back(p_barrier);
+  }
+  else
+  {
+    // Make the members, that already accepted the trajectories, discard them.
+    p_barrier->cancel();
+  }
+
+  return accepted;
+}
+
+bool EGMTrajectoryGroup::stopTrajectories(const bool discard_trajectories)
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+
+  if (discard_trajectories)
+  {
+    // Note: Otherwise, the members that still have a pending synchronized trajectory would wait forever, if any other
+    //       member has discarded its trajectory before it was ready.
+    for (size_t i = 0; i < barriers_.size(); ++i)
+    {
+      barriers_[i]->cancel();
+    }
+
+    barriers_.clear();
+  }
+
+  bool accepted = !members_.empty();
+
+  for (size_t i = 0; i < members_.size(); ++i)
+  {
+    accepted = members_[i]->stopTrajectory(discard_trajectories) && accepted;
+  }
+
+  return accepted;
+}
+
+bool EGMTrajectoryGroup::resumeTrajectories()
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+
+  bool accepted = !members_.empty();
+
+  for (size_t i = 0; i < members_.size(); ++i)
+  {
+    accepted = members_[i]->resumeTrajectory() && accepted;
+  }
+
+  return accepted;
+}
+
+bool EGMTrajectoryGroup::updateDurationFactor(const double factor)
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+
+  bool accepted = !members_.empty();
+
+  for (size_t i = 0; i < members_.size(); ++i)
+  {
+    accepted = members_[i]->updateDurationFactor(factor) && accepted;
+  }
+
+  return accepted;
+}
+
+} // end namespace egm
+} // end namespace abb
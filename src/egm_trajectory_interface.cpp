@@ -38,10 +38,14 @@
 
 #include <math.h>
 
+#include <algorithm>
 #include <sstream>
 
 #include "abb_libegm/egm_common_auxiliary.h"
+#include "abb_libegm/egm_trajectory_blender.h"
+#include "abb_libegm/egm_trajectory_goal.h"
 #include "abb_libegm/egm_trajectory_interface.h"
+#include "abb_libegm/egm_trajectory_retimer.h"
 
 namespace abb
 {
@@ -51,6 +55,38 @@ namespace egm
 using namespace wrapper;
 using namespace wrapper::trajectory;
 
+typedef boost::shared_ptr<const TrajectoryGoal> SharedTrajectoryGoal;
+
+/***********************************************************************************************************************
+ * Struct definitions: EGMTrajectoryInterface::ProgressSnapshot
+ */
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const unsigned int EGMTrajectoryInterface::ProgressSnapshot::MAX_NUMBER_OF_JOINTS;
+
+EGMTrajectoryInterface::ProgressSnapshot::ProgressSnapshot()
+:
+sequence_number(0),
+state(ExecutionProgress_State_UNDEFINED),
+sub_state(ExecutionProgress_SubState_NONE),
+goal_active(false),
+point_index(-1),
+remaining_points(0),
+pending_trajectories(0),
+time_passed(0.0),
+duration(0.0),
+number_of_robot_joints(0),
+number_of_external_joints(0)
+{
+  std::fill(robot_joints, robot_joints + MAX_NUMBER_OF_JOINTS, 0.0);
+  std::fill(cartesian_position, cartesian_position + 3, 0.0);
+  std::fill(cartesian_quaternion, cartesian_quaternion + 4, 0.0);
+  std::fill(external_joints, external_joints + MAX_NUMBER_OF_JOINTS, 0.0);
+}
+
+
+
+
 /***********************************************************************************************************************
  * Class definitions: EGMTrajectoryInterface::TrajectoryMotion::StateManager
  */
@@ -193,6 +229,8 @@ wrapper::trajectory::ExecutionProgress_SubState EGMTrajectoryInterface::Trajecto
 
 void EGMTrajectoryInterface::TrajectoryMotion::MotionStep::resetMotionStep()
 {
+  has_prediction_ = false;
+
   unsigned int robot_joints = data.feedback.robot().joints().position().values_size();
   unsigned int external_joints = data.feedback.external().joints().position().values_size();
 
@@ -242,50 +280,11 @@ void EGMTrajectoryInterface::TrajectoryMotion::MotionStep::resetMotionStep()
 
 void EGMTrajectoryInterface::TrajectoryMotion::MotionStep::prepareNormalGoal(const bool last_point)
 {
-  unsigned int robot_joints = data.feedback.robot().joints().position().values_size();
-  unsigned int external_joints = data.feedback.external().joints().position().values_size();
-
   data.mode = (external_goal.robot().has_cartesian() ? EGMPose : EGMJoint);
 
-  // Reset the internal goal's velocity and acceleration values.
-  // Note: The Euler field is internally used to contain angular velocities.
-  reset(internal_goal.mutable_robot()->mutable_joints()->mutable_velocity(), robot_joints);
-  reset(internal_goal.mutable_robot()->mutable_joints()->mutable_acceleration(), robot_joints);
-  reset(internal_goal.mutable_robot()->mutable_cartesian()->mutable_velocity());
-  reset(internal_goal.mutable_robot()->mutable_cartesian()->mutable_acceleration());
-  reset(internal_goal.mutable_robot()->mutable_cartesian()->mutable_pose()->mutable_euler());
-  reset(internal_goal.mutable_external()->mutable_joints()->mutable_velocity(), external_joints);
-  reset(internal_goal.mutable_external()->mutable_joints()->mutable_acceleration(), external_joints);
-
-  // Set up the internal goal's reach condition.
-  internal_goal.set_reach(external_goal.has_reach() ? external_goal.reach() : false);
-
-  // Transfer external goal values to the internal goal.
-  transfer(external_goal.robot());
-  transfer(external_goal.external());
-
-  // Reset velocity and acceleration values, if it is the last point in the current trajectory.
-  if (last_point)
-  {
-    internal_goal.set_reach(true);
-
-    // Reset robot joint values.
-    reset(internal_goal.mutable_robot()->mutable_joints()->mutable_velocity(), robot_joints);
-    reset(internal_goal.mutable_robot()->mutable_joints()->mutable_acceleration(), robot_joints);
-
-    // Reset Cartesian values. Note: The Euler field is internally used to contain angular velocities.
-    reset(internal_goal.mutable_robot()->mutable_cartesian()->mutable_velocity());
-    reset(internal_goal.mutable_robot()->mutable_cartesian()->mutable_acceleration());
-    reset(internal_goal.mutable_robot()->mutable_cartesian()->mutable_pose()->mutable_euler());
-
-    // Reset external joint values.
-    reset(internal_goal.mutable_external()->mutable_joints()->mutable_velocity(), external_joints);
-    reset(internal_goal.mutable_external()->mutable_joints()->mutable_acceleration(), external_joints);
-  }
-
-  // Set up the internal goal's duration.
-  double duration = (external_goal.has_duration() ? external_goal.duration() : estimateDuration());
-  internal_goal.set_duration(data.duration_factor*duration);
+  // Transfer the external goal's values to the internal goal (and estimate the duration, if none has been specified).
+  prepareGoal(&internal_goal, external_goal, data.feedback, last_point);
+  internal_goal.set_duration(data.duration_factor*internal_goal.duration());
 
   // Prepare the interpolation conditions.
   interpolator_conditions_.mode = data.mode;
@@ -347,164 +346,13 @@ void EGMTrajectoryInterface::TrajectoryMotion::MotionStep::prepareStaticGoal(con
 
 bool EGMTrajectoryInterface::TrajectoryMotion::MotionStep::conditionMet()
 {
-  condition_met_ = true;
-
-  switch (data.mode)
-  {
-    case EGMJoint:
-    {
-      // Robot joints.
-      checkConditions(internal_goal.robot().joints().position(), data.feedback.robot().joints().position());
-
-      // External joints.
-      checkConditions(internal_goal.external().joints().position(), data.feedback.external().joints().position());
-    }
-    break;
-
-    case EGMPose:
-    {
-      // Position.
-      checkConditions(internal_goal.robot().cartesian().pose().position(),
-                      data.feedback.robot().cartesian().pose().position());
-
-      // Orientation.
-      checkConditions(internal_goal.robot().cartesian().pose().quaternion(),
-                      data.feedback.robot().cartesian().pose().quaternion());
-
-      // External joints.
-      checkConditions(internal_goal.external().joints().position(), data.feedback.external().joints().position());
-    }
-    break;
-  }
-
-  return condition_met_;
+  return isGoalReached(internal_goal, data.feedback, data.mode);
 }
 
 /************************************************************
  * Auxiliary methods
  */
 
-double EGMTrajectoryInterface::TrajectoryMotion::MotionStep::estimateDuration()
-{
-  // Note: The duration estimation should only be used if no duration has been specified externally, and it includes:
-  //       * Resetting any velocity and acceleration goals.
-  //       * Estimation of the duration based on the goal and feedback position differences,
-  //         and it assumes 1 degree/s and 1 mm/s as desired velocities.
-
-  double estimate = 0.0;
-
-  unsigned int robot_joints = data.feedback.robot().joints().position().values_size();
-  unsigned int external_joints = data.feedback.external().joints().position().values_size();
-
-  // Reset robot joint values.
-  reset(internal_goal.mutable_robot()->mutable_joints()->mutable_velocity(), robot_joints);
-  reset(internal_goal.mutable_robot()->mutable_joints()->mutable_acceleration(), robot_joints);
-
-  // Reset Cartesian values. Note: The Euler field is internally used to contain angular velocities.
-  reset(internal_goal.mutable_robot()->mutable_cartesian()->mutable_velocity());
-  reset(internal_goal.mutable_robot()->mutable_cartesian()->mutable_acceleration());
-  reset(internal_goal.mutable_robot()->mutable_cartesian()->mutable_pose()->mutable_euler());
-
-  // Reset external joint values.
-  reset(internal_goal.mutable_external()->mutable_joints()->mutable_velocity(), external_joints);
-  reset(internal_goal.mutable_external()->mutable_joints()->mutable_acceleration(), external_joints);
-
-  // Estimate the duration.
-  switch (data.mode)
-  {
-    case EGMJoint:
-    {
-      estimate = std::max(estimate, findMaxDifference(internal_goal.robot().joints().position(),
-                                                      data.feedback.robot().joints().position()));
-
-      estimate = std::max(estimate, findMaxDifference(internal_goal.external().joints().position(),
-                                                      data.feedback.external().joints().position()));
-    }
-    break;
-
-    case EGMPose:
-    {
-      estimate = findMaxDifference(internal_goal.robot().cartesian().pose().position(),
-                                   data.feedback.robot().cartesian().pose().position());
-
-      Euler temp;
-      convert(&temp, internal_goal.robot().cartesian().pose().quaternion());
-      estimate = std::max(estimate, findMaxDifference(temp, data.feedback.robot().cartesian().pose().euler()));
-
-      estimate = std::max(estimate, findMaxDifference(internal_goal.external().joints().position(),
-                                                      data.feedback.external().joints().position()));
-    }
-    break;
-  }
-
-  return estimate;
-}
-
-void EGMTrajectoryInterface::TrajectoryMotion::MotionStep::checkConditions(const Joints& feedback, const Joints& goal)
-{
-  for (int i = 0; condition_met_ && i < feedback.values_size() && i < goal.values_size(); ++i)
-  {
-    condition_met_ = (std::abs(feedback.values(i) - goal.values(i)) < CONDITION);
-  }
-}
-
-void EGMTrajectoryInterface::TrajectoryMotion::MotionStep::checkConditions(const Cartesian& feedback,
-                                                                           const Cartesian& goal)
-{
-  double delta_x = std::abs(feedback.x() - goal.x());
-  double delta_y = std::abs(feedback.y() - goal.y());
-  double delta_z = std::abs(feedback.z() - goal.z());
-
-  condition_met_ = (delta_x < CONDITION && delta_y < CONDITION && delta_z < CONDITION);
-}
-
-void EGMTrajectoryInterface::TrajectoryMotion::MotionStep::checkConditions(const Quaternion& feedback,
-                                                                           const Quaternion& goal)
-{
-  condition_met_ = (condition_met_ && std::abs(dotProduct(feedback, goal)) >= 1.0);
-}
-
-void EGMTrajectoryInterface::TrajectoryMotion::MotionStep::transfer(const RobotGoal& source)
-{
-  JointGoal* p_joints = internal_goal.mutable_robot()->mutable_joints();
-  CartesianGoal* p_cartesian = internal_goal.mutable_robot()->mutable_cartesian();
-
-  // Set up the internal robot joint goal.
-  copyPresent(p_joints->mutable_position(), source.joints().position());
-  copyPresent(p_joints->mutable_velocity(), source.joints().velocity());
-  copyPresent(p_joints->mutable_acceleration(), source.joints().acceleration());
-
-  // Set up the internal robot Cartesian goal.
-  copyPresent(p_cartesian->mutable_pose()->mutable_position(), source.cartesian().pose().position());
-  copyPresent(p_cartesian->mutable_velocity(), source.cartesian().velocity());
-  copyPresent(p_cartesian->mutable_acceleration(), source.cartesian().acceleration());
-
-  // Note: The internal goal's Euler field is used to contain angular velocities.
-  //       Therefore, convert any Euler goal to quaternions.
-  if (source.cartesian().pose().has_euler())
-  {
-    Euler temp;
-    convert(&temp, p_cartesian->mutable_pose()->quaternion());
-    copyPresent(&temp, source.cartesian().pose().euler());
-    convert(p_cartesian->mutable_pose()->mutable_quaternion(), temp);
-    normalize(p_cartesian->mutable_pose()->mutable_quaternion());
-  }
-  else if (source.cartesian().pose().has_quaternion())
-  {
-    copyPresent(p_cartesian->mutable_pose()->mutable_quaternion(), source.cartesian().pose().quaternion());
-  }
-}
-
-void EGMTrajectoryInterface::TrajectoryMotion::MotionStep::transfer(const ExternalGoal& source)
-{
-  JointGoal* p_joints = internal_goal.mutable_external()->mutable_joints();
-
-  // Set up the internal external joint goal.
-  copyPresent(p_joints->mutable_position(), source.joints().position());
-  copyPresent(p_joints->mutable_velocity(), source.joints().velocity());
-  copyPresent(p_joints->mutable_acceleration(), source.joints().acceleration());
-}
-
 void EGMTrajectoryInterface::TrajectoryMotion::MotionStep::transfer(const StaticPositionGoal& source)
 {
   JointGoal* p_robot_joints = internal_goal.mutable_robot()->mutable_joints();
@@ -560,7 +408,7 @@ void EGMTrajectoryInterface::TrajectoryMotion::MotionStep::transfer(const Static
 
 void EGMTrajectoryInterface::TrajectoryMotion::Controller::update(const States state,
                                                                   const MotionStep& motion_step,
-                                                                  const TrajectoryConfiguration& configurations)
+                                                                  const RuntimeConfiguration& configurations)
 {
   is_normal_state_ = (state == Normal);
   is_linear_ = (configurations.spline_method == TrajectoryConfiguration::Linear);
@@ -768,8 +616,8 @@ void EGMTrajectoryInterface::TrajectoryMotion::Controller::calculate(wrapper::Qu
 
 void EGMTrajectoryInterface::TrajectoryMotion::generateOutputs(Output* p_outputs, const InputContainer& inputs)
 {
-  boost::lock_guard<boost::mutex> data_lock(data_.mutex);
-  boost::lock_guard<boost::mutex> trajectory_lock(trajectories_.mutex);
+  RealTimeLockGuard<boost::mutex> data_lock(data_.mutex);
+  RealTimeLockGuard<boost::mutex> trajectory_lock(trajectories_.mutex);
 
   // Prepare for trajectory motion.
   prepare(inputs);
@@ -823,7 +671,14 @@ void EGMTrajectoryInterface::TrajectoryMotion::generateOutputs(Output* p_outputs
     data_.execution_progress.mutable_active_trajectory()->add_points()->CopyFrom(motion_step_.external_goal);
     if (trajectories_.p_current)
     {
-      trajectories_.p_current->copyTo(data_.execution_progress.mutable_active_trajectory());
+      trajectories_.p_current->copyTo(data_.execution_progress.mutable_active_trajectory(),
+                                      &data_.p_progress_points,
+                                      &data_.progress_points_index);
+    }
+    else
+    {
+      data_.p_progress_points.reset();
+      data_.progress_points_index = 0;
     }
     if (trajectories_.temporary_queue.size() > 0)
     {
@@ -834,6 +689,25 @@ void EGMTrajectoryInterface::TrajectoryMotion::generateOutputs(Output* p_outputs
       data_.execution_progress.set_pending_trajectories((unsigned int) trajectories_.primary_queue.size());
     }
     data_.has_updated_execution_progress = true;
+
+    // Publish a lightweight snapshot of the execution progress.
+    publishProgressSnapshot();
+
+    // Update the remaining duration of any active stream goal.
+    double remaining = motion_step_.internal_goal.duration() - motion_step_.data.time_passed;
+    stream_.active_remaining_us.store(stream_.is_active && remaining > 0.0 ? (boost::uint64_t) (remaining*1e6) : 0);
+  }
+}
+
+void EGMTrajectoryInterface::TrajectoryMotion::predictOutputs()
+{
+  // Note: The lock is needed, since user threads also read the data (e.g. the motion step's feedback when validating
+  //       trajectories). The prediction happens after the reply has been sent, so any wait only delays the prediction.
+  RealTimeLockGuard<boost::mutex> data_lock(data_.mutex);
+
+  if (data_.has_active_goal)
+  {
+    motion_step_.predictInterpolation();
   }
 }
 
@@ -846,6 +720,7 @@ void EGMTrajectoryInterface::TrajectoryMotion::prepare(const InputContainer& inp
   // Pre-prepare the auxiliary data.
   motion_step_.data.estimated_sample_time = inputs.estimatedSampleTime();
   motion_step_.data.feedback.CopyFrom(inputs.current().feedback());
+  message_time_ = inputs.clockEstimator().filteredReceiveTime();
 
   // Reset internal components, if a new EGM session has started.
   if (inputs.isFirstMessage())
@@ -872,8 +747,9 @@ void EGMTrajectoryInterface::TrajectoryMotion::prepare(const InputContainer& inp
       motion_step_.resetMotionStep();
       state_manager_.resetStateManager();
 
-      trajectories_.primary_queue.clear();
-      trajectories_.temporary_queue.clear();
+      retireQueue(&trajectories_.primary_queue);
+      retireQueue(&trajectories_.temporary_queue);
+      clearStream();
     }
   }
 
@@ -881,6 +757,80 @@ void EGMTrajectoryInterface::TrajectoryMotion::prepare(const InputContainer& inp
   data_.has_new_goal = false;
 }
 
+void EGMTrajectoryInterface::TrajectoryMotion::publishProgressSnapshot()
+{
+  const ExecutionProgress_State state = state_manager_.mapState();
+  const ExecutionProgress_SubState sub_state = state_manager_.mapSubState();
+
+  // Only notify about changes of the states, or of the active goal.
+  const bool changed = (data_.has_new_goal ||
+                        snapshot_.state != state ||
+                        snapshot_.sub_state != sub_state ||
+                        snapshot_.goal_active != data_.has_active_goal);
+
+  ++snapshot_.sequence_number;
+  snapshot_.state = state;
+  snapshot_.sub_state = sub_state;
+  snapshot_.goal_active = data_.has_active_goal;
+  snapshot_.point_index = (trajectories_.p_current ? trajectories_.p_current->lastIndex() : -1);
+  snapshot_.time_passed = motion_step_.data.time_passed;
+  snapshot_.duration = motion_step_.internal_goal.duration();
+
+  if (trajectories_.p_current)
+  {
+    snapshot_.remaining_points = (unsigned int) trajectories_.p_current->size();
+  }
+  else
+  {
+    snapshot_.remaining_points = (unsigned int) (stream_.is_active ? stream_.points.size() : 0);
+  }
+
+  if (trajectories_.temporary_queue.size() > 0)
+  {
+    snapshot_.pending_trajectories = (unsigned int) trajectories_.temporary_queue.size();
+  }
+  else
+  {
+    snapshot_.pending_trajectories = (unsigned int) trajectories_.primary_queue.size();
+  }
+
+  // Copy the goal's positions (truncated to the snapshot's fixed capacity).
+  const PointGoal& goal = motion_step_.internal_goal;
+  const Joints& robot = goal.robot().joints().position();
+  const Joints& external = goal.external().joints().position();
+  const Cartesian& position = goal.robot().cartesian().pose().position();
+  const Quaternion& quaternion = goal.robot().cartesian().pose().quaternion();
+
+  snapshot_.number_of_robot_joints = std::min((unsigned int) robot.values_size(),
+                                              ProgressSnapshot::MAX_NUMBER_OF_JOINTS);
+  for (unsigned int i = 0; i < snapshot_.number_of_robot_joints; ++i)
+  {
+    snapshot_.robot_joints[i] = robot.values((int) i);
+  }
+
+  snapshot_.number_of_external_joints = std::min((unsigned int) external.values_size(),
+                                                 ProgressSnapshot::MAX_NUMBER_OF_JOINTS);
+  for (unsigned int i = 0; i < snapshot_.number_of_external_joints; ++i)
+  {
+    snapshot_.external_joints[i] = external.values((int) i);
+  }
+
+  snapshot_.cartesian_position[0] = position.x();
+  snapshot_.cartesian_position[1] = position.y();
+  snapshot_.cartesian_position[2] = position.z();
+  snapshot_.cartesian_quaternion[0] = quaternion.u0();
+  snapshot_.cartesian_quaternion[1] = quaternion.u1();
+  snapshot_.cartesian_quaternion[2] = quaternion.u2();
+  snapshot_.cartesian_quaternion[3] = quaternion.u3();
+
+  snapshots_.store(snapshot_);
+
+  if (changed && configurations_.p_progress_cv)
+  {
+    configurations_.p_progress_cv->notify_all();
+  }
+}
+
 void EGMTrajectoryInterface::TrajectoryMotion::resetTrajectoryMotion()
 {
   if (trajectories_.p_current)
@@ -889,11 +839,18 @@ void EGMTrajectoryInterface::TrajectoryMotion::resetTrajectoryMotion()
     trajectories_.primary_queue.push_front(trajectories_.p_current);
     trajectories_.p_current.reset();
   }
+  else if (stream_.is_active)
+  {
+    storeNormalGoal();
+    stream_.is_active = false;
+  }
 
   data_.has_active_goal = false;
   data_.has_new_goal = false;
   data_.execution_progress.Clear();
   data_.has_updated_execution_progress = false;
+  data_.p_progress_points.reset();
+  data_.progress_points_index = 0;
 }
 
 void EGMTrajectoryInterface::TrajectoryMotion::processNormalState()
@@ -912,7 +869,7 @@ void EGMTrajectoryInterface::TrajectoryMotion::processNormalState()
       }
       else
       {
-        if (trajectories_.p_current)
+        if (trajectories_.p_current || stream_.is_active)
         {
           if (motion_step_.interpolationDurationReached())
           {
@@ -933,8 +890,26 @@ void EGMTrajectoryInterface::TrajectoryMotion::processNormalState()
         {
           if (!trajectories_.primary_queue.empty())
           {
-            trajectories_.p_current = trajectories_.primary_queue.front();
-            trajectories_.primary_queue.pop_front();
+            // Note: A synchronized trajectory waits until all interfaces in its group are ready to start.
+            const EGMStartBarrier::Status status =
+              trajectories_.primary_queue.front()->passStartBarrier(message_time_,
+                                                                    motion_step_.data.estimated_sample_time);
+
+            if (status == EGMStartBarrier::Released)
+            {
+              trajectories_.p_current = trajectories_.primary_queue.front();
+              trajectories_.primary_queue.pop_front();
+              updateNormalGoal();
+            }
+            else if (status == EGMStartBarrier::Cancelled)
+            {
+              retireTrajectory(&trajectories_.primary_queue.front());
+              trajectories_.primary_queue.pop_front();
+            }
+          }
+          else if (hasStreamPoints())
+          {
+            stream_.is_active = true;
             updateNormalGoal();
           }
         }
@@ -989,9 +964,10 @@ void EGMTrajectoryInterface::TrajectoryMotion::processRampDownState()
       // Handle the discard event.
       if (data_.pending_events.do_discard)
       {
-        trajectories_.p_current.reset();
-        trajectories_.primary_queue.clear();
+        retireTrajectory(&trajectories_.p_current);
+        retireQueue(&trajectories_.primary_queue);
         trajectories_.primary_queue.swap(trajectories_.temporary_queue);
+        clearStream();
         data_.pending_events.do_discard = false;
       }
 
@@ -1039,6 +1015,9 @@ void EGMTrajectoryInterface::TrajectoryMotion::processStaticGoalState()
         trajectories_.p_current.reset();
       }
 
+      // Any streamed points are resumed after the static goal has finished.
+      stream_.is_active = false;
+
       data_.has_active_goal = false;
       state_manager_.setPendingState(StaticGoal, Running);
     }
@@ -1100,7 +1079,8 @@ void EGMTrajectoryInterface::TrajectoryMotion::updateNormalGoal()
 
   if (trajectories_.p_current)
   {
-    if (trajectories_.p_current->retriveNextTrajectoryPoint(&motion_step_.external_goal))
+    if (trajectories_.p_current->retriveNextTrajectoryPoint(&motion_step_.external_goal,
+                                                            &motion_step_.external_goal_timing))
     {
       bool last_point = trajectories_.p_current->size() == 0;
 
@@ -1112,7 +1092,8 @@ void EGMTrajectoryInterface::TrajectoryMotion::updateNormalGoal()
           motion_step_.prepareNormalGoal(last_point);
           success = !motion_step_.conditionMet();
         }
-        while (!success && trajectories_.p_current->retriveNextTrajectoryPoint(&motion_step_.external_goal));
+        while (!success && trajectories_.p_current->retriveNextTrajectoryPoint(&motion_step_.external_goal,
+                                                                               &motion_step_.external_goal_timing));
       }
       else
       {
@@ -1123,7 +1104,22 @@ void EGMTrajectoryInterface::TrajectoryMotion::updateNormalGoal()
 
     if (!success && trajectories_.p_current->size() == 0)
     {
-      trajectories_.p_current.reset();
+      retireTrajectory(&trajectories_.p_current);
+    }
+  }
+  else if (stream_.is_active)
+  {
+    // Note: If the stream runs dry, then the retrived goal is treated as the last point of a trajectory.
+    while (!success && retriveNextStreamPoint(&motion_step_.external_goal))
+    {
+      motion_step_.external_goal_timing = EGMInterpolator::Timing();
+      motion_step_.prepareNormalGoal(!hasStreamPoints());
+      success = (motion_step_.external_goal.reach() ? !motion_step_.conditionMet() : true);
+    }
+
+    if (!success)
+    {
+      stream_.is_active = false;
     }
   }
 
@@ -1133,33 +1129,157 @@ void EGMTrajectoryInterface::TrajectoryMotion::updateNormalGoal()
 
 void EGMTrajectoryInterface::TrajectoryMotion::storeNormalGoal()
 {
-  if (trajectories_.p_current)
+  if (trajectories_.p_current || stream_.is_active)
   {
     motion_step_.external_goal.set_duration(std::max(Constants::RobotController::LOWEST_SAMPLE_TIME,
                                             motion_step_.internal_goal.duration() - motion_step_.data.time_passed));
 
-    trajectories_.p_current->addTrajectoryPointFront(motion_step_.external_goal);
+    if (trajectories_.p_current)
+    {
+      trajectories_.p_current->addTrajectoryPointFront(motion_step_.external_goal);
+    }
+    else
+    {
+      stream_.front_goal.CopyFrom(motion_step_.external_goal);
+      stream_.has_front_goal = true;
+    }
+  }
+}
+
+bool EGMTrajectoryInterface::TrajectoryMotion::retriveNextStreamPoint(PointGoal* p_point)
+{
+  bool result = false;
+
+  if (stream_.has_front_goal)
+  {
+    p_point->Swap(&stream_.front_goal);
+    stream_.has_front_goal = false;
+    result = true;
+  }
+  else
+  {
+    PointGoal* p_slot = stream_.points.readSlot();
+
+    if (p_slot)
+    {
+      // Note: Swap the point out of the slot, the producer reuses the slot's storage afterwards.
+      stream_.consumed_duration_us.fetch_add(durationInMicroseconds(*p_slot));
+      p_point->Swap(p_slot);
+      stream_.points.release();
+      result = true;
+    }
+  }
+
+  return result;
+}
+
+bool EGMTrajectoryInterface::TrajectoryMotion::hasStreamPoints()
+{
+  return stream_.has_front_goal || stream_.points.readSlot() != 0;
+}
+
+void EGMTrajectoryInterface::TrajectoryMotion::clearStream()
+{
+  PointGoal* p_slot = stream_.points.readSlot();
+
+  while (p_slot)
+  {
+    stream_.consumed_duration_us.fetch_add(durationInMicroseconds(*p_slot));
+    stream_.points.release();
+    p_slot = stream_.points.readSlot();
+  }
+
+  stream_.has_front_goal = false;
+  stream_.is_active = false;
+  stream_.active_remaining_us = 0;
+}
+
+void EGMTrajectoryInterface::TrajectoryMotion::retireTrajectory(boost::shared_ptr<Trajectory>* p_trajectory)
+{
+  if (*p_trajectory)
+  {
+    // Note: The capacity has been reserved by addTrajectory, so this never allocates.
+    trajectories_.retired.push_back(boost::shared_ptr<Trajectory>());
+    trajectories_.retired.back().swap(*p_trajectory);
+  }
+}
+
+void EGMTrajectoryInterface::TrajectoryMotion::reserveRetirements()
+{
+  // Reserve room for retiring every trajectory that the EGM communication loop currently knows about.
+  trajectories_.retired.reserve((trajectories_.p_current ? 1 : 0) +
+                                trajectories_.primary_queue.size() +
+                                trajectories_.temporary_queue.size());
+}
+
+void EGMTrajectoryInterface::TrajectoryMotion::retireQueue(std::deque<boost::shared_ptr<Trajectory> >* p_queue)
+{
+  for (size_t i = 0; i < p_queue->size(); ++i)
+  {
+    retireTrajectory(&(*p_queue)[i]);
   }
+
+  p_queue->clear();
+}
+
+bool EGMTrajectoryInterface::TrajectoryMotion::hasNumberOfJoints(const JointGoal& goal, const int number_of_joints)
+{
+  return ((!goal.has_position() || goal.position().values_size() == number_of_joints) &&
+          (!goal.has_velocity() || goal.velocity().values_size() == number_of_joints) &&
+          (!goal.has_acceleration() || goal.acceleration().values_size() == number_of_joints));
+}
+
+boost::uint64_t EGMTrajectoryInterface::TrajectoryMotion::durationInMicroseconds(const PointGoal& point)
+{
+  return (point.has_duration() && point.duration() > 0.0 ? (boost::uint64_t) (point.duration()*1e6) : 0);
 }
 
 /************************************************************
  * User interaction methods
  */
 
-bool EGMTrajectoryInterface::TrajectoryMotion::addTrajectory(const trajectory::TrajectoryGoal& trajectory,
-                                                             const bool override_trajectories)
+bool EGMTrajectoryInterface::TrajectoryMotion::addTrajectory(const SharedTrajectoryGoal& p_trajectory,
+                                                             const bool override_trajectories,
+                                                             const bool use_segment_cache,
+                                                             const boost::shared_ptr<EGMStartBarrier>& p_barrier)
 {
-  boost::shared_ptr<EGMTrajectoryInterface::Trajectory> p_traj(new EGMTrajectoryInterface::Trajectory(trajectory));
+  if (!p_trajectory)
+  {
+    return false;
+  }
+
+  // Note: Everything is prepared before the locks are acquired. The retired trajectories are declared before the
+  //       locks, so that they are released after the locks have been released.
+  boost::shared_ptr<EGMTrajectoryInterface::Trajectory> p_traj(new EGMTrajectoryInterface::Trajectory(p_trajectory,
+                                                                                                    p_barrier));
+  std::vector<boost::shared_ptr<EGMTrajectoryInterface::Trajectory> > retired;
+
+  if (use_segment_cache)
+  {
+    double duration_factor = 1.0;
+
+    {
+      boost::lock_guard<boost::mutex> lock(data_.mutex);
+      duration_factor = data_.pending_events.duration_factor;
+    }
+
+    // Note: The cached values are only used if they match the durations when the points are executed. I.e. they
+    //       are transparently recomputed if e.g. the duration factor is updated before then.
+    p_traj->precomputeTimings(duration_factor);
+  }
 
   boost::lock_guard<boost::mutex> data_lock(data_.mutex);
   boost::lock_guard<boost::mutex> trajectory_lock(trajectories_.mutex);
 
+  retired.swap(trajectories_.retired);
+
   bool accepted = state_manager_.verifyState(Normal, Running);
 
   if (accepted)
   {
     if (override_trajectories)
     {
+      retired.insert(retired.end(), trajectories_.temporary_queue.begin(), trajectories_.temporary_queue.end());
       trajectories_.temporary_queue.clear();
       trajectories_.temporary_queue.push_back(p_traj);
       data_.pending_events.do_ramp_down = true;
@@ -1180,21 +1300,75 @@ bool EGMTrajectoryInterface::TrajectoryMotion::addTrajectory(const trajectory::T
     }
   }
 
+  reserveRetirements();
+
   return accepted;
 }
 
-bool EGMTrajectoryInterface::TrajectoryMotion::stopTrajectory(const bool discard_trajectories)
+void EGMTrajectoryInterface::TrajectoryMotion::releaseRetiredTrajectories()
 {
-  boost::lock_guard<boost::mutex> lock(data_.mutex);
+  // Note: The retired trajectories are released after the lock has been released.
+  std::vector<boost::shared_ptr<EGMTrajectoryInterface::Trajectory> > retired;
 
-  bool accepted = state_manager_.verifyState(Normal, Running);
+  boost::lock_guard<boost::mutex> lock(trajectories_.mutex);
 
-  if (accepted)
+  if (!trajectories_.retired.empty())
   {
-    data_.pending_events.do_ramp_down = true;
-    data_.pending_events.do_stop = true;
-    data_.pending_events.do_discard = discard_trajectories;
+    retired.swap(trajectories_.retired);
+    reserveRetirements();
   }
+}
+
+bool EGMTrajectoryInterface::TrajectoryMotion::validateTrajectory(const TrajectoryGoal& trajectory)
+{
+  int robot_joints = 0;
+  int external_joints = 0;
+
+  {
+    boost::lock_guard<boost::mutex> lock(data_.mutex);
+
+    if (!state_manager_.verifyState(Normal, Running))
+    {
+      return false;
+    }
+
+    robot_joints = motion_step_.data.feedback.robot().joints().position().values_size();
+    external_joints = motion_step_.data.feedback.external().joints().position().values_size();
+  }
+
+  for (int i = 0; i < trajectory.points_size(); ++i)
+  {
+    const PointGoal& point = trajectory.points(i);
+
+    if ((point.robot().has_cartesian() && robot_joints == 0) ||
+        !hasNumberOfJoints(point.robot().joints(), robot_joints) ||
+        !hasNumberOfJoints(point.external().joints(), external_joints))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool EGMTrajectoryInterface::TrajectoryMotion::stopTrajectory(const bool discard_trajectories)
+{
+  bool accepted = false;
+
+  {
+    boost::lock_guard<boost::mutex> lock(data_.mutex);
+
+    accepted = state_manager_.verifyState(Normal, Running);
+
+    if (accepted)
+    {
+      data_.pending_events.do_ramp_down = true;
+      data_.pending_events.do_stop = true;
+      data_.pending_events.do_discard = discard_trajectories;
+    }
+  }
+
+  releaseRetiredTrajectories();
 
   return accepted;
 }
@@ -1304,20 +1478,103 @@ bool EGMTrajectoryInterface::TrajectoryMotion::finishStaticGoal(const bool resum
 
 bool EGMTrajectoryInterface::TrajectoryMotion::retrieveExecutionProgress(trajectory::ExecutionProgress* p_progress)
 {
-  bool result = false;
+  SharedTrajectoryGoal p_points;
+  int index = 0;
 
-  boost::lock_guard<boost::mutex> lock(data_.mutex);
+  bool result = retrieveExecutionProgress(p_progress, &p_points, &index);
 
-  if (data_.execution_progress.has_inputs())
+  // Add the active trajectory's remaining points (outside of the lock, since the shared points are never modified).
+  if (p_points && index < p_points->points_size())
   {
-    p_progress->CopyFrom(data_.execution_progress);
-    result = data_.has_updated_execution_progress;
-    data_.has_updated_execution_progress = false;
+    google::protobuf::RepeatedPtrField<PointGoal>* p_remaining =
+      p_progress->mutable_active_trajectory()->mutable_points();
+
+    p_remaining->Reserve(p_remaining->size() + p_points->points_size() - index);
+
+    for (int i = index; i < p_points->points_size(); ++i)
+    {
+      p_remaining->Add()->CopyFrom(p_points->points(i));
+    }
+  }
+
+  return result;
+}
+
+bool EGMTrajectoryInterface::TrajectoryMotion::retrieveExecutionProgress(trajectory::ExecutionProgress* p_progress,
+                                                                         SharedTrajectoryGoal* p_points,
+                                                                         int* p_index)
+{
+  bool result = false;
+
+  {
+    boost::lock_guard<boost::mutex> lock(data_.mutex);
+
+    if (data_.execution_progress.has_inputs())
+    {
+      p_progress->CopyFrom(data_.execution_progress);
+      result = data_.has_updated_execution_progress;
+      data_.has_updated_execution_progress = false;
+      *p_points = data_.p_progress_points;
+      *p_index = data_.progress_points_index;
+    }
   }
 
+  releaseRetiredTrajectories();
+
   return result;
 }
 
+bool EGMTrajectoryInterface::TrajectoryMotion::retrieveProgressSnapshot(ProgressSnapshot* p_snapshot) const
+{
+  return snapshots_.tryLoad(p_snapshot);
+}
+
+bool EGMTrajectoryInterface::TrajectoryMotion::pushPoint(const PointGoal& point)
+{
+  boost::lock_guard<boost::mutex> lock(stream_.producer_mutex);
+
+  PointGoal* p_slot = stream_.points.writeSlot();
+
+  if (p_slot)
+  {
+    // Note: Account for the duration before publishing, so that the consumed durations never exceed the pushed.
+    p_slot->CopyFrom(point);
+    stream_.pushed_duration_us.fetch_add(durationInMicroseconds(point));
+    stream_.points.publish();
+  }
+
+  return p_slot != 0;
+}
+
+size_t EGMTrajectoryInterface::TrajectoryMotion::pushPoints(const TrajectoryGoal& trajectory)
+{
+  size_t pushed = 0;
+
+  while ((int) pushed < trajectory.points_size() && pushPoint(trajectory.points((int) pushed)))
+  {
+    ++pushed;
+  }
+
+  return pushed;
+}
+
+EGMTrajectoryInterface::StreamStatus EGMTrajectoryInterface::TrajectoryMotion::getStreamStatus()
+{
+  StreamStatus status;
+
+  // Note: Load the consumed durations first, so that the difference never becomes negative.
+  const boost::uint64_t consumed = stream_.consumed_duration_us.load();
+  const boost::uint64_t pushed = stream_.pushed_duration_us.load();
+
+  status.capacity = stream_.points.capacity();
+  status.number_of_points = stream_.points.size();
+  status.queued_duration = (pushed - consumed)*1e-6;
+  status.estimated_time_remaining = status.queued_duration + stream_.active_remaining_us.load()*1e-6;
+  status.active = stream_.is_active;
+
+  return status;
+}
+
 
 
 
@@ -1333,20 +1590,30 @@ EGMTrajectoryInterface::EGMTrajectoryInterface(boost::asio::io_service& io_servi
                                                const unsigned short port_number,
                                                const TrajectoryConfiguration& configuration)
 :
-EGMBaseInterface(io_service, port_number),
+EGMBaseInterface(io_service, port_number, configuration.base, false),
 configuration_(configuration),
 trajectory_motion_(configuration)
 {
-  if (configuration_.active.base.use_logging)
-  {
-    std::stringstream ss;
-    ss << "port_" << port_number << +"_log.csv";
-    p_logger_.reset(new EGMLogger(ss.str()));
-  }
+  // Start the server once the interface has been fully constructed, so the callbacks never see a partial object.
+  udp_server_.start();
+}
+
+EGMTrajectoryInterface::~EGMTrajectoryInterface()
+{
+  udp_server_.stop();
 }
 
 const std::string& EGMTrajectoryInterface::callback(const UDPServerData& server_data)
 {
+  // Check the callback's real-time safety (if built with the checks).
+  ScopedRealTimeSection real_time_section(rt_checker_);
+
+  // Apply any requested configuration changes (that are allowed during a session).
+  refreshConfiguration();
+
+  // Start collecting statistics for the callback, if set to do so.
+  statistics_.startCycle(configuration_.p_active->base.use_statistics, server_data.receive_time);
+
   // Initialize the callback by:
   // - Parsing and extracting data from the received message.
   // - Updating any pending configuration changes.
@@ -1354,7 +1621,7 @@ const std::string& EGMTrajectoryInterface::callback(const UDPServerData& server_
   if (initializeCallback(server_data))
   {
     // Handle demo execution or trajectory execution.
-    if (configuration_.active.base.use_demo_outputs)
+    if (configuration_.p_active->base.use_demo_outputs)
     {
       outputs_.generateDemoOutputs(inputs_);
     }
@@ -1363,28 +1630,68 @@ const std::string& EGMTrajectoryInterface::callback(const UDPServerData& server_
       trajectory_motion_.generateOutputs(&outputs_.current, inputs_);
     }
 
+    statistics_.markStage(EGMStatisticsCollector::Outputs);
+
     // Log inputs and outputs.
-    if (configuration_.active.base.use_logging && p_logger_)
+    if (configuration_.p_active->base.use_logging)
     {
-      logData(inputs_, outputs_, configuration_.active.base.max_logging_duration);
+      logData(inputs_, outputs_, configuration_.p_active->base.max_logging_duration);
+      statistics_.markStage(EGMStatisticsCollector::Logging);
     }
 
     // Constuct the reply message.
-    outputs_.constructReply(configuration_.active.base);
+    outputs_.constructReply(configuration_.p_active->base);
+    statistics_.markStage(EGMStatisticsCollector::Reply);
+
+    // Publish the (optional) telemetry.
+    if (p_telemetry_)
+    {
+      p_telemetry_->add(inputs_.current(), outputs_.current);
+    }
 
     // Prepare for the next callback.
     inputs_.updatePrevious();
     outputs_.updatePrevious();
+
+    // Signal the (optional) event descriptor.
+    event_notifier_.notify();
   }
 
+  statistics_.endCycle();
+
   // Return the reply.
   return outputs_.reply();
 }
 
+void EGMTrajectoryInterface::postReply()
+{
+  if (configuration_.p_active->use_predictive_outputs && !configuration_.p_active->base.use_demo_outputs)
+  {
+    trajectory_motion_.predictOutputs();
+  }
+}
+
 /************************************************************
  * Auxiliary methods
  */
 
+void EGMTrajectoryInterface::refreshConfiguration()
+{
+  if (configuration_.snapshots.refresh())
+  {
+    const TrajectoryConfiguration& latest = configuration_.snapshots.current();
+
+    // Note: Only the runtime parameters are applied here (the full configuration is applied when a session starts).
+    applyRuntimeParameters(&configuration_.p_active->base, latest.base);
+    configuration_.p_active->spline_method = latest.spline_method;
+    configuration_.p_active->use_predictive_outputs = latest.use_predictive_outputs;
+    configuration_.p_active->p_progress_cv = latest.p_progress_cv;
+    configuration_.has_pending_update = true;
+
+    trajectory_motion_.updateConfigurations(RuntimeConfiguration(*configuration_.p_active));
+  }
+}
+
 bool EGMTrajectoryInterface::initializeCallback(const UDPServerData& server_data)
 {
   bool success = false;
@@ -1392,30 +1699,50 @@ bool EGMTrajectoryInterface::initializeCallback(const UDPServerData& server_data
   // Parse the received message.
   if (server_data.p_data)
   {
-    success = inputs_.parseFromArray(server_data.p_data, server_data.bytes_transferred);
+    success = inputs_.parseFromArray(server_data.p_data,
+                                     server_data.bytes_transferred,
+                                     configuration_.p_active->base.use_fast_input_parsing);
+
+    statistics_.markStage(EGMStatisticsCollector::Parse);
   }
 
-  // Update configurations, if requested to do so.
-  if (success && inputs_.isFirstMessage())
+  // Update the session parameters, if requested to do so.
+  if (success && inputs_.isFirstMessage() && configuration_.has_pending_update)
   {
-    boost::lock_guard<boost::mutex> lock(configuration_.mutex);
+    // Note: The prepared configuration was copied by a user thread, so it is only swapped in here. If a user thread
+    //       is replacing it at the moment, then the update is postponed to the next session instead of waiting.
+    boost::unique_lock<boost::mutex> lock(configuration_.prepared_mutex, boost::try_to_lock);
 
-    if (configuration_.has_pending_update)
+    if (lock.owns_lock())
     {
-      configuration_.active = configuration_.update;
-      configuration_.has_pending_update = false;
+      if (configuration_.has_prepared_update)
+      {
+        configuration_.p_active.swap(configuration_.p_prepared);
+        configuration_.has_prepared_update = false;
+
+        trajectory_motion_.updateConfigurations(RuntimeConfiguration(*configuration_.p_active));
+      }
 
-      trajectory_motion_.updateConfigurations(configuration_.active);
+      configuration_.has_pending_update = false;
     }
   }
 
   // Extract information from the parsed message.
   if (success)
   {
-    success = inputs_.extractParsedInformation(configuration_.active.base.axes);
+    success = inputs_.extractParsedInformation(configuration_.p_active->base.axes, server_data.receive_time);
+
+    statistics_.markStage(EGMStatisticsCollector::Extract);
+
+    if (success)
+    {
+      statistics_.updateSequence(inputs_.isFirstMessage(),
+                                 inputs_.current().header().sequence_number(),
+                                 inputs_.estimatedSampleTime());
+    }
 
     {
-      boost::lock_guard<boost::mutex> lock(session_data_.mutex);
+      RealTimeLockGuard<boost::mutex> lock(session_data_.mutex);
 
       // Update the session data.
       if (success)
@@ -1429,6 +1756,16 @@ bool EGMTrajectoryInterface::initializeCallback(const UDPServerData& server_data
         session_data_.status.Clear();
       }
     }
+
+    // Update the connection's liveness.
+    if (success)
+    {
+      connection_monitor_.update(server_data.receive_time, inputs_.isFirstMessage());
+    }
+    else
+    {
+      connection_monitor_.invalidate();
+    }
   }
 
   // Prepare the outputs.
@@ -1441,29 +1778,128 @@ bool EGMTrajectoryInterface::initializeCallback(const UDPServerData& server_data
   return success;
 }
 
+bool EGMTrajectoryInterface::queueTrajectory(const SharedTrajectoryGoal& p_trajectory,
+                                             const bool override_trajectories,
+                                             const boost::shared_ptr<EGMStartBarrier>& p_barrier)
+{
+  // Note: The retiming and segment cache parameters are applied directly (they are only used by the user thread).
+  const TrajectoryConfiguration configuration = configuration_.snapshots.latest();
+
+  const bool use_retiming = configuration.retiming.use_retiming;
+  const bool use_blending = p_trajectory && EGMTrajectoryBlender::hasZones(*p_trajectory);
+
+  if (p_trajectory && (use_retiming || use_blending))
+  {
+    // Note: The shared points must never be modified, so a processed copy is added instead.
+    boost::shared_ptr<TrajectoryGoal> p_processed(new TrajectoryGoal(*p_trajectory));
+    EGMTrajectoryRetimer retimer(configuration);
+
+    if (use_retiming)
+    {
+      retimer.retime(p_processed.get());
+    }
+
+    // Note: The blended velocities depend on the durations, and they allow shorter durations (if retiming is used).
+    if (use_blending)
+    {
+      EGMTrajectoryBlender blender;
+
+      if (blender.blend(p_processed.get()) && use_retiming)
+      {
+        retimer.retime(p_processed.get());
+      }
+    }
+
+    return trajectory_motion_.addTrajectory(p_processed,
+                                            override_trajectories,
+                                            configuration.use_segment_cache,
+                                            p_barrier);
+  }
+
+  return trajectory_motion_.addTrajectory(p_trajectory,
+                                          override_trajectories,
+                                          configuration.use_segment_cache,
+                                          p_barrier);
+}
+
 /************************************************************
  * User interaction methods
  */
 
 TrajectoryConfiguration EGMTrajectoryInterface::getConfiguration()
 {
-  boost::lock_guard<boost::mutex> lock(configuration_.mutex);
-
-  return configuration_.update;
+  return configuration_.snapshots.latest();
 }
 
 void EGMTrajectoryInterface::setConfiguration(const TrajectoryConfiguration& configuration)
 {
-  boost::lock_guard<boost::mutex> lock(configuration_.mutex);
+  // Note: The full copy for the next session is made here, and the replaced copy is released after the lock has been
+  //       released. The copy is prepared before the snapshot is published, so that it is never older than the
+  //       snapshot that the EGM communication loop sees.
+  boost::shared_ptr<TrajectoryConfiguration> p_prepared(new TrajectoryConfiguration(configuration));
+
+  boost::lock_guard<boost::mutex> lock(configuration_.prepared_mutex);
+
+  configuration_.p_prepared.swap(p_prepared);
+  configuration_.has_prepared_update = true;
+  configuration_.snapshots.publish(configuration);
+}
+
+bool EGMTrajectoryInterface::addTrajectory(const trajectory::TrajectoryGoal& trajectory,
+                                           const bool override_trajectories)
+{
+  SharedTrajectoryGoal p_trajectory(new TrajectoryGoal(trajectory));
+
+  return addTrajectory(p_trajectory, override_trajectories);
+}
+
+bool EGMTrajectoryInterface::addTrajectory(trajectory::TrajectoryGoal* p_trajectory,
+                                           const bool override_trajectories)
+{
+  bool result = false;
+
+  if (p_trajectory)
+  {
+    boost::shared_ptr<TrajectoryGoal> p_shared(new TrajectoryGoal());
+    p_shared->Swap(p_trajectory);
+
+    result = addTrajectory(SharedTrajectoryGoal(p_shared), override_trajectories);
+  }
 
-  configuration_.update = configuration;
-  configuration_.has_pending_update = true;
+  return result;
 }
 
-bool EGMTrajectoryInterface::addTrajectory(const trajectory::TrajectoryGoal trajectory,
+bool EGMTrajectoryInterface::addTrajectory(const SharedTrajectoryGoal& p_trajectory,
                                            const bool override_trajectories)
 {
-  return trajectory_motion_.addTrajectory(trajectory, override_trajectories);
+  return queueTrajectory(p_trajectory, override_trajectories, boost::shared_ptr<EGMStartBarrier>());
+}
+
+bool EGMTrajectoryInterface::addSynchronizedTrajectory(const SharedTrajectoryGoal& p_trajectory,
+                                                       const boost::shared_ptr<EGMStartBarrier>& p_barrier,
+                                                       const bool override_trajectories)
+{
+  return queueTrajectory(p_trajectory, override_trajectories, p_barrier);
+}
+
+bool EGMTrajectoryInterface::validateTrajectory(const trajectory::TrajectoryGoal& trajectory)
+{
+  return trajectory_motion_.validateTrajectory(trajectory);
+}
+
+bool EGMTrajectoryInterface::pushPoint(const trajectory::PointGoal& point)
+{
+  return trajectory_motion_.pushPoint(point);
+}
+
+size_t EGMTrajectoryInterface::pushPoints(const trajectory::TrajectoryGoal& trajectory)
+{
+  return trajectory_motion_.pushPoints(trajectory);
+}
+
+EGMTrajectoryInterface::StreamStatus EGMTrajectoryInterface::getStreamStatus()
+{
+  return trajectory_motion_.getStreamStatus();
 }
 
 bool EGMTrajectoryInterface::stopTrajectory(const bool discard_trajectories)
@@ -1513,5 +1949,39 @@ bool EGMTrajectoryInterface::retrieveExecutionProgress(trajectory::ExecutionProg
   return result;
 }
 
+bool EGMTrajectoryInterface::retrieveExecutionProgress(trajectory::ExecutionProgress* p_execution_progress,
+                                                       boost::shared_ptr<const trajectory::TrajectoryGoal>* p_points,
+                                                       int* p_first_remaining_point)
+{
+  bool result = false;
+
+  if (p_execution_progress && p_points && p_first_remaining_point)
+  {
+    p_points->reset();
+    *p_first_remaining_point = 0;
+
+    result = trajectory_motion_.retrieveExecutionProgress(p_execution_progress, p_points, p_first_remaining_point);
+  }
+
+  return result;
+}
+
+void EGMTrajectoryInterface::releaseRetiredTrajectories()
+{
+  trajectory_motion_.releaseRetiredTrajectories();
+}
+
+bool EGMTrajectoryInterface::retrieveProgressSnapshot(ProgressSnapshot* p_snapshot)
+{
+  bool result = false;
+
+  if (p_snapshot)
+  {
+    result = trajectory_motion_.retrieveProgressSnapshot(p_snapshot);
+  }
+
+  return result;
+}
+
 } // end namespace egm
 } // end namespace abb
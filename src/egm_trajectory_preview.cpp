@@ -0,0 +1,269 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+#include "abb_libegm/egm_common_auxiliary.h"
+#include "abb_libegm/egm_trajectory_goal.h"
+#include "abb_libegm/egm_trajectory_preview.h"
+
+namespace abb
+{
+namespace egm
+{
+using namespace wrapper;
+using namespace wrapper::trajectory;
+
+/***********************************************************************************************************************
+ * Class definitions: EGMTrajectoryPreviewer
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const size_t EGMTrajectoryPreviewer::MIN_SAMPLES_PER_TASK;
+
+EGMTrajectoryPreviewer::EGMTrajectoryPreviewer(const unsigned int number_of_workers)
+:
+p_work_(new boost::asio::io_service::work(io_service_)),
+number_of_workers_(number_of_workers)
+{
+  for (unsigned int i = 0; i < number_of_workers_; ++i)
+  {
+    worker_threads_.create_thread(boost::bind(&EGMTrajectoryPreviewer::workerThread, this));
+  }
+}
+
+EGMTrajectoryPreviewer::~EGMTrajectoryPreviewer()
+{
+  p_work_.reset();
+  io_service_.stop();
+  worker_threads_.join_all();
+}
+
+bool EGMTrajectoryPreviewer::preview(const PointGoal& start,
+                                     const TrajectoryGoal& trajectory,
+                                     const TrajectoryConfiguration& configuration,
+                                     TrajectoryPreview* p_preview,
+                                     const double sample_time)
+{
+  if (!p_preview || sample_time <= 0.0)
+  {
+    return false;
+  }
+
+  p_preview->number_of_segments = 0;
+  p_preview->number_of_samples = 0;
+  p_preview->duration = 0.0;
+
+  //---------------------------------------------------------
+  // Determine the segments (sequentially).
+  //
+  // Note: Each segment starts where the preceding segment's
+  //       last sample ended, exactly as during an EGM session.
+  //---------------------------------------------------------
+  PointGoal goal;
+  PointGoal current;
+  initializeGoal(&goal, start);
+  current.CopyFrom(goal);
+
+  for (int i = 0; i < trajectory.points_size(); ++i)
+  {
+    const PointGoal& point = trajectory.points(i);
+    const EGMModes mode = (point.robot().has_cartesian() ? EGMPose : EGMJoint);
+
+    prepareGoal(&goal, point, current, i == trajectory.points_size() - 1);
+
+    // Skip points that should be reached, but already are.
+    if (point.reach() && isGoalReached(goal, current, mode))
+    {
+      continue;
+    }
+
+    if (p_preview->number_of_segments >= p_preview->segments.size())
+    {
+      p_preview->segments.resize(p_preview->number_of_segments + 1);
+    }
+
+    TrajectoryPreview::Segment& segment = p_preview->segments[p_preview->number_of_segments];
+
+    EGMInterpolator::Conditions conditions;
+    conditions.mode = mode;
+    conditions.duration = goal.duration();
+    conditions.operation = EGMInterpolator::Normal;
+    conditions.spline_method = configuration.spline_method;
+
+    current.set_reach(goal.reach());
+    current.set_duration(conditions.duration);
+
+    segment.point_index = i;
+    segment.start.CopyFrom(current);
+    segment.goal.CopyFrom(goal);
+    segment.interpolator.update(current, goal, conditions);
+
+    // Count the samples until the interpolation duration is reached.
+    double t = 0.0;
+    size_t number_of_samples = 0;
+    do
+    {
+      t += sample_time;
+      ++number_of_samples;
+    }
+    while (segment.interpolator.getDuration() - t >= 0.5*Constants::RobotController::LOWEST_SAMPLE_TIME);
+
+    segment.sample_offset = p_preview->number_of_samples;
+    segment.number_of_samples = number_of_samples;
+    segment.start_time = p_preview->duration;
+
+    // Evaluate the segment's end state (i.e. the next segment's start state).
+    segment.interpolator.evaluate(&current, sample_time, t);
+
+    p_preview->number_of_segments++;
+    p_preview->number_of_samples += number_of_samples;
+    p_preview->duration += t;
+  }
+
+  if (p_preview->samples.size() < p_preview->number_of_samples)
+  {
+    p_preview->samples.resize(p_preview->number_of_samples);
+    p_preview->sample_times.resize(p_preview->number_of_samples);
+  }
+
+  //---------------------------------------------------------
+  // Sample the segments (in parallel).
+  //
+  // Note: The segments are split into contiguous ranges with
+  //       roughly equal number of samples. The last range is
+  //       sampled by the calling thread.
+  //---------------------------------------------------------
+  const size_t number_of_tasks = std::max<size_t>(1, std::min<size_t>(number_of_workers_ + 1,
+                                                                       p_preview->number_of_samples /
+                                                                       MIN_SAMPLES_PER_TASK));
+  const size_t samples_per_task = p_preview->number_of_samples / number_of_tasks;
+
+  Completion completion;
+  size_t begin = 0;
+  size_t accumulated = 0;
+
+  for (size_t i = 0; i < p_preview->number_of_segments; ++i)
+  {
+    accumulated += p_preview->segments[i].number_of_samples;
+
+    if (accumulated >= samples_per_task && i + 1 < p_preview->number_of_segments && number_of_workers_ > 0)
+    {
+      {
+        boost::lock_guard<boost::mutex> lock(completion.mutex);
+        ++completion.remaining;
+      }
+
+      io_service_.post(boost::bind(&EGMTrajectoryPreviewer::sampleTask,
+                                   p_preview, begin, i + 1, sample_time, &completion));
+      begin = i + 1;
+      accumulated = 0;
+    }
+  }
+
+  sampleSegments(p_preview, begin, p_preview->number_of_segments, sample_time);
+
+  boost::unique_lock<boost::mutex> lock(completion.mutex);
+  while (completion.remaining > 0)
+  {
+    completion.condition.wait(lock);
+  }
+
+  return true;
+}
+
+unsigned int EGMTrajectoryPreviewer::numberOfWorkers() const
+{
+  return number_of_workers_;
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+void EGMTrajectoryPreviewer::workerThread()
+{
+  io_service_.run();
+}
+
+void EGMTrajectoryPreviewer::sampleTask(TrajectoryPreview* p_preview,
+                                        const size_t begin,
+                                        const size_t end,
+                                        const double sample_time,
+                                        Completion* p_completion)
+{
+  sampleSegments(p_preview, begin, end, sample_time);
+
+  boost::lock_guard<boost::mutex> lock(p_completion->mutex);
+  if (--p_completion->remaining == 0)
+  {
+    p_completion->condition.notify_all();
+  }
+}
+
+void EGMTrajectoryPreviewer::sampleSegments(TrajectoryPreview* p_preview,
+                                            const size_t begin,
+                                            const size_t end,
+                                            const double sample_time)
+{
+  for (size_t i = begin; i < end; ++i)
+  {
+    TrajectoryPreview::Segment& segment = p_preview->segments[i];
+
+    // Note: Accumulate the time instances in the same way as the trajectory interface.
+    double t = 0.0;
+
+    for (size_t j = 0; j < segment.number_of_samples; ++j)
+    {
+      t += sample_time;
+
+      PointGoal& sample = p_preview->samples[segment.sample_offset + j];
+      sample.CopyFrom(segment.start);
+      segment.interpolator.evaluate(&sample, sample_time, t);
+
+      p_preview->sample_times[segment.sample_offset + j] = segment.start_time + t;
+    }
+  }
+}
+
+} // end namespace egm
+} // end namespace abb
@@ -0,0 +1,244 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "abb_libegm/egm_common_auxiliary.h"
+#include "abb_libegm/egm_trajectory_goal.h"
+#include "abb_libegm/egm_trajectory_retimer.h"
+
+namespace abb
+{
+namespace egm
+{
+using namespace wrapper;
+using namespace wrapper::trajectory;
+
+/***********************************************************************************************************************
+ * Class definitions: EGMTrajectoryRetimer
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+const double EGMTrajectoryRetimer::MAX_DURATION = 100.0;
+
+const double EGMTrajectoryRetimer::DURATION_TOLERANCE = 1e-4;
+
+const double EGMTrajectoryRetimer::LIMIT_TOLERANCE = 1e-9;
+
+EGMTrajectoryRetimer::EGMTrajectoryRetimer(const TrajectoryConfiguration& configuration)
+:
+configuration_(configuration)
+{
+  conditions_.operation = EGMInterpolator::Normal;
+  conditions_.spline_method = configuration_.spline_method;
+}
+
+bool EGMTrajectoryRetimer::retime(const PointGoal& start, TrajectoryGoal* p_trajectory, const double sample_time)
+{
+  return retime(&start, p_trajectory, sample_time);
+}
+
+bool EGMTrajectoryRetimer::retime(TrajectoryGoal* p_trajectory, const double sample_time)
+{
+  return retime(0, p_trajectory, sample_time);
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+bool EGMTrajectoryRetimer::retime(const PointGoal* p_start, TrajectoryGoal* p_trajectory, const double sample_time)
+{
+  if (!p_trajectory || sample_time <= 0.0)
+  {
+    return false;
+  }
+
+  bool success = true;
+
+  if (p_trajectory->points_size() == 0)
+  {
+    return true;
+  }
+
+  // Note: The first point is used as start state if it is unknown, so that the goals contain all values.
+  initializeGoal(&goal_, (p_start ? *p_start : p_trajectory->points(0)));
+  current_.CopyFrom(goal_);
+
+  for (int i = 0; i < p_trajectory->points_size(); ++i)
+  {
+    PointGoal* p_point = p_trajectory->mutable_points(i);
+    const EGMModes mode = (p_point->robot().has_cartesian() ? EGMPose : EGMJoint);
+
+    prepareGoal(&goal_, *p_point, current_, i == p_trajectory->points_size() - 1);
+
+    // Keep the first point's duration, if the start state is unknown.
+    if (!p_start && i == 0)
+    {
+      current_.CopyFrom(goal_);
+      continue;
+    }
+
+    // Skip points that should be reached, but already are (they are skipped during execution as well).
+    if (p_point->reach() && isGoalReached(goal_, current_, mode))
+    {
+      continue;
+    }
+
+    double duration = 0.0;
+
+    if (findDuration(&duration, mode, sample_time))
+    {
+      // Note: Points without durations are executed as stops (i.e. with reset velocities and accelerations).
+      if (!p_point->has_duration())
+      {
+        p_point->mutable_robot()->mutable_joints()->clear_velocity();
+        p_point->mutable_robot()->mutable_joints()->clear_acceleration();
+        p_point->mutable_robot()->mutable_cartesian()->clear_velocity();
+        p_point->mutable_robot()->mutable_cartesian()->clear_acceleration();
+        p_point->mutable_external()->mutable_joints()->clear_velocity();
+        p_point->mutable_external()->mutable_joints()->clear_acceleration();
+      }
+
+      p_point->set_duration(duration);
+    }
+    else
+    {
+      success = false;
+    }
+
+    current_.CopyFrom(goal_);
+  }
+
+  return success;
+}
+
+bool EGMTrajectoryRetimer::findDuration(double* p_duration, const EGMModes mode, const double sample_time)
+{
+  double lower = sample_time;
+  double upper = sample_time;
+
+  if (!isFeasible(upper, mode))
+  {
+    // Find a feasible upper bound.
+    do
+    {
+      lower = upper;
+      upper *= 2.0;
+
+      if (upper > MAX_DURATION)
+      {
+        return false;
+      }
+    }
+    while (!isFeasible(upper, mode));
+
+    // Bisect down to the shortest feasible duration.
+    while (upper - lower > DURATION_TOLERANCE)
+    {
+      const double duration = 0.5*(lower + upper);
+
+      if (isFeasible(duration, mode))
+      {
+        upper = duration;
+      }
+      else
+      {
+        lower = duration;
+      }
+    }
+  }
+
+  // Round up to whole sample times (so that the motions end at sample instances).
+  *p_duration = std::ceil(upper / sample_time - DURATION_TOLERANCE)*sample_time;
+
+  return true;
+}
+
+bool EGMTrajectoryRetimer::isFeasible(const double duration, const EGMModes mode)
+{
+  double velocities[EGMInterpolator::MAX_NUMBER_OF_SPLINES];
+  double accelerations[EGMInterpolator::MAX_NUMBER_OF_SPLINES];
+  double jerks[EGMInterpolator::MAX_NUMBER_OF_SPLINES];
+
+  conditions_.duration = duration;
+  conditions_.mode = mode;
+  interpolator_.update(current_, goal_, conditions_);
+  interpolator_.evaluateSplineExtremes(velocities, accelerations, jerks);
+
+  const int robot_axes = (mode == EGMPose ? 3 : current_.robot().joints().position().values_size());
+  const int external_axes = current_.external().joints().position().values_size();
+
+  return withinLimits(velocities, accelerations, jerks, 0, robot_axes, configuration_.retiming.robot_limits) &&
+         withinLimits(velocities, accelerations, jerks, interpolator_.getExternalJointsOffset(), external_axes,
+                      configuration_.retiming.external_limits);
+}
+
+bool EGMTrajectoryRetimer::withinLimits(const double* velocities,
+                                        const double* accelerations,
+                                        const double* jerks,
+                                        const int offset,
+                                        const int number_of_axes,
+                                        const std::vector<AxisLimits>& limits)
+{
+  bool result = true;
+
+  for (int i = 0; i < number_of_axes && i < (int) limits.size() && result; ++i)
+  {
+    const int index = offset + i;
+
+    if (index >= 0 && index < (int) EGMInterpolator::MAX_NUMBER_OF_SPLINES)
+    {
+      result = withinLimit(velocities[index], limits[i].velocity) &&
+               withinLimit(accelerations[index], limits[i].acceleration) &&
+               withinLimit(jerks[index], limits[i].jerk);
+    }
+  }
+
+  return result;
+}
+
+bool EGMTrajectoryRetimer::withinLimit(const double value, const double limit)
+{
+  return limit <= 0.0 || value <= limit*(1.0 + LIMIT_TOLERANCE);
+}
+
+} // end namespace egm
+} // end namespace abb
@@ -0,0 +1,300 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/socket.h>
+#endif
+
+#include <boost/bind.hpp>
+
+#include "abb_libegm/egm_udp_multi_server.h"
+
+namespace abb
+{
+namespace egm
+{
+/***********************************************************************************************************************
+ * Struct definitions: UDPMultiServer::Session
+ */
+
+UDPMultiServer::Session::Session(boost::asio::io_service& io_service,
+                                 const unsigned short port_number,
+                                 AbstractUDPServerInterface* p_interface)
+:
+socket(io_service, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), port_number)),
+dispatcher(port_number, p_interface)
+{}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: UDPMultiServer
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+// See https://stackoverflow.com/questions/16957458/static-const-in-c-class-undefined-reference/16957554
+const size_t UDPMultiServer::BUFFER_SIZE;
+const size_t UDPMultiServer::BATCH_SIZE;
+const int UDPMultiServer::WAIT_TIMEOUT_MS;
+
+UDPMultiServer::UDPMultiServer(const unsigned int number_of_workers)
+:
+number_of_workers_(number_of_workers > 0 ? number_of_workers : 1),
+started_(false),
+stop_requested_(false)
+{}
+
+UDPMultiServer::~UDPMultiServer()
+{
+  stop();
+}
+
+bool UDPMultiServer::addSession(const unsigned short port_number, AbstractUDPServerInterface* p_interface)
+{
+  bool success = false;
+
+  if (!started_ && p_interface)
+  {
+    try
+    {
+      boost::shared_ptr<Session> p_session(new Session(io_service_, port_number, p_interface));
+
+      // All operations are performed without blocking, the workers wait for readiness instead.
+      p_session->socket.non_blocking(true);
+
+      sessions_.push_back(p_session);
+      success = true;
+    }
+    catch (const std::exception&)
+    {
+      success = false;
+    }
+  }
+
+  return success;
+}
+
+bool UDPMultiServer::start()
+{
+  bool success = false;
+
+  if (!started_ && !sessions_.empty())
+  {
+    stop_requested_ = false;
+
+    // Don't start more workers than there are sessions.
+    const size_t number_of_workers = std::min((size_t) number_of_workers_, sessions_.size());
+
+    for (size_t i = 0; i < number_of_workers; ++i)
+    {
+      workers_.create_thread(boost::bind(&UDPMultiServer::workerThread, this, i));
+    }
+
+    started_ = true;
+    success = true;
+  }
+
+  return success;
+}
+
+void UDPMultiServer::stop()
+{
+  if (started_)
+  {
+    stop_requested_ = true;
+    workers_.join_all();
+    started_ = false;
+  }
+}
+
+size_t UDPMultiServer::numberOfSessions() const
+{
+  return sessions_.size();
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+void UDPMultiServer::workerThread(const size_t worker_index)
+{
+  const size_t number_of_workers = std::min((size_t) number_of_workers_, sessions_.size());
+
+  // The sessions are distributed round-robin over the workers.
+  std::vector<Session*> sessions;
+  for (size_t i = worker_index; i < sessions_.size(); i += number_of_workers)
+  {
+    sessions.push_back(sessions_[i].get());
+  }
+
+  // Preallocate all buffers, so that no allocations are needed while running.
+  std::vector<char> receive_buffers(BATCH_SIZE*BUFFER_SIZE);
+  std::vector<char> send_buffers(BATCH_SIZE*BUFFER_SIZE);
+
+#if defined(__linux__)
+  std::vector<pollfd> poll_fds(sessions.size());
+  for (size_t i = 0; i < sessions.size(); ++i)
+  {
+    poll_fds[i].fd = sessions[i]->socket.native_handle();
+    poll_fds[i].events = POLLIN;
+    poll_fds[i].revents = 0;
+  }
+
+  while (!stop_requested_)
+  {
+    if (poll(&poll_fds[0], poll_fds.size(), WAIT_TIMEOUT_MS) > 0)
+    {
+      for (size_t i = 0; i < poll_fds.size(); ++i)
+      {
+        if (poll_fds[i].revents & POLLIN)
+        {
+          processSession(sessions[i], &receive_buffers[0], &send_buffers[0]);
+        }
+      }
+    }
+  }
+#else
+  while (!stop_requested_)
+  {
+    for (size_t i = 0; i < sessions.size(); ++i)
+    {
+      processSession(sessions[i], &receive_buffers[0], &send_buffers[0]);
+    }
+
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(1));
+  }
+#endif
+}
+
+void UDPMultiServer::processSession(Session* p_session, char* p_receive_buffers, char* p_send_buffers)
+{
+#if defined(__linux__)
+  const int fd = p_session->socket.native_handle();
+
+  mmsghdr receive_messages[BATCH_SIZE];
+  mmsghdr send_messages[BATCH_SIZE];
+  iovec receive_vectors[BATCH_SIZE];
+  iovec send_vectors[BATCH_SIZE];
+  sockaddr_storage addresses[BATCH_SIZE];
+
+  int number_of_received = 0;
+
+  do
+  {
+    std::memset(receive_messages, 0, sizeof(receive_messages));
+
+    for (size_t i = 0; i < BATCH_SIZE; ++i)
+    {
+      receive_vectors[i].iov_base = p_receive_buffers + i*BUFFER_SIZE;
+      receive_vectors[i].iov_len = BUFFER_SIZE;
+      receive_messages[i].msg_hdr.msg_iov = &receive_vectors[i];
+      receive_messages[i].msg_hdr.msg_iovlen = 1;
+      receive_messages[i].msg_hdr.msg_name = &addresses[i];
+      receive_messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    }
+
+    number_of_received = recvmmsg(fd, receive_messages, BATCH_SIZE, MSG_DONTWAIT, NULL);
+
+    unsigned int number_of_replies = 0;
+
+    for (int i = 0; i < number_of_received; ++i)
+    {
+      // Process the received data via the callback method (creates the reply message).
+      const std::string& reply = p_session->dispatcher.dispatch(p_receive_buffers + i*BUFFER_SIZE,
+                                                                (int) receive_messages[i].msg_len);
+
+      if (!reply.empty() && reply.size() <= BUFFER_SIZE)
+      {
+        // The reply is owned by the interface (and overwritten by the next callback), so it is copied.
+        char* p_reply = p_send_buffers + number_of_replies*BUFFER_SIZE;
+        std::memcpy(p_reply, reply.data(), reply.size());
+
+        std::memset(&send_messages[number_of_replies], 0, sizeof(mmsghdr));
+        send_vectors[number_of_replies].iov_base = p_reply;
+        send_vectors[number_of_replies].iov_len = reply.size();
+        send_messages[number_of_replies].msg_hdr.msg_iov = &send_vectors[number_of_replies];
+        send_messages[number_of_replies].msg_hdr.msg_iovlen = 1;
+        send_messages[number_of_replies].msg_hdr.msg_name = &addresses[i];
+        send_messages[number_of_replies].msg_hdr.msg_namelen = receive_messages[i].msg_hdr.msg_namelen;
+        ++number_of_replies;
+      }
+    }
+
+    if (number_of_replies > 0)
+    {
+      // Send the response messages to the robot controller(s).
+      sendmmsg(fd, send_messages, number_of_replies, 0);
+      p_session->dispatcher.postReply();
+    }
+  }
+  while (number_of_received == (int) BATCH_SIZE);
+#else
+  boost::system::error_code error;
+  boost::asio::ip::udp::endpoint remote_endpoint;
+
+  while (true)
+  {
+    const std::size_t bytes_transferred = p_session->socket.receive_from(boost::asio::buffer(p_receive_buffers,
+                                                                                             BUFFER_SIZE),
+                                                                         remote_endpoint,
+                                                                         0,
+                                                                         error);
+    if (error)
+    {
+      break;
+    }
+
+    const std::string& reply = p_session->dispatcher.dispatch(p_receive_buffers, (int) bytes_transferred);
+
+    if (!reply.empty())
+    {
+      p_session->socket.send_to(boost::asio::buffer(reply), remote_endpoint, 0, error);
+      p_session->dispatcher.postReply();
+    }
+  }
+#endif
+}
+
+} // end namespace egm
+} // end namespace abb
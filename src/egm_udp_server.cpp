@@ -36,6 +36,13 @@
 
 #include <boost/bind.hpp>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+#include "abb_libegm/egm_capture.h"
 #include "abb_libegm/egm_udp_server.h"
 
 namespace abb
@@ -48,19 +55,29 @@ namespace egm
 
 UDPServer::UDPServer(boost::asio::io_service& io_service,
                      unsigned short port_number,
-                     AbstractUDPServerInterface* p_interface)
+                     AbstractUDPServerInterface* p_interface,
+                     const UDPServerConfiguration& configuration)
 :
 initialized_(false),
-p_interface_(p_interface)
+p_interface_(p_interface),
+configuration_(configuration),
+started_(false),
+stop_requested_(false),
+thread_attributes_status_(NotApplied),
+number_of_failed_replies_(0)
 {
   bool success = true;
 
+  server_data_.port_number = port_number;
+
   try
   {
-    server_data_.port_number = port_number;
-    p_socket_.reset(new boost::asio::ip::udp::socket(io_service,
-                                                     boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(),
-                                                                                    port_number)));
+    if (configuration_.mode != UDPServerConfiguration::External)
+    {
+        p_socket_.reset(new boost::asio::ip::udp::socket(io_service,
+                                                       boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(),
+                                                                                      port_number)));
+    }
   }
   catch (std::exception e)
   {
@@ -70,12 +87,18 @@ p_interface_(p_interface)
   if (success)
   {
     initialized_ = true;
-    startAsynchronousReceive();
+
+    if (!configuration_.capture_filename.empty() && configuration_.mode != UDPServerConfiguration::External)
+    {
+      p_capture_writer_.reset(new EGMCaptureWriter(configuration_.capture_filename));
+    }
   }
 }
 
 UDPServer::~UDPServer()
 {
+  stop();
+
   if (p_socket_)
   {
     p_socket_->close();
@@ -88,6 +111,70 @@ bool UDPServer::isInitialized() const
   return initialized_;
 }
 
+bool UDPServer::start()
+{
+  if (!initialized_ || started_)
+  {
+    return false;
+  }
+
+  started_ = true;
+
+  switch (configuration_.mode)
+  {
+    case UDPServerConfiguration::DedicatedBlocking:
+    case UDPServerConfiguration::DedicatedBusyPolling:
+    {
+      stop_requested_ = false;
+      dedicated_thread_ = boost::thread(&UDPServer::dedicatedThread, this);
+    }
+    break;
+
+    case UDPServerConfiguration::External:
+    {
+      // Nothing to do, the messages are dispatched externally.
+    }
+    break;
+
+    case UDPServerConfiguration::Asynchronous:
+    default:
+    {
+      startAsynchronousReceive();
+    }
+  }
+
+  return true;
+}
+
+void UDPServer::stop()
+{
+  if (dedicated_thread_.joinable())
+  {
+    stop_requested_ = true;
+
+    if (p_socket_ && configuration_.mode == UDPServerConfiguration::DedicatedBlocking)
+    {
+      // Wake up the blocking receive, by sending an empty datagram to the server's own socket.
+      boost::system::error_code error;
+      boost::asio::ip::udp::endpoint local_endpoint(boost::asio::ip::address_v4::loopback(),
+                                                    p_socket_->local_endpoint(error).port());
+      p_socket_->send_to(boost::asio::buffer(receive_buffer_, 0), local_endpoint, 0, error);
+    }
+
+    dedicated_thread_.join();
+  }
+}
+
+UDPServer::ThreadAttributesStatus UDPServer::getThreadAttributesStatus() const
+{
+  return static_cast<ThreadAttributesStatus>(thread_attributes_status_.load());
+}
+
+unsigned int UDPServer::getNumberOfFailedReplies() const
+{
+  return number_of_failed_replies_.load();
+}
+
 void UDPServer::startAsynchronousReceive()
 {
   if (p_socket_)
@@ -105,6 +192,12 @@ void UDPServer::receiveCallback(const boost::system::error_code& error, const st
 {
   server_data_.p_data = receive_buffer_;
   server_data_.bytes_transferred = (int) bytes_transferred;
+  server_data_.receive_time = boost::chrono::steady_clock::now();
+
+  if (p_capture_writer_ && !error)
+  {
+    p_capture_writer_->add(server_data_);
+  }
 
   if (error == boost::system::errc::success && p_interface_)
   {
@@ -120,6 +213,9 @@ void UDPServer::receiveCallback(const boost::system::error_code& error, const st
                                            this,
                                            boost::asio::placeholders::error,
                                            boost::asio::placeholders::bytes_transferred));
+
+      // Note: The send is attempted immediately, so the interface can prepare for the next message.
+      p_interface_->postReply();
     }
   }
 
@@ -127,7 +223,150 @@ void UDPServer::receiveCallback(const boost::system::error_code& error, const st
   startAsynchronousReceive();
 }
 
-void UDPServer::sendCallback(const boost::system::error_code& error, const std::size_t bytes_transferred) {}
+void UDPServer::sendCallback(const boost::system::error_code& error, const std::size_t bytes_transferred)
+{
+  if (error)
+  {
+    ++number_of_failed_replies_;
+  }
+}
+
+void UDPServer::dedicatedThread()
+{
+  thread_attributes_status_ = (applyThreadAttributes() ? Applied : Failed);
+
+  boost::system::error_code error;
+  const bool busy_polling = (configuration_.mode == UDPServerConfiguration::DedicatedBusyPolling);
+
+  p_socket_->non_blocking(busy_polling, error);
+
+  while (!stop_requested_)
+  {
+    const std::size_t bytes_transferred = p_socket_->receive_from(boost::asio::buffer(receive_buffer_),
+                                                                  remote_endpoint_,
+                                                                  0,
+                                                                  error);
+
+    if (stop_requested_)
+    {
+      break;
+    }
+
+    if (error == boost::asio::error::would_block || error == boost::asio::error::try_again)
+    {
+      // Nothing received yet (only when busy-polling).
+      continue;
+    }
+
+    server_data_.p_data = receive_buffer_;
+    server_data_.bytes_transferred = (int) bytes_transferred;
+    server_data_.receive_time = boost::chrono::steady_clock::now();
+
+    if (p_capture_writer_ && !error)
+    {
+      p_capture_writer_->add(server_data_);
+    }
+
+    if (!error && p_interface_)
+    {
+      // Process the received data via the callback method (creates the reply message).
+      const std::string& reply = p_interface_->callback(server_data_);
+
+      if (!reply.empty())
+      {
+        // Send the response message to the robot controller.
+        // Note: The socket is non-blocking when busy-polling, so retry until the send buffer has room for the reply.
+        do
+        {
+          p_socket_->send_to(boost::asio::buffer(reply), remote_endpoint_, 0, error);
+        }
+        while ((error == boost::asio::error::would_block || error == boost::asio::error::try_again) &&
+               !stop_requested_);
+
+        if (error)
+        {
+          ++number_of_failed_replies_;
+        }
+
+        p_interface_->postReply();
+      }
+    }
+  }
+}
+
+bool UDPServer::applyThreadAttributes()
+{
+  bool success = true;
+
+#if defined(__linux__)
+  if (configuration_.cpu_affinity >= 0)
+  {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(configuration_.cpu_affinity, &cpu_set);
+
+    success = (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) == 0) && success;
+  }
+
+  if (configuration_.priority > 0)
+  {
+    sched_param parameters;
+    parameters.sched_priority = configuration_.priority;
+
+    success = (pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters) == 0) && success;
+  }
+
+  if (configuration_.lock_memory)
+  {
+    success = (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) && success;
+  }
+#else
+  success = (configuration_.cpu_affinity < 0 && configuration_.priority <= 0 && !configuration_.lock_memory);
+#endif
+
+  return success;
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: UDPDispatcher
+ */
+
+UDPDispatcher::UDPDispatcher(const unsigned short port_number, AbstractUDPServerInterface* p_interface)
+:
+p_interface_(p_interface)
+{
+  server_data_.port_number = port_number;
+}
+
+const std::string& UDPDispatcher::dispatch(char* p_data, const int bytes_transferred)
+{
+  if (!p_interface_)
+  {
+    return empty_reply_;
+  }
+
+  server_data_.p_data = p_data;
+  server_data_.bytes_transferred = bytes_transferred;
+  server_data_.receive_time = boost::chrono::steady_clock::now();
+
+  return p_interface_->callback(server_data_);
+}
+
+void UDPDispatcher::postReply()
+{
+  if (p_interface_)
+  {
+    p_interface_->postReply();
+  }
+}
+
+unsigned short UDPDispatcher::getPortNumber() const
+{
+  return (unsigned short) server_data_.port_number;
+}
 
 } // end namespace egm
 } // end namespace abb